@@ -0,0 +1,137 @@
+/*
+ Frame ring shared by the INDI 3rd party camera drivers.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct FrameRingNoInfo
+{
+};
+
+/**
+ * @brief The FrameRing class is a fixed set of pre-allocated frame slots shared by exactly one
+ * producer (usually the thread reading frames from the camera SDK) and one consumer (the thread
+ * processing or delivering them). Slots are handed over in order through two atomic counters,
+ * so neither side ever blocks the other.
+ *
+ * Between acquire() and commit() the slot belongs to the producer alone, which may therefore
+ * grow its data vector if the frame does not fit. Likewise the consumer owns the slot between
+ * front() and release().
+ *
+ * @tparam Info driver specific per frame information stored along with the data.
+ */
+template <typename Info = FrameRingNoInfo>
+class FrameRing
+{
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Slot
+        {
+            std::vector<uint8_t> data;
+            uint32_t size = 0;
+            Clock::time_point captured;
+            Info info;
+        };
+
+        /**
+         * @brief allocate (Re)allocate the slots. Must not be called while producer or consumer are active.
+         * @param count number of slots.
+         * @param slotSize size of each slot in bytes, may be 0 to let the producer size the slots on first use.
+         */
+        void allocate(size_t count, size_t slotSize)
+        {
+            if (count < 1)
+                count = 1;
+
+            if (count != m_Slots.size() || slotSize != m_SlotSize)
+            {
+                m_Slots.clear();
+                m_Slots.resize(count);
+                for (auto &slot : m_Slots)
+                    slot.data.resize(slotSize);
+                m_SlotSize = slotSize;
+            }
+
+            m_Head.store(0, std::memory_order_relaxed);
+            m_Tail.store(0, std::memory_order_relaxed);
+        }
+
+        size_t capacity() const
+        {
+            return m_Slots.size();
+        }
+
+        size_t slotSize() const
+        {
+            return m_SlotSize;
+        }
+
+        /** @return number of frames committed by the producer and not yet released by the consumer. */
+        size_t depth() const
+        {
+            return m_Head.load(std::memory_order_acquire) - m_Tail.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief acquire Producer side: get the next free slot.
+         * @return slot to fill, or nullptr if all slots are still queued for the consumer.
+         */
+        Slot *acquire()
+        {
+            size_t head = m_Head.load(std::memory_order_relaxed);
+            if (m_Slots.empty() || head - m_Tail.load(std::memory_order_acquire) >= m_Slots.size())
+                return nullptr;
+            return &m_Slots[head % m_Slots.size()];
+        }
+
+        /** @brief commit Producer side: publish the slot returned by the last acquire(). */
+        void commit()
+        {
+            m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief front Consumer side: get the oldest committed slot.
+         * @return slot to process, or nullptr if the ring is empty.
+         */
+        Slot *front()
+        {
+            size_t tail = m_Tail.load(std::memory_order_relaxed);
+            if (tail == m_Head.load(std::memory_order_acquire))
+                return nullptr;
+            return &m_Slots[tail % m_Slots.size()];
+        }
+
+        /** @brief release Consumer side: hand the slot returned by the last front() back to the producer. */
+        void release()
+        {
+            m_Tail.store(m_Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+    private:
+        std::vector<Slot> m_Slots;
+        size_t m_SlotSize {0};
+        std::atomic<size_t> m_Head {0};
+        std::atomic<size_t> m_Tail {0};
+};
@@ -0,0 +1,501 @@
+/*
+ Frame stacking engine shared by the INDI 3rd party camera drivers.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "framestack.h"
+#include "pixelconvert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRAMESTACK_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FRAMESTACK_NEON
+#include <arm_neon.h>
+#endif
+
+namespace FrameStackKernels
+{
+
+/*********************************************************************************
+ * Scalar
+ *********************************************************************************/
+template <typename T>
+static void accumulateScalar(const T *src, uint32_t *sum, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+        sum[i] += src[i];
+}
+
+/*********************************************************************************
+ * x86 SSE2 / AVX2
+ *
+ * Samples are zero extended to 32 bit and added to the sums, each kernel returns the number of
+ * samples processed and leaves the tail to the scalar loop. SSE2 is used whenever PixelConvert
+ * selected SSSE3, which implies it.
+ *********************************************************************************/
+#ifdef FRAMESTACK_X86
+
+__attribute__((target("sse2")))
+static size_t accumulate8_sse2(const uint8_t *src, uint32_t *sum, size_t samples)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i *s = reinterpret_cast<__m128i *>(sum + i);
+        _mm_storeu_si128(s + 0, _mm_add_epi32(_mm_loadu_si128(s + 0), _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(s + 2, _mm_add_epi32(_mm_loadu_si128(s + 2), _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(s + 3, _mm_add_epi32(_mm_loadu_si128(s + 3), _mm_unpackhi_epi16(hi, zero)));
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+static size_t accumulate16_sse2(const uint16_t *src, uint32_t *sum, size_t samples)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i *s = reinterpret_cast<__m128i *>(sum + i);
+        _mm_storeu_si128(s + 0, _mm_add_epi32(_mm_loadu_si128(s + 0), _mm_unpacklo_epi16(v, zero)));
+        _mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), _mm_unpackhi_epi16(v, zero)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t accumulate8_avx2(const uint8_t *src, uint32_t *sum, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 32 <= samples; i += 32)
+    {
+        __m256i *s = reinterpret_cast<__m256i *>(sum + i);
+        for (int k = 0; k < 4; k++)
+        {
+            __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i + k * 8)));
+            _mm256_storeu_si256(s + k, _mm256_add_epi32(_mm256_loadu_si256(s + k), v));
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t accumulate16_avx2(const uint16_t *src, uint32_t *sum, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        __m256i *s = reinterpret_cast<__m256i *>(sum + i);
+        for (int k = 0; k < 2; k++)
+        {
+            __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + k * 8)));
+            _mm256_storeu_si256(s + k, _mm256_add_epi32(_mm256_loadu_si256(s + k), v));
+        }
+    }
+    return i;
+}
+
+#endif
+
+/*********************************************************************************
+ * ARM NEON
+ *********************************************************************************/
+#ifdef FRAMESTACK_NEON
+
+static size_t accumulate8_neon(const uint8_t *src, uint32_t *sum, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        uint8x16_t v  = vld1q_u8(src + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        vst1q_u32(sum + i + 0, vaddw_u16(vld1q_u32(sum + i + 0), vget_low_u16(lo)));
+        vst1q_u32(sum + i + 4, vaddw_u16(vld1q_u32(sum + i + 4), vget_high_u16(lo)));
+        vst1q_u32(sum + i + 8, vaddw_u16(vld1q_u32(sum + i + 8), vget_low_u16(hi)));
+        vst1q_u32(sum + i + 12, vaddw_u16(vld1q_u32(sum + i + 12), vget_high_u16(hi)));
+    }
+    return i;
+}
+
+static size_t accumulate16_neon(const uint16_t *src, uint32_t *sum, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        uint16x8_t v = vld1q_u16(src + i);
+        vst1q_u32(sum + i + 0, vaddw_u16(vld1q_u32(sum + i + 0), vget_low_u16(v)));
+        vst1q_u32(sum + i + 4, vaddw_u16(vld1q_u32(sum + i + 4), vget_high_u16(v)));
+    }
+    return i;
+}
+
+#endif
+
+void accumulate8(const uint8_t *src, uint32_t *sum, size_t samples)
+{
+    size_t done = 0;
+
+    switch (PixelConvert::current())
+    {
+#ifdef FRAMESTACK_X86
+        case PixelConvert::IMPL_AVX2:
+            done = accumulate8_avx2(src, sum, samples);
+            break;
+        case PixelConvert::IMPL_SSSE3:
+            done = accumulate8_sse2(src, sum, samples);
+            break;
+#endif
+#ifdef FRAMESTACK_NEON
+        case PixelConvert::IMPL_NEON:
+            done = accumulate8_neon(src, sum, samples);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    accumulateScalar(src + done, sum + done, samples - done);
+}
+
+void accumulate16(const uint16_t *src, uint32_t *sum, size_t samples)
+{
+    size_t done = 0;
+
+    switch (PixelConvert::current())
+    {
+#ifdef FRAMESTACK_X86
+        case PixelConvert::IMPL_AVX2:
+            done = accumulate16_avx2(src, sum, samples);
+            break;
+        case PixelConvert::IMPL_SSSE3:
+            done = accumulate16_sse2(src, sum, samples);
+            break;
+#endif
+#ifdef FRAMESTACK_NEON
+        case PixelConvert::IMPL_NEON:
+            done = accumulate16_neon(src, sum, samples);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    accumulateScalar(src + done, sum + done, samples - done);
+}
+
+}
+
+/*********************************************************************************
+ * Rejection
+ *
+ * Groups are processed in blocks of samples so the per sample statistics stay in cache, and the
+ * inner loops run over consecutive samples of one frame, which the compiler can vectorize.
+ *********************************************************************************/
+#define REJECTION_BLOCK 1024
+
+template <typename T>
+static void sigmaClip(const T *frames, size_t stride, size_t count, size_t samples, float kappa, float *out)
+{
+    float sum[REJECTION_BLOCK], squares[REJECTION_BLOCK], kept[REJECTION_BLOCK], keptCount[REJECTION_BLOCK];
+    const float others = 1.0f / (count - 1);
+    const float kappa2 = kappa * kappa;
+
+    for (size_t start = 0; start < samples; start += REJECTION_BLOCK)
+    {
+        size_t n = std::min<size_t>(REJECTION_BLOCK, samples - start);
+
+        std::fill(sum, sum + n, 0.0f);
+        std::fill(squares, squares + n, 0.0f);
+        for (size_t f = 0; f < count; f++)
+        {
+            const T *src = frames + f * stride + start;
+            for (size_t i = 0; i < n; i++)
+            {
+                float v = src[i];
+                sum[i]     += v;
+                squares[i] += v * v;
+            }
+        }
+
+        // Each value is compared with the mean and deviation of the other frames of the group, a
+        // single outlier inflates the deviation of the whole group too much to ever be rejected
+        // in groups of less than 9 frames.
+        std::fill(kept, kept + n, 0.0f);
+        std::fill(keptCount, keptCount + n, 0.0f);
+        for (size_t f = 0; f < count; f++)
+        {
+            const T *src = frames + f * stride + start;
+            for (size_t i = 0; i < n; i++)
+            {
+                float v        = src[i];
+                float mean     = (sum[i] - v) * others;
+                float variance = std::max((squares[i] - v * v) * others - mean * mean, 0.0f);
+                float d        = v - mean;
+                float keep     = (d * d <= kappa2 * variance) ? 1.0f : 0.0f;
+                kept[i]      += v * keep;
+                keptCount[i] += keep;
+            }
+        }
+
+        // With a small kappa every value may be rejected, the mean is used then
+        for (size_t i = 0; i < n; i++)
+            out[start + i] += (keptCount[i] > 0 ? kept[i] / keptCount[i] : sum[i] / count) * count;
+    }
+}
+
+template <typename T>
+static void median(const T *frames, size_t stride, size_t count, size_t samples, float *out)
+{
+    T values[FrameStack::MAX_GROUP];
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        for (size_t f = 0; f < count; f++)
+            values[f] = frames[f * stride + i];
+
+        // Insertion sort, groups are small
+        for (size_t a = 1; a < count; a++)
+        {
+            T v = values[a];
+            size_t b = a;
+            for (; b > 0 && values[b - 1] > v; b--)
+                values[b] = values[b - 1];
+            values[b] = v;
+        }
+
+        float m = (count % 2) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) * 0.5f;
+        out[i] += m * count;
+    }
+}
+
+template <typename T>
+static void addFrames(const T *frames, size_t stride, size_t count, size_t samples, float *out)
+{
+    for (size_t f = 0; f < count; f++)
+    {
+        const T *src = frames + f * stride;
+        for (size_t i = 0; i < samples; i++)
+            out[i] += src[i];
+    }
+}
+
+/*********************************************************************************
+ * FrameStack
+ *********************************************************************************/
+FrameStack::FrameStack(size_t queueDepth)
+{
+    m_Ring.allocate(queueDepth, 0);
+    m_Thread = std::thread(&FrameStack::run, this);
+}
+
+FrameStack::~FrameStack()
+{
+    std::unique_lock<std::mutex> guard(m_Mutex);
+    m_Exit = true;
+    guard.unlock();
+    m_Queued.notify_all();
+    m_Thread.join();
+}
+
+void FrameStack::start(size_t samples, int bpp, Rejection rejection, int groupSize, float kappa)
+{
+    wait();
+
+    m_Samples    = samples;
+    m_BPP        = (bpp > 8) ? 16 : 8;
+    m_Rejection  = rejection;
+    m_GroupSize  = std::max(3, std::min(groupSize, static_cast<int>(MAX_GROUP)));
+    m_Kappa      = kappa;
+    m_Added      = 0;
+    m_Accumulated.store(0, std::memory_order_relaxed);
+    m_GroupFrames = 0;
+
+    size_t frameSize = m_Samples * m_BPP / 8;
+
+    if (m_Rejection == REJECT_NONE)
+    {
+        m_Sum.assign(m_Samples, 0);
+        m_GroupSum.clear();
+        m_Group.clear();
+    }
+    else
+    {
+        m_Sum.clear();
+        m_GroupSum.assign(m_Samples, 0.0f);
+        m_Group.resize(frameSize * m_GroupSize);
+    }
+}
+
+void FrameStack::add(const void *frame)
+{
+    FrameRing<>::Slot *slot = nullptr;
+    {
+        std::unique_lock<std::mutex> guard(m_Mutex);
+        m_Released.wait(guard, [&]
+        {
+            return (slot = m_Ring.acquire()) != nullptr;
+        });
+    }
+
+    size_t frameSize = m_Samples * m_BPP / 8;
+    if (slot->data.size() < frameSize)
+        slot->data.resize(frameSize);
+    memcpy(slot->data.data(), frame, frameSize);
+    slot->size = frameSize;
+    m_Ring.commit();
+    m_Added++;
+
+    std::lock_guard<std::mutex> guard(m_Mutex);
+    m_Queued.notify_one();
+}
+
+void FrameStack::wait()
+{
+    std::unique_lock<std::mutex> guard(m_Mutex);
+    m_Released.wait(guard, [&]
+    {
+        return m_Accumulated.load(std::memory_order_acquire) == m_Added;
+    });
+}
+
+void FrameStack::run()
+{
+    while (true)
+    {
+        FrameRing<>::Slot *slot = nullptr;
+        {
+            std::unique_lock<std::mutex> guard(m_Mutex);
+            m_Queued.wait(guard, [&]
+            {
+                return m_Exit || (slot = m_Ring.front()) != nullptr;
+            });
+            if (slot == nullptr)
+                return;
+        }
+
+        accumulate(slot->data.data());
+        m_Ring.release();
+
+        std::lock_guard<std::mutex> guard(m_Mutex);
+        m_Accumulated.fetch_add(1, std::memory_order_release);
+        m_Released.notify_all();
+    }
+}
+
+void FrameStack::accumulate(const uint8_t *frame)
+{
+    if (m_Rejection == REJECT_NONE)
+    {
+        if (m_BPP == 8)
+            FrameStackKernels::accumulate8(frame, m_Sum.data(), m_Samples);
+        else
+            FrameStackKernels::accumulate16(reinterpret_cast<const uint16_t *>(frame), m_Sum.data(), m_Samples);
+        return;
+    }
+
+    size_t frameSize = m_Samples * m_BPP / 8;
+    memcpy(m_Group.data() + m_GroupFrames * frameSize, frame, frameSize);
+    if (++m_GroupFrames == static_cast<size_t>(m_GroupSize))
+        reduceGroup(m_GroupFrames);
+}
+
+void FrameStack::reduceGroup(size_t count)
+{
+    float *out = m_GroupSum.data();
+
+    // Statistics of less than 3 values reject nothing useful
+    if (count < 3)
+    {
+        if (m_BPP == 8)
+            addFrames(m_Group.data(), m_Samples, count, m_Samples, out);
+        else
+            addFrames(reinterpret_cast<const uint16_t *>(m_Group.data()), m_Samples, count, m_Samples, out);
+    }
+    else if (m_Rejection == REJECT_SIGMA_CLIP)
+    {
+        if (m_BPP == 8)
+            sigmaClip(m_Group.data(), m_Samples, count, m_Samples, m_Kappa, out);
+        else
+            sigmaClip(reinterpret_cast<const uint16_t *>(m_Group.data()), m_Samples, count, m_Samples, m_Kappa, out);
+    }
+    else
+    {
+        if (m_BPP == 8)
+            median(m_Group.data(), m_Samples, count, m_Samples, out);
+        else
+            median(reinterpret_cast<const uint16_t *>(m_Group.data()), m_Samples, count, m_Samples, out);
+    }
+
+    m_GroupFrames = 0;
+}
+
+size_t FrameStack::finish(uint16_t *result, bool average)
+{
+    wait();
+
+    size_t frames = m_Added;
+    float scale = 1.0f;
+    if (average && frames > 0)
+        scale = (m_BPP == 8 ? 256.0f : 1.0f) / frames;
+
+    if (m_Rejection == REJECT_NONE)
+    {
+        // Sums of long stacks go beyond the 24 bit mantissa of a float
+        double exactScale = average && frames > 0 ? (m_BPP == 8 ? 256.0 : 1.0) / frames : 1.0;
+        for (size_t i = 0; i < m_Samples; i++)
+        {
+            double v = m_Sum[i] * exactScale + 0.5;
+            result[i] = static_cast<uint16_t>(std::min(v, 65535.0));
+        }
+    }
+    else
+    {
+        if (m_GroupFrames > 0)
+            reduceGroup(m_GroupFrames);
+
+        for (size_t i = 0; i < m_Samples; i++)
+        {
+            float v = m_GroupSum[i] * scale + 0.5f;
+            result[i] = static_cast<uint16_t>(std::max(0.0f, std::min(v, 65535.0f)));
+        }
+    }
+
+    return frames;
+}
+
+void FrameStack::abort()
+{
+    wait();
+    m_Added = 0;
+    m_Accumulated.store(0, std::memory_order_relaxed);
+    m_GroupFrames = 0;
+    m_Sum.clear();
+    m_GroupSum.clear();
+}
@@ -0,0 +1,125 @@
+/*
+ Frame stacking engine shared by the INDI 3rd party camera drivers.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "framering.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The FrameStack class sums frames of 8 or 16 bit samples on a worker thread, so the caller
+ * can decode the next frame while the previous one is accumulated. The layout of the samples does
+ * not matter, interleaved frames give an interleaved stack.
+ *
+ * Without rejection every frame is added to 32 bit integer sums with the SIMD implementation
+ * selected by PixelConvert. With rejection frames are combined in groups: each group contributes
+ * its median, or its mean after discarding values more than kappa standard deviations away from
+ * the other frames of the group, times the number of frames in the group. Sums of groups are kept
+ * as float.
+ *
+ * The stack is written as 16 bit samples, saturating at 65535.
+ */
+class FrameStack
+{
+    public:
+        enum Rejection
+        {
+            REJECT_NONE,
+            REJECT_SIGMA_CLIP,
+            REJECT_MEDIAN
+        };
+
+        /** Frames of a rejection group are limited to keep the per sample work bounded. */
+        static constexpr int MAX_GROUP = 32;
+
+        /** @param queueDepth frames that may wait for the worker before add() blocks. */
+        explicit FrameStack(size_t queueDepth = 4);
+        ~FrameStack();
+
+        /**
+         * @brief start Drop any previous stack and start a new one.
+         * @param samples values per frame, e.g. width * height * 3 for RGB.
+         * @param bpp bits per sample of the frames, 8 or 16.
+         * @param groupSize frames per rejection group, 3 to MAX_GROUP.
+         * @param kappa clipping threshold in standard deviations for REJECT_SIGMA_CLIP.
+         */
+        void start(size_t samples, int bpp, Rejection rejection = REJECT_NONE, int groupSize = 5, float kappa = 2.5f);
+
+        /** @brief add Queue a copy of the frame, blocks only while the worker is queueDepth frames behind. */
+        void add(const void *frame);
+
+        /**
+         * @brief finish Wait for the queued frames and write the stack.
+         * @param result samples values.
+         * @param average mean of the frames instead of their sum. Means of 8 bit frames are scaled
+         * by 256 so the fraction is kept in the 16 bit result.
+         * @return number of frames stacked.
+         */
+        size_t finish(uint16_t *result, bool average);
+
+        /** @brief abort Wait for the queued frames and drop the stack. */
+        void abort();
+
+        /** @return frames added since start(). */
+        size_t frames() const
+        {
+            return m_Added;
+        }
+
+    private:
+        void run();
+        void wait();
+        void accumulate(const uint8_t *frame);
+        void reduceGroup(size_t count);
+
+        FrameRing<> m_Ring;
+        std::thread m_Thread;
+        std::mutex m_Mutex;
+        std::condition_variable m_Queued, m_Released;
+        bool m_Exit {false};
+
+        size_t m_Added {0};
+        std::atomic<size_t> m_Accumulated {0};
+
+        size_t m_Samples {0};
+        int m_BPP {8};
+        Rejection m_Rejection {REJECT_NONE};
+        int m_GroupSize {5};
+        float m_Kappa {2.5f};
+
+        // Sums without rejection
+        std::vector<uint32_t> m_Sum;
+        // Sums of the groups and frames of the current group with rejection
+        std::vector<float> m_GroupSum;
+        std::vector<uint8_t> m_Group;
+        size_t m_GroupFrames {0};
+};
+
+namespace FrameStackKernels
+{
+/** Add samples to 32 bit sums, with the implementation selected by PixelConvert. */
+void accumulate8(const uint8_t *src, uint32_t *sum, size_t samples);
+void accumulate16(const uint16_t *src, uint32_t *sum, size_t samples);
+}
@@ -0,0 +1,637 @@
+/*
+ Pixel format conversion kernels shared by the INDI 3rd party camera drivers.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pixelconvert.h"
+
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PIXELCONVERT_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXELCONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace PixelConvert
+{
+
+/*********************************************************************************
+ * Scalar
+ *********************************************************************************/
+template <typename T>
+static void deinterleaveScalar(const T *src, T *p0, T *p1, T *p2, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++, src += 3)
+    {
+        p0[i] = src[0];
+        p1[i] = src[1];
+        p2[i] = src[2];
+    }
+}
+
+template <typename T>
+static void interleaveScalar(const T *p0, const T *p1, const T *p2, T *dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++, dst += 3)
+    {
+        dst[0] = p0[i];
+        dst[1] = p1[i];
+        dst[2] = p2[i];
+    }
+}
+
+template <typename T>
+static void swapRBScalar(T *buffer, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++, buffer += 3)
+    {
+        T tmp = buffer[0];
+        buffer[0] = buffer[2];
+        buffer[2] = tmp;
+    }
+}
+
+/*********************************************************************************
+ * x86 SSSE3 / AVX2
+ *
+ * Three consecutive 16 byte registers hold 16 (8 bit) or 8 (16 bit) complete pixels.
+ * Each output plane register is assembled with one byte shuffle per input register.
+ * The AVX2 variant does the same on two such groups at once, one per 128 bit lane.
+ *********************************************************************************/
+#ifdef PIXELCONVERT_X86
+
+struct ShuffleMasks
+{
+    // deinterleave[plane][input register]
+    alignas(16) uint8_t deinterleave[3][3][16];
+    // interleave[output register][plane]
+    alignas(16) uint8_t interleave[3][3][16];
+
+    explicit ShuffleMasks(int elementSize)
+    {
+        const int perRegister = 16 / elementSize;
+
+        for (int b = 0; b < 16; b++)
+        {
+            int element = b / elementSize, byte = b % elementSize;
+
+            for (int plane = 0; plane < 3; plane++)
+            {
+                // Source element for this plane position
+                int j = element * 3 + plane;
+                for (int reg = 0; reg < 3; reg++)
+                    deinterleave[plane][reg][b] = (j / perRegister == reg) ?
+                                                  static_cast<uint8_t>((j - reg * perRegister) * elementSize + byte) : 0x80;
+            }
+
+            for (int reg = 0; reg < 3; reg++)
+            {
+                // Destination element for this register position
+                int j = reg * perRegister + element;
+                for (int plane = 0; plane < 3; plane++)
+                    interleave[reg][plane][b] = (j % 3 == plane) ?
+                                                static_cast<uint8_t>((j / 3) * elementSize + byte) : 0x80;
+            }
+        }
+    }
+};
+
+static const ShuffleMasks &masks8()
+{
+    static const ShuffleMasks masks(1);
+    return masks;
+}
+
+static const ShuffleMasks &masks16()
+{
+    static const ShuffleMasks masks(2);
+    return masks;
+}
+
+#define SSSE3_MASK(m) _mm_load_si128(reinterpret_cast<const __m128i *>(m))
+
+__attribute__((target("ssse3")))
+static inline void deinterleaveRegs_ssse3(__m128i a, __m128i b, __m128i c, __m128i out[3], const ShuffleMasks &m)
+{
+    for (int plane = 0; plane < 3; plane++)
+        out[plane] = _mm_or_si128(_mm_or_si128(
+                                      _mm_shuffle_epi8(a, SSSE3_MASK(m.deinterleave[plane][0])),
+                                      _mm_shuffle_epi8(b, SSSE3_MASK(m.deinterleave[plane][1]))),
+                                  _mm_shuffle_epi8(c, SSSE3_MASK(m.deinterleave[plane][2])));
+}
+
+__attribute__((target("ssse3")))
+static inline void interleaveRegs_ssse3(__m128i p0, __m128i p1, __m128i p2, __m128i out[3], const ShuffleMasks &m)
+{
+    for (int reg = 0; reg < 3; reg++)
+        out[reg] = _mm_or_si128(_mm_or_si128(
+                                    _mm_shuffle_epi8(p0, SSSE3_MASK(m.interleave[reg][0])),
+                                    _mm_shuffle_epi8(p1, SSSE3_MASK(m.interleave[reg][1]))),
+                                _mm_shuffle_epi8(p2, SSSE3_MASK(m.interleave[reg][2])));
+}
+
+/* All SIMD kernels below work on groups of 48 bytes, i.e. three 16 byte registers. */
+__attribute__((target("ssse3")))
+static void deinterleave_ssse3(const uint8_t *src, uint8_t *p0, uint8_t *p1, uint8_t *p2, size_t groups,
+                               const ShuffleMasks &m)
+{
+    for (size_t i = 0; i < groups; i++, src += 48, p0 += 16, p1 += 16, p2 += 16)
+    {
+        __m128i out[3];
+        deinterleaveRegs_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)),
+                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16)),
+                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32)), out, m);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p0), out[0]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p1), out[1]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p2), out[2]);
+    }
+}
+
+__attribute__((target("ssse3")))
+static void interleave_ssse3(const uint8_t *p0, const uint8_t *p1, const uint8_t *p2, uint8_t *dst, size_t groups,
+                             const ShuffleMasks &m)
+{
+    for (size_t i = 0; i < groups; i++, dst += 48, p0 += 16, p1 += 16, p2 += 16)
+    {
+        __m128i out[3];
+        interleaveRegs_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p0)),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(p1)),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(p2)), out, m);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), out[0]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), out[1]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 32), out[2]);
+    }
+}
+
+__attribute__((target("ssse3")))
+static void swapRB_ssse3(uint8_t *buffer, size_t groups, const ShuffleMasks &m)
+{
+    for (size_t i = 0; i < groups; i++, buffer += 48)
+    {
+        __m128i planes[3], out[3];
+        deinterleaveRegs_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer)),
+                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 16)),
+                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 32)), planes, m);
+        interleaveRegs_ssse3(planes[2], planes[1], planes[0], out, m);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer), out[0]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer + 16), out[1]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer + 32), out[2]);
+    }
+}
+
+#define AVX2_MASK(m) _mm256_broadcastsi128_si256(SSSE3_MASK(m))
+
+__attribute__((target("avx2")))
+static inline __m256i loadPair_avx2(const uint8_t *lo, const uint8_t *hi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lo))),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi)), 1);
+}
+
+__attribute__((target("avx2")))
+static inline void storePair_avx2(uint8_t *lo, uint8_t *hi, __m256i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lo), _mm256_castsi256_si128(v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(hi), _mm256_extracti128_si256(v, 1));
+}
+
+__attribute__((target("avx2")))
+static inline void deinterleaveRegs_avx2(__m256i a, __m256i b, __m256i c, __m256i out[3], const ShuffleMasks &m)
+{
+    for (int plane = 0; plane < 3; plane++)
+        out[plane] = _mm256_or_si256(_mm256_or_si256(
+                                         _mm256_shuffle_epi8(a, AVX2_MASK(m.deinterleave[plane][0])),
+                                         _mm256_shuffle_epi8(b, AVX2_MASK(m.deinterleave[plane][1]))),
+                                     _mm256_shuffle_epi8(c, AVX2_MASK(m.deinterleave[plane][2])));
+}
+
+__attribute__((target("avx2")))
+static inline void interleaveRegs_avx2(__m256i p0, __m256i p1, __m256i p2, __m256i out[3], const ShuffleMasks &m)
+{
+    for (int reg = 0; reg < 3; reg++)
+        out[reg] = _mm256_or_si256(_mm256_or_si256(
+                                       _mm256_shuffle_epi8(p0, AVX2_MASK(m.interleave[reg][0])),
+                                       _mm256_shuffle_epi8(p1, AVX2_MASK(m.interleave[reg][1]))),
+                                   _mm256_shuffle_epi8(p2, AVX2_MASK(m.interleave[reg][2])));
+}
+
+/* Two groups of 48 bytes per iteration, the low lane holds the first and the high lane the second. */
+__attribute__((target("avx2")))
+static void deinterleave_avx2(const uint8_t *src, uint8_t *p0, uint8_t *p1, uint8_t *p2, size_t groups,
+                              const ShuffleMasks &m)
+{
+    size_t i = 0;
+    for (; i + 2 <= groups; i += 2, src += 96, p0 += 32, p1 += 32, p2 += 32)
+    {
+        __m256i out[3];
+        deinterleaveRegs_avx2(loadPair_avx2(src, src + 48),
+                              loadPair_avx2(src + 16, src + 64),
+                              loadPair_avx2(src + 32, src + 80), out, m);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p0), out[0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p1), out[1]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p2), out[2]);
+    }
+
+    deinterleave_ssse3(src, p0, p1, p2, groups - i, m);
+}
+
+__attribute__((target("avx2")))
+static void interleave_avx2(const uint8_t *p0, const uint8_t *p1, const uint8_t *p2, uint8_t *dst, size_t groups,
+                            const ShuffleMasks &m)
+{
+    size_t i = 0;
+    for (; i + 2 <= groups; i += 2, dst += 96, p0 += 32, p1 += 32, p2 += 32)
+    {
+        __m256i out[3];
+        interleaveRegs_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p0)),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p1)),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p2)), out, m);
+        storePair_avx2(dst, dst + 48, out[0]);
+        storePair_avx2(dst + 16, dst + 64, out[1]);
+        storePair_avx2(dst + 32, dst + 80, out[2]);
+    }
+
+    interleave_ssse3(p0, p1, p2, dst, groups - i, m);
+}
+
+__attribute__((target("avx2")))
+static void swapRB_avx2(uint8_t *buffer, size_t groups, const ShuffleMasks &m)
+{
+    size_t i = 0;
+    for (; i + 2 <= groups; i += 2, buffer += 96)
+    {
+        __m256i planes[3], out[3];
+        deinterleaveRegs_avx2(loadPair_avx2(buffer, buffer + 48),
+                              loadPair_avx2(buffer + 16, buffer + 64),
+                              loadPair_avx2(buffer + 32, buffer + 80), planes, m);
+        interleaveRegs_avx2(planes[2], planes[1], planes[0], out, m);
+        storePair_avx2(buffer, buffer + 48, out[0]);
+        storePair_avx2(buffer + 16, buffer + 64, out[1]);
+        storePair_avx2(buffer + 32, buffer + 80, out[2]);
+    }
+
+    swapRB_ssse3(buffer, groups - i, m);
+}
+
+#endif // PIXELCONVERT_X86
+
+/*********************************************************************************
+ * ARM NEON
+ *********************************************************************************/
+#ifdef PIXELCONVERT_NEON
+
+static void deinterleave8_neon(const uint8_t *src, uint8_t *p0, uint8_t *p1, uint8_t *p2, size_t groups)
+{
+    for (size_t i = 0; i < groups; i++, src += 48, p0 += 16, p1 += 16, p2 += 16)
+    {
+        uint8x16x3_t v = vld3q_u8(src);
+        vst1q_u8(p0, v.val[0]);
+        vst1q_u8(p1, v.val[1]);
+        vst1q_u8(p2, v.val[2]);
+    }
+}
+
+static void deinterleave16_neon(const uint16_t *src, uint16_t *p0, uint16_t *p1, uint16_t *p2, size_t groups)
+{
+    for (size_t i = 0; i < groups; i++, src += 24, p0 += 8, p1 += 8, p2 += 8)
+    {
+        uint16x8x3_t v = vld3q_u16(src);
+        vst1q_u16(p0, v.val[0]);
+        vst1q_u16(p1, v.val[1]);
+        vst1q_u16(p2, v.val[2]);
+    }
+}
+
+static void interleave8_neon(const uint8_t *p0, const uint8_t *p1, const uint8_t *p2, uint8_t *dst, size_t groups)
+{
+    for (size_t i = 0; i < groups; i++, dst += 48, p0 += 16, p1 += 16, p2 += 16)
+    {
+        uint8x16x3_t v;
+        v.val[0] = vld1q_u8(p0);
+        v.val[1] = vld1q_u8(p1);
+        v.val[2] = vld1q_u8(p2);
+        vst3q_u8(dst, v);
+    }
+}
+
+static void interleave16_neon(const uint16_t *p0, const uint16_t *p1, const uint16_t *p2, uint16_t *dst, size_t groups)
+{
+    for (size_t i = 0; i < groups; i++, dst += 24, p0 += 8, p1 += 8, p2 += 8)
+    {
+        uint16x8x3_t v;
+        v.val[0] = vld1q_u16(p0);
+        v.val[1] = vld1q_u16(p1);
+        v.val[2] = vld1q_u16(p2);
+        vst3q_u16(dst, v);
+    }
+}
+
+static void swapRB8_neon(uint8_t *buffer, size_t groups)
+{
+    for (size_t i = 0; i < groups; i++, buffer += 48)
+    {
+        uint8x16x3_t v = vld3q_u8(buffer);
+        uint8x16_t tmp = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = tmp;
+        vst3q_u8(buffer, v);
+    }
+}
+
+static void swapRB16_neon(uint16_t *buffer, size_t groups)
+{
+    for (size_t i = 0; i < groups; i++, buffer += 24)
+    {
+        uint16x8x3_t v = vld3q_u16(buffer);
+        uint16x8_t tmp = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = tmp;
+        vst3q_u16(buffer, v);
+    }
+}
+
+#endif // PIXELCONVERT_NEON
+
+/*********************************************************************************
+ * Dispatch
+ *********************************************************************************/
+static bool supported(Implementation impl)
+{
+    switch (impl)
+    {
+        case IMPL_SCALAR:
+            return true;
+#ifdef PIXELCONVERT_X86
+        case IMPL_SSSE3:
+            return __builtin_cpu_supports("ssse3");
+        case IMPL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef PIXELCONVERT_NEON
+        case IMPL_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+Implementation best()
+{
+    static const Implementation impl = []() -> Implementation
+    {
+#ifdef PIXELCONVERT_X86
+        __builtin_cpu_init();
+#endif
+        const Implementation candidates[] = { IMPL_AVX2, IMPL_NEON, IMPL_SSSE3 };
+        for (auto candidate : candidates)
+            if (supported(candidate))
+                return candidate;
+        return IMPL_SCALAR;
+    }();
+
+    return impl;
+}
+
+static std::atomic<int> &selected()
+{
+    static std::atomic<int> impl(best());
+    return impl;
+}
+
+Implementation current()
+{
+    return static_cast<Implementation>(selected().load(std::memory_order_relaxed));
+}
+
+bool select(Implementation impl)
+{
+    best();
+    if (!supported(impl))
+        return false;
+    selected().store(impl, std::memory_order_relaxed);
+    return true;
+}
+
+const char *name(Implementation impl)
+{
+    switch (impl)
+    {
+        case IMPL_SSSE3:
+            return "SSSE3";
+        case IMPL_AVX2:
+            return "AVX2";
+        case IMPL_NEON:
+            return "NEON";
+        default:
+            return "Scalar";
+    }
+}
+
+/* Number of pixels per 48 byte SIMD group */
+#define GROUP8  16
+#define GROUP16 8
+
+void deinterleave8(const uint8_t *src, uint8_t *p0, uint8_t *p1, uint8_t *p2, size_t pixels)
+{
+    size_t groups = 0;
+
+    switch (current())
+    {
+#ifdef PIXELCONVERT_X86
+        case IMPL_AVX2:
+            groups = pixels / GROUP8;
+            deinterleave_avx2(src, p0, p1, p2, groups, masks8());
+            break;
+        case IMPL_SSSE3:
+            groups = pixels / GROUP8;
+            deinterleave_ssse3(src, p0, p1, p2, groups, masks8());
+            break;
+#endif
+#ifdef PIXELCONVERT_NEON
+        case IMPL_NEON:
+            groups = pixels / GROUP8;
+            deinterleave8_neon(src, p0, p1, p2, groups);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    size_t done = groups * GROUP8;
+    deinterleaveScalar(src + done * 3, p0 + done, p1 + done, p2 + done, pixels - done);
+}
+
+void deinterleave16(const uint16_t *src, uint16_t *p0, uint16_t *p1, uint16_t *p2, size_t pixels)
+{
+    size_t groups = 0;
+
+    switch (current())
+    {
+#ifdef PIXELCONVERT_X86
+        case IMPL_AVX2:
+            groups = pixels / GROUP16;
+            deinterleave_avx2(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<uint8_t *>(p0),
+                              reinterpret_cast<uint8_t *>(p1), reinterpret_cast<uint8_t *>(p2), groups, masks16());
+            break;
+        case IMPL_SSSE3:
+            groups = pixels / GROUP16;
+            deinterleave_ssse3(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<uint8_t *>(p0),
+                               reinterpret_cast<uint8_t *>(p1), reinterpret_cast<uint8_t *>(p2), groups, masks16());
+            break;
+#endif
+#ifdef PIXELCONVERT_NEON
+        case IMPL_NEON:
+            groups = pixels / GROUP16;
+            deinterleave16_neon(src, p0, p1, p2, groups);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    size_t done = groups * GROUP16;
+    deinterleaveScalar(src + done * 3, p0 + done, p1 + done, p2 + done, pixels - done);
+}
+
+void interleave8(const uint8_t *p0, const uint8_t *p1, const uint8_t *p2, uint8_t *dst, size_t pixels)
+{
+    size_t groups = 0;
+
+    switch (current())
+    {
+#ifdef PIXELCONVERT_X86
+        case IMPL_AVX2:
+            groups = pixels / GROUP8;
+            interleave_avx2(p0, p1, p2, dst, groups, masks8());
+            break;
+        case IMPL_SSSE3:
+            groups = pixels / GROUP8;
+            interleave_ssse3(p0, p1, p2, dst, groups, masks8());
+            break;
+#endif
+#ifdef PIXELCONVERT_NEON
+        case IMPL_NEON:
+            groups = pixels / GROUP8;
+            interleave8_neon(p0, p1, p2, dst, groups);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    size_t done = groups * GROUP8;
+    interleaveScalar(p0 + done, p1 + done, p2 + done, dst + done * 3, pixels - done);
+}
+
+void interleave16(const uint16_t *p0, const uint16_t *p1, const uint16_t *p2, uint16_t *dst, size_t pixels)
+{
+    size_t groups = 0;
+
+    switch (current())
+    {
+#ifdef PIXELCONVERT_X86
+        case IMPL_AVX2:
+            groups = pixels / GROUP16;
+            interleave_avx2(reinterpret_cast<const uint8_t *>(p0), reinterpret_cast<const uint8_t *>(p1),
+                            reinterpret_cast<const uint8_t *>(p2), reinterpret_cast<uint8_t *>(dst), groups, masks16());
+            break;
+        case IMPL_SSSE3:
+            groups = pixels / GROUP16;
+            interleave_ssse3(reinterpret_cast<const uint8_t *>(p0), reinterpret_cast<const uint8_t *>(p1),
+                             reinterpret_cast<const uint8_t *>(p2), reinterpret_cast<uint8_t *>(dst), groups, masks16());
+            break;
+#endif
+#ifdef PIXELCONVERT_NEON
+        case IMPL_NEON:
+            groups = pixels / GROUP16;
+            interleave16_neon(p0, p1, p2, dst, groups);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    size_t done = groups * GROUP16;
+    interleaveScalar(p0 + done, p1 + done, p2 + done, dst + done * 3, pixels - done);
+}
+
+void swapRB8(uint8_t *buffer, size_t pixels)
+{
+    size_t groups = 0;
+
+    switch (current())
+    {
+#ifdef PIXELCONVERT_X86
+        case IMPL_AVX2:
+            groups = pixels / GROUP8;
+            swapRB_avx2(buffer, groups, masks8());
+            break;
+        case IMPL_SSSE3:
+            groups = pixels / GROUP8;
+            swapRB_ssse3(buffer, groups, masks8());
+            break;
+#endif
+#ifdef PIXELCONVERT_NEON
+        case IMPL_NEON:
+            groups = pixels / GROUP8;
+            swapRB8_neon(buffer, groups);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    size_t done = groups * GROUP8;
+    swapRBScalar(buffer + done * 3, pixels - done);
+}
+
+void swapRB16(uint16_t *buffer, size_t pixels)
+{
+    size_t groups = 0;
+
+    switch (current())
+    {
+#ifdef PIXELCONVERT_X86
+        case IMPL_AVX2:
+            groups = pixels / GROUP16;
+            swapRB_avx2(reinterpret_cast<uint8_t *>(buffer), groups, masks16());
+            break;
+        case IMPL_SSSE3:
+            groups = pixels / GROUP16;
+            swapRB_ssse3(reinterpret_cast<uint8_t *>(buffer), groups, masks16());
+            break;
+#endif
+#ifdef PIXELCONVERT_NEON
+        case IMPL_NEON:
+            groups = pixels / GROUP16;
+            swapRB16_neon(buffer, groups);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    size_t done = groups * GROUP16;
+    swapRBScalar(buffer + done * 3, pixels - done);
+}
+
+}
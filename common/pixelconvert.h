@@ -0,0 +1,74 @@
+/*
+ Pixel format conversion kernels shared by the INDI 3rd party camera drivers.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Conversions between interleaved 3 channel pixels (RGBRGB... or BGRBGR...) as delivered by
+ * the camera SDKs and the planar layout (RRR...GGG...BBB...) used for color FITS.
+ *
+ * All functions pick the fastest implementation supported by the running CPU on first use:
+ * AVX2 or SSSE3 on x86, NEON on ARM (when built with NEON enabled), a scalar loop otherwise.
+ * Source and destination buffers must not overlap, except for the in-place swap functions.
+ */
+namespace PixelConvert
+{
+
+enum Implementation
+{
+    IMPL_SCALAR,
+    IMPL_SSSE3,
+    IMPL_AVX2,
+    IMPL_NEON
+};
+
+/** @return the implementation currently used by the conversion functions. */
+Implementation current();
+
+/** @return the fastest implementation supported by the running CPU. */
+Implementation best();
+
+/**
+ * @brief select Force a specific implementation, e.g. to compare results against the scalar one.
+ * @return false if the implementation is not supported on this CPU, the current one is kept then.
+ */
+bool select(Implementation impl);
+
+/** @return human readable name of the implementation. */
+const char *name(Implementation impl);
+
+/**
+ * @brief deinterleave8 Split interleaved 8 bit pixels into three planes.
+ * Channel 0 of each pixel goes to @a p0, channel 1 to @a p1 and channel 2 to @a p2. To convert
+ * BGR to planar RGB simply pass the R plane as @a p2 and the B plane as @a p0.
+ */
+void deinterleave8(const uint8_t *src, uint8_t *p0, uint8_t *p1, uint8_t *p2, size_t pixels);
+void deinterleave16(const uint16_t *src, uint16_t *p0, uint16_t *p1, uint16_t *p2, size_t pixels);
+
+/** @brief interleave8 Merge three planes into interleaved pixels, the inverse of deinterleave8(). */
+void interleave8(const uint8_t *p0, const uint8_t *p1, const uint8_t *p2, uint8_t *dst, size_t pixels);
+void interleave16(const uint16_t *p0, const uint16_t *p1, const uint16_t *p2, uint16_t *dst, size_t pixels);
+
+/** @brief swapRB8 Swap channel 0 and channel 2 of interleaved pixels in place (BGR <-> RGB). */
+void swapRB8(uint8_t *buffer, size_t pixels);
+void swapRB16(uint16_t *buffer, size_t pixels);
+
+}
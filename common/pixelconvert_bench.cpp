@@ -0,0 +1,152 @@
+/*
+ Pixel format conversion kernels benchmark.
+
+ Runs every conversion with each implementation supported by the CPU on common sensor sizes,
+ checks the result against the scalar implementation and reports the throughput in GB/s
+ (bytes of interleaved data processed per second).
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pixelconvert.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct SensorSize
+{
+    const char *name;
+    size_t width, height;
+};
+
+static const SensorSize sensors[] =
+{
+    { "1001x733 (odd ROI)", 1001, 733 },
+    { "1280x960 (ASI120)", 1280, 960 },
+    { "1920x1080 (ASI290)", 1920, 1080 },
+    { "3096x2080 (ASI178)", 3096, 2080 },
+    { "4144x2822 (ASI294)", 4144, 2822 },
+    { "6248x4176 (ASI6200)", 6248, 4176 },
+};
+
+template <typename T>
+struct Buffers
+{
+    std::vector<T> interleaved, planar, reference;
+
+    explicit Buffers(size_t pixels) : interleaved(pixels * 3), planar(pixels * 3), reference(pixels * 3)
+    {
+        for (auto &value : interleaved)
+            value = static_cast<T>(rand());
+    }
+};
+
+template <typename T, typename Function>
+static double measure(Function f, size_t bytes, int iterations)
+{
+    f();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return bytes * iterations / elapsed.count() / 1e9;
+}
+
+template <typename T>
+static bool run(const SensorSize &sensor, int iterations,
+                void (*deinterleave)(const T *, T *, T *, T *, size_t),
+                void (*interleave)(const T *, const T *, const T *, T *, size_t),
+                void (*swapRB)(T *, size_t))
+{
+    const size_t pixels = sensor.width * sensor.height;
+    const size_t bytes  = pixels * 3 * sizeof(T);
+    Buffers<T> b(pixels);
+    bool ok = true;
+
+    T *r = b.planar.data(), *g = r + pixels, *bl = g + pixels;
+
+    // Scalar reference results
+    PixelConvert::select(PixelConvert::IMPL_SCALAR);
+    std::vector<T> refPlanar(pixels * 3), refInterleaved(pixels * 3), refSwapped(b.interleaved);
+    deinterleave(b.interleaved.data(), refPlanar.data(), refPlanar.data() + pixels, refPlanar.data() + 2 * pixels, pixels);
+    interleave(refPlanar.data() + 2 * pixels, refPlanar.data() + pixels, refPlanar.data(), refInterleaved.data(), pixels);
+    swapRB(refSwapped.data(), pixels);
+
+    const PixelConvert::Implementation impls[] =
+    {
+        PixelConvert::IMPL_SCALAR, PixelConvert::IMPL_SSSE3, PixelConvert::IMPL_AVX2, PixelConvert::IMPL_NEON
+    };
+
+    for (auto impl : impls)
+    {
+        if (!PixelConvert::select(impl))
+            continue;
+
+        double deinterleaveGBs = measure<T>([&]
+        {
+            deinterleave(b.interleaved.data(), r, g, bl, pixels);
+        }, bytes, iterations);
+        bool deinterleaveOK = memcmp(b.planar.data(), refPlanar.data(), bytes) == 0;
+
+        double interleaveGBs = measure<T>([&]
+        {
+            interleave(refPlanar.data() + 2 * pixels, refPlanar.data() + pixels, refPlanar.data(), b.reference.data(), pixels);
+        }, bytes, iterations);
+        bool interleaveOK = memcmp(b.reference.data(), refInterleaved.data(), bytes) == 0;
+
+        // The warm up run counts as well, bring the buffer into the swapped state before comparing
+        double swapGBs = measure<T>([&]
+        {
+            swapRB(b.interleaved.data(), pixels);
+        }, bytes, iterations);
+        if (iterations % 2 == 1)
+            swapRB(b.interleaved.data(), pixels);
+        bool swapOK = memcmp(b.interleaved.data(), refSwapped.data(), bytes) == 0;
+        swapRB(b.interleaved.data(), pixels);
+
+        printf("  %-22s %2d bit %-7s deinterleave %6.2f GB/s%s  interleave %6.2f GB/s%s  swapRB %6.2f GB/s%s\n",
+               sensor.name, static_cast<int>(sizeof(T) * 8), PixelConvert::name(impl),
+               deinterleaveGBs, deinterleaveOK ? "" : " MISMATCH",
+               interleaveGBs, interleaveOK ? "" : " MISMATCH",
+               swapGBs, swapOK ? "" : " MISMATCH");
+
+        ok = ok && deinterleaveOK && interleaveOK && swapOK;
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 10;
+    if (iterations < 1)
+        iterations = 1;
+
+    printf("Best implementation: %s, %d iterations\n", PixelConvert::name(PixelConvert::best()), iterations);
+
+    bool ok = true;
+    for (const auto &sensor : sensors)
+    {
+        ok = run<uint8_t>(sensor, iterations, PixelConvert::deinterleave8, PixelConvert::interleave8,
+                          PixelConvert::swapRB8) && ok;
+        ok = run<uint16_t>(sensor, iterations, PixelConvert::deinterleave16, PixelConvert::interleave16,
+                           PixelConvert::swapRB16) && ok;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
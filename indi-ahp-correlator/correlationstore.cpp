@@ -0,0 +1,194 @@
+/*
+    indi_interferometer - a telescope array driver for INDI
+    Support for AHP cross-correlators
+    Copyright (C) 2020  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "correlationstore.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <algorithm>
+
+CorrelationStore::CorrelationStore(int lags, int chunkRows) : lags(lags), chunkRows(chunkRows)
+{
+    chunk.resize(static_cast<size_t>(lags) * static_cast<size_t>(chunkRows));
+}
+
+CorrelationStore::~CorrelationStore()
+{
+    Release();
+}
+
+bool CorrelationStore::Failed(int code)
+{
+    if(code == 0)
+        return false;
+    if(error[0] == '\0')
+        fits_get_errstatus(code, error);
+    return true;
+}
+
+bool CorrelationStore::Begin(size_t expectedRows, const char *spool)
+{
+    Release();
+    status = 0;
+    error[0] = '\0';
+    filled = 0;
+    flushed = 0;
+    allocated = static_cast<long>(expectedRows > 0 ? expectedRows : 1);
+
+    if(spool != nullptr && spool[0] != '\0') {
+        char name[PATH_MAX];
+        snprintf(name, sizeof(name), "%s/ahp_xc_XXXXXX.fits", spool);
+        int fd = mkstemps(name, 5);
+        if(fd < 0) {
+            snprintf(error, sizeof(error), "%s: %s", name, strerror(errno));
+            status = FILE_NOT_CREATED;
+            return false;
+        }
+        close(fd);
+        path = name;
+        // cfitsio refuses to overwrite the placeholder unless asked to
+        fits_create_file(&fptr, ("!" + path).c_str(), &status);
+    } else {
+        // Header, the expected rows and the padding of both
+        memsize = ((static_cast<size_t>(lags) * static_cast<size_t>(allocated) * sizeof(double) + 2879) / 2880 + 2) * 2880;
+        memfile = malloc(memsize);
+        if(memfile == nullptr) {
+            status = MEMORY_ALLOCATION;
+            return !Failed(status);
+        }
+        fits_create_memfile(&fptr, &memfile, &memsize, chunk.size() * sizeof(double), realloc, &status);
+    }
+
+    long naxes[2] = { lags, allocated };
+    if(status == 0)
+        fits_create_img(fptr, DOUBLE_IMG, 2, naxes, &status);
+    return !Failed(status);
+}
+
+double *CorrelationStore::NextRow()
+{
+    // On a write error the rows are dropped, End() reports it
+    if(filled == chunkRows)
+        Flush();
+    return &chunk[static_cast<size_t>(filled++) * static_cast<size_t>(lags)];
+}
+
+bool CorrelationStore::Flush()
+{
+    if(filled == 0)
+        return status == 0;
+
+    if(fptr != nullptr && status == 0) {
+        if(static_cast<long>(flushed + filled) > allocated) {
+            // Longer than expected, grow geometrically to keep resizing rare
+            allocated = std::max(allocated * 2, static_cast<long>(flushed + filled));
+            long naxes[2] = { lags, allocated };
+            fits_resize_img(fptr, DOUBLE_IMG, 2, naxes, &status);
+        }
+        if(status == 0)
+            fits_write_img(fptr, TDOUBLE, static_cast<LONGLONG>(flushed) * lags + 1,
+                           static_cast<LONGLONG>(filled) * lags, chunk.data(), &status);
+    }
+    flushed += filled;
+    filled = 0;
+    return !Failed(status);
+}
+
+bool CorrelationStore::End(void **fits, size_t *size)
+{
+    LONGLONG headstart = 0, datastart = 0, dataend = 0;
+
+    *fits = nullptr;
+    *size = 0;
+    if(fptr == nullptr)
+        return false;
+
+    Flush();
+    if(status == 0 && allocated != static_cast<long>(flushed)) {
+        allocated = static_cast<long>(flushed);
+        long naxes[2] = { lags, allocated };
+        fits_resize_img(fptr, DOUBLE_IMG, 2, naxes, &status);
+    }
+    if(status == 0)
+        fits_get_hduaddrll(fptr, &headstart, &datastart, &dataend, &status);
+    if(Failed(status)) {
+        Release();
+        return false;
+    }
+    fits_close_file(fptr, &status);
+    fptr = nullptr;
+    if(Failed(status)) {
+        Release();
+        return false;
+    }
+
+    if(path.empty()) {
+        *fits = memfile;
+        *size = static_cast<size_t>(dataend);
+        return true;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd >= 0) {
+        mapsize = static_cast<size_t>(dataend);
+        map = mmap(nullptr, mapsize, PROT_READ, MAP_SHARED, fd, 0);
+        if(map == MAP_FAILED)
+            map = nullptr;
+        close(fd);
+    }
+    if(map == nullptr) {
+        snprintf(error, sizeof(error), "%s: %s", path.c_str(), strerror(errno));
+        Release();
+        return false;
+    }
+    // The mapping keeps the data, nothing is left behind in the spool
+    unlink(path.c_str());
+    path.clear();
+    *fits = map;
+    *size = mapsize;
+    return true;
+}
+
+void CorrelationStore::Release()
+{
+    if(fptr != nullptr) {
+        int ignored = 0;
+        fits_close_file(fptr, &ignored);
+        fptr = nullptr;
+    }
+    free(memfile);
+    memfile = nullptr;
+    memsize = 0;
+    if(map != nullptr)
+        munmap(map, mapsize);
+    map = nullptr;
+    mapsize = 0;
+    if(!path.empty())
+        unlink(path.c_str());
+    path.clear();
+    filled = 0;
+    flushed = 0;
+}
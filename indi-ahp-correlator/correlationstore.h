@@ -0,0 +1,88 @@
+/*
+    indi_interferometer - a telescope array driver for INDI
+    Support for AHP cross-correlators
+    Copyright (C) 2020  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <fitsio.h>
+#include <string>
+#include <vector>
+
+// Rows buffered before they are appended to the FITS image
+#define CORRELATION_STORE_CHUNK_ROWS 256
+
+/**
+ * @brief Accumulates the lag spectra of one correlator stream during an integration.
+ * Every packet adds one row of lags. Rows are collected in a preallocated chunk and appended to a
+ * FITS image as each chunk fills, so nothing is copied again as the integration grows and the
+ * FITS file is complete as soon as the last chunk is written.
+ * The image lives in memory, preallocated for the expected number of rows, or in a spool file
+ * which is memory mapped once finished. With a spool file only one chunk per stream is held in
+ * memory, whatever the duration of the integration.
+ */
+class CorrelationStore
+{
+    public:
+        CorrelationStore(int lags, int chunkRows = CORRELATION_STORE_CHUNK_ROWS);
+        ~CorrelationStore();
+
+        /**
+         * @brief Start a new image, dropping the previous one.
+         * @param expectedRows Rows to allocate for upfront, the image grows past it if needed.
+         * @param spool Directory of the spool file, nullptr or empty to keep the image in memory.
+         */
+        bool Begin(size_t expectedRows, const char *spool);
+
+        /** Next row to fill with lags values, never nullptr once begun. */
+        double *NextRow();
+
+        /** Rows collected since Begin(). */
+        size_t Rows() const { return flushed + filled; }
+
+        /** Write the last rows and close the image, fits is valid until Release() or Begin(). */
+        bool End(void **fits, size_t *size);
+
+        /** Free the finished image, or drop an unfinished one. */
+        void Release();
+
+        const char *Error() const { return error; }
+
+    private:
+        bool Flush();
+        bool Failed(int status);
+
+        int lags;
+        int chunkRows;
+        std::vector<double> chunk;
+        int filled { 0 };
+        size_t flushed { 0 };
+        long allocated { 0 };
+
+        fitsfile *fptr { nullptr };
+        int status { 0 };
+        char error[FLEN_ERRMSG] {};
+
+        // In memory image, owned by cfitsio until closed
+        void *memfile { nullptr };
+        size_t memsize { 0 };
+        // Spool file image
+        std::string path;
+        void *map { nullptr };
+        size_t mapsize { 0 };
+};
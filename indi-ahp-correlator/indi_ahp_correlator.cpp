@@ -24,7 +24,8 @@
 #include <unistd.h>
 #include <sys/file.h>
 #include <memory>
-#include <regex>
+#include <fcntl.h>
+#include <chrono>
 #include <indicom.h>
 #include <sys/stat.h>
 
@@ -68,11 +69,33 @@ void ISSnoopDevice (XMLEle *root)
     array->ISSnoopDevice(root);
 }
 
-std::string regex_replace_compat(const std::string &input, const std::string &pattern, const std::string &replace)
+static void replaceAll(std::string &input, const std::string &pattern, const std::string &replace)
 {
-    std::stringstream s;
-    std::regex_replace(std::ostreambuf_iterator<char>(s), input.begin(), input.end(), std::regex(pattern), replace);
-    return s.str();
+    for(size_t pos = input.find(pattern); pos != std::string::npos; pos = input.find(pattern, pos + replace.size()))
+        input.replace(pos, pattern.size(), replace);
+}
+
+static bool writeFile(const char *name, const void *data, size_t len)
+{
+    int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+        return false;
+
+    const char *ptr = static_cast<const char *>(data);
+    while(len > 0) {
+        ssize_t n = write(fd, ptr, len);
+        if(n < 0) {
+            if(errno == EINTR)
+                continue;
+            int err = errno;
+            close(fd);
+            errno = err;
+            return false;
+        }
+        ptr += n;
+        len -= static_cast<size_t>(n);
+    }
+    return close(fd) == 0;
 }
 
 int AHP_XC::getFileIndex(const char * dir, const char * prefix, const char * ext)
@@ -84,8 +107,8 @@ int AHP_XC::getFileIndex(const char * dir, const char * prefix, const char * ext
     std::vector<std::string> files = std::vector<std::string>();
 
     std::string prefixIndex = prefix;
-    prefixIndex             = regex_replace_compat(prefixIndex, "_ISO8601", "");
-    prefixIndex             = regex_replace_compat(prefixIndex, "_XXX", "");
+    replaceAll(prefixIndex, "_ISO8601", "");
+    replaceAll(prefixIndex, "_XXX", "");
 
     // Create directory if does not exist
     struct stat st;
@@ -116,7 +139,6 @@ int AHP_XC::getFileIndex(const char * dir, const char * prefix, const char * ext
     }
     else
     {
-        closedir(dpdf);
         return -1;
     }
     int maxIndex = 0;
@@ -140,102 +162,110 @@ int AHP_XC::getFileIndex(const char * dir, const char * prefix, const char * ext
     return (maxIndex + 1);
 }
 
-void AHP_XC::sendFile(IBLOB* Blobs, IBLOBVectorProperty BlobP, int len)
+void AHP_XC::sendFiles(IBLOBVectorProperty **vectors, int count)
 {
     bool sendImage = (UploadS[0].s == ISS_ON || UploadS[2].s == ISS_ON);
     bool saveImage = (UploadS[1].s == ISS_ON || UploadS[2].s == ISS_ON);
-    for(int x = 0; x < len; x++) {
-        if (saveImage)
-        {
-            snprintf(Blobs[x].format, MAXINDIBLOBFMT, ".%s", PrimaryCCD.getImageExtension());
-
-            FILE * fp = nullptr;
-            char imageFileName[MAXRBUF];
+    std::chrono::duration<double> scan(0), save(0), send(0);
 
-            std::string prefix = UploadSettingsT[UPLOAD_PREFIX].text;
-            int maxIndex       = getFileIndex(UploadSettingsT[UPLOAD_DIR].text, UploadSettingsT[UPLOAD_PREFIX].text,
-                                              Blobs[x].format);
-
-            if (maxIndex < 0)
-            {
-                LOGF_ERROR("Error iterating directory %s. %s", UploadSettingsT[0].text,
-                           strerror(errno));
-                return;
-            }
-
-            if (maxIndex > 0)
-            {
-                char ts[32];
-                struct tm * tp;
-                time_t t;
-                time(&t);
-                tp = localtime(&t);
-                strftime(ts, sizeof(ts), "%Y-%m-%dT%H-%M-%S", tp);
-                std::string filets(ts);
-                prefix = std::regex_replace(prefix, std::regex("ISO8601"), filets);
-
-                char indexString[8];
-                snprintf(indexString, 8, "%03d", maxIndex);
-                std::string prefixIndex = indexString;
-                //prefix.replace(prefix.find("XXX"), std::string::npos, prefixIndex);
-                prefix = std::regex_replace(prefix, std::regex("XXX"), prefixIndex);
-            }
+    for(int v = 0; v < count; v++) {
+        for(int x = 0; x < vectors[v]->nbp; x++)
+            snprintf(vectors[v]->bp[x].format, MAXINDIBLOBFMT, ".%s", PrimaryCCD.getImageExtension());
+    }
 
-            snprintf(imageFileName, MAXRBUF, "%s/%s_%s%s", UploadSettingsT[0].text, prefix.c_str(), Blobs[x].name, Blobs[x].format);
+    if (saveImage)
+    {
+        // One directory scan and one index for all the files of the integration
+        auto start = std::chrono::steady_clock::now();
+        std::string prefix = UploadSettingsT[UPLOAD_PREFIX].text;
+        int maxIndex       = getFileIndex(UploadSettingsT[UPLOAD_DIR].text, UploadSettingsT[UPLOAD_PREFIX].text,
+                                          PrimaryCCD.getImageExtension());
 
-            fp = fopen(imageFileName, "w");
-            if (fp == nullptr)
-            {
-                LOGF_ERROR("Unable to save image file (%s). %s", imageFileName, strerror(errno));
-                return;
+        if (maxIndex < 0)
+        {
+            LOGF_ERROR("Error iterating directory %s. %s", UploadSettingsT[0].text,
+                       strerror(errno));
+            saveImage = false;
+        }
+        else if (maxIndex > 0)
+        {
+            char ts[32];
+            struct tm * tp;
+            time_t t;
+            time(&t);
+            tp = localtime(&t);
+            strftime(ts, sizeof(ts), "%Y-%m-%dT%H-%M-%S", tp);
+            replaceAll(prefix, "ISO8601", ts);
+
+            char indexString[8];
+            snprintf(indexString, 8, "%03d", maxIndex);
+            replaceAll(prefix, "XXX", indexString);
+        }
+        scan = std::chrono::steady_clock::now() - start;
+
+        // Written straight from the FITS buffers
+        start = std::chrono::steady_clock::now();
+        char imageFileName[MAXRBUF];
+        int saved = 0;
+        for(int v = 0; v < count && saveImage; v++) {
+            for(int x = 0; x < vectors[v]->nbp; x++) {
+                IBLOB *blob = &vectors[v]->bp[x];
+                snprintf(imageFileName, MAXRBUF, "%s/%s_%s%s", UploadSettingsT[0].text, prefix.c_str(), blob->name, blob->format);
+                if(!writeFile(imageFileName, blob->blob, static_cast<size_t>(blob->bloblen)))
+                {
+                    LOGF_ERROR("Unable to save image file (%s). %s", imageFileName, strerror(errno));
+                    continue;
+                }
+                LOGF_DEBUG("Image saved to %s", imageFileName);
+                saved++;
             }
+        }
+        save = std::chrono::steady_clock::now() - start;
 
-            size_t n = 0;
-            for (int nr = 0; nr < Blobs[x].bloblen; nr += n)
-                n = fwrite((static_cast<char *>(Blobs[x].blob) + nr), 1, static_cast<unsigned int>(Blobs[x].bloblen - nr), fp);
-
-            fclose(fp);
-
+        if(saved > 0)
+        {
             // Save image file path
             IUSaveText(&FileNameT[0], imageFileName);
 
-            LOGF_INFO("Image saved to %s", imageFileName);
+            LOGF_INFO("%d files saved to %s", saved, UploadSettingsT[0].text);
             FileNameTP.s = IPS_OK;
             IDSetText(&FileNameTP, nullptr);
         }
-
-        snprintf(Blobs[x].format, MAXINDIBLOBFMT, ".%s", PrimaryCCD.getImageExtension());
     }
-    BlobP.s   = IPS_OK;
+
+    for(int v = 0; v < count; v++)
+        vectors[v]->s = IPS_OK;
 
     if (sendImage)
     {
+        auto start = std::chrono::steady_clock::now();
 #ifdef HAVE_WEBSOCKET
         if (HasWebSocket() && WebSocketS[WEBSOCKET_ENABLED].s == ISS_ON)
         {
-            for(int x = 0; x < len; x++) {
-                auto start = std::chrono::high_resolution_clock::now();
-
-                // Send format/size/..etc first later
-                wsServer.send_text(std::string(Blobs[x].format));
-                wsServer.send_binary(Blobs[x].blob, Blobs[x].bloblen);
-
-                auto end = std::chrono::high_resolution_clock::now();
-                std::chrono::duration<double> diff = end - start;
-                LOGF_DEBUG("Websocket transfer took %g seconds", diff.count());
+            for(int v = 0; v < count; v++) {
+                for(int x = 0; x < vectors[v]->nbp; x++) {
+                    // Send format/size/..etc first later
+                    wsServer.send_text(std::string(vectors[v]->bp[x].format));
+                    wsServer.send_binary(vectors[v]->bp[x].blob, vectors[v]->bp[x].bloblen);
+                }
             }
         }
         else
 #endif
         {
-            auto start = std::chrono::high_resolution_clock::now();
-            IDSetBLOB(&BlobP, nullptr);
-            auto end = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double> diff = end - start;
-            LOGF_DEBUG("BLOB transfer took %g seconds", diff.count());
+            for(int v = 0; v < count; v++)
+                IDSetBLOB(vectors[v], nullptr);
         }
+        send = std::chrono::steady_clock::now() - start;
     }
 
+    uploadTimingN[1].value = scan.count();
+    uploadTimingN[2].value = save.count();
+    uploadTimingN[3].value = send.count();
+    uploadTimingNP.s = IPS_OK;
+    IDSetNumber(&uploadTimingNP, nullptr);
+    LOGF_DEBUG("Directory scan %g s, save %g s, transfer %g s", scan.count(), save.count(), send.count());
+
     LOG_INFO( "Upload complete");
 }
 
@@ -243,6 +273,8 @@ void AHP_XC::Callback()
 {
     ahp_xc_packet* packet = ahp_xc_alloc_packet();
 
+    bool storesOpen = false;
+
     EnableCapture(true);
     threadsRunning = true;
     while (threadsRunning)
@@ -280,83 +312,49 @@ void AHP_XC::Callback()
                 minalt = (minalt < alt[x] ? minalt : alt[x]);
             }
         }
+        if(InExposure && !storesOpen) {
+            BeginCorrelations();
+            storesOpen = true;
+        } else if(!InExposure && storesOpen) {
+            // Aborted
+            ReleaseCorrelations();
+            storesOpen = false;
+        }
         if(InExposure) {
             timeleft = CalcTimeLeft(ExpStart, ExposureRequest);
             if(timeleft <= 0.0f) {
                 // We're no longer exposing...
                 AbortExposure();
                 // We're done exposing
-                LOG_INFO("Integration complete, downloading plots...");
-                // Additional BLOBs
-                char **blobs = static_cast<char**>(malloc(sizeof(char*)*static_cast<unsigned int>(plotBP.nbp)+1));
+                LOG_INFO("Integration complete, generating BLOBs...");
+                auto start = std::chrono::steady_clock::now();
+                IBLOBVectorProperty *vectors[3];
+                int nvectors = 0;
                 for(int x = 0; x < nplots; x++) {
-                    size_t memsize = static_cast<unsigned int>(plot_str[x]->len)*sizeof(double);
-                    blobs[x] = static_cast<char*>(malloc(memsize));
+                    size_t memsize = 0;
                     void* fits = dsp_file_write_fits(-64, &memsize, plot_str[x]);
-                    if(fits != nullptr) {
-                        blobs[x] = (char*)realloc(blobs[x], memsize);
-                        memcpy(blobs[x], fits, memsize);
-                        free(fits);
-                    }
-                    plotB[x].blob = blobs[x];
-                    plotB[x].bloblen = static_cast<int>(memsize);
+                    plotB[x].blob = fits;
+                    plotB[x].bloblen = (fits != nullptr ? static_cast<int>(memsize) : 0);
                 }
-                LOG_INFO("Plots BLOBs generated, downloading...");
-                sendFile(plotB, plotBP, nplots);
+                if(nplots > 0)
+                    vectors[nvectors++] = &plotBP;
+                EndCorrelations();
+                if(ahp_xc_get_nlines() > 0 && ahp_xc_get_autocorrelator_jittersize() > 1)
+                    vectors[nvectors++] = &autocorrelationsBP;
+                if(ahp_xc_get_nbaselines() > 0 && ahp_xc_get_crosscorrelator_jittersize() > 1)
+                    vectors[nvectors++] = &crosscorrelationsBP;
+                std::chrono::duration<double> generate = std::chrono::steady_clock::now() - start;
+                uploadTimingN[0].value = generate.count();
+
+                LOG_INFO("BLOBs generated, downloading...");
+                sendFiles(vectors, nvectors);
                 for(int x = 0; x < nplots; x++) {
-                    free(blobs[x]);
+                    free(plotB[x].blob);
+                    plotB[x].blob = nullptr;
                     memset(plot_str[x]->buf, 0, sizeof(dsp_t)*static_cast<size_t>(plot_str[x]->len));
                 }
-                LOG_INFO("Generating additional BLOBs...");
-                if(ahp_xc_get_nlines() > 0 && ahp_xc_get_autocorrelator_jittersize() > 1) {
-                    for(int x = 0; x < ahp_xc_get_nlines(); x++) {
-                        size_t memsize = static_cast<unsigned int>(autocorrelations_str[x]->len)*sizeof(double);
-                        blobs[x] = static_cast<char*>(malloc(memsize));
-                        void* fits = dsp_file_write_fits(-64, &memsize, autocorrelations_str[x]);
-                        if(fits != nullptr) {
-                            blobs[x] = (char*)realloc(blobs[x], memsize);
-                            memcpy(blobs[x], fits, memsize);
-                            free(fits);
-                        }
-                        autocorrelationsB[x].blob = blobs[x];
-                        autocorrelationsB[x].bloblen = static_cast<int>(memsize);
-                        autocorrelations_str[x]->sizes[1] = 1;
-                        autocorrelations_str[x]->len = autocorrelations_str[x]->sizes[0];
-                        dsp_stream_alloc_buffer(autocorrelations_str[x], autocorrelations_str[x]->len);
-                    }
-                    LOG_INFO("Autocorrelations BLOBs generated, downloading...");
-                    sendFile(autocorrelationsB, autocorrelationsBP, ahp_xc_get_nlines());
-                    for(int x = 0; x < ahp_xc_get_nlines(); x++) {
-                        free(blobs[x]);
-                    }
-                }
-                if(ahp_xc_get_nbaselines() > 0 && ahp_xc_get_crosscorrelator_jittersize() > 1) {
-                    int idx = 0;
-                    for(int x = 0; x < ahp_xc_get_nlines(); x++) {
-                        for(int y = x+1; y < ahp_xc_get_nlines(); y++) {
-                            size_t memsize = static_cast<unsigned int>(crosscorrelations_str[idx]->len)*sizeof(double);
-                            blobs[x] = static_cast<char*>(malloc(memsize));
-                            void* fits = dsp_file_write_fits(-64, &memsize, crosscorrelations_str[idx]);
-                            if(fits != nullptr) {
-                                blobs[x] = (char*)realloc(blobs[x], memsize);
-                                memcpy(blobs[x], fits, memsize);
-                                free(fits);
-                            }
-                            autocorrelationsB[x].blob = blobs[x];
-                            autocorrelationsB[x].bloblen = static_cast<int>(memsize);
-                            crosscorrelations_str[idx]->sizes[1] = 1;
-                            crosscorrelations_str[idx]->len = crosscorrelations_str[idx]->sizes[0];
-                            dsp_stream_alloc_buffer(crosscorrelations_str[idx], crosscorrelations_str[idx]->len);
-                            idx++;
-                        }
-                    }
-                    LOG_INFO("Crosscorrelations BLOBs generated, downloading...");
-                    sendFile(crosscorrelationsB, crosscorrelationsBP, ahp_xc_get_nbaselines());
-                    for(int x = 0; x < ahp_xc_get_nbaselines(); x++) {
-                        free(blobs[x]);
-                    }
-                }
-                free(blobs);
+                ReleaseCorrelations();
+                storesOpen = false;
                 LOG_INFO("Download complete.");
             } else {
                 // Filling BLOBs
@@ -380,24 +378,20 @@ void AHP_XC::Callback()
                     }
                 }
                 if(ahp_xc_get_nlines() > 0 && ahp_xc_get_autocorrelator_jittersize() > 1) {
+                    unsigned int lags = static_cast<unsigned int>(ahp_xc_get_autocorrelator_jittersize());
                     for(int x = 0; x < ahp_xc_get_nlines(); x++) {
-                        int pos = autocorrelations_str[x]->len-autocorrelations_str[x]->sizes[0];
-                        autocorrelations_str[x]->sizes[1]++;
-                        autocorrelations_str[x]->len += autocorrelations_str[x]->sizes[0];
-                        autocorrelations_str[x]->buf = (dsp_t*)realloc(autocorrelations_str[x]->buf, sizeof(dsp_t)*static_cast<unsigned int>(autocorrelations_str[x]->len));
-                        for(unsigned int i = 0; i < packet->autocorrelations[x].jitter_size; i++)
-                            autocorrelations_str[x]->buf[pos++] = packet->autocorrelations[x].correlations[i].coherence;
+                        double *row = autocorrelations_store[x]->NextRow();
+                        for(unsigned int i = 0; i < lags; i++)
+                            row[i] = (i < packet->autocorrelations[x].jitter_size ? packet->autocorrelations[x].correlations[i].coherence : 0.0);
                     }
                 }
                 idx = 0;
                 if(ahp_xc_get_nbaselines() > 0 && ahp_xc_get_crosscorrelator_jittersize() > 1) {
+                    unsigned int lags = static_cast<unsigned int>(ahp_xc_get_crosscorrelator_jittersize()*2-1);
                     for(int x = 0; x < ahp_xc_get_nbaselines(); x++) {
-                        int pos = crosscorrelations_str[x]->len-crosscorrelations_str[x]->sizes[0];
-                        crosscorrelations_str[x]->sizes[1]++;
-                        crosscorrelations_str[x]->len += crosscorrelations_str[x]->sizes[0];
-                        crosscorrelations_str[x]->buf = (dsp_t*)realloc(crosscorrelations_str[x]->buf, sizeof(dsp_t)*static_cast<unsigned int>(crosscorrelations_str[x]->len));
-                        for(unsigned int i = 0; i < packet->crosscorrelations[x].jitter_size; i++)
-                            crosscorrelations_str[x]->buf[pos++] = packet->crosscorrelations[x].correlations[i].coherence;
+                        double *row = crosscorrelations_store[x]->NextRow();
+                        for(unsigned int i = 0; i < lags; i++)
+                            row[i] = (i < packet->crosscorrelations[x].jitter_size ? packet->crosscorrelations[x].correlations[i].coherence : 0.0);
                     }
                 }
             }
@@ -439,10 +433,75 @@ void AHP_XC::Callback()
             ahp_xc_set_delay(x, delay_clocks);
         }
     }
+    if(storesOpen)
+        ReleaseCorrelations();
     EnableCapture(false);
     ahp_xc_free_packet(packet);
 }
 
+/**************************************************************************************
+** Correlation BLOBs, one row of lags per packet
+***************************************************************************************/
+void AHP_XC::BeginCorrelations()
+{
+    double packettime = static_cast<double>(ahp_xc_get_packettime());
+    size_t rows = static_cast<size_t>(packettime > 0.0 ? static_cast<double>(ExposureRequest)*1000000.0/packettime : 0.0)+1;
+    const char *spool = (accumulationS[1].s == ISS_ON ? spoolT[0].text : nullptr);
+
+    if(ahp_xc_get_autocorrelator_jittersize() > 1) {
+        for(int x = 0; x < ahp_xc_get_nlines(); x++) {
+            if(!autocorrelations_store[x]->Begin(rows, spool))
+                LOGF_ERROR("Autocorrelations %d: %s", x+1, autocorrelations_store[x]->Error());
+        }
+    }
+    if(ahp_xc_get_crosscorrelator_jittersize() > 1) {
+        for(int x = 0; x < ahp_xc_get_nbaselines(); x++) {
+            if(!crosscorrelations_store[x]->Begin(rows, spool))
+                LOGF_ERROR("Crosscorrelations %d: %s", x+1, crosscorrelations_store[x]->Error());
+        }
+    }
+}
+
+void AHP_XC::EndCorrelations()
+{
+    void *fits;
+    size_t size;
+
+    // The finished FITS images are sent as they are, without another copy
+    if(ahp_xc_get_nlines() > 0 && ahp_xc_get_autocorrelator_jittersize() > 1) {
+        for(int x = 0; x < ahp_xc_get_nlines(); x++) {
+            if(!autocorrelations_store[x]->End(&fits, &size))
+                LOGF_ERROR("Autocorrelations %d: %s", x+1, autocorrelations_store[x]->Error());
+            autocorrelationsB[x].blob = fits;
+            autocorrelationsB[x].bloblen = static_cast<int>(size);
+        }
+    }
+    if(ahp_xc_get_nbaselines() > 0 && ahp_xc_get_crosscorrelator_jittersize() > 1) {
+        for(int x = 0; x < ahp_xc_get_nbaselines(); x++) {
+            if(!crosscorrelations_store[x]->End(&fits, &size))
+                LOGF_ERROR("Crosscorrelations %d: %s", x+1, crosscorrelations_store[x]->Error());
+            crosscorrelationsB[x].blob = fits;
+            crosscorrelationsB[x].bloblen = static_cast<int>(size);
+        }
+    }
+}
+
+void AHP_XC::ReleaseCorrelations()
+{
+    if(ahp_xc_get_autocorrelator_jittersize() > 1) {
+        for(int x = 0; x < ahp_xc_get_nlines(); x++) {
+            autocorrelations_store[x]->Release();
+            autocorrelationsB[x].blob = nullptr;
+        }
+    }
+    if(ahp_xc_get_crosscorrelator_jittersize() > 1) {
+        for(int x = 0; x < ahp_xc_get_nbaselines(); x++) {
+            crosscorrelations_store[x]->Release();
+            crosscorrelationsB[x].blob = nullptr;
+        }
+    }
+}
+
 AHP_XC::AHP_XC()
 {
     clock_divider = 0;
@@ -492,8 +551,8 @@ AHP_XC::AHP_XC()
 
     correlationsN = static_cast<INumber*>(malloc(1));
 
-    autocorrelations_str = static_cast<dsp_stream_p*>(malloc(1));
-    crosscorrelations_str = static_cast<dsp_stream_p*>(malloc(1));
+    autocorrelations_store = static_cast<CorrelationStore**>(malloc(1));
+    crosscorrelations_store = static_cast<CorrelationStore**>(malloc(1));
     plot_str = static_cast<dsp_stream_p*>(malloc(1));
 
     framebuffer = static_cast<double*>(malloc(1));
@@ -508,30 +567,26 @@ AHP_XC::AHP_XC()
 
 bool AHP_XC::Disconnect()
 {
+    threadsRunning = false;
+
+    readThread->join();
+    readThread->~thread();
+
     for(int x = 0; x < nplots; x++) {
         dsp_stream_free_buffer(plot_str[x]);
         dsp_stream_free(plot_str[x]);
     }
     for(int x = 0; x < ahp_xc_get_nlines(); x++) {
-        if(ahp_xc_get_autocorrelator_jittersize() > 1) {
-            dsp_stream_free_buffer(autocorrelations_str[x]);
-            dsp_stream_free(autocorrelations_str[x]);
-        }
+        if(ahp_xc_get_autocorrelator_jittersize() > 1)
+            delete autocorrelations_store[x];
         ActiveLine(x, false, false);
         usleep(10000);
     }
     for(int x = 0; x < ahp_xc_get_nbaselines(); x++) {
-        if(ahp_xc_get_crosscorrelator_jittersize() > 1) {
-            dsp_stream_free_buffer(crosscorrelations_str[x]);
-            dsp_stream_free(crosscorrelations_str[x]);
-        }
+        if(ahp_xc_get_crosscorrelator_jittersize() > 1)
+            delete crosscorrelations_store[x];
     }
 
-    threadsRunning = false;
-
-    readThread->join();
-    readThread->~thread();
-
     ahp_xc_disconnect();
 
     return true;
@@ -557,6 +612,8 @@ bool AHP_XC::saveConfigItems(FILE *fp)
         }
     }
     IUSaveConfigNumber(fp, &settingsNP);
+    IUSaveConfigSwitch(fp, &accumulationSP);
+    IUSaveConfigText(fp, &spoolTP);
 
     INDI::CCD::saveConfigItems(fp);
     return true;
@@ -577,6 +634,19 @@ bool AHP_XC::initProperties()
     IUFillNumber(&settingsN[1], "INTERFEROMETER_BANDWIDTH_VALUE", "Filter bandwidth (m)", "%g", 3.0E-12, 3.0E+3, 1.0E-9, 1199.169832);
     IUFillNumberVector(&settingsNP, settingsN, 2, getDeviceName(), "INTERFEROMETER_SETTINGS", "AHP_XC Settings", MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    // Long integrations can be spooled to disk instead of memory
+    IUFillSwitch(&accumulationS[0], "ACCUMULATION_MEMORY", "Memory", ISS_ON);
+    IUFillSwitch(&accumulationS[1], "ACCUMULATION_SPOOL", "Spool file", ISS_OFF);
+    IUFillSwitchVector(&accumulationSP, accumulationS, 2, getDeviceName(), "CORRELATIONS_ACCUMULATION", "Correlations storage", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    IUFillText(&spoolT[0], "SPOOL_DIR", "Directory", "/tmp");
+
+    IUFillNumber(&uploadTimingN[0], "UPLOAD_GENERATE", "FITS generation (s)", "%.3f", 0, 86400, 0, 0);
+    IUFillNumber(&uploadTimingN[1], "UPLOAD_SCAN", "Directory scan (s)", "%.3f", 0, 86400, 0, 0);
+    IUFillNumber(&uploadTimingN[2], "UPLOAD_SAVE", "Save (s)", "%.3f", 0, 86400, 0, 0);
+    IUFillNumber(&uploadTimingN[3], "UPLOAD_SEND", "Transfer (s)", "%.3f", 0, 86400, 0, 0);
+    IUFillNumberVector(&uploadTimingNP, uploadTimingN, 4, getDeviceName(), "UPLOAD_TIMING", "Upload timing", "Stats", IP_RO, 60, IPS_IDLE);
+    IUFillTextVector(&spoolTP, spoolT, 1, getDeviceName(), "CORRELATIONS_SPOOL", "Spool", OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
+
     // Set minimum exposure speed to 0.001 seconds
     PrimaryCCD.setMinMaxStep("CCD_EXPOSURE", "CCD_EXPOSURE_VALUE", 1.0, STELLAR_DAY, 1, false);
     setDefaultPollingPeriod(500);
@@ -607,6 +677,9 @@ void AHP_XC::ISGetProperties(const char *dev)
             defineBLOB(&crosscorrelationsBP);
         defineNumber(&correlationsNP);
         defineNumber(&settingsNP);
+        defineSwitch(&accumulationSP);
+        defineText(&spoolTP);
+        defineNumber(&uploadTimingNP);
 
         // Define our properties
     }
@@ -636,6 +709,9 @@ bool AHP_XC::updateProperties()
             defineBLOB(&crosscorrelationsBP);
         defineNumber(&correlationsNP);
         defineNumber(&settingsNP);
+        defineSwitch(&accumulationSP);
+        defineText(&spoolTP);
+        defineNumber(&uploadTimingNP);
     }
     else
         // We're disconnected
@@ -646,6 +722,9 @@ bool AHP_XC::updateProperties()
             deleteProperty(crosscorrelationsBP.name);
         deleteProperty(correlationsNP.name);
         deleteProperty(settingsNP.name);
+        deleteProperty(accumulationSP.name);
+        deleteProperty(spoolTP.name);
+        deleteProperty(uploadTimingNP.name);
         for (int x=0; x<ahp_xc_get_nlines(); x++) {
             deleteProperty(lineEnableSP[x].name);
             deleteProperty(linePowerSP[x].name);
@@ -759,6 +838,13 @@ bool AHP_XC::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
         }
     }
 
+    if(!strcmp(name, accumulationSP.name)) {
+        IUUpdateSwitch(&accumulationSP, states, names, n);
+        accumulationSP.s = IPS_OK;
+        IDSetSwitch(&accumulationSP, nullptr);
+        return true;
+    }
+
     for(int x = 0; x < ahp_xc_get_nbaselines(); x++)
         baselines[x]->ISNewSwitch(dev, name, states, names, n);
 
@@ -817,6 +903,14 @@ bool AHP_XC::ISNewText(const char *dev, const char *name, char *texts[], char *n
 
     //  This is for our device
     //  Now lets see if it's something we process here
+    if (!strcmp(name, spoolTP.name))
+    {
+        IUUpdateText(&spoolTP, texts, names, n);
+        spoolTP.s = IPS_OK;
+        IDSetText(&spoolTP, nullptr);
+        return true;
+    }
+
     for(int x = 0; x < ahp_xc_get_nlines(); x++) {
         if (!strcmp(name, lineDevicesTP[x].name))
         {
@@ -1035,9 +1129,9 @@ bool AHP_XC::Connect()
         plotB = static_cast<IBLOB*>(realloc(plotB, static_cast<unsigned long>(nplots)*sizeof(IBLOB)+1));
 
     if(ahp_xc_get_autocorrelator_jittersize() > 1)
-        autocorrelations_str = static_cast<dsp_stream_p*>(realloc(autocorrelations_str, static_cast<unsigned long>(ahp_xc_get_nlines())*sizeof(dsp_stream_p)+1));
+        autocorrelations_store = static_cast<CorrelationStore**>(realloc(autocorrelations_store, static_cast<unsigned long>(ahp_xc_get_nlines())*sizeof(CorrelationStore*)+1));
     if(ahp_xc_get_crosscorrelator_jittersize() > 1)
-        crosscorrelations_str = static_cast<dsp_stream_p*>(realloc(crosscorrelations_str, static_cast<unsigned long>(ahp_xc_get_nbaselines())*sizeof(dsp_stream_p)+1));
+        crosscorrelations_store = static_cast<CorrelationStore**>(realloc(crosscorrelations_store, static_cast<unsigned long>(ahp_xc_get_nbaselines())*sizeof(CorrelationStore*)+1));
     if(nplots > 0)
         plot_str = static_cast<dsp_stream_p*>(realloc(plot_str, static_cast<unsigned long>(nplots)*sizeof(dsp_stream_p)+1));
 
@@ -1053,12 +1147,8 @@ bool AHP_XC::Connect()
     memset (alt, 0, static_cast<unsigned long>(ahp_xc_get_nlines())*sizeof(double)+1);
     memset (az, 0, static_cast<unsigned long>(ahp_xc_get_nlines())*sizeof(double)+1);
     for(int x = 0; x < ahp_xc_get_nbaselines(); x++) {
-        if(ahp_xc_get_crosscorrelator_jittersize() > 1) {
-            crosscorrelations_str[x] = dsp_stream_new();
-            dsp_stream_add_dim(crosscorrelations_str[x], ahp_xc_get_crosscorrelator_jittersize()*2-1);
-            dsp_stream_add_dim(crosscorrelations_str[x], 1);
-            dsp_stream_alloc_buffer(crosscorrelations_str[x], crosscorrelations_str[x]->len);
-        }
+        if(ahp_xc_get_crosscorrelator_jittersize() > 1)
+            crosscorrelations_store[x] = new CorrelationStore(ahp_xc_get_crosscorrelator_jittersize()*2-1);
         baselines[x] = new baseline();
         baselines[x]->initProperties();
     }
@@ -1080,12 +1170,8 @@ bool AHP_XC::Connect()
     IUFillBLOBVector(&plotBP, plotB, nplots, getDeviceName(), "PLOTS", "Plots", "Stats", IP_RO, 60, IPS_BUSY);
 
     for (int x = 0; x < ahp_xc_get_nlines(); x++) {
-        if(ahp_xc_get_autocorrelator_jittersize() > 1) {
-            autocorrelations_str[x] = dsp_stream_new();
-            dsp_stream_add_dim(autocorrelations_str[x], ahp_xc_get_autocorrelator_jittersize());
-            dsp_stream_add_dim(autocorrelations_str[x], 1);
-            dsp_stream_alloc_buffer(autocorrelations_str[x], autocorrelations_str[x]->len);
-        }
+        if(ahp_xc_get_autocorrelator_jittersize() > 1)
+            autocorrelations_store[x] = new CorrelationStore(ahp_xc_get_autocorrelator_jittersize());
 
         //snoop properties
         IUFillNumber(&snoopTelescopeN[x*2+0], "RA", "RA (hh:mm:ss)", "%010.6m", 0, 24, 0, 0);
@@ -22,6 +22,7 @@
 
 #include "indiccd.h"
 #include "indicorrelator.h"
+#include "correlationstore.h"
 #include <ahp/ahp_xc.h>
 
 class baseline : public INDI::Correlator
@@ -92,8 +93,8 @@ public:
         free(crosscorrelationsB);
         free(plotB);
 
-        free(autocorrelations_str);
-        free(crosscorrelations_str);
+        free(autocorrelations_store);
+        free(crosscorrelations_store);
         free(plot_str);
 
         free(totalcounts);
@@ -201,10 +202,19 @@ private:
     IBLOB *plotB;
     IBLOBVectorProperty plotBP;
 
-    dsp_stream_p *autocorrelations_str;
-    dsp_stream_p *crosscorrelations_str;
+    CorrelationStore **autocorrelations_store;
+    CorrelationStore **crosscorrelations_store;
     dsp_stream_p *plot_str;
 
+    ISwitch accumulationS[2];
+    ISwitchVectorProperty accumulationSP;
+
+    IText spoolT[1] {};
+    ITextVectorProperty spoolTP;
+
+    INumber uploadTimingN[4];
+    INumberVectorProperty uploadTimingNP;
+
     INumber settingsN[2];
     INumberVectorProperty settingsNP;
 
@@ -214,6 +224,9 @@ private:
     float timeleft;
     double wavelength;
     void Callback();
+    void BeginCorrelations();
+    void EndCorrelations();
+    void ReleaseCorrelations();
     bool callHandshake();
     // Utility functions
     float CalcTimeLeft();
@@ -223,7 +236,7 @@ private:
     void ActiveLine(int, bool, bool);
     void SetFrequencyDivider(unsigned char divider);
     void EnableCapture(bool start);
-    void sendFile(IBLOB* Blobs, IBLOBVectorProperty BlobP, int len);
+    void sendFiles(IBLOBVectorProperty **vectors, int count);
     int getFileIndex(const char * dir, const char * prefix, const char * ext);
     float CalcTimeLeft(timeval start, float req);
     // Struct to keep timing
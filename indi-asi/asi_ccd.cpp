@@ -23,11 +23,13 @@
 #include "asi_ccd.h"
 
 #include "config.h"
+#include "pixelconvert.h"
 
 #include <stream/streammanager.h>
 
 #include <algorithm>
 #include <cmath>
+#include <ctime>
 #include <unistd.h>
 #include <vector>
 #include <unordered_map>
@@ -37,8 +39,11 @@
 #define TEMP_TIMER_MS           1000 /* Temperature polling time (ms) */
 #define TEMP_THRESHOLD          .25  /* Differential temperature threshold (C)*/
 #define MAX_DEVICES             4    /* Max device cameraCount */
+#define STREAM_BUFFERS          4    /* Default number of video frame slots */
+#define STREAM_STATS_MS         1000 /* Streaming statistics update interval (ms) */
 
 #define CONTROL_TAB "Controls"
+#define STREAM_TAB  "Streaming"
 
 //#define USE_SIMULATION
 
@@ -240,6 +245,28 @@ bool ASICCD::initProperties()
     IUFillNumberVector(&ADCDepthNP, &ADCDepthN, 1, getDeviceName(), "ADC_DEPTH", "ADC Depth", IMAGE_INFO_TAB, IP_RO, 60,
                        IPS_IDLE);
 
+    IUFillNumber(&SequenceN[0], "COUNT", "Frames", "%.f", 1, 100000, 1, 1);
+    IUFillNumberVector(&SequenceNP, SequenceN, NARRAY(SequenceN), getDeviceName(), "CCD_SEQUENCE", "Sequence", CONTROL_TAB,
+                       IP_RW, 60, IPS_IDLE);
+
+    IUFillNumber(&SequenceStatsN[SEQUENCE_FRAMES], "FRAMES", "Frames", "%.f", 0, 1e9, 0, 0);
+    IUFillNumber(&SequenceStatsN[SEQUENCE_DUTY_CYCLE], "DUTY_CYCLE", "Duty cycle (%)", "%.2f", 0, 100, 0, 0);
+    IUFillNumber(&SequenceStatsN[SEQUENCE_DEAD_TIME], "DEAD_TIME", "Dead time (ms)", "%.2f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&SequenceStatsNP, SequenceStatsN, NARRAY(SequenceStatsN), getDeviceName(), "CCD_SEQUENCE_STATS",
+                       "Sequence Stats", CONTROL_TAB, IP_RO, 60, IPS_IDLE);
+
+    IUFillNumber(&StreamBuffersN[0], "BUFFERS", "Frame buffers", "%.f", 1, 64, 1, STREAM_BUFFERS);
+    IUFillNumberVector(&StreamBuffersNP, StreamBuffersN, NARRAY(StreamBuffersN), getDeviceName(), "STREAM_BUFFERS", "Buffers",
+                       STREAM_TAB, IP_RW, 60, IPS_IDLE);
+
+    IUFillNumber(&StreamStatsN[STREAM_DROPPED], "DROPPED", "Dropped frames", "%.f", 0, 1e9, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_QUEUE_DEPTH], "QUEUE_DEPTH", "Queue depth", "%.f", 0, 64, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_CAPTURE_MS], "CAPTURE_MS", "Capture (ms)", "%.2f", 0, 1e6, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_QUEUE_MS], "QUEUE_MS", "Queued (ms)", "%.2f", 0, 1e6, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_DELIVERY_MS], "DELIVERY_MS", "Delivery (ms)", "%.2f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&StreamStatsNP, StreamStatsN, NARRAY(StreamStatsN), getDeviceName(), "STREAM_STATS", "Statistics",
+                       STREAM_TAB, IP_RO, 60, IPS_IDLE);
+
     IUFillText(&SDKVersionS[0], "VERSION", "Version", ASIGetSDKVersion());
     IUFillTextVector(&SDKVersionSP, SDKVersionS, 1, getDeviceName(), "SDK", "SDK", INFO_TAB, IP_RO, 60, IPS_IDLE);
 
@@ -347,6 +374,13 @@ bool ASICCD::updateProperties()
 
         defineNumber(&BlinkNP);
 
+        defineNumber(&SequenceNP);
+        defineNumber(&SequenceStatsNP);
+
+        defineNumber(&StreamBuffersNP);
+        loadConfig(true, StreamBuffersNP.name);
+        defineNumber(&StreamStatsNP);
+
         defineNumber(&ADCDepthNP);
         defineText(&SDKVersionSP);
     }
@@ -370,6 +404,10 @@ bool ASICCD::updateProperties()
             deleteProperty(VideoFormatSP.name);
 
         deleteProperty(BlinkNP.name);
+        deleteProperty(SequenceNP.name);
+        deleteProperty(SequenceStatsNP.name);
+        deleteProperty(StreamBuffersNP.name);
+        deleteProperty(StreamStatsNP.name);
         deleteProperty(SDKVersionSP.name);
         deleteProperty(ADCDepthNP.name);
     }
@@ -706,6 +744,36 @@ bool ASICCD::ISNewNumber(const char *dev, const char *name, double values[], cha
             IDSetNumber(&BlinkNP, nullptr);
             return true;
         }
+
+        if (!strcmp(name, SequenceNP.name))
+        {
+            if (InExposure)
+            {
+                SequenceNP.s = IPS_ALERT;
+                LOG_ERROR("Cannot change sequence while exposing.");
+                IDSetNumber(&SequenceNP, nullptr);
+                return true;
+            }
+
+            SequenceNP.s = IUUpdateNumber(&SequenceNP, values, names, n) < 0 ? IPS_ALERT : IPS_OK;
+            IDSetNumber(&SequenceNP, nullptr);
+            return true;
+        }
+
+        if (!strcmp(name, StreamBuffersNP.name))
+        {
+            if (Streamer->isBusy())
+            {
+                StreamBuffersNP.s = IPS_ALERT;
+                LOG_ERROR("Cannot change frame buffers while streaming/recording.");
+                IDSetNumber(&StreamBuffersNP, nullptr);
+                return true;
+            }
+
+            StreamBuffersNP.s = IUUpdateNumber(&StreamBuffersNP, values, names, n) < 0 ? IPS_ALERT : IPS_OK;
+            IDSetNumber(&StreamBuffersNP, nullptr);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -967,6 +1035,27 @@ bool ASICCD::activateCooler(bool enable)
 }
 
 bool ASICCD::StartExposure(float duration)
+{
+    // The imaging thread already re-arms the camera for the rest of a sequence, a request
+    // answering one of its frames only waits for the next
+    if (m_SequenceRemaining > 0)
+    {
+        if (std::fabs(duration - ExposureRequest) > 0.0005)
+        {
+            LOGF_ERROR("A sequence of %g seconds frames is running, abort it before taking %g seconds frames.",
+                       ExposureRequest, duration);
+            return false;
+        }
+        PrimaryCCD.setExposureDuration(duration);
+        return true;
+    }
+
+    m_SequenceRemaining = static_cast<uint32_t>(SequenceN[0].value);
+    m_SequenceCaptured  = 0;
+    return beginExposure(duration);
+}
+
+bool ASICCD::beginExposure(float duration)
 {
     ASI_ERROR_CODE errCode = ASI_SUCCESS;
 
@@ -1043,10 +1132,13 @@ bool ASICCD::StartExposure(float duration)
     if (errCode != ASI_SUCCESS)
     {
         LOG_WARN("ASI firmware might require an update to *compatible mode. Check http://www.indilib.org/devices/ccds/zwo-optics-asi-cameras.html for details.");
+        m_SequenceRemaining = 0;
         return false;
     }
 
     gettimeofday(&ExpStart, nullptr);
+    if (m_SequenceCaptured == 0)
+        m_SequenceStart = ExpStart;
     if (ExposureRequest > VERBOSE_EXPOSURE)
         LOGF_INFO("Taking a %g seconds frame...", ExposureRequest);
 
@@ -1076,11 +1168,13 @@ bool ASICCD::AbortExposure()
     //    }
     //    pthread_mutex_unlock(&condMutex);
 
+    discardSequenceFrames();
     setThreadRequest(StateAbort);
     waitUntil(StateIdle);
 
     ASIStopExposure(m_camInfo->CameraID);
     InExposure = false;
+    m_SequenceRemaining = 0;
     return true;
 }
 
@@ -1209,41 +1303,47 @@ int ASICCD::grabImage()
 
     if (type == ASI_IMG_RGB24)
     {
-        buffer = static_cast<uint8_t *>(malloc(nTotalBytes));
-        if (buffer == nullptr)
+        if (m_RGBBuffer.size() < nTotalBytes)
         {
-            LOGF_ERROR("%s: %d malloc failed (RGB 24)", getDeviceName());
-            return -1;
+            try
+            {
+                m_RGBBuffer.resize(nTotalBytes);
+            }
+            catch (const std::bad_alloc &)
+            {
+                LOGF_ERROR("%s: %zu bytes allocation failed (RGB 24)", getDeviceName(), nTotalBytes);
+                return -1;
+            }
         }
+        buffer = m_RGBBuffer.data();
     }
 
     if ((errCode = ASIGetDataAfterExp(m_camInfo->CameraID, buffer, nTotalBytes)) != ASI_SUCCESS)
     {
         LOGF_ERROR("ASIGetDataAfterExp (%dx%d #%d channels) error (%d)", subW, subH, nChannels,
                    errCode);
-        if (type == ASI_IMG_RGB24)
-            free(buffer);
         return -1;
     }
 
+    // ASI delivers BGR, FITS wants planar R, G and B
     if (type == ASI_IMG_RGB24)
     {
-        uint8_t *subR = image;
-        uint8_t *subG = image + subW * subH;
-        uint8_t *subB = image + subW * subH * 2;
-        uint32_t nPixels = subW * subH * 3 - 3;
-
-        for (uint32_t i = 0; i <= nPixels; i += 3)
-        {
-            *subB++ = buffer[i];
-            *subG++ = buffer[i + 1];
-            *subR++ = buffer[i + 2];
-        }
-
-        free(buffer);
+        uint32_t nPixels = subW * subH;
+        PixelConvert::deinterleave8(buffer, image + nPixels * 2, image + nPixels, image, nPixels);
     }
     guard.unlock();
 
+    setImageAxes(type);
+
+    if (ExposureRequest > VERBOSE_EXPOSURE)
+        LOG_INFO("Download complete.");
+
+    ExposureComplete(&PrimaryCCD);
+    return 0;
+}
+
+void ASICCD::setImageAxes(ASI_IMG_TYPE type)
+{
     if (type == ASI_IMG_RGB24)
         PrimaryCCD.setNAxis(3);
     else
@@ -1254,12 +1354,6 @@ int ASICCD::grabImage()
         SetCCDCapability(GetCCDCapability() & ~CCD_HAS_BAYER);
     else
         SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
-
-    if (ExposureRequest > VERBOSE_EXPOSURE)
-        LOG_INFO("Download complete.");
-
-    ExposureComplete(&PrimaryCCD);
-    return 0;
 }
 
 bool ASICCD::isMonoBinActive()
@@ -1791,7 +1885,8 @@ void *ASICCD::imagingThreadEntry()
         {
             threadRequest = StateIdle;
             lock.unlock();
-            StartExposure(ExposureRequest);
+            // A retried frame of a sequence keeps its place in it
+            beginExposure(ExposureRequest);
             lock.lock();
         }
         else if (threadRequest == StateTerminate)
@@ -1832,10 +1927,32 @@ void ASICCD::waitUntil(ImageState request)
     cv.wait(lock, [this, request] {return threadState == request;});
 }
 
+/*
+ * Frames are read from the camera into a ring of pre-allocated slots by the
+ * imaging thread, while a separate delivery thread converts and passes them
+ * to the streamer. This way a slow encoder or recorder no longer delays the
+ * next ASIGetVideoData() call; if the ring is full the frame is read into a
+ * spill buffer and counted as dropped instead of stalling the camera.
+ */
 void ASICCD::streamVideo()
 {
-    //int ret;
-    //int frames = 0;
+    uint32_t totalBytes = PrimaryCCD.getFrameBufferSize();
+
+    m_FrameRing.allocate(static_cast<size_t>(StreamBuffersN[0].value), totalBytes);
+    m_SpillFrame.resize(totalBytes);
+
+    m_DroppedFrames = 0;
+    m_CaptureTimeUS = 0;
+    m_CaptureCount  = 0;
+    m_QueueTimeUS = m_DeliveryTimeUS = 0;
+    m_DeliveryCount = 0;
+    m_StreamStatsUpdate = FrameRing<>::Clock::now();
+
+    {
+        std::lock_guard<std::mutex> guard(m_DeliveryMutex);
+        m_DeliveryStop = false;
+    }
+    m_DeliveryThread = std::thread(&ASICCD::streamDeliveryThreadEntry, this);
 
     std::unique_lock<std::mutex> lock(condMutex);
 
@@ -1843,12 +1960,14 @@ void ASICCD::streamVideo()
     {
         lock.unlock();
 
-        std::unique_lock<std::mutex> guard(ccdBufferLock);
-        uint8_t *targetFrame = PrimaryCCD.getFrameBuffer();
-        uint32_t totalBytes  = PrimaryCCD.getFrameBufferSize();
-        int waitMS           = static_cast<int>((ExposureRequest * 2000.0) + 500);
+        FrameRing<>::Slot *slot = m_FrameRing.acquire();
+        uint8_t *targetFrame    = slot ? slot->data.data() : m_SpillFrame.data();
+        int waitMS              = static_cast<int>((ExposureRequest * 2000.0) + 500);
 
+        auto start = FrameRing<>::Clock::now();
         int ret = ASIGetVideoData(m_camInfo->CameraID, targetFrame, totalBytes, waitMS);
+        auto end = FrameRing<>::Clock::now();
+
         if (ret != ASI_SUCCESS)
         {
             if (ret != ASI_ERROR_TIMEOUT)
@@ -1864,33 +1983,108 @@ void ASICCD::streamVideo()
             }
             else
             {
-                //frames = 0;
                 usleep(100);
             }
         }
         else
         {
-            if (currentVideoFormat == ASI_IMG_RGB24)
-                for (uint32_t i = 0; i < totalBytes; i += 3)
-                    std::swap(targetFrame[i], targetFrame[i + 2]);
+            m_CaptureTimeUS += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            m_CaptureCount++;
 
-            guard.unlock();
+            if (slot == nullptr)
+                m_DroppedFrames++;
+            else
+            {
+                slot->size     = totalBytes;
+                slot->captured = end;
+                m_FrameRing.commit();
 
-            Streamer->newFrame(targetFrame, totalBytes);
-
-            //            /*
-            //             * Release the CPU every 30 frames
-            //             */
-            //            frames++;
-            //            if (frames == 30)
-            //            {
-            //                frames = 0;
-            //                usleep(10);
-            //            }
+                // Take the lock so the wakeup cannot slip between the consumer's check and its wait
+                std::lock_guard<std::mutex> guard(m_DeliveryMutex);
+                m_DeliveryCV.notify_one();
+            }
         }
 
         lock.lock();
     }
+
+    lock.unlock();
+
+    {
+        std::lock_guard<std::mutex> guard(m_DeliveryMutex);
+        m_DeliveryStop = true;
+    }
+    m_DeliveryCV.notify_one();
+    m_DeliveryThread.join();
+
+    lock.lock();
+}
+
+void ASICCD::streamDeliveryThreadEntry()
+{
+    while (true)
+    {
+        FrameRing<>::Slot *slot = nullptr;
+        {
+            std::unique_lock<std::mutex> guard(m_DeliveryMutex);
+            m_DeliveryCV.wait_for(guard, std::chrono::milliseconds(STREAM_STATS_MS), [this, &slot]
+            {
+                slot = m_FrameRing.front();
+                return slot != nullptr || m_DeliveryStop;
+            });
+
+            if (slot == nullptr && m_DeliveryStop)
+                break;
+        }
+
+        if (slot != nullptr)
+        {
+            auto start = FrameRing<>::Clock::now();
+
+            if (currentVideoFormat == ASI_IMG_RGB24)
+                PixelConvert::swapRB8(slot->data.data(), slot->size / 3);
+
+            Streamer->newFrame(slot->data.data(), slot->size);
+
+            auto end = FrameRing<>::Clock::now();
+            m_QueueTimeUS += std::chrono::duration_cast<std::chrono::microseconds>(start - slot->captured).count();
+            m_DeliveryTimeUS += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            m_DeliveryCount++;
+
+            m_FrameRing.release();
+        }
+
+        updateStreamStats();
+    }
+
+    updateStreamStats(true);
+}
+
+/* Called from the delivery thread only */
+void ASICCD::updateStreamStats(bool force)
+{
+    auto now = FrameRing<>::Clock::now();
+    if (!force && now - m_StreamStatsUpdate < std::chrono::milliseconds(STREAM_STATS_MS))
+        return;
+    m_StreamStatsUpdate = now;
+
+    uint32_t captures = m_CaptureCount.exchange(0);
+    uint64_t captureUS = m_CaptureTimeUS.exchange(0);
+
+    StreamStatsN[STREAM_DROPPED].value     = m_DroppedFrames;
+    StreamStatsN[STREAM_QUEUE_DEPTH].value = m_FrameRing.depth();
+    if (captures > 0)
+        StreamStatsN[STREAM_CAPTURE_MS].value = captureUS / 1000.0 / captures;
+    if (m_DeliveryCount > 0)
+    {
+        StreamStatsN[STREAM_QUEUE_MS].value    = m_QueueTimeUS / 1000.0 / m_DeliveryCount;
+        StreamStatsN[STREAM_DELIVERY_MS].value = m_DeliveryTimeUS / 1000.0 / m_DeliveryCount;
+    }
+    m_QueueTimeUS = m_DeliveryTimeUS = 0;
+    m_DeliveryCount = 0;
+
+    StreamStatsNP.s = (StreamStatsN[STREAM_DROPPED].value > 0) ? IPS_BUSY : IPS_OK;
+    IDSetNumber(&StreamStatsNP, nullptr);
 }
 
 void ASICCD::getExposure()
@@ -1913,10 +2107,25 @@ void ASICCD::getExposure()
         errCode = ASIGetExpStatus(m_camInfo->CameraID, &status);
         if (errCode == ASI_SUCCESS)
         {
-            if (status == ASI_EXP_SUCCESS)
+            // Every frame of a sequence, including the last one, goes through the publisher
+            if (status == ASI_EXP_SUCCESS && (m_SequenceRemaining > 1 || m_SequenceCaptured > 0))
+            {
+                m_ExposureRetry = 0;
+                PrimaryCCD.setExposureLeft(0.0);
+
+                bool more = grabSequenceFrame();
+
+                lock.lock();
+                if (more && threadRequest == StateExposure)
+                    continue;
+                exposureSetRequest(StateIdle);
+                break;
+            }
+            else if (status == ASI_EXP_SUCCESS)
             {
                 InExposure = false;
                 m_ExposureRetry = 0;
+                m_SequenceRemaining = 0;
                 PrimaryCCD.setExposureLeft(0.0);
                 if (PrimaryCCD.getExposureDuration() > 3)
                     LOG_INFO("Exposure done, downloading image...");
@@ -1962,6 +2171,7 @@ void ASICCD::getExposure()
                             "Exposure failed after %d attempts.", m_ExposureRetry);
                     }
                     m_ExposureRetry = 0;
+                    m_SequenceRemaining = 0;
                     ASIStopExposure(m_camInfo->CameraID);
                     PrimaryCCD.setExposureFailed();
                     usleep(100000);
@@ -1985,6 +2195,7 @@ void ASICCD::getExposure()
                 }
                 PrimaryCCD.setExposureFailed();
                 InExposure = false;
+                m_SequenceRemaining = 0;
 
                 lock.lock();
                 exposureSetRequest(StateIdle);
@@ -2015,10 +2226,18 @@ void ASICCD::getExposure()
                 uSecs = 1000000;
             }
         }
-        else
+        else if (timeLeft > 0.1)
         {
             uSecs = 100000;
         }
+        else
+        {
+            /*
+             * Short exposures and readout: poll at a fine interval so that
+             * back-to-back frames do not lose up to 100ms each
+             */
+            uSecs = std::max(static_cast<int>(timeLeft * 1000000.0), 2000);
+        }
         if (timeLeft >= 0.0049)
         {
             PrimaryCCD.setExposureLeft(timeLeft);
@@ -2027,6 +2246,167 @@ void ASICCD::getExposure()
 
         lock.lock();
     }
+
+    lock.unlock();
+    stopSequencePublisher();
+}
+
+bool ASICCD::grabSequenceFrame()
+{
+    ASI_ERROR_CODE errCode = ASI_SUCCESS;
+    ASI_IMG_TYPE type = getImageType();
+
+    uint16_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    uint16_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    int nChannels = (type == ASI_IMG_RGB24) ? 3 : 1;
+    size_t nTotalBytes = subW * subH * nChannels * (PrimaryCCD.getBPP() / 8);
+
+    // The publisher always starts with the first half of the frame store
+    if (m_SequenceThread.joinable() == false)
+    {
+        m_SequenceWrite   = 0;
+        m_SequenceStop    = false;
+        m_SequenceDiscard = false;
+        m_SequenceThread = std::thread(&ASICCD::sequencePublisherEntry, this);
+    }
+
+    // Wait until the publisher is done with this half of the frame store
+    std::unique_lock<std::mutex> guard(m_SequenceMutex);
+    m_SequenceCV.wait(guard, [this] {return m_SequenceFrames[m_SequenceWrite].ready == false;});
+    SequenceFrame &frame = m_SequenceFrames[m_SequenceWrite];
+    guard.unlock();
+
+    frame.data.resize(nTotalBytes);
+    frame.type   = type;
+    frame.width  = subW;
+    frame.height = subH;
+    frame.start  = ExpStart;
+
+    if ((errCode = ASIGetDataAfterExp(m_camInfo->CameraID, frame.data.data(), nTotalBytes)) != ASI_SUCCESS)
+    {
+        LOGF_ERROR("ASIGetDataAfterExp (%dx%d #%d channels) error (%d)", subW, subH, nChannels, errCode);
+        PrimaryCCD.setExposureFailed();
+        InExposure = false;
+        m_SequenceRemaining = 0;
+        return false;
+    }
+
+    // Re-arm right away, the frame is packaged and uploaded while the next one exposes
+    bool more = --m_SequenceRemaining > 0;
+    if (more)
+    {
+        ASI_BOOL isDark = (PrimaryCCD.getFrameType() == INDI::CCDChip::DARK_FRAME) ? ASI_TRUE : ASI_FALSE;
+        if ((errCode = ASIStartExposure(m_camInfo->CameraID, isDark)) != ASI_SUCCESS)
+        {
+            LOGF_ERROR("ASIStartExposure error (%d), sequence stopped with %u frames left", errCode, m_SequenceRemaining.load());
+            m_SequenceRemaining = 0;
+            more = false;
+        }
+        else
+            gettimeofday(&ExpStart, nullptr);
+    }
+    InExposure = more;
+
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    frame.number  = ++m_SequenceCaptured;
+    frame.elapsed = (now.tv_sec - m_SequenceStart.tv_sec) + (now.tv_usec - m_SequenceStart.tv_usec) / 1e6;
+
+    guard.lock();
+    frame.ready = true;
+    m_SequenceWrite ^= 1;
+    m_SequenceCV.notify_all();
+
+    return more;
+}
+
+void ASICCD::sequencePublisherEntry()
+{
+    int index = 0;
+
+    std::unique_lock<std::mutex> guard(m_SequenceMutex);
+    while (true)
+    {
+        m_SequenceCV.wait(guard, [this, index] {return m_SequenceFrames[index].ready || m_SequenceStop;});
+        if (m_SequenceFrames[index].ready == false)
+            break;
+
+        if (m_SequenceDiscard == false)
+        {
+            guard.unlock();
+            publishSequenceFrame(index);
+            guard.lock();
+        }
+
+        m_SequenceFrames[index].ready = false;
+        m_SequenceCV.notify_all();
+        index ^= 1;
+    }
+}
+
+void ASICCD::publishSequenceFrame(int index)
+{
+    SequenceFrame &frame = m_SequenceFrames[index];
+
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    uint8_t *image = PrimaryCCD.getFrameBuffer();
+    if (frame.type == ASI_IMG_RGB24)
+    {
+        uint32_t nPixels = frame.width * frame.height;
+        PixelConvert::deinterleave8(frame.data.data(), image + nPixels * 2, image + nPixels, image, nPixels);
+    }
+    else
+        memcpy(image, frame.data.data(), frame.data.size());
+    guard.unlock();
+
+    setImageAxes(frame.type);
+
+    // Aborted while the frame was being packaged
+    {
+        std::lock_guard<std::mutex> sequenceGuard(m_SequenceMutex);
+        if (m_SequenceDiscard)
+            return;
+    }
+
+    m_PublishStart = &frame.start;
+    ExposureComplete(&PrimaryCCD);
+    m_PublishStart = nullptr;
+
+    // Duty cycle: share of the time since the first exposure started that was spent exposing
+    double exposed = frame.number * ExposureRequest;
+
+    SequenceStatsN[SEQUENCE_FRAMES].value = frame.number;
+    if (frame.elapsed > 0)
+    {
+        SequenceStatsN[SEQUENCE_DUTY_CYCLE].value = std::min(100.0, 100.0 * exposed / frame.elapsed);
+        SequenceStatsN[SEQUENCE_DEAD_TIME].value  = std::max(0.0, (frame.elapsed - exposed) * 1000.0 / frame.number);
+    }
+    SequenceStatsNP.s = InExposure ? IPS_BUSY : IPS_OK;
+    IDSetNumber(&SequenceStatsNP, nullptr);
+}
+
+void ASICCD::stopSequencePublisher()
+{
+    if (m_SequenceThread.joinable() == false)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_SequenceMutex);
+        m_SequenceStop = true;
+    }
+    m_SequenceCV.notify_all();
+    m_SequenceThread.join();
+}
+
+void ASICCD::discardSequenceFrames()
+{
+    // The publisher still releases each half of the frame store, so capture never writes into a frame being read.
+    // Cleared when the next sequence starts its publisher.
+    {
+        std::lock_guard<std::mutex> guard(m_SequenceMutex);
+        m_SequenceDiscard = true;
+    }
+    m_SequenceCV.notify_all();
 }
 
 /* Caller must hold the mutex */
@@ -2042,6 +2422,18 @@ void ASICCD::addFITSKeywords(fitsfile *fptr, INDI::CCDChip *targetChip)
 {
     INDI::CCD::addFITSKeywords(fptr, targetChip);
 
+    // Sequence frames are published while the next one is exposing, use the exact start time
+    if (m_PublishStart != nullptr)
+    {
+        int status = 0;
+        char ts[32], dateObs[40];
+        struct tm tp;
+        gmtime_r(&m_PublishStart->tv_sec, &tp);
+        strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &tp);
+        snprintf(dateObs, sizeof(dateObs), "%s.%03d", ts, static_cast<int>(m_PublishStart->tv_usec / 1000));
+        fits_update_key_s(fptr, TSTRING, "DATE-OBS", dateObs, "UTC start date of observation", &status);
+    }
+
     // e-/ADU
     INumber *np = IUFindNumber(&ControlNP, "Gain");
     if (np)
@@ -2075,6 +2467,7 @@ bool ASICCD::saveConfigItems(FILE *fp)
         IUSaveConfigSwitch(fp, &VideoFormatSP);
 
     IUSaveConfigNumber(fp, &BlinkNP);
+    IUSaveConfigNumber(fp, &StreamBuffersNP);
 
     return true;
 }
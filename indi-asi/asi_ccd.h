@@ -24,8 +24,11 @@
 
 #include <ASICamera2.h>
 
+#include "framering.h"
+
 #include <vector>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <indiccd.h>
@@ -89,9 +92,29 @@ class ASICCD : public INDI::CCD
         static void *imagingHelper(void *context);
         void *imagingThreadEntry();
         void streamVideo();
+        /** Consume frames queued by streamVideo() and hand them over to the streamer */
+        void streamDeliveryThreadEntry();
+        /** Publish dropped frames, queue depth and stage latencies */
+        void updateStreamStats(bool force = false);
         void getExposure();
         void exposureSetRequest(ImageState request);
 
+        /** Blink if requested, then start the camera exposure and hand it to the imaging thread */
+        bool beginExposure(float duration);
+        /**
+         * @brief grabSequenceFrame Download a sequence frame into the free half of the frame store,
+         * immediately re-arm the next exposure and queue the frame for the publisher thread.
+         * @return true if another exposure of the sequence was started.
+         */
+        bool grabSequenceFrame();
+        /** Package and upload sequence frames while the camera is already exposing the next one */
+        void sequencePublisherEntry();
+        void publishSequenceFrame(int index);
+        /** Wait until all queued sequence frames are uploaded and stop the publisher thread */
+        void stopSequencePublisher();
+        /** Drop the queued sequence frames, none is published after an abort */
+        void discardSequenceFrames();
+
         /**
          * @brief setThreadRequest Set the thread request
          * @param request Desired thread state
@@ -117,6 +140,8 @@ class ASICCD : public INDI::CCD
         IPState guidePulseWE(float ms, ASI_GUIDE_DIRECTION dir, const char *dirName);
         /** Get image from CCD and send it to client */
         int grabImage();
+        /** Set axes and bayer capability matching the downloaded image type */
+        void setImageAxes(ASI_IMG_TYPE type);
         /** Get initial parameters from camera */
         void setupParams();
         /** Calculate time left in seconds after start_time */
@@ -169,6 +194,34 @@ class ASICCD : public INDI::CCD
         INumber ADCDepthN;
         INumberVectorProperty ADCDepthNP;
 
+        INumber SequenceN[1];
+        INumberVectorProperty SequenceNP;
+
+        enum
+        {
+            SEQUENCE_FRAMES,
+            SEQUENCE_DUTY_CYCLE,
+            SEQUENCE_DEAD_TIME,
+        };
+
+        INumber SequenceStatsN[3];
+        INumberVectorProperty SequenceStatsNP;
+
+        INumber StreamBuffersN[1];
+        INumberVectorProperty StreamBuffersNP;
+
+        enum
+        {
+            STREAM_DROPPED,
+            STREAM_QUEUE_DEPTH,
+            STREAM_CAPTURE_MS,
+            STREAM_QUEUE_MS,
+            STREAM_DELIVERY_MS,
+        };
+
+        INumber StreamStatsN[5];
+        INumberVectorProperty StreamStatsNP;
+
         IText SDKVersionS[1] = {};
         ITextVectorProperty SDKVersionSP;
 
@@ -194,6 +247,51 @@ class ASICCD : public INDI::CCD
         std::mutex condMutex;
         std::condition_variable cv;
 
+        // Back-to-back sequence: double buffered frame store shared by the
+        // imaging thread (capture) and the publisher thread (FITS & upload).
+        struct SequenceFrame
+        {
+            std::vector<uint8_t> data;
+            ASI_IMG_TYPE type = ASI_IMG_END;
+            uint16_t width = 0, height = 0;
+            struct timeval start = {0, 0};
+            // Frame number and seconds since the sequence started, taken when downloaded
+            uint32_t number = 0;
+            double elapsed = 0;
+            bool ready = false;
+        };
+
+        SequenceFrame m_SequenceFrames[2];
+        int m_SequenceWrite {0};
+        std::atomic<uint32_t> m_SequenceRemaining {0};
+        std::atomic<uint32_t> m_SequenceCaptured {0};
+        struct timeval m_SequenceStart;
+        std::thread m_SequenceThread;
+        std::mutex m_SequenceMutex;
+        std::condition_variable m_SequenceCV;
+        bool m_SequenceStop {false};
+        // Set on abort, queued frames are dropped instead of published
+        bool m_SequenceDiscard {false};
+        // Start of the sequence frame being published, used for DATE-OBS
+        const struct timeval *m_PublishStart {nullptr};
+
+        // Video streaming: frames are read into the ring by the imaging thread
+        // and delivered to the streamer by the delivery thread.
+        FrameRing<> m_FrameRing;
+        std::vector<uint8_t> m_SpillFrame;
+        std::thread m_DeliveryThread;
+        std::mutex m_DeliveryMutex;
+        std::condition_variable m_DeliveryCV;
+        bool m_DeliveryStop {false};
+
+        std::atomic<uint32_t> m_DroppedFrames {0};
+        std::atomic<uint64_t> m_CaptureTimeUS {0};
+        std::atomic<uint32_t> m_CaptureCount {0};
+        uint64_t m_QueueTimeUS {0};
+        uint64_t m_DeliveryTimeUS {0};
+        uint32_t m_DeliveryCount {0};
+        FrameRing<>::Clock::time_point m_StreamStatsUpdate;
+
         // ST4
         float WEPulseRequest;
         struct timeval WEPulseStart;
@@ -207,6 +305,9 @@ class ASICCD : public INDI::CCD
         ASI_GUIDE_DIRECTION NSDir;
         const char *NSDirName;
 
+        // Scratch buffer for interleaved RGB24 frames, kept between exposures
+        std::vector<uint8_t> m_RGBBuffer;
+
         // Camera ROI
         uint32_t m_SubX = 0, m_SubY = 0, m_SubW = 0, m_SubH = 0;
 
@@ -257,6 +257,17 @@ void AUXCommand::parseBuf(buffer buf, bool do_checksum)
         data  = buffer(buf.begin() + 5, buf.end());
 }
 
+// Frame already checked by the reader, no copy of it is made
+void AUXCommand::parseFrame(const unsigned char *frame)
+{
+    len   = frame[1];
+    src   = (AUXtargets)frame[2];
+    dst   = (AUXtargets)frame[3];
+    cmd   = (AUXCommands)frame[4];
+    data.assign(frame + 5, frame + len + 2);
+    valid = true;
+}
+
 
 unsigned char AUXCommand::checksum(buffer buf)
 {
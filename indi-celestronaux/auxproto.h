@@ -65,6 +65,7 @@ class AUXCommand
     void fillBuf(buffer &buf);
     void parseBuf(buffer buf);
     void parseBuf(buffer buf, bool do_checksum);
+    void parseFrame(const unsigned char *frame);
     long getPosition();
     void setPosition(long p);
     void setPosition(double p);
@@ -0,0 +1,210 @@
+/*
+    Celestron Aux Mount Driver - AUX bus reactor.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "auxreactor.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Wake up this often to check for stop
+#define POLL_TIMEOUT 100 // ms
+
+constexpr size_t AUXReactor::RING_SIZE;
+
+AUXReactor::~AUXReactor()
+{
+    stop();
+}
+
+bool AUXReactor::start(int fd, Handler unsolicited)
+{
+    stop();
+    if (fd < 0)
+        return false;
+
+    this->fd          = fd;
+    this->unsolicited = unsolicited;
+    head = tail = 0;
+    exit   = false;
+    active = true;
+    thread = std::thread(&AUXReactor::run, this);
+    return true;
+}
+
+void AUXReactor::stop()
+{
+    exit = true;
+    if (thread.joinable())
+        thread.join();
+    active = false;
+
+    // Waiting requests see a broken promise
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.clear();
+}
+
+AUXReactor::Request AUXReactor::expect(const AUXCommand &request)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Pending p;
+    p.id  = nextId++;
+    p.key = key(request.dst, request.src, request.cmd);
+    Request r { p.id, p.promise.get_future() };
+    pending.push_back(std::move(p));
+    return r;
+}
+
+void AUXReactor::cancel(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.remove_if([id](const Pending & p)
+    {
+        return p.id == id;
+    });
+}
+
+void AUXReactor::run()
+{
+    while (!exit)
+    {
+        pollfd pfd;
+        pfd.fd     = fd;
+        pfd.events = POLLIN;
+        int rc     = poll(&pfd, 1, POLL_TIMEOUT);
+        if (rc < 0 && errno == EINTR)
+            continue;
+        if (rc < 0)
+        {
+            fprintf(stderr, "AUXReactor: poll failed: %s\n", strerror(errno));
+            break;
+        }
+        if (rc == 0)
+            continue;
+
+        // A full ring holds no frame, drop it
+        if (head - tail == RING_SIZE)
+        {
+            resync += RING_SIZE;
+            tail = head;
+        }
+
+        // Read whatever is there, up to the end of the ring
+        size_t offset = head % RING_SIZE;
+        size_t space  = std::min(RING_SIZE - (head - tail), RING_SIZE - offset);
+        ssize_t n     = read(fd, ring + offset, space);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if (n <= 0)
+        {
+            fprintf(stderr, "AUXReactor: connection lost: %s\n", n < 0 ? strerror(errno) : "end of file");
+            break;
+        }
+        head += n;
+        extract();
+    }
+
+    active = false;
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.clear();
+}
+
+void AUXReactor::extract()
+{
+    // 0x3b <len>=3> <src> <dst> <cmd> <len-3 bytes of data> <checksum>
+    unsigned char copy[3 + 255];
+
+    while (head - tail >= 2)
+    {
+        if (at(tail) != 0x3b)
+        {
+            tail++;
+            resync++;
+            continue;
+        }
+
+        size_t len = at(tail + 1);
+        if (len < 3)
+        {
+            tail++;
+            resync++;
+            continue;
+        }
+
+        size_t size = len + 3;
+        if (head - tail < size)
+            break;
+
+        unsigned sum = 0;
+        for (size_t i = 1; i < size - 1; i++)
+            sum += at(tail + i);
+        if (((~sum + 1) & 0xFF) != at(tail + size - 1))
+        {
+            // Not a frame after all, look for the next preamble
+            tail++;
+            resync++;
+            continue;
+        }
+
+        // Frames wrapping around the end of the ring are copied out
+        size_t offset = tail % RING_SIZE;
+        const unsigned char *frame = ring + offset;
+        if (offset + size > RING_SIZE)
+        {
+            for (size_t i = 0; i < size; i++)
+                copy[i] = at(tail + i);
+            frame = copy;
+        }
+
+        tail += size;
+        received++;
+        dispatch(frame);
+    }
+}
+
+void AUXReactor::dispatch(const unsigned char *frame)
+{
+    // The bus echoes what we send
+    if (frame[2] == APP)
+        return;
+
+    AUXCommand m;
+    m.parseFrame(frame);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t k = key(frame[2], frame[3], frame[4]);
+        auto it = std::find_if(pending.begin(), pending.end(), [k](const Pending & p)
+        {
+            return p.key == k;
+        });
+        if (it != pending.end())
+        {
+            it->promise.set_value(std::move(m));
+            pending.erase(it);
+            return;
+        }
+    }
+
+    if (unsolicited)
+        unsolicited(m);
+}
@@ -0,0 +1,107 @@
+/*
+    Celestron Aux Mount Driver - AUX bus reactor.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include "auxproto.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief AUXReactor reads the AUX bus on its own thread. Bytes are read in chunks into a ring,
+ * frames are cut and checksummed in the ring and each reply goes to the oldest request waiting
+ * for the same (src, dst, cmd). Frames nobody waits for, e.g. hand controller traffic, go to the
+ * unsolicited handler on the reactor thread. Echoes of the frames sent by the driver are dropped.
+ */
+class AUXReactor
+{
+  public:
+    typedef std::function<void(AUXCommand &)> Handler;
+
+    struct Request
+    {
+        uint64_t id;
+        std::future<AUXCommand> reply;
+    };
+
+    ~AUXReactor();
+
+    bool start(int fd, Handler unsolicited);
+    void stop();
+    bool running() const
+    {
+        return active;
+    }
+
+    /** Register for the reply to request, before sending it. */
+    Request expect(const AUXCommand &request);
+    /** Forget a request that timed out, so a late reply does not go to the next one. */
+    void cancel(uint64_t id);
+
+    /** Frames received and bytes skipped looking for a valid frame. */
+    uint64_t frames() const
+    {
+        return received;
+    }
+    uint64_t skipped() const
+    {
+        return resync;
+    }
+
+  private:
+    static uint32_t key(unsigned src, unsigned dst, unsigned cmd)
+    {
+        return (src << 16) | (dst << 8) | cmd;
+    }
+    unsigned char at(size_t i) const
+    {
+        return ring[i % RING_SIZE];
+    }
+    void run();
+    void extract();
+    void dispatch(const unsigned char *frame);
+
+    // Power of two, the free running indices wrap with it
+    static constexpr size_t RING_SIZE = 4096;
+    unsigned char ring[RING_SIZE];
+    size_t head {0}, tail {0};
+
+    struct Pending
+    {
+        uint64_t id;
+        uint32_t key;
+        std::promise<AUXCommand> promise;
+    };
+    std::list<Pending> pending;
+    uint64_t nextId {1};
+    std::mutex mutex;
+
+    int fd {-1};
+    Handler unsolicited;
+    std::thread thread;
+    std::atomic<bool> active {false};
+    std::atomic<bool> exit {false};
+    std::atomic<uint64_t> received {0}, resync {0};
+};
@@ -21,8 +21,10 @@
 */
 
 #include <algorithm>
+#include <cmath>
 #include <math.h>
 #include <queue>
+#include <vector>
 #include <string.h>
 #include <termios.h>
 #include <unistd.h>
@@ -37,6 +39,7 @@
 #define READ_TIMEOUT 1 		// s
 #define CTS_TIMEOUT 100		// ms
 #define RTS_DELAY 50		// ms
+#define MAX_UNSOLICITED 64	// frames kept between ticks
 
 bool TOUT_DEBUG = false;
 bool GPS_DEBUG = false;
@@ -158,6 +161,7 @@ CelestronAUX::CelestronAUX()
 /////////////////////////////////////////////////////////////////////////////////////
 CelestronAUX::~CelestronAUX()
 {
+    stopTrackingThread();
 }
 
 
@@ -191,6 +195,7 @@ bool CelestronAUX::Abort()
     AxisStatusAZ = AxisStatusALT = STOPPED;
     ScopeStatus                  = IDLE;
 
+    resetTrajectory();
     Track(0, 0);
     buffer b(1);
     b[0] = 0;
@@ -305,6 +310,10 @@ bool CelestronAUX::Handshake()
                 if (!tty_set_speed(PortFD, B19200))
                     return false;
                 LOG_INFO("Setting serial speed to 19200 baud.");
+                reactor.start(PortFD, [this](AUXCommand & m)
+                {
+                    queueUnsolicited(m);
+                });
             }
             else
             {
@@ -323,6 +332,10 @@ bool CelestronAUX::Handshake()
         {
             LOG_INFO("Wait for mount connection to settle.");
             msleep(1000);
+            reactor.start(PortFD, [this](AUXCommand & m)
+            {
+                queueUnsolicited(m);
+            });
             return true;
         }
 
@@ -337,6 +350,7 @@ bool CelestronAUX::Handshake()
         {
             LOG_ERROR("Got no response from target ALT or AZM.");
             LOG_ERROR("Cannot continue without connection to motor controllers.");
+            reactor.stop();
             return false;
         }
 
@@ -356,6 +370,7 @@ bool CelestronAUX::Handshake()
 bool CelestronAUX::Disconnect()
 {
     Abort();
+    reactor.stop();
     return INDI::Telescope::Disconnect();
 }
 
@@ -609,6 +624,18 @@ bool CelestronAUX::initProperties()
     IUFillSwitchVector(&GPSEmuSP, GPSEmuS, 2, getDeviceName(), "GPSEMU", "GPS Emu", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60,
                        IPS_IDLE);
 
+    IUFillNumber(&TrackLoopN[TRACK_PERIOD], "TRACK_PERIOD", "Period (ms)", "%.0f", 100, 5000, 50, 250);
+    IUFillNumber(&TrackLoopN[TRACK_SPAN], "TRACK_SPAN", "Fit span (s)", "%.0f", 1, 600, 10, 30);
+    IUFillNumber(&TrackLoopN[TRACK_GAIN], "TRACK_GAIN", "Correction gain", "%.2f", 0, 1, 0.05, 0.3);
+    IUFillNumberVector(&TrackLoopNP, TrackLoopN, 3, getDeviceName(), "TRACK_LOOP", "Tracking loop", MOTION_TAB, IP_RW, 60,
+                       IPS_IDLE);
+
+    IUFillNumber(&TrackErrorN[TRACK_ERROR_ALT], "TRACK_ERROR_ALT", "Alt error (arcsec)", "%.1f", -1e6, 1e6, 0, 0);
+    IUFillNumber(&TrackErrorN[TRACK_ERROR_AZ], "TRACK_ERROR_AZ", "Az error (arcsec)", "%.1f", -1e6, 1e6, 0, 0);
+    IUFillNumber(&TrackErrorN[TRACK_ERROR_RMS], "TRACK_ERROR_RMS", "RMS (arcsec)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&TrackErrorNP, TrackErrorN, 3, getDeviceName(), "TRACK_ERROR", "Tracking error", MOTION_TAB, IP_RO, 60,
+                       IPS_IDLE);
+
     IUFillSwitch(&NetDetectS[ISS_OFF], "ISS_OFF", "Detect", ISS_OFF);
     IUFillSwitchVector(&NetDetectSP, NetDetectS, 1, getDeviceName(), "NETDETECT", "Network scope", CONNECTION_TAB, IP_RW,
                        ISR_ATMOST1, 60, IPS_IDLE);
@@ -649,6 +676,10 @@ bool CelestronAUX::updateProperties()
         GPSEmuS[gpsemu].s = ISS_ON;
         IDSetSwitch(&GPSEmuSP, nullptr);
 
+        defineNumber(&TrackLoopNP);
+        defineNumber(&TrackErrorNP);
+        startTrackingThread();
+
         IUSaveText(&FirmwareT[FW_HC], "HC version");
         IUSaveText(&FirmwareT[FW_HCp], "HC+ version");
         IUSaveText(&FirmwareT[FW_AZM], "Ra/AZM version");
@@ -666,6 +697,10 @@ bool CelestronAUX::updateProperties()
         deleteProperty(CWPosSP.name);
         deleteProperty(GPSEmuSP.name);
         deleteProperty(FirmwareTP.name);
+
+        stopTrackingThread();
+        deleteProperty(TrackLoopNP.name);
+        deleteProperty(TrackErrorNP.name);
     }
     return true;
 }
@@ -681,6 +716,7 @@ bool CelestronAUX::saveConfigItems(FILE *fp)
     IUSaveConfigSwitch(fp, &CordWrapSP);
     IUSaveConfigSwitch(fp, &CWPosSP);
     IUSaveConfigSwitch(fp, &GPSEmuSP);
+    IUSaveConfigNumber(fp, &TrackLoopNP);
     return true;
 }
 
@@ -720,6 +756,18 @@ bool CelestronAUX::ISNewNumber(const char *dev, const char *name, double values[
 
     if (strcmp(dev, getDeviceName()) == 0)
     {
+        // Tracking loop
+        if (!strcmp(name, TrackLoopNP.name))
+        {
+            {
+                std::lock_guard<std::mutex> lock(trackMutex);
+                IUUpdateNumber(&TrackLoopNP, values, names, n);
+            }
+            TrackLoopNP.s = IPS_OK;
+            IDSetNumber(&TrackLoopNP, nullptr);
+            return true;
+        }
+
         // Process alignment properties
         ProcessAlignmentNumberProperties(this, name, values, names, n);
     }
@@ -1101,6 +1149,9 @@ void CelestronAUX::TimerHit()
 
     // OK I have updated the celestial reference frame RA/DEC in ReadScopeStatus
     // Now handle the tracking state
+    if (TrackState != SCOPE_TRACKING)
+        resetTrajectory();
+
     switch (TrackState)
     {
         case SCOPE_PARKING:
@@ -1163,16 +1214,9 @@ void CelestronAUX::TimerHit()
 
         case SCOPE_TRACKING:
         {
-            // Continue or start tracking
-            // Calculate where the mount needs to be in a minute
-            double JulianOffset = 60.0 / (24.0 * 60 * 60);
-            TelescopeDirectionVector TDV;
-            ln_hrz_posn AltAz, AAzero;
-
-            AltAz  = AltAzFromRaDec(CurrentTrackingTarget.ra, CurrentTrackingTarget.dec, JulianOffset);
-            AAzero = AltAzFromRaDec(CurrentTrackingTarget.ra, CurrentTrackingTarget.dec, 0);
-            if (TraceThisTick)
-                DEBUGF(DBG_CAUX, "Tracking - Calculated Alt %lf deg ; Az %lf deg", AltAz.alt, AltAz.az);
+            // Continue or start tracking.
+            // Refit the trajectory the tracking thread follows between ticks
+            fitTrajectory(CurrentTrackingTarget);
             /*
             TODO
             The tracking should take into account movement of the scope
@@ -1181,41 +1225,6 @@ void CelestronAUX::TimerHit()
             Right now when we move the scope by HC it returns to the
             designated target by corrective tracking.
             */
-
-            // Fold Azimuth into 0-360
-            AltAz.az = range360(AltAz.az);
-
-            {
-                long altRate, azRate;
-
-                // This is in steps per minute
-                altRate = long(AltAz.alt * STEPS_PER_DEGREE - GetALT());
-                azRate  = long(AltAz.az * STEPS_PER_DEGREE - GetAZ());
-
-                if (TraceThisTick)
-                    DEBUGF(DBG_CAUX, "Target (AltAz): %f  %f  Scope  (AltAz)  %f  %f", AltAz.alt, AltAz.az,
-                           GetALT() / STEPS_PER_DEGREE, GetAZ() / STEPS_PER_DEGREE);
-
-                if (std::abs(azRate) > STEPS_PER_REVOLUTION / 2)
-                {
-                    // Crossing the meridian. AZ skips from 350+ to 0+
-                    // Correct for wrap-around
-                    azRate += STEPS_PER_REVOLUTION;
-                    if (azRate > STEPS_PER_REVOLUTION)
-                        azRate %= STEPS_PER_REVOLUTION;
-                }
-
-                // Track function needs rates in 1000*arcmin/minute
-                // Rates here are in steps/minute
-                // conv. factor: TRACK_SCALE = 60000/STEPS_PER_DEGREE
-                altRate = long(TRACK_SCALE * altRate);
-                azRate  = long(TRACK_SCALE * azRate);
-                Track(altRate, azRate);
-
-                if (TraceThisTick)
-                    DEBUGF(DBG_CAUX, "TimerHit - Tracking AltRate %d AzRate %d ; Pos diff (deg): Alt: %f Az: %f",
-                           altRate, azRate, AltAz.alt - AAzero.alt, anglediff(AltAz.az, AAzero.az));
-            }
             break;
         }
 
@@ -1276,11 +1285,11 @@ bool CelestronAUX::slewing()
 /////////////////////////////////////////////////////////////////////////////////////
 bool CelestronAUX::Slew(AUXtargets trg, int rate)
 {
+    resetTrajectory();
     AUXCommand cmd((rate < 0) ? MC_MOVE_NEG : MC_MOVE_POS, APP, trg);
     cmd.setRate((unsigned char)(std::abs(rate) & 0xFF));
 
-    sendCmd(cmd);
-    readMsgs(cmd);
+    transact(cmd);
     return true;
 }
 
@@ -1312,6 +1321,7 @@ bool CelestronAUX::GoToFast(long alt, long az, bool track)
     targetAz   = az;
     tracking   = track;
     slewingAlt = slewingAz = true;
+    resetTrajectory();
     Track(0, 0);
     AUXCommand altcmd(MC_GOTO_FAST, APP, ALT);
     AUXCommand azmcmd(MC_GOTO_FAST, APP, AZM);
@@ -1320,10 +1330,8 @@ bool CelestronAUX::GoToFast(long alt, long az, bool track)
     az += STEPS_PER_REVOLUTION / 2;
     az %= STEPS_PER_REVOLUTION;
     azmcmd.setPosition(az);
-    sendCmd(altcmd);
-    readMsgs(altcmd);
-    sendCmd(azmcmd);
-    readMsgs(azmcmd);
+    AUXCommand cmds[2] = { altcmd, azmcmd };
+    exchange(cmds, 2);
     //DEBUG=false;
     return true;
 };
@@ -1338,6 +1346,7 @@ bool CelestronAUX::GoToSlow(long alt, long az, bool track)
     targetAz   = az;
     tracking   = track;
     slewingAlt = slewingAz = true;
+    resetTrajectory();
     Track(0, 0);
     AUXCommand altcmd(MC_GOTO_SLOW, APP, ALT);
     AUXCommand azmcmd(MC_GOTO_SLOW, APP, AZM);
@@ -1346,10 +1355,8 @@ bool CelestronAUX::GoToSlow(long alt, long az, bool track)
     az += STEPS_PER_REVOLUTION / 2;
     az %= STEPS_PER_REVOLUTION;
     azmcmd.setPosition(az);
-    sendCmd(altcmd);
-    readMsgs(altcmd);
-    sendCmd(azmcmd);
-    readMsgs(azmcmd);
+    AUXCommand cmds[2] = { altcmd, azmcmd };
+    exchange(cmds, 2);
     //DEBUG=false;
     return true;
 };
@@ -1360,9 +1367,7 @@ bool CelestronAUX::GoToSlow(long alt, long az, bool track)
 bool CelestronAUX::getVersion(AUXtargets trg)
 {
     AUXCommand firmver(GET_VER, APP, trg);
-    if (! sendCmd(firmver))
-        return false;
-    if (! readMsgs(firmver))
+    if (! transact(firmver))
         return false;
     return true;
 };
@@ -1393,8 +1398,7 @@ bool CelestronAUX::setCordwrap(bool enable)
 
     AUXCommand cwcmd((enable) ? MC_ENABLE_CORDWRAP : MC_DISABLE_CORDWRAP, APP, AZM);
     LOGF_INFO("setCordWrap before %d", cordwrap);
-    sendCmd(cwcmd);
-    readMsgs(cwcmd);
+    transact(cwcmd);
     LOGF_INFO("setCordWrap after %d", cordwrap);
     return true;
 };
@@ -1403,8 +1407,7 @@ bool CelestronAUX::getCordwrap()
 {
     AUXCommand cwcmd(MC_POLL_CORDWRAP, APP, AZM);
     LOGF_INFO("getCordWrap before %d", cordwrap);
-    sendCmd(cwcmd);
-    readMsgs(cwcmd);
+    transact(cwcmd);
     LOGF_INFO("getCordWrap after %d", cordwrap);
     return cordwrap;
 };
@@ -1416,8 +1419,7 @@ bool CelestronAUX::setCordwrapPos(long pos)
 {
     AUXCommand cwcmd(MC_SET_CORDWRAP_POS, APP, AZM);
     cwcmd.setPosition(pos);
-    sendCmd(cwcmd);
-    readMsgs(cwcmd);
+    transact(cwcmd);
     return true;
 };
 
@@ -1427,8 +1429,7 @@ bool CelestronAUX::setCordwrapPos(long pos)
 long CelestronAUX::getCordwrapPos()
 {
     AUXCommand cwcmd(MC_GET_CORDWRAP_POS, APP, AZM);
-    sendCmd(cwcmd);
-    readMsgs(cwcmd);
+    transact(cwcmd);
     return cordwrapPos;
 };
 
@@ -1452,13 +1453,186 @@ bool CelestronAUX::Track(long altRate, long azRate)
     altcmd.setPosition(long(std::abs(AltRate)));
     azmcmd.setPosition(long(std::abs(AzRate)));
 
-    sendCmd(altcmd);
-    readMsgs(altcmd);
-    sendCmd(azmcmd);
-    readMsgs(azmcmd);
+    AUXCommand cmds[2] = { altcmd, azmcmd };
+    exchange(cmds, 2);
     return true;
 };
 
+/////////////////////////////////////////////////////////////////////////////////////
+/// Fit a quadratic to the target position in encoder steps a span before, at and
+/// after now. The span is a few tens of seconds, the tracking thread only follows
+/// the fit until the next tick.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::fitTrajectory(const ln_equ_posn &target)
+{
+    double span   = TrackLoopN[TRACK_SPAN].value;
+    double offset = span / (24.0 * 60 * 60);
+
+    ln_hrz_posn before = AltAzFromRaDec(target.ra, target.dec, -offset);
+    auto epoch         = std::chrono::steady_clock::now();
+    ln_hrz_posn now    = AltAzFromRaDec(target.ra, target.dec, 0);
+    ln_hrz_posn after  = AltAzFromRaDec(target.ra, target.dec, offset);
+
+    if (TraceThisTick)
+        DEBUGF(DBG_CAUX, "Tracking - Calculated Alt %lf deg ; Az %lf deg", now.alt, now.az);
+
+    double alt[3] = { before.alt * STEPS_PER_DEGREE, now.alt * STEPS_PER_DEGREE, after.alt * STEPS_PER_DEGREE };
+    double az[3]  = { range360(before.az) * STEPS_PER_DEGREE, range360(now.az) * STEPS_PER_DEGREE,
+                      range360(after.az) * STEPS_PER_DEGREE
+                    };
+
+    // Unwrap the azimuth around the middle sample, AZ skips from 360 to 0 at the north
+    for (int i = 0; i < 3; i += 2)
+    {
+        if (az[i] - az[1] > STEPS_PER_REVOLUTION / 2)
+            az[i] -= STEPS_PER_REVOLUTION;
+        else if (az[i] - az[1] < -STEPS_PER_REVOLUTION / 2)
+            az[i] += STEPS_PER_REVOLUTION;
+    }
+
+    Trajectory fit;
+    fit.valid  = true;
+    fit.epoch  = epoch;
+    fit.alt[0] = alt[1];
+    fit.alt[1] = (alt[2] - alt[0]) / (2 * span);
+    fit.alt[2] = (alt[2] - 2 * alt[1] + alt[0]) / (span * span);
+    fit.az[0]  = az[1];
+    fit.az[1]  = (az[2] - az[0]) / (2 * span);
+    fit.az[2]  = (az[2] - 2 * az[1] + az[0]) / (span * span);
+
+    if (TraceThisTick)
+        DEBUGF(DBG_CAUX, "Tracking - Rates (steps/s) Alt %f Az %f ; Accelerations (steps/s^2) Alt %g Az %g",
+               fit.alt[1], fit.az[1], fit.alt[2], fit.az[2]);
+
+    std::lock_guard<std::mutex> lock(trackMutex);
+    trajectory = fit;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+/// Stop following the trajectory, the caller takes over the motors.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::resetTrajectory()
+{
+    std::lock_guard<std::mutex> lock(trackMutex);
+    trajectory.valid = false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::startTrackingThread()
+{
+    if (trackThread.joinable())
+        return;
+
+    trackStop      = false;
+    trackSquares   = 0;
+    trackSamples   = 0;
+    trackPublished = std::chrono::steady_clock::now();
+    trackThread    = std::thread(&CelestronAUX::trackingLoop, this);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::stopTrackingThread()
+{
+    if (!trackThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(trackMutex);
+        trackStop        = true;
+        trajectory.valid = false;
+        trackCV.notify_all();
+    }
+    trackThread.join();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+/// Issue rate updates every TRACK_PERIOD ms while there is a trajectory to follow.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::trackingLoop()
+{
+    auto next = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(trackMutex);
+    while (!trackStop)
+    {
+        double period = TrackLoopN[TRACK_PERIOD].value / 1000.0;
+        double gain   = TrackLoopN[TRACK_GAIN].value;
+
+        // Keep the cadence, the bus traffic of a step is part of the period
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period));
+        next = std::max(next, std::chrono::steady_clock::now());
+        trackCV.wait_until(lock, next);
+        if (trackStop || !trajectory.valid)
+            continue;
+
+        lock.unlock();
+        trackStep(period, gain);
+        lock.lock();
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+/// Command the rate that brings the axes to the trajectory by the end of the period:
+/// the rate of the trajectory in the middle of the period as feed-forward plus a
+/// fraction of the current error.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::trackStep(double period, double gain)
+{
+    // Keep the bus until the rates are sent, a GoTo waits for us and then overrides them
+    std::lock_guard<std::recursive_mutex> bus(auxMutex);
+
+    AUXCommand cmds[2] = { AUXCommand(MC_GET_POSITION, APP, ALT), AUXCommand(MC_GET_POSITION, APP, AZM) };
+    if (!exchange(cmds, 2))
+        return;
+
+    Trajectory fit;
+    {
+        std::lock_guard<std::mutex> lock(trackMutex);
+        fit = trajectory;
+    }
+    if (!fit.valid)
+        return;
+
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - fit.epoch).count();
+
+    double altError = fit.alt[0] + (fit.alt[1] + fit.alt[2] * t / 2) * t - GetALT();
+    double azError  = fit.az[0] + (fit.az[1] + fit.az[2] * t / 2) * t - GetAZ();
+    azError = std::fmod(azError, double(STEPS_PER_REVOLUTION));
+    if (azError > STEPS_PER_REVOLUTION / 2)
+        azError -= STEPS_PER_REVOLUTION;
+    else if (azError < -STEPS_PER_REVOLUTION / 2)
+        azError += STEPS_PER_REVOLUTION;
+
+    // Steps per second
+    double altRate = fit.alt[1] + fit.alt[2] * (t + period / 2) + gain * altError / period;
+    double azRate  = fit.az[1] + fit.az[2] * (t + period / 2) + gain * azError / period;
+
+    // Track function needs rates in 1000*arcmin/minute
+    Track(long(TRACK_SCALE * 60 * altRate), long(TRACK_SCALE * 60 * azRate));
+
+    // Export the error once a second
+    trackSquares += altError * altError + azError * azError;
+    trackSamples++;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - trackPublished < std::chrono::seconds(1))
+        return;
+
+    const double arcsec = 3600.0 / STEPS_PER_DEGREE;
+    TrackErrorN[TRACK_ERROR_ALT].value = altError * arcsec;
+    TrackErrorN[TRACK_ERROR_AZ].value  = azError * arcsec;
+    TrackErrorN[TRACK_ERROR_RMS].value = std::sqrt(trackSquares / trackSamples) * arcsec;
+    TrackErrorNP.s = IPS_OK;
+    IDSetNumber(&TrackErrorNP, nullptr);
+
+    trackSquares   = 0;
+    trackSamples   = 0;
+    trackPublished = now;
+}
+
 int debug_timeout = 30;
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -1467,6 +1641,7 @@ int debug_timeout = 30;
 bool CelestronAUX::TimerTick(double dt)
 {
     querryStatus();
+    processUnsolicited();
     if (TOUT_DEBUG)
     {
         if (debug_timeout < 0)
@@ -1503,8 +1678,8 @@ bool CelestronAUX::TimerTick(double dt)
         // if we reach the target at previous tick start tracking if tracking requested
         if (tracking && !slewing && Alt == targetAlt && Az == targetAz)
         {
-            targetAlt = (Alt += AltRate * dt);
-            targetAz  = (Az += AzRate * dt);
+            targetAlt = (Alt += long(AltRate * dt));
+            targetAz  = (Az += long(AzRate * dt));
         }
     }
     return true;
@@ -1515,24 +1690,52 @@ bool CelestronAUX::TimerTick(double dt)
 /////////////////////////////////////////////////////////////////////////////////////
 void CelestronAUX::querryStatus()
 {
-    AUXtargets trg[2] = { ALT, AZM };
-    for (int i = 0; i < 2; i++)
+    // Both positions and the slew status in one exchange
+    AUXCommand cmds[4] = { AUXCommand(MC_GET_POSITION, APP, ALT), AUXCommand(MC_GET_POSITION, APP, AZM) };
+    size_t count = 2;
+    if (slewingAlt)
+        cmds[count++] = AUXCommand(MC_SLEW_DONE, APP, ALT);
+    if (slewingAz)
+        cmds[count++] = AUXCommand(MC_SLEW_DONE, APP, AZM);
+    exchange(cmds, count);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+/// Called on the reactor thread for frames no request waits for.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::queueUnsolicited(AUXCommand &m)
+{
+    // The hand controller does not wait long for the GPS, answer right away
+    if (m.dst == GPS)
     {
-        AUXCommand cmd(MC_GET_POSITION, APP, trg[i]);
-        sendCmd(cmd);
-        readMsgs(cmd);
+        emulateGPS(m);
+        return;
     }
-    if (slewingAlt)
+
+    std::lock_guard<std::mutex> lock(unsolicitedMutex);
+    if (unsolicitedMsgs.size() < MAX_UNSOLICITED)
+        unsolicitedMsgs.push_back(std::move(m));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+/// Log the hand controller traffic heard since the last tick and keep track of the
+/// positions it reads.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::processUnsolicited()
+{
+    std::deque<AUXCommand> msgs;
     {
-        AUXCommand cmd(MC_SLEW_DONE, APP, ALT);
-        sendCmd(cmd);
-        readMsgs(cmd);
+        std::lock_guard<std::mutex> lock(unsolicitedMutex);
+        msgs.swap(unsolicitedMsgs);
     }
-    if (slewingAz)
+
+    std::lock_guard<std::recursive_mutex> lock(auxMutex);
+    for (auto &m : msgs)
     {
-        AUXCommand cmd(MC_SLEW_DONE, APP, AZM);
-        sendCmd(cmd);
-        readMsgs(cmd);
+        if (m.src == HC || m.src == HCP || m.dst == HC || m.dst == HCP)
+            DEBUGF(DBG_AUXMOUNT, "HC traffic: 0x%02x -> 0x%02x command 0x%02x, %d data bytes", m.src, m.dst, m.cmd,
+                   (int)m.data.size());
+        processCmd(m);
     }
 }
 
@@ -1670,10 +1873,8 @@ void CelestronAUX::processCmd(AUXCommand &m)
                         // if (PROC_DEBUG) IDLog("ALT: %ld", Alt);
                         break;
                     case AZM:
-                        Az = m.getPosition();
                         // Celestron uses N as zero Azimuth!
-                        Az += STEPS_PER_REVOLUTION / 2;
-                        Az %= STEPS_PER_REVOLUTION;
+                        Az = (m.getPosition() + STEPS_PER_REVOLUTION / 2) % STEPS_PER_REVOLUTION;
                         // if (PROC_DEBUG) IDLog("AZM: %ld", Az);
                         break;
                     default:
@@ -1910,6 +2111,7 @@ bool CelestronAUX::tcp_readMsgs()
 /////////////////////////////////////////////////////////////////////////////////////
 bool CelestronAUX::readMsgs(AUXCommand c)
 {
+    std::lock_guard<std::recursive_mutex> lock(auxMutex);
     if (getActiveConnection() == serialConnection)
         return serial_readMsgs(c);
     else
@@ -1929,7 +2131,9 @@ int CelestronAUX::sendBuffer(int PortFD, buffer buf)
         if (aux_tty_write(PortFD, (char*)buf.data(), buf.size(), CTS_TIMEOUT, &n) != TTY_OK)
             return 0;
 
-        msleep(50);
+        // Give the reply time to arrive, the reactor waits for it instead
+        if (!reactor.running())
+            msleep(50);
         if (n == -1)
             perror("CAUX::sendBuffer");
         if ((unsigned)n != buf.size())
@@ -1945,6 +2149,7 @@ int CelestronAUX::sendBuffer(int PortFD, buffer buf)
 /////////////////////////////////////////////////////////////////////////////////////
 bool CelestronAUX::sendCmd(AUXCommand &c)
 {
+    std::lock_guard<std::mutex> lock(writeMutex);
     buffer buf;
 
     if (SEND_DEBUG)
@@ -1979,10 +2184,73 @@ bool CelestronAUX::sendCmd(AUXCommand &c)
         IDLog("Send packet: <%s>\n", hexbuf);
     }
 
-    tcflush(PortFD, TCIOFLUSH);
+    // The reactor owns whatever is waiting to be read
+    if (!reactor.running())
+        tcflush(PortFD, TCIOFLUSH);
     return sendBuffer(PortFD, buf) == (int)buf.size();
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+/// Send the command and read the reply without letting the other thread on the bus
+/////////////////////////////////////////////////////////////////////////////////////
+bool CelestronAUX::transact(AUXCommand &c)
+{
+    return exchange(&c, 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+/// Send the commands and process their replies. Through the reactor all commands go
+/// out before waiting and the replies are collected as they arrive, otherwise each
+/// command waits for its reply.
+/////////////////////////////////////////////////////////////////////////////////////
+bool CelestronAUX::exchange(AUXCommand *cmds, size_t count)
+{
+    std::lock_guard<std::recursive_mutex> lock(auxMutex);
+    bool ok = true;
+
+    if (!reactor.running())
+    {
+        for (size_t i = 0; i < count; i++)
+            ok = sendCmd(cmds[i]) && readMsgs(cmds[i]) && ok;
+        return ok;
+    }
+
+    std::vector<AUXReactor::Request> requests;
+    requests.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        requests.push_back(reactor.expect(cmds[i]));
+
+    size_t sent = 0;
+    while (sent < count && sendCmd(cmds[sent]))
+        sent++;
+    for (size_t i = sent; i < count; i++)
+        reactor.cancel(requests[i].id);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(READ_TIMEOUT);
+    for (size_t i = 0; i < sent; i++)
+    {
+        if (requests[i].reply.wait_until(deadline) != std::future_status::ready)
+        {
+            reactor.cancel(requests[i].id);
+            DEBUGF(DBG_CAUX, "No reply to command 0x%02x from 0x%02x", cmds[i].cmd, cmds[i].dst);
+            ok = false;
+            continue;
+        }
+
+        try
+        {
+            AUXCommand reply = requests[i].reply.get();
+            processCmd(reply);
+        }
+        catch (const std::future_error &)
+        {
+            // The reactor stopped
+            ok = false;
+        }
+    }
+    return ok && sent == count;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Wrap functions around the standard driver communication functions tty_read
@@ -2110,8 +2378,8 @@ int CelestronAUX::aux_tty_write(int PortFD, char *buf, int bufsiz, float timeout
     }
 
     // ports requiring hardware flow control echo all sent characters,
-    // verify them.
-    if (isRTSCTS)
+    // verify them. The reactor reads and drops the echo itself.
+    if (isRTSCTS && !reactor.running())
     {
         if (WR_DEBUG) IDLog("aux_tty_write: verify echo\n");
         if ((errcode = tty_read(PortFD, errmsg, *n, READ_TIMEOUT, &ne)) != TTY_OK)
@@ -29,6 +29,14 @@
 #include <alignment/AlignmentSubsystemForDrivers.h>
 
 #include "auxproto.h"
+#include "auxreactor.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 class CelestronAUX :
     public INDI::Telescope,
@@ -90,6 +98,14 @@ class CelestronAUX :
         bool Track(long altRate, long azRate);
         bool TimerTick(double dt);
 
+        // Tracking loop
+        void fitTrajectory(const ln_equ_posn &target);
+        void resetTrajectory();
+        void startTrackingThread();
+        void stopTrackingThread();
+        void trackingLoop();
+        void trackStep(double period, double gain);
+
     private:
         static const long STEPS_PER_REVOLUTION;
         static const double STEPS_PER_DEGREE;
@@ -152,6 +168,24 @@ class CelestronAUX :
         ln_equ_posn CurrentTrackingTarget;
         ln_equ_posn NewTrackingTarget;
 
+        // Target trajectory around epoch in encoder steps, steps/s and steps/s^2.
+        // Fitted by TimerHit, followed by the tracking thread.
+        struct Trajectory
+        {
+            bool valid {false};
+            std::chrono::steady_clock::time_point epoch;
+            double alt[3] {};
+            double az[3] {};
+        };
+        Trajectory trajectory;
+        std::mutex trackMutex;
+        std::condition_variable trackCV;
+        std::thread trackThread;
+        bool trackStop {false};
+        double trackSquares {0};
+        int trackSamples {0};
+        std::chrono::steady_clock::time_point trackPublished;
+
         // Tracing in timer tick
         int TraceThisTickCount;
         bool TraceThisTick;
@@ -176,17 +210,30 @@ class CelestronAUX :
         void querryStatus();
         int sendBuffer(int PortFD, buffer buf);
         bool sendCmd(AUXCommand &c);
+        bool transact(AUXCommand &c);
+        bool exchange(AUXCommand *cmds, size_t count);
+        void queueUnsolicited(AUXCommand &m);
+        void processUnsolicited();
+
+        // Serializes the bus between TimerHit and the tracking thread
+        std::recursive_mutex auxMutex;
+        // Keeps frames whole on the wire, the reactor answers GPS requests on its own
+        std::mutex writeMutex;
+        // Reads the AUX bus, not used through the HC serial port
+        AUXReactor reactor;
+        std::mutex unsolicitedMutex;
+        std::deque<AUXCommand> unsolicitedMsgs;
 
         double Lat, Lon, Elv;
-        long Alt;
-        long Az;
+        std::atomic<long> Alt {0};
+        std::atomic<long> Az {0};
         long AltRate;
         long AzRate;
         long targetAlt;
         long targetAz;
         long slewRate;
         bool tracking;
-        bool slewingAlt, slewingAz;
+        std::atomic<bool> slewingAlt {false}, slewingAz {false};
         bool gpsemu;
         bool cordwrap;
         long cordwrapPos;
@@ -226,4 +273,12 @@ class CelestronAUX :
         ISwitch GPSEmuS[2];
         ISwitchVectorProperty GPSEmuSP;
         enum { GPSEMU_OFF, GPSEMU_ON };
+        // Tracking loop settings
+        INumber TrackLoopN[3];
+        INumberVectorProperty TrackLoopNP;
+        enum { TRACK_PERIOD, TRACK_SPAN, TRACK_GAIN };
+        // Tracking error
+        INumber TrackErrorN[3];
+        INumberVectorProperty TrackErrorNP;
+        enum { TRACK_ERROR_ALT, TRACK_ERROR_AZ, TRACK_ERROR_RMS };
 };
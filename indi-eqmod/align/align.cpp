@@ -397,10 +397,10 @@ void Align::AlignNearest(double jd, struct ln_lnlat_posn *position, double curre
     //double pointaz = (pointset->range24(lst - currentRA - 12.0) * 360.0) / 24.0;
     //double pointalt = currentDEC + pointset->lat;
     double pointaz, pointalt;
-    std::set<PointSet::Distance, bool (*)(PointSet::Distance, PointSet::Distance)> *sortedpoints;
+    std::vector<PointSet::Distance> sortedpoints;
     pointset->AltAzFromRaDec(currentRA, currentDEC, jd, &pointalt, &pointaz, position);
-    sortedpoints = pointset->ComputeDistances(pointalt, pointaz, PointSet::None, ingoto);
-    if (sortedpoints->empty())
+    sortedpoints = pointset->ComputeDistances(pointalt, pointaz, PointSet::None, ingoto, 1);
+    if (sortedpoints.empty())
     {
         *alignedRA  = currentRA;
         *alignedDEC = currentDEC;
@@ -408,7 +408,7 @@ void Align::AlignNearest(double jd, struct ln_lnlat_posn *position, double curre
     }
     else
     {
-        PointSet::Point *point = pointset->getPoint(sortedpoints->begin()->htmID);
+        PointSet::Point *point = pointset->getPoint(sortedpoints.front().htmID);
         if (lastnearestindex != point->index)
             LOGF_INFO("Align: current point is %d\n", point->index);
         lastnearestindex = point->index;
@@ -0,0 +1,121 @@
+/* Copyright 2012 Geehalel (geehalel AT gmail DOT com) */
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pointindex.h"
+
+#include <algorithm>
+#include <math.h>
+
+static bool nearer(const PointIndex::Neighbour &n1, const PointIndex::Neighbour &n2)
+{
+    return n1.chord2 < n2.chord2;
+}
+
+void PointIndex::Reset()
+{
+    nodes.clear();
+}
+
+size_t PointIndex::size() const
+{
+    return nodes.size();
+}
+
+double PointIndex::angle(double chord2)
+{
+    double half = sqrt(chord2) / 2.0;
+    return 2.0 * asin(half > 1.0 ? 1.0 : half);
+}
+
+void PointIndex::AddPoint(HtmID id, double x, double y, double z)
+{
+    Node node;
+    node.p[0]  = x;
+    node.p[1]  = y;
+    node.p[2]  = z;
+    node.htmID = id;
+    node.left  = -1;
+    node.right = -1;
+    nodes.push_back(node);
+    int added = nodes.size() - 1;
+    if (added == 0)
+        return;
+
+    int current = 0, axis = 0;
+    while (true)
+    {
+        int &child = (node.p[axis] < nodes[current].p[axis]) ? nodes[current].left : nodes[current].right;
+        if (child < 0)
+        {
+            child = added;
+            return;
+        }
+        current = child;
+        axis    = (axis + 1) % 3;
+    }
+}
+
+void PointIndex::Nearest(double x, double y, double z, size_t k, std::vector<Neighbour> *result) const
+{
+    double q[3] = { x, y, z };
+    result->clear();
+    if (k == 0 || k > nodes.size())
+        k = nodes.size();
+    if (k == 0)
+        return;
+    result->reserve(k + 1);
+    search(0, 0, q, k, result);
+    std::sort_heap(result->begin(), result->end(), nearer);
+}
+
+/* result is kept as a max heap of the k best points found so far */
+void PointIndex::search(int node, int axis, const double q[3], size_t k, std::vector<Neighbour> *best) const
+{
+    while (node >= 0)
+    {
+        const Node &n = nodes[node];
+        double dx = q[0] - n.p[0], dy = q[1] - n.p[1], dz = q[2] - n.p[2];
+        Neighbour candidate;
+        candidate.htmID  = n.htmID;
+        candidate.chord2 = dx * dx + dy * dy + dz * dz;
+        if (best->size() < k)
+        {
+            best->push_back(candidate);
+            std::push_heap(best->begin(), best->end(), nearer);
+        }
+        else if (candidate.chord2 < best->front().chord2)
+        {
+            std::pop_heap(best->begin(), best->end(), nearer);
+            best->back() = candidate;
+            std::push_heap(best->begin(), best->end(), nearer);
+        }
+
+        double split = q[axis] - n.p[axis];
+        int nearside = (split < 0) ? n.left : n.right;
+        int farside  = (split < 0) ? n.right : n.left;
+        int next     = (axis + 1) % 3;
+        search(nearside, next, q, k, best);
+        // the other side can only hold nearer points if the splitting plane is nearer than the worst kept
+        if (best->size() < k || split * split < best->front().chord2)
+        {
+            node = farside;
+            axis = next;
+        }
+        else
+            node = -1;
+    }
+}
@@ -0,0 +1,56 @@
+/* Copyright 2012 Geehalel (geehalel AT gmail DOT com) */
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "htm.h"
+
+#include <cstddef>
+#include <vector>
+
+/* Nearest neighbour index over unit vectors of the sync points.
+   A 3-d tree, points are inserted incrementally as they are synced and the
+   tree is never rebalanced: sync points come in a spread out order so it stays
+   shallow enough for the few hundred points of a pointing model.
+   Distances are squared chord lengths, which order points like the angular
+   distance on the sphere does. */
+class PointIndex
+{
+  public:
+    typedef struct Neighbour
+    {
+        HtmID htmID;
+        double chord2;
+    } Neighbour;
+    void Reset();
+    void AddPoint(HtmID id, double x, double y, double z);
+    size_t size() const;
+    /* The k nearest points sorted by distance, all points when k is 0 */
+    void Nearest(double x, double y, double z, size_t k, std::vector<Neighbour> *result) const;
+    /* Angular distance in radians of a squared chord length */
+    static double angle(double chord2);
+
+  private:
+    typedef struct Node
+    {
+        double p[3];
+        HtmID htmID;
+        int left, right;
+    } Node;
+    void search(int node, int axis, const double q[3], size_t k, std::vector<Neighbour> *best) const;
+    std::vector<Node> nodes;
+};
@@ -115,19 +115,14 @@ void PointSet::RaDecFromAltAz(double alt, double az, double jd, double *ra, doub
     *dec = lnradec.dec;
 }
 
-/* Using haversine: http://en.wikipedia.org/wiki/Haversine_formula */
-double sphere_unit_distance(double theta1, double theta2, double phi1, double phi2)
+/* Unit vector of an alt/az position, in the frame used for the triangulation */
+void PointSet::unitVector(double alt, double az, double *x, double *y, double *z)
 {
-    double sqrt_haversin_lat  = sin(((phi2 - phi1) / 2) * (M_PI / 180));
-    double sqrt_haversin_long = sin(((theta2 - theta1) / 2) * (M_PI / 180));
-    return (2 *
-            asin(sqrt((sqrt_haversin_lat * sqrt_haversin_lat) + cos(phi1 * (M_PI / 180)) * cos(phi2 * (M_PI / 180)) *
-                                                                    (sqrt_haversin_long * sqrt_haversin_long))));
-}
-
-bool compelt(PointSet::Distance d1, PointSet::Distance d2)
-{
-    return d1.value < d2.value;
+    double horangle = range360(-180.0 - az) * M_PI / 180.0;
+    double altangle = alt * M_PI / 180.0;
+    *x              = cos(altangle) * cos(horangle);
+    *y              = cos(altangle) * sin(horangle);
+    *z              = sin(altangle);
 }
 
 PointSet::PointSet(INDI::Telescope *t)
@@ -135,6 +130,8 @@ PointSet::PointSet(INDI::Telescope *t)
     telescope  = t;
     lnalignpos = nullptr;
     PointSetInitialized = false;
+    currentFace         = -1;
+    currentRevision     = 0;
 }
 
 const char *PointSet::getDeviceName()
@@ -142,35 +139,27 @@ const char *PointSet::getDeviceName()
     return telescope->getDeviceName();
 }
 
-std::set<PointSet::Distance, bool (*)(PointSet::Distance, PointSet::Distance)> *
-PointSet::ComputeDistances(double alt, double az, PointFilter filter, bool ingoto)
+std::vector<PointSet::Distance> PointSet::ComputeDistances(double alt, double az, PointFilter filter, bool ingoto,
+                                                          size_t k)
 {
     INDI_UNUSED(filter);
-    std::map<HtmID, Point>::iterator it;
-    std::set<Distance, bool (*)(Distance, Distance)> *distances =
-        new std::set<Distance, bool (*)(Distance, Distance)>(compelt);
-    std::set<Distance>::iterator distit;
-    std::pair<std::set<Distance>::iterator, bool> ret;
+    std::vector<PointIndex::Neighbour> neighbours;
+    std::vector<Distance> distances;
+    double x, y, z;
     /* IDLog("Compute distances for point alt=%f az=%f\n", alt, az);*/
-    for (it = PointSetMap->begin(); it != PointSetMap->end(); it++)
+    unitVector(alt, az, &x, &y, &z);
+    if (ingoto)
+        celestialIndex.Nearest(x, y, z, k, &neighbours);
+    else
+        telescopeIndex.Nearest(x, y, z, k, &neighbours);
+    distances.reserve(neighbours.size());
+    for (size_t i = 0; i < neighbours.size(); i++)
     {
-        double d;
-        if (ingoto)
-            d = sphere_unit_distance(az, (*it).second.celestialAZ, alt, (*it).second.celestialALT);
-        else
-            d = sphere_unit_distance(az, (*it).second.telescopeAZ, alt, (*it).second.telescopeALT);
         Distance elt;
-        elt.htmID = (*it).first;
-        elt.value = d;
-        ret       = distances->insert(elt);
-        /*IDLog("  Point %lld (alt=%f az=%f): distance %f \n",  elt.htmID, (*it).second.celestialALT, (*it).second.celestialAZ, elt.value);*/
+        elt.htmID = neighbours[i].htmID;
+        elt.value = PointIndex::angle(neighbours[i].chord2);
+        distances.push_back(elt);
     }
-    /*
-  IDLog("  Ordered distances for point alt=%f az=%f\n", alt, az);
-  for ( distit=distances->begin() ; distit != distances->end(); distit++ ) {
-    IDLog("  Point %lld: distance %f \n",  distit->htmID, distit->value);
-  }
-  */
     return distances;
 }
 
@@ -178,7 +167,6 @@ void PointSet::AddPoint(AlignData aligndata, struct ln_lnlat_posn *pos)
 {
     Point point;
     point.aligndata = aligndata;
-    double horangle, altangle;
     //point.celestialAZ = (range24(point.aligndata.lst - point.aligndata.targetRA - 12.0) * 360.0) / 24.0;
     //point.telescopeAZ = (range24(point.aligndata.lst - point.aligndata.telescopeRA - 12.0) * 360.0) / 24.0;
     //point.celestialALT = point.aligndata.targetDEC + lat;
@@ -197,21 +185,17 @@ void PointSet::AddPoint(AlignData aligndata, struct ln_lnlat_posn *pos)
         AltAzFromRaDecSidereal(point.aligndata.telescopeRA, point.aligndata.telescopeDEC, point.aligndata.lst,
                                &point.telescopeALT, &point.telescopeAZ, pos);
     }
-    horangle    = range360(-180.0 - point.celestialAZ) * M_PI / 180.0;
-    altangle    = point.celestialALT * M_PI / 180.0;
-    point.cx    = cos(altangle) * cos(horangle);
-    point.cy    = cos(altangle) * sin(horangle);
-    point.cz    = sin(altangle);
-    horangle    = range360(-180.0 - point.telescopeAZ) * M_PI / 180.0;
-    altangle    = point.telescopeALT * M_PI / 180.0;
-    point.tx    = cos(altangle) * cos(horangle);
-    point.ty    = cos(altangle) * sin(horangle);
-    point.tz    = sin(altangle);
+    unitVector(point.celestialALT, point.celestialAZ, &point.cx, &point.cy, &point.cz);
+    unitVector(point.telescopeALT, point.telescopeAZ, &point.tx, &point.ty, &point.tz);
     point.htmID = cc_radec2ID(point.celestialAZ, point.celestialALT, 19);
     cc_ID2name(point.htmname, point.htmID);
     point.index = getNbPoints();
     //IDLog("Adding sync point index = %d htm id = %lld htm name = %s\n ", point.index, point.htmID, point.htmname);
-    PointSetMap->insert(std::pair<HtmID, Point>(point.htmID, point));
+    if (PointSetMap->insert(std::pair<HtmID, Point>(point.htmID, point)).second)
+    {
+        celestialIndex.AddPoint(point.htmID, point.cx, point.cy, point.cz);
+        telescopeIndex.AddPoint(point.htmID, point.tx, point.ty, point.tz);
+    }
     //IDLog("       sync point celestial alt = %g az = %g\n ", point.celestialALT, point.celestialAZ);
     //IDLog("       sync point telescope alt = %g az = %g\n ", point.telescopeALT, point.telescopeAZ);
     // compute new Delaunay triangulation of the points on the unit sphere
@@ -259,11 +243,14 @@ void PointSet::Init()
 void PointSet::Reset()
 {
     current.clear();
+    currentFace = -1;
     if (PointSetMap)
     {
         PointSetMap->clear();
         //delete(PointSetMap);
     }
+    celestialIndex.Reset();
+    telescopeIndex.Reset();
     //PointSetMap=nullptr;
     if (PointSetXmlRoot)
         delXMLEle(PointSetXmlRoot);
@@ -339,6 +326,8 @@ char *PointSet::LoadDataFile(const char *filename)
     lnalignpos->lng = lon;
     lnalignpos->lat = lat;
     PointSetMap->clear();
+    celestialIndex.Reset();
+    telescopeIndex.Reset();
     alignxml     = nextXMLEle(sitexml, 1);
     aligndata.jd = -1.0;
     while (alignxml)
@@ -542,9 +531,8 @@ std::vector<HtmID> PointSet::findFace(double currentRA, double currentDEC, doubl
     INDI_UNUSED(pointalt);
     INDI_UNUSED(pointaz);
     Point point;
-    double horangle = 0, altangle = 0;
-    std::vector<Face *> faces;
-    std::vector<Face *>::iterator it;
+    double p[3];
+    int start = -1, face;
 
     point.aligndata.jd        = jd;
     point.aligndata.targetRA  = currentRA;
@@ -552,28 +540,31 @@ std::vector<HtmID> PointSet::findFace(double currentRA, double currentDEC, doubl
     AltAzFromRaDec(point.aligndata.targetRA, point.aligndata.targetDEC, point.aligndata.jd, &point.celestialALT,
                    &point.celestialAZ, position);
 
-    horangle = range360(-180.0 - point.celestialAZ) * M_PI / 180.0;
-    altangle = point.celestialALT * M_PI / 180.0;
-    point.cx = cos(altangle) * cos(horangle);
-    point.cy = cos(altangle) * sin(horangle);
-    point.cz = sin(altangle);
+    unitVector(point.celestialALT, point.celestialAZ, &p[0], &p[1], &p[2]);
 
-    if (Triangulation->isValid() && isPointInside(&point, current, ingoto))
-        return current;
-    faces = Triangulation->getFaces();
-    it    = faces.begin();
-    while (it < faces.end())
+    // While tracking the point stays in or near the current face, after a new sync start from the nearest vertex
+    if (currentFace >= 0 && currentRevision == Triangulation->getRevision())
+        start = currentFace;
+    else
+    {
+        std::vector<Distance> nearest = ComputeDistances(point.celestialALT, point.celestialAZ, None, ingoto, 1);
+        if (!nearest.empty())
+            start = Triangulation->getVertexFace(nearest.front().htmID);
+    }
+    face = Triangulation->locate(p, ingoto, start);
+    if (face >= 0)
     {
-        if (isPointInside(&point, (*it)->v, ingoto))
+        if (face != currentFace || currentRevision != Triangulation->getRevision())
         {
-            currentFace = *it;
-            current     = (*it)->v;
+            currentFace     = face;
+            currentRevision = Triangulation->getRevision();
+            current         = Triangulation->getFace(face)->v;
             LOGF_INFO("Align: current face is {%d, %d, %d}", PointSetMap->at(current[0]).index,
                    PointSetMap->at(current[1]).index, PointSetMap->at(current[2]).index);
-            return current;
         }
-        it++;
+        return current;
     }
+    currentFace = -1;
     if (current.size() > 0)
         LOG_INFO("Align: current face is empty");
     current.clear();
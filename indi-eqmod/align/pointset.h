@@ -18,6 +18,7 @@
 #pragma once
 
 #include "htm.h"
+#include "pointindex.h"
 
 #include <map>
 #include <set>
@@ -72,8 +73,9 @@ class PointSet
     void setBlobData(IBLOBVectorProperty *bp);
     void setPointBlobData(IBLOB *blob);
     void setTriangulationBlobData(IBLOB *blob);
-    std::set<Distance, bool (*)(Distance, Distance)> *ComputeDistances(double alt, double az, PointFilter filter,
-                                                                       bool ingoto);
+    /* The k nearest sync points sorted by distance (all points when k is 0),
+       in celestial coordinates when ingoto, telescope coordinates otherwise */
+    std::vector<Distance> ComputeDistances(double alt, double az, PointFilter filter, bool ingoto, size_t k = 0);
     std::vector<HtmID> findFace(double currentRA, double currentDEC, double jd, double pointalt, double pointaz,
                                 ln_lnlat_posn *position, bool ingoto);
     double lat, lon, alt;
@@ -83,6 +85,7 @@ class PointSet
     void AltAzFromRaDec(double ra, double dec, double jd, double *alt, double *az, struct ln_lnlat_posn *pos);
     void AltAzFromRaDecSidereal(double ra, double dec, double lst, double *alt, double *az, struct ln_lnlat_posn *pos);
     void RaDecFromAltAz(double alt, double az, double jd, double *ra, double *dec, struct ln_lnlat_posn *pos);
+    void unitVector(double alt, double az, double *x, double *y, double *z);
     double scalarTripleProduct(Point *p, Point *e1, Point *e2, bool ingoto);
     bool isPointInside(Point *p, std::vector<HtmID> f, bool ingoto);
 
@@ -90,9 +93,14 @@ class PointSet
   private:
     XMLEle *PointSetXmlRoot;
     std::map<HtmID, Point> *PointSetMap;
+    // nearest point queries, kept in step with PointSetMap
+    PointIndex celestialIndex;
+    PointIndex telescopeIndex;
     bool PointSetInitialized;
     TriangulateCHull *Triangulation;
-    Face *currentFace;
+    // index of the current face in the triangulation revision it was found in
+    int currentFace;
+    unsigned int currentRevision;
     std::vector<HtmID> current;
     // to get access to lat/long data
     INDI::Telescope *telescope;
@@ -26,7 +26,18 @@ void Triangulate::Reset()
 {
     isvalid = false;
     vvertices.clear();
+    clearFaces();
+}
+
+void Triangulate::clearFaces()
+{
+    std::vector<Face *>::iterator it;
+    for (it = vfaces.begin(); it != vfaces.end(); it++)
+        delete *it;
     vfaces.clear();
+    vertexface.clear();
+    locatorvalid = false;
+    revision++;
 }
 
 void Triangulate::AddPoint(HtmID id)
@@ -72,3 +83,131 @@ bool Triangulate::isValid()
 {
     return isvalid;
 }
+
+Face *Triangulate::getFace(int index)
+{
+    return vfaces.at(index);
+}
+
+int Triangulate::getVertexFace(HtmID id)
+{
+    if (!locatorvalid)
+        buildLocator();
+    std::unordered_map<HtmID, int>::iterator it = vertexface.find(id);
+    return (it == vertexface.end()) ? -1 : it->second;
+}
+
+unsigned int Triangulate::getRevision()
+{
+    return revision;
+}
+
+static void cross(const double a[3], const double b[3], double n[3])
+{
+    n[0] = a[1] * b[2] - a[2] * b[1];
+    n[1] = a[2] * b[0] - a[0] * b[2];
+    n[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static double dot(const double a[3], const double b[3])
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/* Compute edge normals and face adjacencies of the current faces */
+void Triangulate::buildLocator()
+{
+    // directed edge (v[k], v[k+1]) of a face, vertices numbered in vvertices order
+    std::unordered_map<HtmID, int> vertexnum;
+    std::unordered_map<unsigned long long, int> edgeface;
+    unsigned long long nb = vvertices.size();
+    consistent[0] = consistent[1] = true;
+    vertexface.clear();
+    vertexnum.reserve(nb);
+    for (size_t i = 0; i < vvertices.size(); i++)
+        vertexnum[vvertices[i]] = i;
+    edgeface.reserve(3 * vfaces.size());
+    for (size_t i = 0; i < vfaces.size(); i++)
+    {
+        Face *f = vfaces[i];
+        for (int k = 0; k < 3; k++)
+        {
+            edgeface[vertexnum[f->v[k]] * nb + vertexnum[f->v[(k + 1) % 3]]] = i;
+            vertexface[f->v[k]] = i;
+        }
+        for (int frame = 0; frame < 2; frame++)
+        {
+            double p[3][3];
+            for (int k = 0; k < 3; k++)
+            {
+                PointSet::Point &point = pmap->at(f->v[k]);
+                p[k][0]                = frame ? point.tx : point.cx;
+                p[k][1]                = frame ? point.ty : point.cy;
+                p[k][2]                = frame ? point.tz : point.cz;
+            }
+            for (int k = 0; k < 3; k++)
+                cross(p[k], p[(k + 1) % 3], f->normal[frame][k]);
+            f->ccw[frame] = dot(p[0], f->normal[frame][1]) >= 0;
+            if (f->ccw[frame] != vfaces[0]->ccw[frame])
+                consistent[frame] = false;
+        }
+    }
+    for (size_t i = 0; i < vfaces.size(); i++)
+    {
+        Face *f = vfaces[i];
+        for (int k = 0; k < 3; k++)
+        {
+            std::unordered_map<unsigned long long, int>::iterator it =
+                edgeface.find(vertexnum[f->v[(k + 1) % 3]] * nb + vertexnum[f->v[k]]);
+            f->adj[k] = (it == edgeface.end()) ? -1 : it->second;
+        }
+    }
+    locatorvalid = true;
+}
+
+int Face::exitEdge(const double p[3], int frame) const
+{
+    bool left = false, right = false;
+    int exit  = -1;
+    for (int k = 0; k < 3; k++)
+    {
+        bool negative = dot(p, normal[frame][k]) < 0;
+        if (negative)
+            left = true;
+        else
+            right = true;
+        if (exit < 0 && negative == ccw[frame])
+            exit = k;
+    }
+    return (left && right) ? exit : -1;
+}
+
+int Triangulate::locate(const double p[3], bool ingoto, int start)
+{
+    if (!locatorvalid)
+        buildLocator();
+    int frame = ingoto ? 0 : 1;
+    int nb    = vfaces.size();
+    int f     = (start >= 0 && start < nb) ? start : 0;
+    if (nb == 0)
+        return -1;
+    for (int steps = 0; steps < nb; steps++)
+    {
+        int k = vfaces[f]->exitEdge(p, frame);
+        if (k < 0)
+            return f;
+        if (vfaces[f]->adj[k] < 0)
+        {
+            // the faces of the hull cover a convex region when all are oriented the same way
+            if (consistent[frame])
+                return -1;
+            break;
+        }
+        f = vfaces[f]->adj[k];
+    }
+    // folded triangulation in the telescope frame: test every face
+    for (f = 0; f < nb; f++)
+        if (vfaces[f]->exitEdge(p, frame) < 0)
+            return f;
+    return -1;
+}
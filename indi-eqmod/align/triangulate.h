@@ -19,6 +19,8 @@
 
 #include "pointset.h"
 
+#include <unordered_map>
+
 class Face
 {
   public:
@@ -27,8 +29,17 @@ class Face
         v[0] = v0;
         v[1] = v1;
         v[2] = v2;
+        adj[0] = adj[1] = adj[2] = -1;
     }
+    /* Edge of the face to cross to get nearer to point p, -1 when p is inside the face.
+       Same inside test as PointSet::isPointInside. frame is 0 for celestial, 1 for telescope coordinates */
+    int exitEdge(const double p[3], int frame) const;
     std::vector<HtmID> v;
+    // face across edge v[k] v[k+1], -1 on the border of the triangulation
+    int adj[3];
+    // normals v[k] x v[k+1] of the edges and orientation of the face, in both frames
+    double normal[2][3][3];
+    bool ccw[2];
 };
 
 class Triangulate
@@ -43,10 +54,25 @@ class Triangulate
     virtual XMLEle *toXML();
     virtual std::vector<Face *> getFaces();
     virtual bool isValid();
+    /* Index of the face containing the unit vector p, -1 if none.
+       Walks from face start over the face adjacencies, so a start near p makes this near O(1) */
+    int locate(const double p[3], bool ingoto, int start);
+    Face *getFace(int index);
+    /* A face having vertex id, -1 if none */
+    int getVertexFace(HtmID id);
+    /* Changed each time the faces are rebuilt, face indexes are only valid for one revision */
+    unsigned int getRevision();
 
   protected:
+    void buildLocator();
+    void clearFaces();
     std::map<HtmID, PointSet::Point> *pmap;
     std::vector<HtmID> vvertices;
     std::vector<Face *> vfaces;
+    std::unordered_map<HtmID, int> vertexface;
+    // the locator is built on the first lookup after the faces changed, not for each point of a loaded model
+    bool locatorvalid {false};
+    bool consistent[2] {true, true};
+    unsigned int revision {0};
     bool isvalid {false};
 };
@@ -79,7 +79,7 @@ void TriangulateCHull::AddPoint(HtmID id)
         AddOne(v);
         CleanUp(&vnext);
     }
-    vfaces.clear();
+    clearFaces();
     f = faces;
     do
     {
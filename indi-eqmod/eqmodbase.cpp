@@ -867,8 +867,12 @@ bool EQMod::ReadScopeStatus()
     try
     {
         TelescopePierSide pierSide;
-        currentRAEncoder = mount->GetRAEncoder();
-        currentDEEncoder = mount->GetDEEncoder();
+        uint32_t auxencoders[2] = { 0, 0 };
+        // Encoders, motor status and aux encoders in a single batch
+        if (mount->HasAuxEncoders())
+            mount->ReadAxesStatus(&currentRAEncoder, &currentDEEncoder, &auxencoders[0], &auxencoders[1]);
+        else
+            mount->ReadAxesStatus(&currentRAEncoder, &currentDEEncoder);
         DEBUGF(DBG_SCOPE_STATUS, "Current encoders RA=%ld DE=%ld", static_cast<long>(currentRAEncoder),
                static_cast<long>(currentDEEncoder));
         EncodersToRADec(currentRAEncoder, currentDEEncoder, lst, &currentRA, &currentDEC, &currentHA, &pierSide);
@@ -968,8 +972,8 @@ bool EQMod::ReadScopeStatus()
         IUUpdateNumber(CurrentSteppersNP, steppervalues, (char **)steppernames, 2);
         IDSetNumber(CurrentSteppersNP, nullptr);
 
-        mount->GetRAMotorStatus(RAStatusLP);
-        mount->GetDEMotorStatus(DEStatusLP);
+        mount->GetRAMotorStatus(RAStatusLP, false);
+        mount->GetDEMotorStatus(DEStatusLP, false);
         IDSetLight(RAStatusLP, nullptr);
         IDSetLight(DEStatusLP, nullptr);
 
@@ -982,8 +986,8 @@ bool EQMod::ReadScopeStatus()
         {
             double auxencodervalues[2];
             const char *auxencodernames[] = { "AUXENCRASteps", "AUXENCDESteps" };
-            auxencodervalues[0]           = mount->GetRAAuxEncoder();
-            auxencodervalues[1]           = mount->GetDEAuxEncoder();
+            auxencodervalues[0]           = auxencoders[0];
+            auxencodervalues[1]           = auxencoders[1];
             IUUpdateNumber(AuxEncoderNP, auxencodervalues, (char **)auxencodernames, 2);
             IDSetNumber(AuxEncoderNP, nullptr);
         }
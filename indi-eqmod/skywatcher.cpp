@@ -28,7 +28,6 @@
 Skywatcher::Skywatcher(EQMod *t)
 {
     debug         = false;
-    debugnextread = false;
     simulation    = false;
     telescope     = t;
     reconnect     = false;
@@ -74,7 +73,17 @@ bool Skywatcher::Handshake()
     if (isSimulation())
     {
         telescope->simulator->Connect();
+        channel.Open(new SkywatcherChannel::LoopbackTransport(
+                         [this](const char *cmd, int *received) { telescope->simulator->receive_cmd(cmd, received); },
+                         [this](char *buf, int *sent) { telescope->simulator->send_reply(buf, sent); }),
+                     EQMOD_TIMEOUT);
     }
+    else
+    {
+        channel.Open(new SkywatcherChannel::TTYTransport(PortFD), EQMOD_TIMEOUT);
+    }
+    channel.ResetLatencies();
+    batches = 0;
 
     uint32_t tmpMCVersion = 0;
 
@@ -96,10 +105,16 @@ bool Skywatcher::Handshake()
 
 bool Skywatcher::Disconnect()
 {
-    if (PortFD < 0)
+    if (PortFD < 0 || !channel.IsOpen())
+    {
+        channel.Close();
         return true;
+    }
     StopMotor(Axis1);
     StopMotor(Axis2);
+    if (telescope->isDebug())
+        ReportLatencies();
+    channel.Close();
     // Deactivate motor (for geehalel mount only)
     /*
     if (MountCode == 0xF0) {
@@ -141,6 +156,47 @@ uint32_t Skywatcher::GetDEEncoder()
     return DEStep;
 }
 
+void Skywatcher::ReadAxesStatus(uint32_t *raencoder, uint32_t *deencoder, uint32_t *raauxencoder,
+                                uint32_t *deauxencoder)
+{
+    SkywatcherChannel::Request requests[6];
+    int count = 4;
+
+    format_command(&requests[0], GetAxisPosition, Axis1, nullptr);
+    format_command(&requests[1], GetAxisPosition, Axis2, nullptr);
+    format_command(&requests[2], GetAxisStatus, Axis1, nullptr);
+    format_command(&requests[3], GetAxisStatus, Axis2, nullptr);
+    if (raauxencoder && deauxencoder)
+    {
+        format_command(&requests[4], InquireAuxEncoder, Axis1, nullptr);
+        format_command(&requests[5], InquireAuxEncoder, Axis2, nullptr);
+        count = 6;
+    }
+    dispatch_commands(requests, count);
+
+    RAStep = Revu24str2long(requests[0].response + 1);
+    DEStep = Revu24str2long(requests[1].response + 1);
+    gettimeofday(&lastreadmotorposition[Axis1], nullptr);
+    lastreadmotorposition[Axis2] = lastreadmotorposition[Axis1];
+    if (RAStep != lastRAStep || DEStep != lastDEStep)
+    {
+        DEBUGF(telescope->DBG_SCOPE_STATUS, "%s() = %ld %ld", __FUNCTION__, static_cast<long>(RAStep),
+               static_cast<long>(DEStep));
+        lastRAStep = RAStep;
+        lastDEStep = DEStep;
+    }
+    SetMotorStatus(Axis1, requests[2].response);
+    SetMotorStatus(Axis2, requests[3].response);
+    if (count == 6)
+    {
+        *raauxencoder = Revu24str2long(requests[4].response + 1);
+        *deauxencoder = Revu24str2long(requests[5].response + 1);
+    }
+
+    *raencoder = RAStep;
+    *deencoder = DEStep;
+}
+
 uint32_t Skywatcher::GetRAEncoderZero()
 {
     LOGF_DEBUG("%s() = %ld", __FUNCTION__, static_cast<long>(RAStepInit));
@@ -213,9 +269,10 @@ uint32_t Skywatcher::GetlastreadDEIndexer()
     return lastreadIndexer[Axis2];
 }
 
-void Skywatcher::GetRAMotorStatus(ILightVectorProperty *motorLP)
+void Skywatcher::GetRAMotorStatus(ILightVectorProperty *motorLP, bool read)
 {
-    ReadMotorStatus(Axis1);
+    if (read)
+        ReadMotorStatus(Axis1);
     if (!RAInitialized)
     {
         IUFindLight(motorLP, "RAInitialized")->s = IPS_ALERT;
@@ -234,9 +291,10 @@ void Skywatcher::GetRAMotorStatus(ILightVectorProperty *motorLP)
     }
 }
 
-void Skywatcher::GetDEMotorStatus(ILightVectorProperty *motorLP)
+void Skywatcher::GetDEMotorStatus(ILightVectorProperty *motorLP, bool read)
 {
-    ReadMotorStatus(Axis2);
+    if (read)
+        ReadMotorStatus(Axis2);
     if (!DEInitialized)
     {
         IUFindLight(motorLP, "DEInitialized")->s = IPS_ALERT;
@@ -692,36 +750,41 @@ void Skywatcher::ReadMotorStatus(SkywatcherAxis axis)
 {
     dispatch_command(GetAxisStatus, axis, nullptr);
     //read_eqmod();
+    SetMotorStatus(axis, response);
+}
+
+void Skywatcher::SetMotorStatus(SkywatcherAxis axis, const char *status)
+{
     switch (axis)
     {
         case Axis1:
-            RAInitialized = (response[3] & 0x01);
-            RARunning     = (response[2] & 0x01);
-            if (response[1] & 0x01)
+            RAInitialized = (status[3] & 0x01);
+            RARunning     = (status[2] & 0x01);
+            if (status[1] & 0x01)
                 RAStatus.slewmode = SLEW;
             else
                 RAStatus.slewmode = GOTO;
-            if (response[1] & 0x02)
+            if (status[1] & 0x02)
                 RAStatus.direction = BACKWARD;
             else
                 RAStatus.direction = FORWARD;
-            if (response[1] & 0x04)
+            if (status[1] & 0x04)
                 RAStatus.speedmode = HIGHSPEED;
             else
                 RAStatus.speedmode = LOWSPEED;
             break;
         case Axis2:
-            DEInitialized = (response[3] & 0x01);
-            DERunning     = (response[2] & 0x01);
-            if (response[1] & 0x01)
+            DEInitialized = (status[3] & 0x01);
+            DERunning     = (status[2] & 0x01);
+            if (status[1] & 0x01)
                 DEStatus.slewmode = SLEW;
             else
                 DEStatus.slewmode = GOTO;
-            if (response[1] & 0x02)
+            if (status[1] & 0x02)
                 DEStatus.direction = BACKWARD;
             else
                 DEStatus.direction = FORWARD;
-            if (response[1] & 0x04)
+            if (status[1] & 0x04)
                 DEStatus.speedmode = HIGHSPEED;
             else
                 DEStatus.speedmode = LOWSPEED;
@@ -1683,114 +1746,141 @@ double Skywatcher::get_max_rate()
     return MAX_RATE;
 }
 
+void Skywatcher::format_command(SkywatcherChannel::Request *request, SkywatcherCommand cmd, SkywatcherAxis axis,
+                                const char *command_arg)
+{
+    if (command_arg == nullptr)
+        snprintf(request->command, SKYWATCHER_CHANNEL_MAX_MSG, "%c%c%c%c", SkywatcherLeadingChar, cmd, AxisCmd[axis],
+                 SkywatcherTrailingChar);
+    else
+        snprintf(request->command, SKYWATCHER_CHANNEL_MAX_MSG, "%c%c%c%s%c", SkywatcherLeadingChar, cmd, AxisCmd[axis],
+                 command_arg, SkywatcherTrailingChar);
+    request->answered = false;
+}
+
 bool Skywatcher::dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, char *command_arg)
 {
+    SkywatcherChannel::Request request;
+
+    format_command(&request, cmd, axis, command_arg);
+    dispatch_commands(&request, 1);
+    strncpy(response, request.response, SKYWATCHER_MAX_CMD);
+    return true;
+}
+
+/*
+ Send a batch of independent commands, their replies are pipelined by the channel.
+ Only the commands which failed are sent again, up to EQMOD_MAX_RETRY times for the whole batch.
+*/
+bool Skywatcher::dispatch_commands(SkywatcherChannel::Request *requests, int count)
+{
+    char command[SKYWATCHER_CHANNEL_MAX_MSG];
+    char ttyerrormsg[ERROR_MSG_LENGTH];
+
     for (uint8_t i = 0; i < EQMOD_MAX_RETRY; i++)
     {
-        // Clear string
-        command[0] = '\0';
+        bool retry = false, writefailed = false;
 
-        if (command_arg == nullptr)
-            snprintf(command, SKYWATCHER_MAX_CMD, "%c%c%c%c", SkywatcherLeadingChar, cmd, AxisCmd[axis], SkywatcherTrailingChar);
-        else
-            snprintf(command, SKYWATCHER_MAX_CMD, "%c%c%c%s%c", SkywatcherLeadingChar, cmd, AxisCmd[axis], command_arg,
-                     SkywatcherTrailingChar);
+        channel.Transact(requests, count);
 
-        int nbytes_written = 0;
-        if (!isSimulation())
+        for (int j = 0; j < count; j++)
         {
-            int err_code = 0;
-            tcflush(PortFD, TCIOFLUSH);
+            SkywatcherChannel::Request *request = &requests[j];
+            bool lasttry                        = (i == EQMOD_MAX_RETRY - 1);
+
+            if (request->answered)
+                continue;
 
-            if ((err_code = tty_write_string(PortFD, command, &nbytes_written)) != TTY_OK)
+            // Remove \r, the SkywatcherTrailingChar
+            strncpy(command, request->command, SKYWATCHER_CHANNEL_MAX_MSG);
+            command[strlen(command) - 1] = '\0';
+
+            if (request->write_error != TTY_OK)
             {
-                if (i == EQMOD_MAX_RETRY - 1)
+                if (lasttry)
                 {
-                    char ttyerrormsg[ERROR_MSG_LENGTH];
-                    tty_error_msg(err_code, ttyerrormsg, ERROR_MSG_LENGTH);
+                    tty_error_msg(request->write_error, ttyerrormsg, ERROR_MSG_LENGTH);
                     throw EQModError(EQModError::ErrDisconnect, "tty write failed, check connection: %s", ttyerrormsg);
                 }
-                else
+                retry = writefailed = true;
+                continue;
+            }
+            if (request->read_error == TTY_OK && request->nbytes_read == 0)
+            {
+                // Not sent after an earlier failure in the batch
+                retry = true;
+                continue;
+            }
+
+            DEBUGF(telescope->DBG_COMM, "dispatch_command: \"%s\", %d bytes written", command, request->nbytes_written);
+
+            if (request->read_error != TTY_OK)
+            {
+                // JM 2018-05-07 immediately rethrow if GET_FEATURES_CMD
+                if (lasttry || command[1] == GetFeatureCmd)
                 {
-                    struct timespec wait;
-                    wait.tv_sec  = 0;
-                    wait.tv_nsec = 100000000; // 100ms
-                    nanosleep(nullptr, &wait);
-                    continue;
+                    tty_error_msg(request->read_error, ttyerrormsg, ERROR_MSG_LENGTH);
+                    throw EQModError(EQModError::ErrDisconnect, "tty read failed, check connection: %s", ttyerrormsg);
                 }
+                DEBUG(telescope->DBG_COMM, "read error, will retry again...");
+                retry = true;
+                continue;
             }
-        }
-        else
-        {
-            telescope->simulator->receive_cmd(command, &nbytes_written);
-        }
 
-        //if (INDI::Logger::debugSerial(cmd)) {
-        command[nbytes_written - 1] = '\0'; //hmmm, remove \r, the  SkywatcherTrailingChar
-        DEBUGF(telescope->DBG_COMM, "dispatch_command: \"%s\", %d bytes written", command, nbytes_written);
-        debugnextread = true;
+            // Remove CR
+            request->response[request->nbytes_read - 1] = '\0';
+            DEBUGF(telescope->DBG_COMM, "read_eqmod: \"%s\", %d bytes read", request->response, request->nbytes_read);
 
-        try
-        {
-            if (read_eqmod())
-                return true;
+            switch (request->response[0])
+            {
+                case '=':
+                    request->answered = true;
+                    break;
+                default:
+                    if (lasttry || command[1] == GetFeatureCmd)
+                    {
+                        if (request->response[0] == '!')
+                            throw EQModError(EQModError::ErrCmdFailed, "Failed command %s - Reply %s", command,
+                                             request->response);
+                        throw EQModError(EQModError::ErrInvalidCmd, "Invalid response to command %s - Reply %s", command,
+                                         request->response);
+                    }
+                    DEBUG(telescope->DBG_COMM, "read error, will retry again...");
+                    retry = true;
+                    break;
+            }
         }
-        catch (EQModError)
+
+        if (telescope->isDebug() && ++batches % SKYWATCHER_LATENCY_REPORT == 0)
+            ReportLatencies();
+
+        if (!retry)
+            return true;
+
+        if (writefailed)
         {
-            // By this time, we just rethrow the error
-            // JM 2018-05-07 immediately rethrow if GET_FEATURES_CMD
-            if (i == EQMOD_MAX_RETRY - 1 || cmd == GetFeatureCmd)
-                throw;
+            struct timespec wait;
+            wait.tv_sec  = 0;
+            wait.tv_nsec = 100000000; // 100ms
+            nanosleep(&wait, nullptr);
         }
-
-        DEBUG(telescope->DBG_COMM, "read error, will retry again...");
     }
 
     return true;
 }
 
-bool Skywatcher::read_eqmod()
+void Skywatcher::ReportLatencies()
 {
-    int err_code = 0, nbytes_read = 0;
+    char buf[256];
+    SkywatcherChannel::Latency latency;
 
-    // Clear string
-    response[0] = '\0';
-    if (!isSimulation())
-    {
-        //Have to onsider cases when we read ! (error) or 0x01 (buffer overflow)
-        // Read until encountring a CR
-        //if ((err_code = tty_read_section(PortFD, response, 0x0D, 15, &nbytes_read)) != TTY_OK)
-        if ((err_code = tty_read_section(PortFD, response, 0x0D, EQMOD_TIMEOUT, &nbytes_read)) != TTY_OK)
-        {
-            char ttyerrormsg[ERROR_MSG_LENGTH];
-            tty_error_msg(err_code, ttyerrormsg, ERROR_MSG_LENGTH);
-            throw EQModError(EQModError::ErrDisconnect, "tty read failed, check connection: %s", ttyerrormsg);
-            //return false;
-        }
-    }
-    else
+    for (char cmd = ' '; cmd < 0x7F; cmd++)
     {
-        telescope->simulator->send_reply(response, &nbytes_read);
+        if (!channel.GetLatency(cmd, &latency))
+            continue;
+        channel.FormatLatency(cmd, buf, sizeof(buf));
+        DEBUGF(telescope->DBG_COMM, "Command latency %s", buf);
     }
-    // Remove CR
-    response[nbytes_read - 1] = '\0';
-
-    if (debugnextread)
-    {
-        DEBUGF(telescope->DBG_COMM, "read_eqmod: \"%s\", %d bytes read", response, nbytes_read);
-        debugnextread = false;
-    }
-    switch (response[0])
-    {
-        case '=':
-            break;
-        case '!':
-            throw EQModError(EQModError::ErrCmdFailed, "Failed command %s - Reply %s", command, response);
-        default:
-            throw EQModError(EQModError::ErrInvalidCmd, "Invalid response to command %s - Reply %s", command, response);
-    }
-
-    return true;
 }
 
 uint32_t Skywatcher::Revu24str2long(char *s)
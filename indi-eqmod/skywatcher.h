@@ -18,6 +18,7 @@
 #pragma once
 
 #include "eqmoderror.h"
+#include "skywatcherchannel.h"
 
 #include <inditelescope.h>
 
@@ -33,6 +34,8 @@ class EQMod; // TODO
 #define SKYWATCHER_MAX_CMD      16
 #define SKYWATCHER_MAX_TRIES    3
 #define SKYWATCHER_ERROR_BUFFER 1024
+/* Command batches between two latency reports in debug mode */
+#define SKYWATCHER_LATENCY_REPORT 500
 
 #define SKYWATCHER_SIDEREAL_DAY   86164.09053083288
 #define SKYWATCHER_SIDEREAL_SPEED 15.04106864
@@ -75,8 +78,12 @@ class Skywatcher
         uint32_t GetDEEncoderHome();
         uint32_t GetRAPeriod();
         uint32_t GetDEPeriod();
-        void GetRAMotorStatus(ILightVectorProperty *motorLP);
-        void GetDEMotorStatus(ILightVectorProperty *motorLP);
+        // Both axes positions and motor status (and aux encoders if asked) in one pipelined batch
+        void ReadAxesStatus(uint32_t *raencoder, uint32_t *deencoder, uint32_t *raauxencoder = nullptr,
+                            uint32_t *deauxencoder = nullptr);
+        // Set read to false to show the status of the last ReadAxesStatus()
+        void GetRAMotorStatus(ILightVectorProperty *motorLP, bool read = true);
+        void GetDEMotorStatus(ILightVectorProperty *motorLP, bool read = true);
         void InquireBoardVersion(ITextVectorProperty *boardTP);
         void InquireFeatures();
         void InquireRAEncoderInfo(INumberVectorProperty *encoderNP);
@@ -252,6 +259,7 @@ class Skywatcher
         // Functions
         void CheckMotorStatus(SkywatcherAxis axis);
         void ReadMotorStatus(SkywatcherAxis axis);
+        void SetMotorStatus(SkywatcherAxis axis, const char *status);
         void SetMotion(SkywatcherAxis axis, SkywatcherAxisStatus newstatus);
         void SetSpeed(SkywatcherAxis axis, uint32_t period);
         void SetTarget(SkywatcherAxis axis, uint32_t increment);
@@ -275,8 +283,11 @@ class Skywatcher
         void GetPPECStatus(SkywatcherAxis axis, bool *intraining, bool *inppec);
         void TurnSnapPort(SkywatcherAxis axis, bool on);
 
-        bool read_eqmod();
+        void format_command(SkywatcherChannel::Request *request, SkywatcherCommand cmd, SkywatcherAxis axis,
+                            const char *arg);
+        bool dispatch_commands(SkywatcherChannel::Request *requests, int count);
         bool dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, char *arg);
+        void ReportLatencies();
 
         uint32_t Revu24str2long(char *);
         uint32_t Highstr2long(char *);
@@ -321,11 +332,12 @@ class Skywatcher
         SkyWatcherFeatures AxisFeatures[NUMBER_OF_SKYWATCHERAXIS];
 
         int PortFD = -1;
-        char command[SKYWATCHER_MAX_CMD];
+        SkywatcherChannel channel;
+        uint32_t batches {0};
+        // Reply of the last dispatch_command()
         char response[SKYWATCHER_MAX_CMD];
 
         bool debug;
-        bool debugnextread;
         EQMod *telescope;
         bool reconnect;
 
@@ -0,0 +1,252 @@
+/* Copyright 2012 Geehalel (geehalel AT gmail DOT com) */
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "skywatcherchannel.h"
+
+#include <indicom.h>
+
+#include <termios.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+/* Transports */
+
+int SkywatcherChannel::TTYTransport::Write(const char *cmd, int *nbytes_written)
+{
+    return tty_write_string(fd, cmd, nbytes_written);
+}
+
+int SkywatcherChannel::TTYTransport::Read(char *buf, int size, int timeout, int *nbytes_read)
+{
+    return tty_nread_section(fd, buf, size, 0x0D, timeout, nbytes_read);
+}
+
+void SkywatcherChannel::TTYTransport::Flush()
+{
+    tcflush(fd, TCIOFLUSH);
+}
+
+int SkywatcherChannel::LoopbackTransport::Write(const char *cmd, int *nbytes_written)
+{
+    char buf[64];
+    int received = 0, len = 0;
+
+    receive(cmd, &received);
+    reply(buf, &len);
+    *nbytes_written = strlen(cmd);
+
+    // No reply is a timeout for the reader
+    std::lock_guard<std::mutex> guard(mutex);
+    if (len > 0)
+        replies.push_back(std::string(buf, len));
+    return TTY_OK;
+}
+
+int SkywatcherChannel::LoopbackTransport::Read(char *buf, int size, int timeout, int *nbytes_read)
+{
+    (void)timeout;
+    std::lock_guard<std::mutex> guard(mutex);
+    *nbytes_read = 0;
+    if (replies.empty())
+        return TTY_TIME_OUT;
+    *nbytes_read = std::min(static_cast<int>(replies.front().size()), size);
+    memcpy(buf, replies.front().data(), *nbytes_read);
+    replies.pop_front();
+    return TTY_OK;
+}
+
+void SkywatcherChannel::LoopbackTransport::Flush()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    replies.clear();
+}
+
+/* Channel */
+
+SkywatcherChannel::SkywatcherChannel()
+{
+    ResetLatencies();
+}
+
+SkywatcherChannel::~SkywatcherChannel()
+{
+    Close();
+}
+
+void SkywatcherChannel::Open(Transport *t, int seconds)
+{
+    Close();
+    transport = t;
+    timeout   = seconds;
+    stop      = false;
+    aborted   = false;
+    reader    = std::thread(&SkywatcherChannel::Reader, this);
+}
+
+void SkywatcherChannel::Close()
+{
+    std::lock_guard<std::mutex> serial(batch);
+    if (transport == nullptr)
+        return;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stop = true;
+    }
+    written.notify_all();
+    reader.join();
+    delete transport;
+    transport = nullptr;
+}
+
+bool SkywatcherChannel::IsOpen()
+{
+    return transport != nullptr;
+}
+
+void SkywatcherChannel::Transact(Request *requests, int count)
+{
+    std::lock_guard<std::mutex> serial(batch);
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Nothing in flight: drop stale bytes, a late reply would shift every reply of the batch
+    if (transport != nullptr)
+        transport->Flush();
+    aborted = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        Request *request = &requests[i];
+        if (request->answered)
+            continue;
+        request->nbytes_written = 0;
+        request->nbytes_read    = 0;
+        request->write_error    = TTY_OK;
+        request->read_error     = TTY_OK;
+        request->response[0]    = '\0';
+        if (transport == nullptr)
+        {
+            request->write_error = TTY_PORT_FAILURE;
+            continue;
+        }
+
+        replied.wait(lock, [this] { return aborted || inflight.size() < SKYWATCHER_CHANNEL_DEPTH; });
+        // Left unsent after an earlier failure of the batch
+        if (aborted)
+            continue;
+
+        // Written under the lock so a read error can not flush half of the batch
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        int err_code = transport->Write(request->command, &request->nbytes_written);
+        if (err_code != TTY_OK)
+        {
+            request->write_error = err_code;
+            aborted              = true;
+            continue;
+        }
+        inflight.push_back({ request, now });
+        written.notify_one();
+    }
+
+    replied.wait(lock, [this] { return inflight.empty(); });
+}
+
+void SkywatcherChannel::Reader()
+{
+    char buf[SKYWATCHER_CHANNEL_MAX_MSG];
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        written.wait(lock, [this] { return stop || !inflight.empty(); });
+        if (stop)
+            return;
+
+        int nbytes_read = 0;
+        lock.unlock();
+        int err_code = transport->Read(buf, SKYWATCHER_CHANNEL_MAX_MSG - 1, timeout, &nbytes_read);
+        lock.lock();
+
+        InFlight done = inflight.front();
+        inflight.pop_front();
+        if (err_code != TTY_OK)
+        {
+            // The replies still in flight can not be matched any more
+            done.request->read_error = err_code;
+            for (auto &f : inflight)
+                f.request->read_error = err_code;
+            inflight.clear();
+            aborted = true;
+            transport->Flush();
+        }
+        else
+        {
+            memcpy(done.request->response, buf, nbytes_read);
+            done.request->response[nbytes_read] = '\0';
+            done.request->nbytes_read           = nbytes_read;
+            AddLatency(done.request->command[1],
+                       std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - done.sent).count());
+        }
+        replied.notify_all();
+    }
+}
+
+/* Latencies */
+
+void SkywatcherChannel::AddLatency(char cmd, double ms)
+{
+    Latency *latency = &latencies[cmd & 0x7F];
+    int bucket       = 0;
+
+    while (bucket < SKYWATCHER_LATENCY_BUCKETS - 1 && ms >= (1 << bucket))
+        bucket++;
+    latency->count++;
+    latency->total += ms;
+    if (ms > latency->max)
+        latency->max = ms;
+    latency->buckets[bucket]++;
+}
+
+bool SkywatcherChannel::GetLatency(char cmd, Latency *latency)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    *latency = latencies[cmd & 0x7F];
+    return latency->count > 0;
+}
+
+void SkywatcherChannel::FormatLatency(char cmd, char *buf, int size)
+{
+    Latency latency;
+    int len;
+
+    GetLatency(cmd, &latency);
+    len = snprintf(buf, size, "%c: %u replies, mean %.2f ms, max %.2f ms, histogram", cmd, latency.count,
+                   latency.count ? latency.total / latency.count : 0.0, latency.max);
+    for (int i = 0; i < SKYWATCHER_LATENCY_BUCKETS && len > 0 && len < size; i++)
+    {
+        if (i < SKYWATCHER_LATENCY_BUCKETS - 1)
+            len += snprintf(buf + len, size - len, " <%d:%u", 1 << i, latency.buckets[i]);
+        else
+            len += snprintf(buf + len, size - len, " >=%d:%u", 1 << (i - 1), latency.buckets[i]);
+    }
+}
+
+void SkywatcherChannel::ResetLatencies()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    memset(latencies, 0, sizeof(latencies));
+}
@@ -0,0 +1,152 @@
+/* Copyright 2012 Geehalel (geehalel AT gmail DOT com) */
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define SKYWATCHER_CHANNEL_MAX_MSG 16
+/* Commands written ahead of their replies */
+#define SKYWATCHER_CHANNEL_DEPTH 4
+/* Latency buckets: <1ms, <2ms, <4ms, ... <512ms, >=512ms */
+#define SKYWATCHER_LATENCY_BUCKETS 11
+
+/*
+ Command channel to a Skywatcher motor controller.
+ The caller writes the commands of a batch while a reader thread collects the replies. The
+ controller answers commands in the order it receives them, so replies are matched to the
+ commands in write order. Up to SKYWATCHER_CHANNEL_DEPTH commands are in flight at once, which
+ hides the serial round trip for independent queries (encoders and status of both axes).
+ On a read error the channel loses track of the reply order: every command in flight fails
+ and the input is flushed. Retries and reply checking are left to the caller.
+*/
+class SkywatcherChannel
+{
+    public:
+        class Transport
+        {
+            public:
+                virtual ~Transport() {}
+                /* Write a complete command, returns a TTY error code */
+                virtual int Write(const char *cmd, int *nbytes_written) = 0;
+                /* Read one reply up to its trailing CR, returns a TTY error code */
+                virtual int Read(char *buf, int size, int timeout, int *nbytes_read) = 0;
+                /* Drop any pending input and output */
+                virtual void Flush() = 0;
+        };
+
+        /* Serial port or network socket */
+        class TTYTransport : public Transport
+        {
+            public:
+                explicit TTYTransport(int fd) : fd(fd) {}
+                int Write(const char *cmd, int *nbytes_written) override;
+                int Read(char *buf, int size, int timeout, int *nbytes_read) override;
+                void Flush() override;
+
+            private:
+                int fd;
+        };
+
+        /* Synchronous simulator: each command is processed when written and its reply queued */
+        class LoopbackTransport : public Transport
+        {
+            public:
+                LoopbackTransport(std::function<void(const char *, int *)> receive,
+                                  std::function<void(char *, int *)> reply)
+                    : receive(receive), reply(reply) {}
+                int Write(const char *cmd, int *nbytes_written) override;
+                int Read(char *buf, int size, int timeout, int *nbytes_read) override;
+                void Flush() override;
+
+            private:
+                std::function<void(const char *, int *)> receive;
+                std::function<void(char *, int *)> reply;
+                std::mutex mutex;
+                std::deque<std::string> replies;
+        };
+
+        struct Request
+        {
+            char command[SKYWATCHER_CHANNEL_MAX_MSG];  // Including the trailing CR
+            char response[SKYWATCHER_CHANNEL_MAX_MSG]; // Including the trailing CR
+            int nbytes_written;
+            int nbytes_read;
+            int write_error; // TTY_OK or the tty_write error
+            int read_error;  // TTY_OK or the tty_read error
+            bool answered;   // Set by the caller once the reply is accepted, skipped by Transact
+        };
+
+        struct Latency
+        {
+            uint32_t count;
+            double total; // ms
+            double max;   // ms
+            uint32_t buckets[SKYWATCHER_LATENCY_BUCKETS];
+        };
+
+        SkywatcherChannel();
+        ~SkywatcherChannel();
+
+        /* Takes ownership of the transport and starts the reader thread */
+        void Open(Transport *transport, int timeout);
+        void Close();
+        bool IsOpen();
+
+        /*
+         Send the requests not yet answered and wait for their replies.
+         A request was answered when write_error and read_error are TTY_OK and nbytes_read > 0. With
+         no error and no reply it was not sent because an earlier request of the batch failed.
+        */
+        void Transact(Request *requests, int count);
+
+        /* Latency from the write of a command to its reply, per command character */
+        bool GetLatency(char cmd, Latency *latency);
+        void FormatLatency(char cmd, char *buf, int size);
+        void ResetLatencies();
+
+    private:
+        void Reader();
+        void AddLatency(char cmd, double ms);
+
+        struct InFlight
+        {
+            Request *request;
+            std::chrono::steady_clock::time_point sent;
+        };
+
+        Transport *transport {nullptr};
+        int timeout {5};
+
+        std::thread reader;
+        std::mutex batch;   // One Transact at a time
+        std::mutex mutex;   // Everything below
+        std::condition_variable written; // Caller to reader
+        std::condition_variable replied; // Reader to caller
+        std::deque<InFlight> inflight;
+        bool aborted {false};
+        bool stop {false};
+
+        Latency latencies[128];
+};
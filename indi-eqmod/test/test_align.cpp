@@ -0,0 +1,324 @@
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "align/pointindex.h"
+#include "align/triangulate_chull.h"
+
+// Offline tests of the alignment data structures, no mount needed.
+
+struct SyncPoint
+{
+    HtmID id;
+    double x, y, z;
+};
+
+// Sync points spread over the sky like an automated pointing model.
+static std::vector<SyncPoint> randomPoints(int n, unsigned int seed)
+{
+    std::vector<SyncPoint> points;
+    srand(seed);
+    for (int i = 0; i < n; i++)
+    {
+        double az  = (rand() / (double)RAND_MAX) * 2.0 * M_PI;
+        double alt = asin(rand() / (double)RAND_MAX);
+        SyncPoint p;
+        p.id = i + 1;
+        p.x  = cos(alt) * cos(az);
+        p.y  = cos(alt) * sin(az);
+        p.z  = sin(alt);
+        points.push_back(p);
+    }
+    return points;
+}
+
+static std::vector<PointIndex::Neighbour> bruteForce(const std::vector<SyncPoint> &points, const SyncPoint &q)
+{
+    std::vector<PointIndex::Neighbour> result;
+    for (const SyncPoint &p : points)
+    {
+        PointIndex::Neighbour n;
+        n.htmID  = p.id;
+        n.chord2 = (p.x - q.x) * (p.x - q.x) + (p.y - q.y) * (p.y - q.y) + (p.z - q.z) * (p.z - q.z);
+        result.push_back(n);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const PointIndex::Neighbour &a, const PointIndex::Neighbour &b) { return a.chord2 < b.chord2; });
+    return result;
+}
+
+TEST(AlignTest, point_index_empty)
+{
+    PointIndex index;
+    std::vector<PointIndex::Neighbour> result;
+    index.Nearest(1, 0, 0, 1, &result);
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(AlignTest, point_index_nearest)
+{
+    std::vector<SyncPoint> points  = randomPoints(500, 1);
+    std::vector<SyncPoint> queries = randomPoints(200, 2);
+    PointIndex index;
+    std::vector<PointIndex::Neighbour> result;
+
+    // Check while the index grows, as sync points are added one by one.
+    std::vector<SyncPoint> added;
+    for (const SyncPoint &p : points)
+    {
+        index.AddPoint(p.id, p.x, p.y, p.z);
+        added.push_back(p);
+        if (added.size() % 50 != 1)
+            continue;
+        for (const SyncPoint &q : queries)
+        {
+            std::vector<PointIndex::Neighbour> expected = bruteForce(added, q);
+            for (size_t k : { (size_t)1, (size_t)3, (size_t)0 })
+            {
+                index.Nearest(q.x, q.y, q.z, k, &result);
+                size_t n = (k == 0) ? added.size() : std::min(k, added.size());
+                ASSERT_EQ(result.size(), n);
+                for (size_t i = 0; i < n; i++)
+                    EXPECT_DOUBLE_EQ(result[i].chord2, expected[i].chord2);
+            }
+        }
+    }
+    EXPECT_EQ(index.size(), points.size());
+
+    index.Reset();
+    EXPECT_EQ(index.size(), 0u);
+}
+
+TEST(AlignTest, point_index_angle)
+{
+    // chord of the angle between two unit vectors
+    for (double a = 0.0; a <= M_PI; a += 0.1)
+    {
+        double chord = 2.0 * sin(a / 2.0);
+        EXPECT_NEAR(PointIndex::angle(chord * chord), a, 1e-9);
+    }
+}
+
+TEST(AlignTest, point_index_benchmark)
+{
+    std::vector<SyncPoint> queries = randomPoints(10000, 3);
+    for (int n : { 50, 500, 2000 })
+    {
+        std::vector<SyncPoint> points = randomPoints(n, 4);
+        PointIndex index;
+        for (const SyncPoint &p : points)
+            index.AddPoint(p.id, p.x, p.y, p.z);
+
+        std::vector<PointIndex::Neighbour> result;
+        HtmID sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const SyncPoint &q : queries)
+        {
+            index.Nearest(q.x, q.y, q.z, 1, &result);
+            sum += result[0].htmID;
+        }
+        std::chrono::duration<double> indexed = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        for (const SyncPoint &q : queries)
+            sum -= bruteForce(points, q)[0].htmID;
+        std::chrono::duration<double> scanned = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(sum, 0u);
+        printf("%d points: nearest %.2f us/query, full scan %.2f us/query\n", n, indexed.count() * 1e6 / queries.size(),
+               scanned.count() * 1e6 / queries.size());
+    }
+}
+
+// Synthetic pointing model, sync points above 15 degrees with a telescope position off by up to half a degree.
+static std::map<HtmID, PointSet::Point> syntheticModel(int n, unsigned int seed)
+{
+    std::map<HtmID, PointSet::Point> model;
+    srand(seed);
+    for (int i = 0; i < n; i++)
+    {
+        double az  = (rand() / (double)RAND_MAX) * 2.0 * M_PI;
+        double alt = asin(sin(15.0 * M_PI / 180.0) + (rand() / (double)RAND_MAX) * (1.0 - sin(15.0 * M_PI / 180.0)));
+        double taz  = az + ((rand() / (double)RAND_MAX) - 0.5) * M_PI / 180.0;
+        double talt = alt + ((rand() / (double)RAND_MAX) - 0.5) * M_PI / 180.0;
+        PointSet::Point p = PointSet::Point();
+        p.index = i;
+        p.htmID = i + 1;
+        p.cx    = cos(alt) * cos(az);
+        p.cy    = cos(alt) * sin(az);
+        p.cz    = sin(alt);
+        p.tx    = cos(talt) * cos(taz);
+        p.ty    = cos(talt) * sin(taz);
+        p.tz    = sin(talt);
+        model[p.htmID] = p;
+    }
+    return model;
+}
+
+// Face test as PointSet::isPointInside does it, used to check the locator against the former full scan.
+static double tripleProduct(const double p[3], const PointSet::Point &e1, const PointSet::Point &e2, bool ingoto)
+{
+    if (ingoto)
+        return (p[0] * e1.cy * e2.cz) + (p[2] * e1.cx * e2.cy) + (p[1] * e1.cz * e2.cx) - (p[2] * e1.cy * e2.cx) -
+               (p[0] * e1.cz * e2.cy) - (p[1] * e1.cx * e2.cz);
+    return (p[0] * e1.ty * e2.tz) + (p[2] * e1.tx * e2.ty) + (p[1] * e1.tz * e2.tx) - (p[2] * e1.ty * e2.tx) -
+           (p[0] * e1.tz * e2.ty) - (p[1] * e1.tx * e2.tz);
+}
+
+static bool isInside(std::map<HtmID, PointSet::Point> &model, const double p[3], const Face *f, bool ingoto)
+{
+    bool left = false, right = false;
+    for (int k = 0; k < 3; k++)
+    {
+        if (tripleProduct(p, model.at(f->v[(k + 2) % 3]), model.at(f->v[k]), ingoto) < 0)
+            left = true;
+        else
+            right = true;
+    }
+    return !(left && right);
+}
+
+static int scan(std::map<HtmID, PointSet::Point> &model, TriangulateCHull &triangulation, const double p[3], bool ingoto)
+{
+    std::vector<Face *> faces = triangulation.getFaces();
+    for (size_t i = 0; i < faces.size(); i++)
+        if (isInside(model, p, faces[i], ingoto))
+            return i;
+    return -1;
+}
+
+TEST(AlignTest, triangulation_locate)
+{
+    std::map<HtmID, PointSet::Point> model = syntheticModel(300, 5);
+    std::vector<SyncPoint> queries         = randomPoints(300, 6);
+    TriangulateCHull triangulation(&model);
+    int added = 0;
+
+    for (auto &point : model)
+    {
+        triangulation.AddPoint(point.first);
+        if (++added % 25 != 0)
+            continue;
+        for (const SyncPoint &q : queries)
+        {
+            double p[3] = { q.x, q.y, q.z };
+            for (bool ingoto : { true, false })
+            {
+                int expected = scan(model, triangulation, p, ingoto);
+                for (int start : { -1, 0, (int)triangulation.getFaces().size() - 1 })
+                {
+                    int face = triangulation.locate(p, ingoto, start);
+                    if (ingoto)
+                    {
+                        EXPECT_EQ(face < 0, expected < 0);
+                    }
+                    else if (expected >= 0)
+                    {
+                        EXPECT_GE(face, 0);
+                    }
+                    if (face >= 0)
+                    {
+                        EXPECT_TRUE(isInside(model, p, triangulation.getFace(face), ingoto));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Sidereal tracking (one second steps for an hour) and gotos to random positions.
+TEST(AlignTest, triangulation_benchmark)
+{
+    const double latitude = 45.0 * M_PI / 180.0;
+    const double pole[3]  = { cos(latitude), 0.0, sin(latitude) };
+    const double step     = 15.0 / 3600.0 * M_PI / 180.0;
+    std::vector<SyncPoint> gotos = randomPoints(2000, 8);
+
+    for (int n : { 50, 500, 2000 })
+    {
+        std::map<HtmID, PointSet::Point> model = syntheticModel(n, 7);
+        TriangulateCHull triangulation(&model);
+        PointIndex index;
+        auto start = std::chrono::steady_clock::now();
+        for (auto &point : model)
+        {
+            triangulation.AddPoint(point.first);
+            index.AddPoint(point.first, point.second.cx, point.second.cy, point.second.cz);
+        }
+        std::chrono::duration<double> build = std::chrono::steady_clock::now() - start;
+
+        // tracking path, rotating a position around the pole
+        std::vector<std::vector<double>> path;
+        double p[3] = { 0.0, 1.0, 0.0 };
+        for (int i = 0; i < 3600; i++)
+        {
+            double c = cos(step), s = sin(step), d = (1 - c) * (pole[0] * p[0] + pole[1] * p[1] + pole[2] * p[2]);
+            double r[3] = { p[0] * c + (pole[1] * p[2] - pole[2] * p[1]) * s + pole[0] * d,
+                            p[1] * c + (pole[2] * p[0] - pole[0] * p[2]) * s + pole[1] * d,
+                            p[2] * c + (pole[0] * p[1] - pole[1] * p[0]) * s + pole[2] * d };
+            std::copy(r, r + 3, p);
+            path.push_back(std::vector<double>(p, p + 3));
+        }
+
+        // former findFace: current face first, then every face
+        int found = 0, current = -1;
+        start = std::chrono::steady_clock::now();
+        for (auto &q : path)
+        {
+            if (current < 0 || !isInside(model, q.data(), triangulation.getFace(current), true))
+                current = scan(model, triangulation, q.data(), true);
+            found += current >= 0;
+        }
+        std::chrono::duration<double> scantrack = std::chrono::steady_clock::now() - start;
+
+        int located = 0;
+        current     = -1;
+        start       = std::chrono::steady_clock::now();
+        for (auto &q : path)
+        {
+            current = triangulation.locate(q.data(), true, current);
+            located += current >= 0;
+        }
+        std::chrono::duration<double> walktrack = std::chrono::steady_clock::now() - start;
+        EXPECT_EQ(found, located);
+
+        found = 0;
+        start = std::chrono::steady_clock::now();
+        for (const SyncPoint &q : gotos)
+        {
+            double g[3] = { q.x, q.y, q.z };
+            found += scan(model, triangulation, g, true) >= 0;
+        }
+        std::chrono::duration<double> scangoto = std::chrono::steady_clock::now() - start;
+
+        located = 0;
+        std::vector<PointIndex::Neighbour> nearest;
+        start = std::chrono::steady_clock::now();
+        for (const SyncPoint &q : gotos)
+        {
+            double g[3] = { q.x, q.y, q.z };
+            index.Nearest(q.x, q.y, q.z, 1, &nearest);
+            located += triangulation.locate(g, true, triangulation.getVertexFace(nearest[0].htmID)) >= 0;
+        }
+        std::chrono::duration<double> walkgoto = std::chrono::steady_clock::now() - start;
+        EXPECT_EQ(found, located);
+
+        printf("%d points, %zu faces, built in %.0f ms: tracking scan %.2f us walk %.2f us, goto scan %.2f us walk %.2f us\n",
+               n, triangulation.getFaces().size(), build.count() * 1e3, scantrack.count() * 1e6 / path.size(),
+               walktrack.count() * 1e6 / path.size(), scangoto.count() * 1e6 / gotos.size(),
+               walkgoto.count() * 1e6 / gotos.size());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
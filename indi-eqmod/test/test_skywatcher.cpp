@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+
+#include <indicom.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "skywatcherchannel.h"
+#include "simulator/skywatcher-simulator.h"
+
+// Pipelined Skywatcher command channel, against the mount simulator, no serial port needed.
+
+static void setupEQ6(SkywatcherSimulator *sim)
+{
+    sim->setupVersion("020300");
+    sim->setupRA(180, 47, 12, 200, 64, 2);
+    sim->setupDE(180, 47, 12, 200, 64, 2);
+}
+
+static SkywatcherChannel::Transport *simulatorTransport(SkywatcherSimulator *sim)
+{
+    return new SkywatcherChannel::LoopbackTransport(
+               [sim](const char *cmd, int *received) { sim->process_command(cmd, received); },
+               [sim](char *buf, int *len) { sim->get_reply(buf, len); });
+}
+
+static std::vector<SkywatcherChannel::Request> requests(const std::vector<std::string> &commands)
+{
+    std::vector<SkywatcherChannel::Request> result(commands.size());
+    for (size_t i = 0; i < commands.size(); i++)
+    {
+        memset(&result[i], 0, sizeof(result[i]));
+        snprintf(result[i].command, SKYWATCHER_CHANNEL_MAX_MSG, ":%s\r", commands[i].c_str());
+    }
+    return result;
+}
+
+// The queries of EQMod::ReadScopeStatus() plus the encoder information of the handshake
+static const std::vector<std::string> queries = { "j1", "j2", "f1", "f2", "d1", "d2", "e1", "a1", "a2", "b1", "g2", "s1" };
+
+TEST(TestSkywatcherChannel, replies_match_synchronous_simulator)
+{
+    SkywatcherSimulator reference, sim;
+    setupEQ6(&reference);
+    setupEQ6(&sim);
+
+    SkywatcherChannel channel;
+    channel.Open(simulatorTransport(&sim), 5);
+    std::vector<SkywatcherChannel::Request> batch = requests(queries);
+    channel.Transact(batch.data(), batch.size());
+
+    for (auto &request : batch)
+    {
+        char expected[64];
+        int received = 0, len = 0;
+        reference.process_command(request.command, &received);
+        reference.get_reply(expected, &len);
+
+        EXPECT_EQ(request.write_error, TTY_OK);
+        EXPECT_EQ(request.read_error, TTY_OK);
+        EXPECT_EQ(request.nbytes_written, static_cast<int>(strlen(request.command)));
+        EXPECT_EQ(request.nbytes_read, len);
+        EXPECT_STREQ(request.response, expected) << "command " << request.command;
+    }
+}
+
+TEST(TestSkywatcherChannel, answered_requests_are_skipped)
+{
+    SkywatcherSimulator sim;
+    setupEQ6(&sim);
+
+    SkywatcherChannel channel;
+    channel.Open(simulatorTransport(&sim), 5);
+    std::vector<SkywatcherChannel::Request> batch = requests({ "j1", "j2" });
+    batch[0].answered = true;
+    channel.Transact(batch.data(), batch.size());
+
+    EXPECT_EQ(batch[0].nbytes_written, 0);
+    EXPECT_EQ(batch[1].response[0], '=');
+}
+
+TEST(TestSkywatcherChannel, not_open)
+{
+    SkywatcherChannel channel;
+    std::vector<SkywatcherChannel::Request> batch = requests({ "j1" });
+    channel.Transact(batch.data(), batch.size());
+    EXPECT_EQ(batch[0].write_error, TTY_PORT_FAILURE);
+}
+
+// Controller answering one command at a time in serviceTime, behind a link adding transit each way
+// (serial line and USB adapter). Records how many commands wait for a reply and fails the reads listed
+// in timeouts.
+class SlowMount : public SkywatcherChannel::Transport
+{
+    public:
+        SlowMount(std::chrono::microseconds serviceTime, std::chrono::microseconds transit = std::chrono::microseconds(0),
+                  std::vector<int> timeouts = {})
+            : serviceTime(serviceTime), transit(transit), timeouts(timeouts) {}
+
+        int Write(const char *cmd, int *nbytes_written) override
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto now = std::chrono::steady_clock::now();
+            ready    = std::max(ready, now + transit) + serviceTime;
+            replies.push_back({ ready + transit, std::string("=") + cmd[1] + "\r" });
+            maxPending      = std::max(maxPending, ++pending);
+            *nbytes_written = strlen(cmd);
+            return TTY_OK;
+        }
+
+        int Read(char *buf, int size, int timeout, int *nbytes_read) override
+        {
+            (void)size;
+            (void)timeout;
+            std::unique_lock<std::mutex> lock(mutex);
+            *nbytes_read = 0;
+            if (replies.empty())
+                return TTY_TIME_OUT;
+            auto reply = replies.front();
+            replies.pop_front();
+            bool fail = std::find(timeouts.begin(), timeouts.end(), reads++) != timeouts.end();
+            lock.unlock();
+
+            std::this_thread::sleep_until(reply.first);
+            lock.lock();
+            pending--;
+            if (fail)
+                return TTY_TIME_OUT;
+            memcpy(buf, reply.second.data(), reply.second.size());
+            *nbytes_read = reply.second.size();
+            return TTY_OK;
+        }
+
+        void Flush() override
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            pending -= replies.size();
+            replies.clear();
+            flushes++;
+        }
+
+        std::mutex mutex;
+        std::chrono::microseconds serviceTime;
+        std::chrono::microseconds transit;
+        std::chrono::steady_clock::time_point ready;
+        std::deque<std::pair<std::chrono::steady_clock::time_point, std::string>> replies;
+        std::vector<int> timeouts;
+        int reads { 0 };
+        int flushes { 0 };
+        int pending { 0 };
+        int maxPending { 0 };
+};
+
+TEST(TestSkywatcherChannel, depth_is_bounded)
+{
+    SlowMount *mount = new SlowMount(std::chrono::microseconds(2000));
+    SkywatcherChannel channel;
+    channel.Open(mount, 5);
+
+    std::vector<SkywatcherChannel::Request> batch = requests(queries);
+    channel.Transact(batch.data(), batch.size());
+
+    EXPECT_EQ(mount->maxPending, SKYWATCHER_CHANNEL_DEPTH);
+    for (auto &request : batch)
+        EXPECT_EQ(request.response[1], request.command[1]);
+}
+
+TEST(TestSkywatcherChannel, read_error_fails_in_flight_commands)
+{
+    // Second reply lost: it and the commands written behind it fail, the rest of the batch is not sent
+    SlowMount *mount = new SlowMount(std::chrono::microseconds(1000), std::chrono::microseconds(0), { 1 });
+    SkywatcherChannel channel;
+    channel.Open(mount, 5);
+
+    std::vector<SkywatcherChannel::Request> batch = requests(queries);
+    channel.Transact(batch.data(), batch.size());
+
+    EXPECT_EQ(batch[0].read_error, TTY_OK);
+    EXPECT_EQ(batch[0].response[0], '=');
+    int failed = 0, unsent = 0;
+    for (size_t i = 1; i < batch.size(); i++)
+    {
+        EXPECT_EQ(batch[i].write_error, TTY_OK);
+        EXPECT_EQ(batch[i].nbytes_read, 0);
+        if (batch[i].read_error == TTY_TIME_OUT)
+            failed++;
+        else if (batch[i].nbytes_written == 0)
+            unsent++;
+    }
+    EXPECT_GE(failed, 1);
+    EXPECT_LE(failed, SKYWATCHER_CHANNEL_DEPTH);
+    EXPECT_EQ(failed + unsent, static_cast<int>(batch.size()) - 1);
+    EXPECT_EQ(batch[1].read_error, TTY_TIME_OUT);
+
+    // The retry sends only what was not answered, after flushing the lost replies
+    batch[0].answered = true;
+    int flushes       = mount->flushes;
+    channel.Transact(batch.data(), batch.size());
+    EXPECT_GT(mount->flushes, flushes);
+    for (size_t i = 1; i < batch.size(); i++)
+    {
+        EXPECT_EQ(batch[i].read_error, TTY_OK);
+        EXPECT_EQ(batch[i].response[1], batch[i].command[1]);
+    }
+}
+
+TEST(TestSkywatcherChannel, latency_histogram)
+{
+    SlowMount *mount = new SlowMount(std::chrono::microseconds(1500));
+    SkywatcherChannel channel;
+    channel.Open(mount, 5);
+
+    for (int i = 0; i < 5; i++)
+    {
+        std::vector<SkywatcherChannel::Request> batch = requests({ "j1", "j2", "f1", "f2" });
+        channel.Transact(batch.data(), batch.size());
+    }
+
+    SkywatcherChannel::Latency latency;
+    ASSERT_TRUE(channel.GetLatency('j', &latency));
+    EXPECT_EQ(latency.count, 10u);
+    uint32_t total = 0;
+    for (int i = 0; i < SKYWATCHER_LATENCY_BUCKETS; i++)
+        total += latency.buckets[i];
+    EXPECT_EQ(total, latency.count);
+    EXPECT_EQ(latency.buckets[0], 0u); // Nothing faster than the 1.5ms service time
+    EXPECT_GE(latency.max, 1.5);
+    EXPECT_FALSE(channel.GetLatency('e', &latency));
+
+    char buf[256];
+    channel.FormatLatency('f', buf, sizeof(buf));
+    EXPECT_EQ(strncmp(buf, "f: 10 replies", 13), 0);
+
+    channel.ResetLatencies();
+    EXPECT_FALSE(channel.GetLatency('j', &latency));
+}
+
+// Time of a ReadScopeStatus() sized batch, against one command per transaction as before
+TEST(TestSkywatcherChannel, benchmark)
+{
+    const int polls = 20;
+    // 9600 baud line behind a USB serial adapter
+    SkywatcherChannel channel;
+    channel.Open(new SlowMount(std::chrono::microseconds(1000), std::chrono::microseconds(4000)), 5);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < polls; i++)
+    {
+        for (const char *cmd : { "j1", "j2", "f1", "f2" })
+        {
+            std::vector<SkywatcherChannel::Request> single = requests({ cmd });
+            channel.Transact(single.data(), single.size());
+        }
+    }
+    std::chrono::duration<double, std::milli> sequential = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < polls; i++)
+    {
+        std::vector<SkywatcherChannel::Request> batch = requests({ "j1", "j2", "f1", "f2" });
+        channel.Transact(batch.data(), batch.size());
+    }
+    std::chrono::duration<double, std::milli> pipelined = std::chrono::steady_clock::now() - start;
+
+    printf("4 queries per poll: sequential %.1f ms/poll, pipelined %.1f ms/poll\n", sequential.count() / polls,
+           pipelined.count() / polls);
+    // The mount serves one command at a time, pipelining overlaps the transit of the commands
+    EXPECT_LT(pipelined.count(), sequential.count());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
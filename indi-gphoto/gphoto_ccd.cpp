@@ -27,6 +27,7 @@
 #include "gphoto_readimage.h"
 
 #include <algorithm>
+#include <chrono>
 #include <stream/streammanager.h>
 
 #include <math.h>
@@ -36,6 +37,7 @@
 #include <sys/stat.h>
 
 #define FOCUS_TAB    "Focus"
+#define STREAMING_TAB "Streaming"
 #define MAX_DEVICES  5 /* Max device cameraCount */
 #define FOCUS_TIMER  50
 #define MAX_RETRIES  3
@@ -403,6 +405,25 @@ bool GPhotoCCD::initProperties()
     IUFillSwitchVector(&livePreviewSP, livePreviewS, 2, getDeviceName(), "AUX_VIDEO_STREAM", "Preview",
                        MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
+    IUFillSwitch(&liveViewDecodeS[LIVE_VIEW_JPEG], "LIVE_VIEW_JPEG", "JPEG", ISS_OFF);
+    IUFillSwitch(&liveViewDecodeS[LIVE_VIEW_FULL], "LIVE_VIEW_FULL", "Full", ISS_ON);
+    IUFillSwitch(&liveViewDecodeS[LIVE_VIEW_HALF], "LIVE_VIEW_HALF", "1/2", ISS_OFF);
+    IUFillSwitch(&liveViewDecodeS[LIVE_VIEW_QUARTER], "LIVE_VIEW_QUARTER", "1/4", ISS_OFF);
+    IUFillSwitchVector(&liveViewDecodeSP, liveViewDecodeS, 4, getDeviceName(), "LIVE_VIEW_DECODE", "Live Decode",
+                       STREAMING_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
+    IUFillNumber(&liveViewROIN[LIVE_VIEW_ROI_X], "X", "X", "%.f", 0, 10000, 1, 0);
+    IUFillNumber(&liveViewROIN[LIVE_VIEW_ROI_Y], "Y", "Y", "%.f", 0, 10000, 1, 0);
+    IUFillNumber(&liveViewROIN[LIVE_VIEW_ROI_W], "WIDTH", "Width", "%.f", 0, 10000, 1, 0);
+    IUFillNumber(&liveViewROIN[LIVE_VIEW_ROI_H], "HEIGHT", "Height", "%.f", 0, 10000, 1, 0);
+    IUFillNumberVector(&liveViewROINP, liveViewROIN, 4, getDeviceName(), "LIVE_VIEW_ROI", "Live ROI", STREAMING_TAB,
+                       IP_RW, 60, IPS_IDLE);
+
+    IUFillNumber(&liveViewStatsN[LIVE_VIEW_FPS], "LIVE_VIEW_FPS", "FPS", "%.1f", 0, 1000, 0, 0);
+    IUFillNumber(&liveViewStatsN[LIVE_VIEW_DECODE_MS], "LIVE_VIEW_DECODE_MS", "Decode (ms)", "%.1f", 0, 10000, 0, 0);
+    IUFillNumberVector(&liveViewStatsNP, liveViewStatsN, 2, getDeviceName(), "LIVE_VIEW_STATS", "Live Stats",
+                       STREAMING_TAB, IP_RO, 60, IPS_IDLE);
+
     IUFillSwitch(&captureTargetS[CAPTURE_INTERNAL_RAM], "RAM", "", ISS_ON);
     IUFillSwitch(&captureTargetS[CAPTURE_SD_CARD], "SD Card", "", ISS_OFF);
     IUFillSwitchVector(&captureTargetSP, captureTargetS, 2, getDeviceName(), "CCD_CAPTURE_TARGET", "Capture Target",
@@ -418,6 +439,11 @@ bool GPhotoCCD::initProperties()
     IUFillSwitchVector(&forceBULBSP, forceBULBS, 2, getDeviceName(), "CCD_FORCE_BLOB", "Force BULB",
                        OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
+    IUFillSwitch(&keepNativeS[KEEP_NATIVE_ON], "On", "On", ISS_OFF);
+    IUFillSwitch(&keepNativeS[KEEP_NATIVE_OFF], "Off", "Off", ISS_ON);
+    IUFillSwitchVector(&keepNativeSP, keepNativeS, 2, getDeviceName(), "CCD_KEEP_NATIVE", "Keep Native",
+                       IMAGE_SETTINGS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
     // Upload File
     IUFillText(&UploadFileT[0], "PATH", "Path", nullptr);
     IUFillTextVector(&UploadFileTP, UploadFileT, 1, getDeviceName(), "CCD_UPLOAD_FILE", "Upload File", OPTIONS_TAB, IP_RW, 0,
@@ -510,6 +536,10 @@ bool GPhotoCCD::updateProperties()
 
         defineSwitch(&livePreviewSP);
         defineSwitch(&TransferFormatSP);
+        defineSwitch(&keepNativeSP);
+        defineSwitch(&liveViewDecodeSP);
+        defineNumber(&liveViewROINP);
+        defineNumber(&liveViewStatsNP);
         defineSwitch(&autoFocusSP);
 
         if (m_CanFocus)
@@ -564,6 +594,10 @@ bool GPhotoCCD::updateProperties()
         deleteProperty(livePreviewSP.name);
         deleteProperty(autoFocusSP.name);
         deleteProperty(TransferFormatSP.name);
+        deleteProperty(keepNativeSP.name);
+        deleteProperty(liveViewDecodeSP.name);
+        deleteProperty(liveViewROINP.name);
+        deleteProperty(liveViewStatsNP.name);
 
         if (m_CanFocus)
             FI::updateProperties();
@@ -699,6 +733,48 @@ bool GPhotoCCD::ISNewSwitch(const char * dev, const char * name, ISState * state
             return true;
         }
 
+        ///////////////////////////////////////////////////////////////////////////////////////////////
+        // Live View Decode
+        // JPEG forwards the camera frames to the streamer untouched, other modes decode them scaled down.
+        // The pixel format of the stream depends on it, so it cannot change while streaming.
+        ///////////////////////////////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, liveViewDecodeSP.name))
+        {
+            if (Streamer->isBusy())
+            {
+                liveViewDecodeSP.s = IPS_ALERT;
+                IDSetSwitch(&liveViewDecodeSP, nullptr);
+                LOG_WARN("Cannot change live view decoding while streaming.");
+                return true;
+            }
+
+            if (IUUpdateSwitch(&liveViewDecodeSP, states, names, n) < 0)
+                return false;
+
+            liveViewDecodeSP.s = IPS_OK;
+            IDSetSwitch(&liveViewDecodeSP, nullptr);
+            return true;
+        }
+
+        ///////////////////////////////////////////////////////////////////////////////////////////////
+        // Keep Native
+        // FITS captures are decoded in memory, this writes the camera file to the upload directory as well.
+        ///////////////////////////////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, keepNativeSP.name))
+        {
+            if (IUUpdateSwitch(&keepNativeSP, states, names, n) < 0)
+                return false;
+
+            keepNativeSP.s = IPS_OK;
+            if (keepNativeS[KEEP_NATIVE_ON].s == ISS_ON)
+                LOGF_INFO("Native files of FITS captures shall be saved to %s.", UploadSettingsT[UPLOAD_DIR].text);
+            else
+                LOG_INFO("Native files of FITS captures shall not be saved.");
+
+            IDSetSwitch(&keepNativeSP, nullptr);
+            return true;
+        }
+
         if (!strcmp(name, mExposurePresetSP.name))
         {
             if (IUUpdateSwitch(&mExposurePresetSP, states, names, n) < 0)
@@ -941,6 +1017,17 @@ bool GPhotoCCD::ISNewNumber(const char * dev, const char * name, double values[]
             return true;
         }
 
+        // The live view thread picks the region up on its next frame
+        if (!strcmp(name, liveViewROINP.name))
+        {
+            std::unique_lock<std::mutex> guard(liveStreamMutex);
+            IUUpdateNumber(&liveViewROINP, values, names, n);
+            guard.unlock();
+            liveViewROINP.s = IPS_OK;
+            IDSetNumber(&liveViewROINP, nullptr);
+            return true;
+        }
+
         if (CamOptions.find(name) != CamOptions.end())
         {
             cam_opt * opt = CamOptions[name];
@@ -1394,8 +1481,12 @@ bool GPhotoCCD::grabImage()
 
     if (TransferFormatS[FORMAT_FITS].s == ISS_ON)
     {
-        char filename[MAXRBUF] = "/tmp/indi_XXXXXX";
         const char *extension = "unknown";
+        const char *data = nullptr;
+        size_t size = 0;
+        void *mmap_mem = MAP_FAILED;
+
+        // The capture is decoded straight from memory, it never goes through a temporary file
         if (isSimulation())
         {
             if (!UploadFileT[0].text[0])
@@ -1404,34 +1495,52 @@ bool GPhotoCCD::grabImage()
                 return false;
             }
 
-            strncpy(filename, UploadFileT[0].text, MAXRBUF);
-            extension = strchr(filename, '.') + 1;
+            int fd = open(UploadFileT[0].text, O_RDONLY);
+            struct stat sb;
+            if (fd == -1 || fstat(fd, &sb) == -1)
+            {
+                LOGF_ERROR("Error opening file %s: %s", UploadFileT[0].text, strerror(errno));
+                if (fd != -1)
+                    close(fd);
+                return false;
+            }
+
+            size = sb.st_size;
+            mmap_mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mmap_mem == MAP_FAILED)
+            {
+                LOGF_ERROR("Error reading file %s: %s", UploadFileT[0].text, strerror(errno));
+                return false;
+            }
+
+            data = static_cast<const char *>(mmap_mem);
+            const char *dot = strrchr(UploadFileT[0].text, '.');
+            if (dot != nullptr)
+                extension = dot + 1;
         }
         else
         {
-            int fd = mkstemp(filename);
-            int ret = gphoto_read_exposure_fd(gphotodrv, fd);
-            if (ret != GP_OK || fd == -1)
+            int ret = gphoto_read_exposure(gphotodrv);
+            if (ret != GP_OK)
             {
-                if (fd == -1)
-                    LOGF_ERROR("Exposure failed to save image. Cannot create temp file %s", tmpfile);
-                else
-                {
-                    LOGF_ERROR("Exposure failed to save image... %s", gp_result_as_string(ret));
-                    // As suggested on INDI forums, this result could be misleading.
-                    if (ret == GP_ERROR_DIRECTORY_NOT_FOUND)
-                        LOG_INFO("Make sure BULB switch is ON in the camera. Try setting AF switch to OFF.");
-                }
-                unlink(filename);
+                LOGF_ERROR("Exposure failed to save image... %s", gp_result_as_string(ret));
+                // As suggested on INDI forums, this result could be misleading.
+                if (ret == GP_ERROR_DIRECTORY_NOT_FOUND)
+                    LOG_INFO("Make sure BULB switch is ON in the camera. Try setting AF switch to OFF.");
                 return false;
             }
 
-            extension = gphoto_get_file_extension(gphotodrv);
+            gphoto_get_buffer(gphotodrv, &data, &size);
+            if (data != nullptr && size > 0)
+                extension = gphoto_get_file_extension(gphotodrv);
         }
 
         if (!strcmp(extension, "unknown"))
         {
             LOG_ERROR("Exposure failed.");
+            if (mmap_mem != MAP_FAILED)
+                munmap(mmap_mem, size);
             return false;
         }
 
@@ -1439,126 +1548,71 @@ bool GPhotoCCD::grabImage()
         if (ExposureRequest > 3)
             LOG_INFO("Exposure done, downloading image...");
 
+        // Only the requested subframe is copied out of the decoded image
+        image_window window = { PrimaryCCD.getSubX(), PrimaryCCD.getSubY(), PrimaryCCD.getSubW(), PrimaryCCD.getSubH() };
+        int rc = 0;
+
+        auto decodeStart = std::chrono::steady_clock::now();
+
         if (strcasecmp(extension, "jpg") == 0 || strcasecmp(extension, "jpeg") == 0)
         {
-            if (read_jpeg(filename, &memptr, &memsize, &naxis, &w, &h))
-            {
+            rc = read_jpeg_mem_planar(data, size, &memptr, &memsize, &naxis, &w, &h, &window);
+            if (rc)
                 LOG_ERROR("Exposure failed to parse jpeg.");
-                if (!isSimulation())
-                    unlink(filename);
-                return false;
+            else
+            {
+                LOGF_DEBUG("read_jpeg: memsize (%d) naxis (%d) w (%d) h (%d) bpp (%d)", memsize, naxis, w, h, bpp);
+                SetCCDCapability(GetCCDCapability() & ~CCD_HAS_BAYER);
             }
-
-            LOGF_DEBUG("read_jpeg: memsize (%d) naxis (%d) w (%d) h (%d) bpp (%d)", memsize, naxis, w, h, bpp);
-
-            SetCCDCapability(GetCCDCapability() & ~CCD_HAS_BAYER);
         }
         else
         {
             char bayer_pattern[8] = {};
 
-            if (read_libraw(filename, &memptr, &memsize, &naxis, &w, &h, &bpp, bayer_pattern))
-            {
+            rc = read_libraw_mem(data, size, &memptr, &memsize, &naxis, &w, &h, &bpp, bayer_pattern, &window);
+            if (rc)
                 LOG_ERROR("Exposure failed to parse raw image.");
-                if (!isSimulation())
-                    unlink(filename);
-                return false;
-            }
-
-            LOGF_DEBUG("read_libraw: memsize (%d) naxis (%d) w (%d) h (%d) bpp (%d) bayer pattern (%s)",
-                       memsize, naxis, w, h, bpp, bayer_pattern);
-
-            if (!isSimulation())
-                unlink(filename);
+            else
+            {
+                LOGF_DEBUG("read_libraw: memsize (%d) naxis (%d) w (%d) h (%d) bpp (%d) bayer pattern (%s)",
+                           memsize, naxis, w, h, bpp, bayer_pattern);
 
-            IUSaveText(&BayerT[2], bayer_pattern);
-            IDSetText(&BayerTP, nullptr);
-            SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
+                IUSaveText(&BayerT[2], bayer_pattern);
+                IDSetText(&BayerTP, nullptr);
+                SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
+            }
         }
 
-        PrimaryCCD.setImageExtension("fits");
-
-        uint16_t subW = PrimaryCCD.getSubW();
-        uint16_t subH = PrimaryCCD.getSubH();
-
-        // If subframing is requested
-        // If either axis is less than the image resolution
-        // then we subframe, given the OTHER axis is within range as well.
-        if ( (subW > 0 && subH > 0) && ((subW < w && subH <= h) || (subH < h && subW <= w)))
+        if (rc)
         {
-            uint16_t subX = PrimaryCCD.getSubX();
-            uint16_t subY = PrimaryCCD.getSubY();
-
-            // Align all boundaries to be even
-            // This should fix issues with subframed bayered images.
-            //            subX -= subX % 2;
-            //            subY -= subY % 2;
-            //            subW -= subW % 2;
-            //            subH -= subH % 2;
-
-            int subFrameSize     = subW * subH * bpp / 8 * ((naxis == 3) ? 3 : 1);
-            int oneFrameSize     = subW * subH * bpp / 8;
-
-            int lineW  = subW * bpp / 8;
-
-            LOGF_DEBUG("Subframing... subFrameSize: %d - oneFrameSize: %d - subX: %d - subY: %d - subW: %d - subH: %d",
-                       subFrameSize, oneFrameSize,
-                       subX, subY, subW, subH);
-
-            if (naxis == 2)
-            {
-                // JM 2020-08-29: Using memmove since regions are overlaping
-                // as proposed by Camiel Severijns on INDI forums.
-                for (int i = subY; i < subY + subH; i++)
-                    memmove(memptr + (i - subY) * lineW, memptr + (i * w + subX) * bpp / 8, lineW);
-            }
-            else
-            {
-                uint8_t * subR = memptr;
-                uint8_t * subG = memptr + oneFrameSize;
-                uint8_t * subB = memptr + oneFrameSize * 2;
-
-                uint8_t * startR = memptr;
-                uint8_t * startG = memptr + (w * h * bpp / 8);
-                uint8_t * startB = memptr + (w * h * bpp / 8 * 2);
+            if (mmap_mem != MAP_FAILED)
+                munmap(mmap_mem, size);
+            return false;
+        }
 
-                for (int i = subY; i < subY + subH; i++)
-                {
-                    memcpy(subR + (i - subY) * lineW, startR + (i * w + subX) * bpp / 8, lineW);
-                    memcpy(subG + (i - subY) * lineW, startG + (i * w + subX) * bpp / 8, lineW);
-                    memcpy(subB + (i - subY) * lineW, startB + (i * w + subX) * bpp / 8, lineW);
-                }
-            }
+        LOGF_DEBUG("Decoded %s (%zu bytes) to %dx%d+%d+%d in %.3f s", extension, size, window.w, window.h, window.x,
+                   window.y, std::chrono::duration<double>(std::chrono::steady_clock::now() - decodeStart).count());
 
-            PrimaryCCD.setFrameBuffer(memptr);
-            PrimaryCCD.setFrameBufferSize(memsize, false);
-            PrimaryCCD.setResolution(w, h);
-            PrimaryCCD.setFrame(subX, subY, subW, subH);
-            PrimaryCCD.setNAxis(naxis);
-            PrimaryCCD.setBPP(bpp);
+        if (PrimaryCCD.getSubW() > w || PrimaryCCD.getSubH() > h)
+            LOGF_WARN("Camera image size (%dx%d) is less than requested size (%d,%d). Purge configuration and update frame size to match camera size.",
+                      w, h, PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
 
-            ExposureComplete(&PrimaryCCD);
+        PrimaryCCD.setImageExtension("fits");
+        PrimaryCCD.setFrameBuffer(memptr);
+        PrimaryCCD.setFrameBufferSize(memsize, false);
+        PrimaryCCD.setResolution(w, h);
+        PrimaryCCD.setFrame(window.x, window.y, window.w, window.h);
+        PrimaryCCD.setNAxis(naxis);
+        PrimaryCCD.setBPP(bpp);
 
-            // Restore old pointer and release memory
-            //PrimaryCCD.setFrameBuffer(memptr);
-            //PrimaryCCD.setFrameBufferSize(memsize, false);
-            //delete [] (subframeBuf);
-        }
-        else
-        {
-            if (PrimaryCCD.getSubW() != 0 && (w > PrimaryCCD.getSubW() || h > PrimaryCCD.getSubH()))
-                LOGF_WARN("Camera image size (%dx%d) is less than requested size (%d,%d). Purge configuration and update frame size to match camera size.",
-                          w, h, PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
+        ExposureComplete(&PrimaryCCD);
 
-            PrimaryCCD.setFrame(0, 0, w, h);
-            PrimaryCCD.setFrameBuffer(memptr);
-            PrimaryCCD.setFrameBufferSize(memsize, false);
-            PrimaryCCD.setResolution(w, h);
-            PrimaryCCD.setNAxis(naxis);
-            PrimaryCCD.setBPP(bpp);
+        // The native file is written once the frame is out, off the critical path
+        if (keepNativeS[KEEP_NATIVE_ON].s == ISS_ON && !isSimulation())
+            saveNativeCopy(data, size);
 
-            ExposureComplete(&PrimaryCCD);
-        }
+        if (mmap_mem != MAP_FAILED)
+            munmap(mmap_mem, size);
     }
     // Read Native image AS IS
     else
@@ -1650,6 +1704,42 @@ bool GPhotoCCD::grabImage()
     return true;
 }
 
+bool GPhotoCCD::saveNativeCopy(const char * data, size_t size)
+{
+    char filename[MAXRBUF];
+    snprintf(filename, MAXRBUF, "%s/%s", UploadSettingsT[UPLOAD_DIR].text, gphoto_get_file_name(gphotodrv));
+
+    auto start = std::chrono::steady_clock::now();
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd == -1)
+    {
+        LOGF_WARN("Cannot save native file %s: %s", filename, strerror(errno));
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < size)
+    {
+        ssize_t n = write(fd, data + written, size - written);
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+                continue;
+            LOGF_WARN("Cannot save native file %s: %s", filename, strerror(errno));
+            close(fd);
+            unlink(filename);
+            return false;
+        }
+        written += n;
+    }
+    close(fd);
+
+    LOGF_DEBUG("Native file saved to %s in %.3f s", filename,
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
 ISwitch * GPhotoCCD::create_switch(const char * basestr, char ** options, int max_opts, int setidx)
 {
     int i;
@@ -1961,7 +2051,8 @@ bool GPhotoCCD::StartStreaming()
 
     if (gphoto_start_preview(gphotodrv) == GP_OK)
     {
-        Streamer->setPixelFormat(INDI_RGB);
+        Streamer->setPixelFormat(liveViewDecodeS[LIVE_VIEW_JPEG].s == ISS_ON ? INDI_JPG : INDI_RGB);
+        liveVideoWidth = liveVideoHeight = -1;
         std::unique_lock<std::mutex> guard(liveStreamMutex);
         m_RunLiveStream = true;
         guard.unlock();
@@ -1996,12 +2087,24 @@ void GPhotoCCD::streamLiveView()
         return;
     }
 
+    // Decoded frames are private to this thread, the CCD buffer is left to captures
+    uint8_t * liveBuffer = nullptr;
+    double fps = 0;
+    auto lastFrame  = std::chrono::steady_clock::now();
+    auto lastReport = lastFrame;
+
     char errMsg[MAXRBUF] = {0};
     while (true)
     {
         std::unique_lock<std::mutex> guard(liveStreamMutex);
         if (m_RunLiveStream == false)
             break;
+        int decode = IUFindOnSwitchIndex(&liveViewDecodeSP);
+        image_window window = { static_cast<int>(liveViewROIN[LIVE_VIEW_ROI_X].value),
+                                static_cast<int>(liveViewROIN[LIVE_VIEW_ROI_Y].value),
+                                static_cast<int>(liveViewROIN[LIVE_VIEW_ROI_W].value),
+                                static_cast<int>(liveViewROIN[LIVE_VIEW_ROI_H].value)
+                              };
         guard.unlock();
 
         rc = gphoto_capture_preview(gphotodrv, previewFile, errMsg);
@@ -2024,68 +2127,82 @@ void GPhotoCCD::streamLiveView()
         }
 
         uint8_t * inBuffer = reinterpret_cast<uint8_t *>(const_cast<char *>(previewData));
+        auto decodeStart = std::chrono::steady_clock::now();
+        double decodeMS = 0;
+        int w = 0, h = 0;
 
-        //        if (streamSubframeS[1].s == ISS_ON)
-        //        {
-        //            if (liveVideoWidth <= 0)
-        //            {
-        //                read_jpeg_size(inBuffer, previewSize, &liveVideoWidth, &liveVideoHeight);
-        //                Streamer->setSize(liveVideoWidth, liveVideoHeight);
-        //            }
-
-        //            std::unique_lock<std::mutex> ccdguard(ccdBufferLock);
-        //            Streamer->newFrame(inBuffer, previewSize);
-        //            ccdguard.unlock();
-        //            continue;
-        //        }
-
-        uint8_t * ccdBuffer      = PrimaryCCD.getFrameBuffer();
-        size_t size             = 0;
-        int w = 0, h = 0, naxis = 0;
-
-        // Read jpeg from memory
-        std::unique_lock<std::mutex> ccdguard(ccdBufferLock);
-        rc = read_jpeg_mem(inBuffer, previewSize, &ccdBuffer, &size, &naxis, &w, &h);
-
-        if (rc != 0)
+        if (decode == LIVE_VIEW_JPEG)
         {
-            LOG_ERROR("Error getting live video frame.");
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
-        }
+            // Nothing to process, the camera JPEG goes to the streamer as is
+            if (liveVideoWidth <= 0)
+            {
+                read_jpeg_size(inBuffer, previewSize, &liveVideoWidth, &liveVideoHeight);
+                Streamer->setSize(liveVideoWidth, liveVideoHeight);
+            }
+            w = liveVideoWidth;
+            h = liveVideoHeight;
+            window = { 0, 0, w, h };
 
-        if (liveVideoWidth <= 0)
-        {
-            liveVideoWidth = w;
-            liveVideoHeight = h;
-            Streamer->setSize(liveVideoWidth, liveVideoHeight);
+            Streamer->newFrame(inBuffer, previewSize);
         }
+        else
+        {
+            // The region is given in full resolution pixels
+            int scale = 1 << (decode - LIVE_VIEW_FULL);
+            window.x /= scale;
+            window.y /= scale;
+            window.w /= scale;
+            window.h /= scale;
+
+            size_t size = 0;
+            int naxis = 0;
+            rc = read_jpeg_mem_scaled(inBuffer, previewSize, scale, &liveBuffer, &size, &naxis, &w, &h, &window);
+            if (rc != 0)
+            {
+                LOG_ERROR("Error getting live video frame.");
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            decodeMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeStart).count();
 
-        PrimaryCCD.setFrameBuffer(ccdBuffer);
+            if (naxis != PrimaryCCD.getNAxis())
+            {
+                if (naxis == 1)
+                    Streamer->setPixelFormat(INDI_MONO);
 
-        // We are done with writing to CCD buffer
-        ccdguard.unlock();
+                PrimaryCCD.setNAxis(naxis);
+            }
 
-        if (naxis != PrimaryCCD.getNAxis())
-        {
-            if (naxis == 1)
-                Streamer->setPixelFormat(INDI_MONO);
+            if (PrimaryCCD.getSubW() != window.w || PrimaryCCD.getSubH() != window.h)
+            {
+                Streamer->setSize(window.w, window.h);
+                PrimaryCCD.setFrame(0, 0, window.w, window.h);
+            }
 
-            PrimaryCCD.setNAxis(naxis);
+            Streamer->newFrame(liveBuffer, size);
         }
 
-        if (PrimaryCCD.getSubW() != w || PrimaryCCD.getSubH() != h)
-        {
-            Streamer->setSize(w, h);
-            PrimaryCCD.setFrame(0, 0, w, h);
-        }
+        auto now = std::chrono::steady_clock::now();
+        double interval = std::chrono::duration<double>(now - lastFrame).count();
+        lastFrame = now;
+        if (interval > 0)
+            fps = (fps > 0) ? fps * 0.9 + 0.1 / interval : 1 / interval;
 
-        if (PrimaryCCD.getFrameBufferSize() != static_cast<int>(size))
-            PrimaryCCD.setFrameBufferSize(size, false);
+        DEBUGF(INDI::Logger::DBG_EXTRA_1, "Live view %dx%d+%d+%d of %dx%d: %.1f fps, decode %.1f ms", window.w, window.h,
+               window.x, window.y, w, h, fps, decodeMS);
 
-        Streamer->newFrame(ccdBuffer, size);
+        // Clients get the figures once a second, not at the frame rate
+        if (now - lastReport >= std::chrono::seconds(1))
+        {
+            lastReport = now;
+            liveViewStatsN[LIVE_VIEW_FPS].value = fps;
+            liveViewStatsN[LIVE_VIEW_DECODE_MS].value = decodeMS;
+            liveViewStatsNP.s = IPS_OK;
+            IDSetNumber(&liveViewStatsNP, nullptr);
+        }
     }
 
+    free(liveBuffer);
     gp_file_unref(previewFile);
 }
 
@@ -2201,6 +2318,13 @@ bool GPhotoCCD::saveConfigItems(FILE * fp)
     // Force BULB Mode
     IUSaveConfigSwitch(fp, &forceBULBSP);
 
+    // Native copy of FITS captures
+    IUSaveConfigSwitch(fp, &keepNativeSP);
+
+    // Live view
+    IUSaveConfigSwitch(fp, &liveViewDecodeSP);
+    IUSaveConfigNumber(fp, &liveViewROINP);
+
     return true;
 }
 
@@ -141,6 +141,7 @@ class GPhotoCCD : public INDI::CCD, public INDI::FocuserInterface
 
         double CalcTimeLeft();
         bool grabImage();
+        bool saveNativeCopy(const char * data, size_t size);
 
         char name[MAXINDIDEVICE];
         char model[MAXINDINAME];
@@ -213,6 +214,36 @@ class GPhotoCCD : public INDI::CCD, public INDI::FocuserInterface
         ISwitch livePreviewS[2];
         ISwitchVectorProperty livePreviewSP;
 
+        // Live view decoding, the camera JPEG is forwarded as is or decoded at a fraction of its size
+        ISwitch liveViewDecodeS[4];
+        ISwitchVectorProperty liveViewDecodeSP;
+        enum
+        {
+            LIVE_VIEW_JPEG,
+            LIVE_VIEW_FULL,
+            LIVE_VIEW_HALF,
+            LIVE_VIEW_QUARTER
+        };
+
+        // Region of the live view to decode, in full resolution pixels, zero size for the whole frame
+        INumber liveViewROIN[4];
+        INumberVectorProperty liveViewROINP;
+        enum
+        {
+            LIVE_VIEW_ROI_X,
+            LIVE_VIEW_ROI_Y,
+            LIVE_VIEW_ROI_W,
+            LIVE_VIEW_ROI_H
+        };
+
+        INumber liveViewStatsN[2];
+        INumberVectorProperty liveViewStatsNP;
+        enum
+        {
+            LIVE_VIEW_FPS,
+            LIVE_VIEW_DECODE_MS
+        };
+
         ISwitch * mExposurePresetS = nullptr;
         ISwitchVectorProperty mExposurePresetSP;
 
@@ -224,6 +255,15 @@ class GPhotoCCD : public INDI::CCD, public INDI::FocuserInterface
             FORCE_BULB_OFF
         };
 
+        // Keep a copy of the native file in the upload directory when transferring FITS
+        ISwitch keepNativeS[2];
+        ISwitchVectorProperty keepNativeSP;
+        enum
+        {
+            KEEP_NATIVE_ON,
+            KEEP_NATIVE_OFF
+        };
+
         // Upload file, used for testing purposes under simulation under native mode
         ITextVectorProperty UploadFileTP;
         IText UploadFileT[1] {};
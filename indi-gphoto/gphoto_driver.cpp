@@ -824,9 +824,15 @@ static int download_image(gphoto_driver *gphoto, CameraFilePath *fn, int fd)
             DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "gp_file_new_from_fd failed (%s)", gp_result_as_string(result));
     }
 
+    struct timeval download_start, download_end, download_time;
+    gettimeofday(&download_start, nullptr);
+
     result = gp_camera_file_get(gphoto->camera, fn->folder, fn->name, GP_FILE_TYPE_NORMAL, gphoto->camerafile,
                                 gphoto->context);
 
+    gettimeofday(&download_end, nullptr);
+    timersub(&download_end, &download_start, &download_time);
+
     //if (!(gphoto->command & DSLR_CMD_ABORT))
     //    DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "Downloading image (%s) in folder (%s)", fn->name, fn->folder);
 
@@ -838,6 +844,9 @@ static int download_image(gphoto_driver *gphoto, CameraFilePath *fn, int fd)
         return result;
     }
 
+    DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "Download of %s took %ld.%03ld s", fn->name,
+                 static_cast<long>(download_time.tv_sec), static_cast<long>(download_time.tv_usec / 1000));
+
     result = gp_camera_file_get_info(gphoto->camera, fn->folder, fn->name, &info, gphoto->context);
 
     if (result == GP_OK)
@@ -2077,6 +2086,11 @@ void gphoto_free_buffer(gphoto_driver *gphoto)
     }
 }
 
+const char *gphoto_get_file_name(gphoto_driver *gphoto)
+{
+    return gphoto->filename;
+}
+
 const char *gphoto_get_file_extension(gphoto_driver *gphoto)
 {
     if (gphoto->filename[0])
@@ -91,6 +91,7 @@ gphoto_driver *gphoto_open(Camera *camera, GPContext *context, const char *model
 int gphoto_close(gphoto_driver *gphoto);
 void gphoto_get_buffer(gphoto_driver *gphoto, const char **buffer, size_t *size);
 void gphoto_free_buffer(gphoto_driver *gphoto);
+const char *gphoto_get_file_name(gphoto_driver *gphoto);
 const char *gphoto_get_file_extension(gphoto_driver *gphoto);
 void gphoto_show_options(gphoto_driver *gphoto);
 gphoto_widget_list *gphoto_find_all_widgets(gphoto_driver *gphoto);
@@ -7,6 +7,7 @@
 #include <fitsio.h>
 #include <libraw.h>
 
+#include <time.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 
@@ -308,77 +309,140 @@ int dcraw_parse_header_info(const char *filename, struct dcraw_header *header)
     return 0;
 }
 
-int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
-                char *bayer_pattern)
+static double elapsed_ms(const struct timespec &start)
 {
-    int ret = 0;
-    // Creation of image processing object
-    LibRaw RawProcessor;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1e3 + (now.tv_nsec - start.tv_nsec) / 1e6;
+}
 
-    // Let us open the file
-    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
+// Clamp the window to the image, or select the whole image if it does not fit
+static void fit_window(image_window *window, int w, int h)
+{
+    if (window->w <= 0 || window->h <= 0 || window->x < 0 || window->y < 0 || window->x + window->w > w ||
+            window->y + window->h > h)
     {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
-        RawProcessor.recycle();
-        return -1;
+        window->x = 0;
+        window->y = 0;
+        window->w = w;
+        window->h = h;
     }
+}
+
+// Copy the window of the visible area out of an unpacked raw, no demosaic and no conversion
+static int copy_libraw(LibRaw &RawProcessor, const char *name, uint8_t **memptr, size_t *memsize, int *n_axis, int *w,
+                       int *h, int *bitsperpixel, char *bayer_pattern, image_window *window)
+{
+    int ret = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
     // Let us unpack the image
     if ((ret = RawProcessor.unpack()) != LIBRAW_SUCCESS)
     {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot unpack %s: %s", filename, libraw_strerror(ret));
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot unpack %s: %s", name, libraw_strerror(ret));
         RawProcessor.recycle();
         return -1;
     }
 
-    // Covert to image
-    if ((ret = RawProcessor.raw2image()) != LIBRAW_SUCCESS)
+    // Only bayer sensors have one value per photosite
+    if (RawProcessor.imgdata.rawdata.raw_image == nullptr)
     {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot convert %s : %s", filename, libraw_strerror(ret));
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot convert %s: not a bayer raw image", name);
         RawProcessor.recycle();
         return -1;
     }
 
+    double unpacked = elapsed_ms(start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
     *n_axis       = 2;
     *w            = RawProcessor.imgdata.rawdata.sizes.width;
     *h            = RawProcessor.imgdata.rawdata.sizes.height;
     *bitsperpixel = 16;
+
+    image_window whole = { 0, 0, 0, 0 };
+    if (window == nullptr)
+        window = &whole;
+    fit_window(window, *w, *h);
+
     // cdesc contains counter-clock wise e.g. RGBG CFA pattern while we want it sequential as RGGB
-    bayer_pattern[0] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(0, 0)];
-    bayer_pattern[1] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(0, 1)];
-    bayer_pattern[2] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(1, 0)];
-    bayer_pattern[3] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(1, 1)];
+    // The pattern is the one of the first pixel of the window
+    bayer_pattern[0] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(window->y, window->x)];
+    bayer_pattern[1] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(window->y, window->x + 1)];
+    bayer_pattern[2] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(window->y + 1, window->x)];
+    bayer_pattern[3] = RawProcessor.imgdata.idata.cdesc[RawProcessor.COLOR(window->y + 1, window->x + 1)];
     bayer_pattern[4] = '\0';
 
-    int first_visible_pixel = RawProcessor.imgdata.rawdata.sizes.raw_width * RawProcessor.imgdata.sizes.top_margin +
-                              RawProcessor.imgdata.sizes.left_margin;
+    int raw_width = RawProcessor.imgdata.rawdata.sizes.raw_width;
+    int first_visible_pixel = raw_width * RawProcessor.imgdata.sizes.top_margin + RawProcessor.imgdata.sizes.left_margin;
 
     DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG,
                  "read_libraw: raw_width: %d top_margin %d left_margin %d first_visible_pixel %d",
-                 RawProcessor.imgdata.rawdata.sizes.raw_width, RawProcessor.imgdata.sizes.top_margin,
+                 raw_width, RawProcessor.imgdata.sizes.top_margin,
                  RawProcessor.imgdata.sizes.left_margin, first_visible_pixel);
 
-    *memsize = RawProcessor.imgdata.rawdata.sizes.width * RawProcessor.imgdata.rawdata.sizes.height * sizeof(uint16_t);
+    *memsize = window->w * window->h * sizeof(uint16_t);
     *memptr  = (uint8_t *)realloc(*memptr, *memsize);
 
     DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG,
-                 "read_libraw: rawdata.sizes.width: %d rawdata.sizes.height %d memsize %d bayer_pattern %s",
-                 RawProcessor.imgdata.rawdata.sizes.width, RawProcessor.imgdata.rawdata.sizes.height, *memsize,
-                 bayer_pattern);
+                 "read_libraw: rawdata.sizes.width: %d rawdata.sizes.height %d window %dx%d+%d+%d memsize %zu bayer_pattern %s",
+                 *w, *h, window->w, window->h, window->x, window->y, *memsize, bayer_pattern);
 
     uint16_t *image = reinterpret_cast<uint16_t *>(*memptr);
-    uint16_t *src   = RawProcessor.imgdata.rawdata.raw_image + first_visible_pixel;
+    uint16_t *src   = RawProcessor.imgdata.rawdata.raw_image + first_visible_pixel + window->y * raw_width + window->x;
 
-    for (int i = 0; i < RawProcessor.imgdata.rawdata.sizes.height; i++)
+    for (int i = 0; i < window->h; i++)
     {
-        memcpy(image, src, RawProcessor.imgdata.rawdata.sizes.width * 2);
-        image += RawProcessor.imgdata.rawdata.sizes.width;
-        src += RawProcessor.imgdata.rawdata.sizes.raw_width;
+        memcpy(image, src, window->w * 2);
+        image += window->w;
+        src += raw_width;
     }
 
+    RawProcessor.recycle();
+
+    DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "read_libraw: unpack %.1f ms, crop %.1f ms", unpacked,
+                 elapsed_ms(start));
+
     return 0;
 }
 
+int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
+                char *bayer_pattern)
+{
+    int ret = 0;
+    // Creation of image processing object
+    LibRaw RawProcessor;
+
+    // Let us open the file
+    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    return copy_libraw(RawProcessor, filename, memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern, nullptr);
+}
+
+int read_libraw_mem(const void *buffer, size_t size, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h,
+                    int *bitsperpixel, char *bayer_pattern, image_window *window)
+{
+    int ret = 0;
+    // Creation of image processing object
+    LibRaw RawProcessor;
+
+    // The buffer is only read, older LibRaw versions just lack the const
+    if ((ret = RawProcessor.open_buffer(const_cast<void *>(buffer), size)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open raw buffer: %s", libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    return copy_libraw(RawProcessor, "raw buffer", memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern, window);
+}
+
 int read_dcraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel)
 {
     struct dcraw_header header;
@@ -546,6 +610,169 @@ int read_jpeg_mem(unsigned char *inBuffer, unsigned long inSize, uint8_t **mempt
     return 0;
 }
 
+int read_jpeg_mem_planar(const void *buffer, size_t size, uint8_t **memptr, size_t *memsize, int *naxis, int *w, int *h,
+                        image_window *window)
+{
+    /* these are standard libjpeg structures for reading(decompression) */
+    struct jpeg_decompress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    /* libjpeg data structure for storing one row, that is, scanline of an image */
+    JSAMPROW row_pointer[1] = { nullptr };
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* here we set up the standard libjpeg error handler */
+    cinfo.err = jpeg_std_error(&jerr);
+    /* setup decompression process and source, then read JPEG header */
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, static_cast<unsigned char *>(const_cast<void *>(buffer)), size);
+
+    /* reading the image header which contains image information */
+    jpeg_read_header(&cinfo, (boolean)TRUE);
+
+    /* Start decompression jpeg here */
+    jpeg_start_decompress(&cinfo);
+
+    *naxis = cinfo.num_components;
+    *w     = cinfo.output_width;
+    *h     = cinfo.output_height;
+
+    image_window whole = { 0, 0, 0, 0 };
+    if (window == nullptr)
+        window = &whole;
+    fit_window(window, *w, *h);
+
+    // One plane per component, holding the window only
+    size_t plane = window->w * window->h;
+    *memsize = plane * cinfo.num_components;
+    *memptr  = (uint8_t *)realloc(*memptr, *memsize);
+
+    row_pointer[0] = (unsigned char *)malloc(cinfo.output_width * cinfo.num_components);
+
+    /* rows below the window are never decoded */
+    for (int row = 0; row < window->y + window->h; row++)
+    {
+        jpeg_read_scanlines(&cinfo, row_pointer, 1);
+        if (row < window->y)
+            continue;
+
+        const unsigned char *src = row_pointer[0] + window->x * cinfo.num_components;
+        size_t offset = (row - window->y) * window->w;
+        if (cinfo.num_components == 3)
+        {
+            uint8_t *r_data = *memptr + offset;
+            uint8_t *g_data = r_data + plane;
+            uint8_t *b_data = g_data + plane;
+            for (int i = 0; i < window->w; i++)
+            {
+                *r_data++ = *src++;
+                *g_data++ = *src++;
+                *b_data++ = *src++;
+            }
+        }
+        else
+            memcpy(*memptr + offset, src, window->w);
+    }
+
+    /* the remaining rows are dropped, which finish would complain about */
+    if (cinfo.output_scanline < cinfo.output_height)
+        jpeg_abort_decompress(&cinfo);
+    else
+        jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    if (row_pointer[0])
+        free(row_pointer[0]);
+
+    DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "read_jpeg_mem_planar: %dx%d window %dx%d+%d+%d decoded in %.1f ms",
+                 *w, *h, window->w, window->h, window->x, window->y, elapsed_ms(start));
+
+    return 0;
+}
+
+int read_jpeg_mem_scaled(const void *buffer, size_t size, int scale, uint8_t **memptr, size_t *memsize, int *naxis, int *w,
+                        int *h, image_window *window)
+{
+    /* these are standard libjpeg structures for reading(decompression) */
+    struct jpeg_decompress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    /* libjpeg data structure for storing one row, that is, scanline of an image */
+    JSAMPROW row_pointer[1] = { nullptr };
+
+    /* here we set up the standard libjpeg error handler */
+    cinfo.err = jpeg_std_error(&jerr);
+    /* setup decompression process and source, then read JPEG header */
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, static_cast<unsigned char *>(const_cast<void *>(buffer)), size);
+
+    /* reading the image header which contains image information */
+    jpeg_read_header(&cinfo, (boolean)TRUE);
+
+    // Scaling happens in the inverse DCT, a 1/2 decode costs about a quarter of a full one
+    // Preview quality is enough here, so trade accuracy for speed
+    cinfo.scale_num           = 1;
+    cinfo.scale_denom         = scale;
+    cinfo.dct_method          = JDCT_IFAST;
+    cinfo.do_fancy_upsampling = FALSE;
+
+    /* Start decompression jpeg here */
+    jpeg_start_decompress(&cinfo);
+
+    int components = cinfo.output_components;
+    *naxis = cinfo.num_components;
+    *w     = cinfo.output_width;
+    *h     = cinfo.output_height;
+
+    image_window whole = { 0, 0, 0, 0 };
+    if (window == nullptr)
+        window = &whole;
+    fit_window(window, *w, *h);
+
+    size_t stride = window->w * components;
+    *memsize = stride * window->h;
+    *memptr  = (uint8_t *)realloc(*memptr, *memsize);
+
+    // Column of the window in the decoded rows
+    int first = window->x;
+#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+    // Only the iMCU columns and the rows of the window are decoded
+    if (window->w < *w)
+    {
+        JDIMENSION xoffset = window->x, width = window->w;
+        jpeg_crop_scanline(&cinfo, &xoffset, &width);
+        first = window->x - xoffset;
+    }
+    if (window->y > 0)
+        jpeg_skip_scanlines(&cinfo, window->y);
+    row_pointer[0] = (unsigned char *)malloc(cinfo.output_width * components);
+#else
+    row_pointer[0] = (unsigned char *)malloc(cinfo.output_width * components);
+    for (int row = 0; row < window->y; row++)
+        jpeg_read_scanlines(&cinfo, row_pointer, 1);
+#endif
+
+    uint8_t *destmem = *memptr;
+    for (int row = 0; row < window->h; row++)
+    {
+        jpeg_read_scanlines(&cinfo, row_pointer, 1);
+        memcpy(destmem, row_pointer[0] + first * components, stride);
+        destmem += stride;
+    }
+
+    /* the remaining rows are dropped, which finish would complain about */
+    if (cinfo.output_scanline < cinfo.output_height)
+        jpeg_abort_decompress(&cinfo);
+    else
+        jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    if (row_pointer[0])
+        free(row_pointer[0]);
+
+    return 0;
+}
+
 int read_jpeg_size(unsigned char *inBuffer, unsigned long inSize, int *w, int *h)
 {
     /* these are standard libjpeg structures for reading(decompression) */
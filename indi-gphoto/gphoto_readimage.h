@@ -4,11 +4,27 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/**
+ * Part of the visible image to decode, x and y from the top left corner.
+ * An empty window, or one reaching out of the image, selects the whole image.
+ * On return it holds the area actually decoded.
+ */
+typedef struct
+{
+    int x, y, w, h;
+} image_window;
+
 int read_dcraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel);
 int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
                 char *bayer_pattern);
+int read_libraw_mem(const void *buffer, size_t size, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h,
+                    int *bitsperpixel, char *bayer_pattern, image_window *window);
 int read_jpeg(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h);
 int read_jpeg_mem(unsigned char *inBuffer, unsigned long inSize, uint8_t **memptr, size_t *memsize, int *naxis, int *w,
                   int *h);
+int read_jpeg_mem_planar(const void *buffer, size_t size, uint8_t **memptr, size_t *memsize, int *naxis, int *w, int *h,
+                        image_window *window);
+int read_jpeg_mem_scaled(const void *buffer, size_t size, int scale, uint8_t **memptr, size_t *memsize, int *naxis, int *w,
+                        int *h, image_window *window);
 int read_jpeg_size(unsigned char *inBuffer, unsigned long inSize, int *w, int *h);
 void gphoto_read_set_debug(const char *name);
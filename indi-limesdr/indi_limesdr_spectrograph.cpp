@@ -23,6 +23,8 @@
 #include <unistd.h>
 #include <indilogger.h>
 #include <memory>
+#include <vector>
+#include <chrono>
 
 #define min(a, b)               \
     ({                          \
@@ -36,6 +38,8 @@
 #define MIN_FRAME_SIZE (512)
 #define MAX_FRAME_SIZE (SUBFRAME_SIZE * 16)
 #define SPECTRUM_SIZE  (256)
+// Receiver FIFO, in chunks
+#define FIFO_CHUNKS    (8)
 
 static int iNumofConnectedSpectrographs;
 static LIMESDR *receivers[MAX_DEVICES];
@@ -187,6 +191,12 @@ LIMESDR::LIMESDR(uint32_t index)
 ***************************************************************************************/
 bool LIMESDR::Connect()
 {
+    if (isSimulation())
+    {
+        LOG_INFO("LIME-SDR Spectrograph simulator connected, receiving a synthetic tone.");
+        return true;
+    }
+
     int r = LMS_Open(&lime_dev, lime_dev_list[spectrographIndex], NULL);
     if (r < 0)
     {
@@ -209,7 +219,9 @@ bool LIMESDR::Connect()
 bool LIMESDR::Disconnect()
 {
     InIntegration = false;
-    LMS_Close(lime_dev);
+    stopAcquisition();
+    if (!isSimulation())
+        LMS_Close(lime_dev);
     setBufferSize(1);
     LOG_INFO("LIME-SDR Spectrograph disconnected successfully!");
     return true;
@@ -242,6 +254,13 @@ bool LIMESDR::initProperties()
     setMinMaxStep("SPECTROGRAPH_SETTINGS", "SPECTROGRAPH_BANDWIDTH", 400.0e+6, 3.8e+9, 1, false);
     setMinMaxStep("SPECTROGRAPH_SETTINGS", "SPECTROGRAPH_BITSPERSAMPLE", -32, -32, 0, false);
     setIntegrationFileExtension("fits");
+
+    // The receive stream, integrations and streamed frames are spectra of FFT size bins
+    IUFillNumber(&StreamN[0], "STREAM_FFT_SIZE", "FFT size", "%.f", 64, 65536, 64, 1024);
+    IUFillNumber(&StreamN[1], "STREAM_CHUNK_SIZE", "Chunk (samples)", "%.f", 1024, 1048576, 1024, SUBFRAME_SIZE);
+    IUFillNumber(&StreamN[2], "STREAM_INTERVAL", "Stream interval (s)", "%.2f", 0.05, 3600, 0.05, 1);
+    IUFillNumberVector(&StreamNP, StreamN, 3, getDeviceName(), "LIME_STREAM", "Receive stream", MAIN_CONTROL_TAB, IP_RW, 60,
+                       IPS_IDLE);
     /*
     // PrimarySpectrograph Device Continuum Blob
     IUFillBLOB(&TFitsB[0], "TRMT", "Transmit1", "");
@@ -273,6 +292,8 @@ bool LIMESDR::updateProperties()
         // Inital values
         setupParams(1000000, 1420000000, 10000, 10);
         //defineBLOB(&TFitsBP);
+        defineNumber(&StreamNP);
+        StreamNP.s = (startAcquisition() ? IPS_OK : IPS_ALERT);
 
         // Start the timer
         SetTimer(POLLMS);
@@ -280,6 +301,7 @@ bool LIMESDR::updateProperties()
     else
     {
         //deleteProperty(TFitsBP.name);
+        deleteProperty(StreamNP.name);
     }
 
     return true;
@@ -288,34 +310,143 @@ bool LIMESDR::updateProperties()
 /**************************************************************************************
 ** Client is asking us to start an exposure
 ***************************************************************************************/
-bool LIMESDR::StartIntegration(float duration)
+bool LIMESDR::StartIntegration(double duration)
 {
+    std::lock_guard<std::mutex> lock(integrationMutex);
+    if (!acquisition.joinable())
+    {
+        LOG_ERROR("The receiver is not streaming.");
+        return false;
+    }
+
     IntegrationRequest = duration;
 
     // Since we have only have one Spectrograph with one chip, we set the exposure duration of the primary Spectrograph
     setIntegrationTime(duration);
-    b_read  = 0;
-    to_read = getSampleRate() * getIntegrationTime();
 
-    setBufferSize(to_read * sizeof(float));
+    // The integration is the power spectrum averaged over its samples, whatever its duration
+    int bins = static_cast<int>(StreamN[0].value);
+    if (integration == nullptr || integration->bins() != bins)
+        integration.reset(new SpectrumAccumulator(bins));
+    integration->reset();
+    integrationSamples = static_cast<uint64_t>(getSampleRate() * duration);
+    if (integrationSamples < static_cast<uint64_t>(integration->bins()))
+        integrationSamples = static_cast<uint64_t>(integration->bins());
+    setBufferSize(integration->bins() * sizeof(float));
+
+    gettimeofday(&CapStart, nullptr);
+    InIntegration = true;
+    LOG_INFO("Integration started...");
+    return true;
+}
+
+/**************************************************************************************
+** Receive stream, read in chunks from connection to disconnection
+***************************************************************************************/
+bool LIMESDR::startAcquisition()
+{
+    if (isSimulation())
+    {
+        double rate = (getSampleRate() > 0 ? getSampleRate() : 1000000);
+        // A tone an eighth of the band above the center frequency
+        source.reset(new SyntheticSource(rate, rate / 8));
+    }
+    else
+        source.reset(new LimeSource(lime_dev, static_cast<int>(StreamN[1].value) * FIFO_CHUNKS));
 
-    if (to_read > 0)
+    if (!source->start())
     {
-        lime_stream.channel             = 0;
-        lime_stream.isTx                = false;
-        lime_stream.fifoSize            = to_read;
-        lime_stream.dataFmt             = lms_stream_t::LMS_FMT_F32;
-        lime_stream.throughputVsLatency = 0.5;
-        LMS_SetupStream(lime_dev, &lime_stream);
-        LMS_StartStream(&lime_stream);
-        gettimeofday(&CapStart, nullptr);
-        InIntegration = true;
-        LOG_INFO("Integration started...");
-        return true;
+        LOG_ERROR("Failed to start the receive stream.");
+        source.reset();
+        return false;
+    }
+    terminateThread = false;
+    acquisition     = std::thread(&LIMESDR::acquisitionLoop, this);
+    return true;
+}
+
+void LIMESDR::stopAcquisition()
+{
+    terminateThread = true;
+    if (acquisition.joinable())
+        acquisition.join();
+    source.reset();
+}
+
+void LIMESDR::acquisitionLoop()
+{
+    int chunk = static_cast<int>(StreamN[1].value);
+    std::vector<float> iq(static_cast<size_t>(chunk) * 2);
+    SpectrumAccumulator continuous(static_cast<int>(StreamN[0].value));
+    std::vector<float> spectrum(static_cast<size_t>(continuous.bins()));
+    std::chrono::duration<double> interval(StreamN[2].value);
+    auto published = std::chrono::steady_clock::now();
+
+    while (!terminateThread)
+    {
+        int n = source->read(iq.data(), chunk, 1000);
+        if (n < 0)
+        {
+            LOG_ERROR("Receive stream failed.");
+            break;
+        }
+        if (n == 0)
+            continue;
+
+        integrate(iq.data(), n);
+
+        if (!streaming)
+        {
+            if (continuous.samples() > 0)
+                continuous.reset();
+            continue;
+        }
+        // Each frame is the average since the previous one
+        continuous.add(iq.data(), static_cast<size_t>(n));
+        auto now = std::chrono::steady_clock::now();
+        if (now - published >= interval && continuous.frames() > 0)
+        {
+            continuous.average(spectrum.data());
+            Streamer->newFrame(reinterpret_cast<const uint8_t *>(spectrum.data()), spectrum.size() * sizeof(float));
+            continuous.reset();
+            published = now;
+        }
+    }
+
+    if (InIntegration)
+    {
+        LOG_ERROR("Integration aborted.");
+        AbortIntegration();
     }
+}
+
+void LIMESDR::integrate(const float *iq, int samples)
+{
+    std::lock_guard<std::mutex> lock(integrationMutex);
+    if (!InIntegration)
+        return;
+
+    uint64_t left = integrationSamples - integration->samples();
+    integration->add(iq, min(static_cast<uint64_t>(samples), left));
+    if (integration->samples() < integrationSamples)
+        return;
+
+    integration->average(reinterpret_cast<float *>(getBuffer()));
+    InIntegration = false;
+    LOGF_INFO("Download complete, %llu spectra averaged.", static_cast<unsigned long long>(integration->frames()));
+    IntegrationComplete();
+}
 
-    // We're done
-    return false;
+bool LIMESDR::StartStreaming()
+{
+    streaming = true;
+    return true;
+}
+
+bool LIMESDR::StopStreaming()
+{
+    streaming = false;
+    return true;
 }
 
 /**************************************************************************************
@@ -324,6 +455,11 @@ bool LIMESDR::StartIntegration(float duration)
 void LIMESDR::setupParams(float sr, float freq, float bw, float gain)
 {
     setBPS(-32);
+    if (source != nullptr)
+        source->setSampleRate(sr);
+    if (isSimulation())
+        return;
+
     int r = 0;
     r |= LMS_SetAntenna(lime_dev, LMS_CH_RX, 0, 0);
     r |= LMS_SetNormalizedGain(lime_dev, LMS_CH_RX, 0, gain);
@@ -340,6 +476,23 @@ void LIMESDR::setupParams(float sr, float freq, float bw, float gain)
 bool LIMESDR::ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n)
 {
     bool r = false;
+    if (dev && !strcmp(dev, getDeviceName()) && !strcmp(name, StreamNP.name)) {
+        if (InIntegration) {
+            LOG_WARN("Wait for the integration to complete before changing the receive stream.");
+            StreamNP.s = IPS_ALERT;
+            IDSetNumber(&StreamNP, nullptr);
+            return false;
+        }
+        IUUpdateNumber(&StreamNP, values, names, n);
+        StreamNP.s = IPS_OK;
+        if (isConnected()) {
+            stopAcquisition();
+            if (!startAcquisition())
+                StreamNP.s = IPS_ALERT;
+        }
+        IDSetNumber(&StreamNP, nullptr);
+        return true;
+    }
     if (dev && !strcmp(dev, getDeviceName()) && !strcmp(name, SpectrographSettingsNP.name)) {
         for(int i = 0; i < n; i++) {
             if (!strcmp(names[i], "SPECTROGRAPH_GAIN")) {
@@ -362,17 +515,8 @@ bool LIMESDR::ISNewNumber(const char *dev, const char *name, double values[], ch
 ***************************************************************************************/
 bool LIMESDR::AbortIntegration()
 {
-    if (InIntegration)
-    {
-        lms_stream_status_t status;
-        LMS_GetStreamStatus(&lime_stream, &status);
-        if (status.fifoFilledCount <= 0)
-        {
-            InIntegration = false;
-            LMS_StopStream(&lime_stream);
-            LMS_DestroyStream(lime_dev, &lime_stream);
-        }
-    }
+    std::lock_guard<std::mutex> lock(integrationMutex);
+    InIntegration = false;
     return true;
 }
 
@@ -406,23 +550,10 @@ void LIMESDR::TimerHit()
 
     if (InIntegration)
     {
+        // The receive thread completes the integration once it has all the samples
         timeleft = CalcTimeLeft();
-        if (timeleft < 0.1)
-        {
-            /* We're done capturing */
-            LOG_INFO("Integration done, expecting data...");
-            lms_stream_status_t status;
-            LMS_GetStreamStatus(&lime_stream, &status);
-            if (status.active)
-            {
-                if (status.fifoFilledCount >= status.fifoSize)
-                {
-                    n_read = status.fifoFilledCount;
-                    grabData();
-                }
-            }
+        if (timeleft < 0.0)
             timeleft = 0.0;
-        }
 
         // This is an over simplified timing method, check SpectrographSimulator and limesdrSpectrograph for better timing checks
         setIntegrationLeft(timeleft);
@@ -431,22 +562,3 @@ void LIMESDR::TimerHit()
     SetTimer(POLLMS);
     return;
 }
-
-/**************************************************************************************
-** Create the spectrum
-***************************************************************************************/
-void LIMESDR::grabData()
-{
-    if (InIntegration)
-    {
-        continuum = getBuffer();
-        LOG_INFO("Downloading...");
-        LMS_RecvStream(&lime_stream, continuum, n_read, NULL, 1000);
-        LMS_StopStream(&lime_stream);
-        LMS_DestroyStream(lime_dev, &lime_stream);
-        InIntegration = false;
-
-        LOG_INFO("Download complete.");
-        IntegrationComplete();
-    }
-}
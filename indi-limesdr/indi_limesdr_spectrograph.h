@@ -21,6 +21,13 @@
 
 #include <lime/LimeSuite.h>
 #include "indispectrograph.h"
+#include "samplesource.h"
+#include "spectrumaccumulator.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 enum Settings
 {
@@ -45,29 +52,44 @@ class LIMESDR : public INDI::Spectrograph
 	bool updateProperties();
 
     // Spectrograph specific functions
-    bool StartIntegration(float duration);
+    bool StartIntegration(double duration);
     bool paramsUpdated(float sr, float freq, float bps, float bw, float gain);
     bool AbortIntegration();
     void TimerHit();
 
-    void grabData();
+    bool StartStreaming();
+    bool StopStreaming();
 
   private:
     lms_device_t *lime_dev = { nullptr };
 	// Utility functions
 	float CalcTimeLeft();
     void setupParams(float sr, float freq, float bw, float gain);
-    lms_stream_t lime_stream;
+
+    // Receive thread, runs from connection to disconnection
+    bool startAcquisition();
+    void stopAcquisition();
+    void acquisitionLoop();
+    void integrate(const float *iq, int samples);
+
 	// Are we exposing?
-    bool InIntegration;
+    std::atomic<bool> InIntegration;
 	// Struct to keep timing
 	struct timeval CapStart;
-    int to_read;
-    int b_read;
-    int n_read;
     float IntegrationRequest;
-	uint8_t* continuum;
-    uint8_t *spectrum;
+
+    std::unique_ptr<SampleSource> source;
+    std::thread acquisition;
+    std::atomic<bool> terminateThread { false };
+    std::atomic<bool> streaming { false };
+
+    // Integration state, shared with the receive thread
+    std::mutex integrationMutex;
+    std::unique_ptr<SpectrumAccumulator> integration;
+    uint64_t integrationSamples { 0 };
+
+    INumber StreamN[3];
+    INumberVectorProperty StreamNP;
 
     uint32_t spectrographIndex = { 0 };
 
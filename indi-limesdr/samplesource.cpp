@@ -0,0 +1,101 @@
+/*
+    indi_limesdr_spectrograph - a software defined radio driver for INDI
+    Copyright (C) 2017  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "samplesource.h"
+
+#include <cmath>
+#include <thread>
+
+bool LimeSource::start()
+{
+    stop();
+    stream.channel             = 0;
+    stream.isTx                = false;
+    stream.fifoSize            = static_cast<uint32_t>(fifoSize);
+    stream.dataFmt             = lms_stream_t::LMS_FMT_F32;
+    stream.throughputVsLatency = 0.5;
+    if (LMS_SetupStream(device, &stream) != 0)
+        return false;
+    if (LMS_StartStream(&stream) != 0)
+    {
+        LMS_DestroyStream(device, &stream);
+        return false;
+    }
+    running = true;
+    return true;
+}
+
+void LimeSource::stop()
+{
+    if (!running)
+        return;
+    LMS_StopStream(&stream);
+    LMS_DestroyStream(device, &stream);
+    running = false;
+}
+
+int LimeSource::read(float *iq, int samples, int timeout)
+{
+    lms_stream_meta_t meta;
+    return LMS_RecvStream(&stream, iq, static_cast<size_t>(samples), &meta, static_cast<unsigned>(timeout));
+}
+
+bool SyntheticSource::start()
+{
+    restart = true;
+    return true;
+}
+
+void SyntheticSource::setSampleRate(double value)
+{
+    rate    = value;
+    restart = true;
+}
+
+int SyntheticSource::read(float *iq, int samples, int timeout)
+{
+    double r = rate;
+    auto now = std::chrono::steady_clock::now();
+    if (restart.exchange(false))
+    {
+        started   = now;
+        delivered = 0;
+    }
+
+    // Delivered at the sample rate, like the receiver
+    auto due = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>((delivered + samples) / r));
+    auto limit = now + std::chrono::milliseconds(timeout);
+    if (due > limit)
+    {
+        std::this_thread::sleep_until(limit);
+        return 0;
+    }
+    std::this_thread::sleep_until(due);
+
+    double step = 2.0 * M_PI * tone / r;
+    for (int i = 0; i < samples; i++)
+    {
+        iq[i * 2]     = static_cast<float>(amplitude * cos(phase)) + gauss(generator);
+        iq[i * 2 + 1] = static_cast<float>(amplitude * sin(phase)) + gauss(generator);
+        phase = fmod(phase + step, 2.0 * M_PI);
+    }
+    delivered += samples;
+    return samples;
+}
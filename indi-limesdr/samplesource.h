@@ -0,0 +1,87 @@
+/*
+    indi_limesdr_spectrograph - a software defined radio driver for INDI
+    Copyright (C) 2017  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <lime/LimeSuite.h>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+
+/**
+ * @brief Source of interleaved I/Q float samples, read in chunks by the receive thread.
+ */
+class SampleSource
+{
+    public:
+        virtual ~SampleSource() {}
+
+        virtual bool start() = 0;
+        virtual void stop() = 0;
+        /** Read up to samples I/Q pairs, returns the pairs read, 0 on timeout or -1 on error. */
+        virtual int read(float *iq, int samples, int timeout) = 0;
+        virtual void setSampleRate(double rate) { (void)rate; }
+};
+
+/**
+ * @brief RX channel 0 of a LimeSDR, with a FIFO of a few chunks.
+ */
+class LimeSource : public SampleSource
+{
+    public:
+        LimeSource(lms_device_t *device, int fifoSize) : device(device), fifoSize(fifoSize) {}
+        ~LimeSource() { stop(); }
+
+        bool start() override;
+        void stop() override;
+        int read(float *iq, int samples, int timeout) override;
+
+    private:
+        lms_device_t *device;
+        int fifoSize;
+        lms_stream_t stream {};
+        bool running { false };
+};
+
+/**
+ * @brief Tone in gaussian noise delivered at the sample rate, for the simulator.
+ */
+class SyntheticSource : public SampleSource
+{
+    public:
+        SyntheticSource(double rate, double tone, double amplitude = 1.0, double noise = 0.1)
+            : rate(rate), tone(tone), amplitude(amplitude), gauss(0.0, noise) {}
+
+        bool start() override;
+        void stop() override {}
+        int read(float *iq, int samples, int timeout) override;
+        void setSampleRate(double value) override;
+
+    private:
+        std::atomic<double> rate;
+        std::atomic<bool> restart { true };
+        double tone;
+        double amplitude;
+        double phase { 0 };
+        std::mt19937 generator;
+        std::normal_distribution<float> gauss;
+        std::chrono::steady_clock::time_point started;
+        double delivered { 0 };
+};
@@ -0,0 +1,116 @@
+/*
+    indi_limesdr_spectrograph - a software defined radio driver for INDI
+    Copyright (C) 2017  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "spectrumaccumulator.h"
+
+#include <cmath>
+#include <algorithm>
+
+SpectrumAccumulator::SpectrumAccumulator(int bins)
+{
+    int bits = 0;
+    while (size < bins)
+    {
+        size <<= 1;
+        bits++;
+    }
+
+    window.resize(size);
+    windowPower = 0;
+    for (int i = 0; i < size; i++)
+    {
+        window[i] = static_cast<float>(0.5 - 0.5 * cos(2.0 * M_PI * i / size));
+        windowPower += static_cast<double>(window[i]) * window[i];
+    }
+
+    twiddle.resize(size / 2 + 1);
+    for (int i = 0; i < size / 2; i++)
+        twiddle[i] = std::polar(1.0f, static_cast<float>(-2.0 * M_PI * i / size));
+
+    // Samples are stored bit reversed as they arrive, the transform runs in place
+    reversed.resize(size);
+    for (int i = 0; i < size; i++)
+    {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        reversed[i] = r;
+    }
+
+    frame.resize(size);
+    power.resize(size);
+    reset();
+}
+
+void SpectrumAccumulator::reset()
+{
+    std::fill(power.begin(), power.end(), 0.0);
+    filled = 0;
+    count  = 0;
+    total  = 0;
+}
+
+void SpectrumAccumulator::add(const float *iq, size_t samples)
+{
+    total += samples;
+    while (samples > 0)
+    {
+        size_t n = std::min(samples, static_cast<size_t>(size - filled));
+        for (size_t i = 0; i < n; i++, filled++)
+            frame[reversed[filled]] = std::complex<float>(iq[i * 2], iq[i * 2 + 1]) * window[filled];
+        iq += n * 2;
+        samples -= n;
+
+        if (filled == size)
+        {
+            transform();
+            // DC in the middle
+            for (int i = 0; i < size; i++)
+                power[(i + size / 2) & (size - 1)] += std::norm(frame[i]);
+            filled = 0;
+            count++;
+        }
+    }
+}
+
+void SpectrumAccumulator::transform()
+{
+    for (int len = 2; len <= size; len <<= 1)
+    {
+        int half = len / 2;
+        int step = size / len;
+        for (int i = 0; i < size; i += len)
+        {
+            for (int j = 0; j < half; j++)
+            {
+                std::complex<float> u = frame[i + j];
+                std::complex<float> v = frame[i + j + half] * twiddle[j * step];
+                frame[i + j]        = u + v;
+                frame[i + j + half] = u - v;
+            }
+        }
+    }
+}
+
+void SpectrumAccumulator::average(float *spectrum) const
+{
+    double scale = (count > 0 ? 1.0 / (windowPower * count) : 0.0);
+    for (int i = 0; i < size; i++)
+        spectrum[i] = static_cast<float>(power[i] * scale);
+}
@@ -0,0 +1,66 @@
+/*
+    indi_limesdr_spectrograph - a software defined radio driver for INDI
+    Copyright (C) 2017  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Averaged power spectrum of a stream of interleaved I/Q float samples.
+ * Samples are cut into consecutive frames of bins samples, each frame is Hann windowed and
+ * transformed, and its power is added to the running sum. Memory does not depend on how many
+ * samples are added: one frame and one sum of bins values.
+ */
+class SpectrumAccumulator
+{
+    public:
+        /** bins is rounded up to a power of two. */
+        explicit SpectrumAccumulator(int bins);
+
+        int bins() const { return size; }
+
+        /** Add samples I/Q pairs, a partial frame is kept for the next call. */
+        void add(const float *iq, size_t samples);
+
+        /** Frames summed, and samples added including the partial frame. */
+        uint64_t frames() const { return count; }
+        uint64_t samples() const { return total; }
+
+        /** Mean power of the frames, bins values from -fs/2 to fs/2, zeros if no frame completed. */
+        void average(float *spectrum) const;
+
+        void reset();
+
+    private:
+        void transform();
+
+        int size { 1 };
+        std::vector<float> window;
+        std::vector<std::complex<float>> twiddle;
+        std::vector<uint32_t> reversed;
+        std::vector<std::complex<float>> frame;
+        std::vector<double> power;
+        double windowPower { 1.0 };
+        int filled { 0 };
+        uint64_t count { 0 };
+        uint64_t total { 0 };
+};
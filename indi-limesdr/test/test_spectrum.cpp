@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "samplesource.h"
+#include "spectrumaccumulator.h"
+
+// Integration path against the synthetic tone, no receiver needed.
+
+static const int BINS       = 1024;
+static const double RATE    = 4.0e6;
+static const double NOISE   = 0.1;
+
+// Averaged spectrum of frames FFTs of the synthetic source
+static std::vector<float> integrate(double tone, double amplitude, int frames)
+{
+    SyntheticSource source(RATE, tone, amplitude, NOISE);
+    SpectrumAccumulator accumulator(BINS);
+    std::vector<float> iq(BINS * 2 * 8);
+    std::vector<float> spectrum(BINS);
+
+    EXPECT_TRUE(source.start());
+    uint64_t wanted = static_cast<uint64_t>(BINS) * frames;
+    while (accumulator.samples() < wanted)
+    {
+        int n = source.read(iq.data(), static_cast<int>(std::min<uint64_t>(iq.size() / 2, wanted - accumulator.samples())),
+                            1000);
+        EXPECT_GE(n, 0);
+        accumulator.add(iq.data(), n);
+    }
+
+    EXPECT_EQ(accumulator.frames(), static_cast<uint64_t>(frames));
+    accumulator.average(spectrum.data());
+    return spectrum;
+}
+
+TEST(SpectrumAccumulatorTest, SyntheticTonePeak)
+{
+    // A tone on a bin centre, DC is in the middle of the spectrum
+    double tone = RATE / 8;
+    std::vector<float> spectrum = integrate(tone, 1.0, 64);
+    int peak = static_cast<int>(std::max_element(spectrum.begin(), spectrum.end()) - spectrum.begin());
+    EXPECT_EQ(peak, BINS / 2 + BINS / 8);
+
+    // Hann windowed tone: A^2 (sum w)^2 / sum w^2 = 2N/3 in the peak, a quarter of it either side
+    double expected = 2.0 * BINS / 3.0;
+    EXPECT_NEAR(spectrum[peak], expected, expected * 0.01);
+    EXPECT_NEAR(spectrum[peak - 1], expected / 4, expected / 4 * 0.02);
+    EXPECT_NEAR(spectrum[peak + 1], expected / 4, expected / 4 * 0.02);
+
+    // Away from the tone the average is the noise power of both components
+    double floor = 0;
+    int count    = 0;
+    for (int i = 0; i < BINS / 4; i++, count++)
+        floor += spectrum[i];
+    EXPECT_NEAR(floor / count, 2 * NOISE * NOISE, 2 * NOISE * NOISE * 0.1);
+}
+
+TEST(SpectrumAccumulatorTest, NegativeToneAndReset)
+{
+    SyntheticSource source(RATE, -RATE / 4, 0.5, NOISE);
+    SpectrumAccumulator accumulator(BINS);
+    std::vector<float> iq(BINS * 2);
+    std::vector<float> spectrum(BINS);
+
+    // A partial frame is kept, not averaged
+    ASSERT_EQ(source.read(iq.data(), BINS / 2, 1000), BINS / 2);
+    accumulator.add(iq.data(), BINS / 2);
+    EXPECT_EQ(accumulator.frames(), 0u);
+    accumulator.average(spectrum.data());
+    EXPECT_EQ(*std::max_element(spectrum.begin(), spectrum.end()), 0.0f);
+
+    accumulator.reset();
+    for (int f = 0; f < 16; f++)
+    {
+        ASSERT_EQ(source.read(iq.data(), BINS, 1000), BINS);
+        accumulator.add(iq.data(), BINS);
+    }
+    EXPECT_EQ(accumulator.frames(), 16u);
+    EXPECT_EQ(accumulator.samples(), 16u * BINS);
+
+    accumulator.average(spectrum.data());
+    int peak = static_cast<int>(std::max_element(spectrum.begin(), spectrum.end()) - spectrum.begin());
+    EXPECT_EQ(peak, BINS / 2 - BINS / 4);
+    double expected = 0.25 * 2.0 * BINS / 3.0;
+    EXPECT_NEAR(spectrum[peak], expected, expected * 0.02);
+}
@@ -31,6 +31,7 @@
 #include <assert.h>
 #include <cstdint>
 #include <cstdlib>
+#include <thread>
 #include <bcm_host.h>
 
 #include "mmalexception.h"
@@ -94,6 +95,8 @@ bool MMALDriver::saveConfigItems(FILE * fp)
     // Gain Settings
     IUSaveConfigNumber(fp, &mGainNP);
 
+    IUSaveConfigNumber(fp, &mDecodeThreadsNP);
+
     return true;
 }
 
@@ -126,6 +129,11 @@ void MMALDriver::addFITSKeywords(fitsfile * fptr, INDI::CCDChip * targetChip)
 void MMALDriver::capture_complete()
 {
     LOGF_DEBUG("%s", __FUNCTION__);
+    if (decode_pipe)
+    {
+        LOGF_DEBUG("%s: decode %.1f ms on the buffer callback, %u threads", __FUNCTION__,
+                   decode_pipe->get_busy_time().count() * 1000, decode_pipe->get_threads());
+    }
     exposure_thread_done = true;
 }
 
@@ -211,6 +219,11 @@ bool MMALDriver::initProperties()
     IUFillNumber(&mGainN[0], "GAIN", "Gain", "%.f", 1, 16.0, 1, 1);
     IUFillNumberVector(&mGainNP, mGainN, 1, getDeviceName(), "CCD_GAIN", "Gain", IMAGE_SETTINGS_TAB, IP_RW, 60, IPS_IDLE);
 
+    // Threads unpacking the RAW data, 1 unpacks on the MMAL buffer callback.
+    unsigned int cores = std::max(1U, std::thread::hardware_concurrency());
+    IUFillNumber(&mDecodeThreadsN[0], "THREADS", "Threads", "%.f", 1, 8, 1, std::min(4U, cores));
+    IUFillNumberVector(&mDecodeThreadsNP, mDecodeThreadsN, 1, getDeviceName(), "DECODE_THREADS", "Decode", OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
+
     addDebugControl();
 
     SetCCDCapability(0
@@ -251,6 +264,7 @@ bool MMALDriver::updateProperties()
         }
 #endif
         defineNumber(&mGainNP);
+        defineNumber(&mDecodeThreadsNP);
     }
     else
     {
@@ -262,6 +276,7 @@ bool MMALDriver::updateProperties()
 #endif
 
         deleteProperty(mGainNP.name);
+        deleteProperty(mDecodeThreadsNP.name);
     }
 
     return true;
@@ -522,6 +537,26 @@ bool MMALDriver::ISNewNumber(const char *dev, const char *name, double values[],
         return true;
     }
 
+    if (!strcmp(name, mDecodeThreadsNP.name))
+    {
+        if (InExposure)
+        {
+            LOG_WARN("Can not change decode threads during an exposure.");
+            mDecodeThreadsNP.s = IPS_ALERT;
+            IDSetNumber(&mDecodeThreadsNP, nullptr);
+            return true;
+        }
+
+        IUUpdateNumber(&mDecodeThreadsNP, values, names, n);
+        if (decode_pipe)
+        {
+            decode_pipe->set_threads(static_cast<unsigned int>(mDecodeThreadsN[0].value));
+        }
+        mDecodeThreadsNP.s = IPS_OK;
+        IDSetNumber(&mDecodeThreadsNP, nullptr);
+        return true;
+    }
+
     return false;
 }
 
@@ -564,6 +599,8 @@ void MMALDriver::setupPipeline()
         raw_pipe->daisyChain(brcm_pipe);
 
         Raw12ToBayer16Pipeline *raw12_pipe = new Raw12ToBayer16Pipeline(brcm_pipe, &chipWrapper);
+        decode_pipe = new ParallelDecodePipeline(brcm_pipe, raw12_pipe, static_cast<unsigned int>(mDecodeThreadsN[0].value));
+        brcm_pipe->daisyChain(decode_pipe);
         brcm_pipe->daisyChain(raw12_pipe);
     }
     else if (!strcmp(camera_control->get_camera()->getModel(), "ov5647")) {
@@ -576,6 +613,8 @@ void MMALDriver::setupPipeline()
 
         Raw10ToBayer16Pipeline *raw10_pipe = new Raw10ToBayer16Pipeline(brcm_pipe, &chipWrapper);
         // receiver->daisyChain(&raw_writer);
+        decode_pipe = new ParallelDecodePipeline(brcm_pipe, raw10_pipe, static_cast<unsigned int>(mDecodeThreadsN[0].value));
+        brcm_pipe->daisyChain(decode_pipe);
         brcm_pipe->daisyChain(raw10_pipe);
     }    
     else if (!strcmp(camera_control->get_camera()->getModel(), "imx219"))
@@ -586,6 +625,8 @@ void MMALDriver::setupPipeline()
         raw_pipe->daisyChain(brcm_pipe);
 
         Raw10ToBayer16Pipeline *raw10_pipe = new Raw10ToBayer16Pipeline(brcm_pipe, &chipWrapper);
+        decode_pipe = new ParallelDecodePipeline(brcm_pipe, raw10_pipe, static_cast<unsigned int>(mDecodeThreadsN[0].value));
+        brcm_pipe->daisyChain(decode_pipe);
         brcm_pipe->daisyChain(raw10_pipe);
     }
     else
@@ -29,6 +29,7 @@
 #include "jpegpipeline.h"
 #include "broadcompipeline.h"
 #include "raw12tobayer16pipeline.h"
+#include "paralleldecodepipeline.h"
 #include "capturelistener.h"
 #include "chipwrapper.h"
 #include "config.h"
@@ -91,10 +92,13 @@ private:
 #endif
   INumber mGainN[1];
   INumberVectorProperty mGainNP;
+  INumber mDecodeThreadsN[1];
+  INumberVectorProperty mDecodeThreadsNP;
 
   std::unique_ptr<CameraControl> camera_control; // Controller object for the camera communication.
 
   std::unique_ptr<Pipeline> raw_pipe; // Start of pipeline that recieved raw data from camera.
+  ParallelDecodePipeline *decode_pipe {nullptr}; // Owned by raw_pipe.
 
   ChipWrapper chipWrapper;
 
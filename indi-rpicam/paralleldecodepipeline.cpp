@@ -0,0 +1,200 @@
+/*
+ Raspberry Pi High Quality Camera CCD Driver for Indi.
+ Copyright (C) 2020 Lars Berntzon (lars.berntzon@cecilia-data.se).
+ All rights reserved.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+
+#include "paralleldecodepipeline.h"
+#include "broadcompipeline.h"
+#include "rawtobayer16pipeline.h"
+
+ParallelDecodePipeline::ParallelDecodePipeline(const BroadcomPipeline *bcm_pipe, RawToBayer16Pipeline *decoder,
+                                               unsigned int threads) : Pipeline(), bcm_pipe(bcm_pipe), decoder(decoder)
+{
+    set_threads(threads);
+}
+
+ParallelDecodePipeline::~ParallelDecodePipeline()
+{
+    stop_workers();
+}
+
+void ParallelDecodePipeline::set_threads(unsigned int threads)
+{
+    stop_workers();
+    this->threads = std::max(1U, threads);
+    if (this->threads > 1) {
+        start_workers();
+    }
+}
+
+void ParallelDecodePipeline::start_workers()
+{
+    stop = false;
+    for(unsigned int i = 0; i < threads; i++) {
+        workers.emplace_back(&ParallelDecodePipeline::worker, this, i, job_id);
+    }
+}
+
+void ParallelDecodePipeline::stop_workers()
+{
+    if (workers.empty()) {
+        return;
+    }
+
+    wait_batches();
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stop = true;
+    }
+    work_cv.notify_all();
+
+    for(auto &t : workers) {
+        t.join();
+    }
+    workers.clear();
+}
+
+void ParallelDecodePipeline::reset()
+{
+    wait_batches();
+    started = false;
+    raw_x = 0;
+    raw_y = 0;
+    filling = 0;
+    batch_rows = 0;
+    busy_time = std::chrono::duration<double>::zero();
+}
+
+void ParallelDecodePipeline::data_received(uint8_t *data,  uint32_t length)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (threads <= 1) {
+        forward(data, length);
+        busy_time += std::chrono::steady_clock::now() - start;
+        return;
+    }
+
+    if (!started) {
+        raw_width = bcm_pipe->header.omx_data.raw_width;
+        first_row = decoder->first_row();
+        end_row = first_row + decoder->row_count();
+        for(auto &b : batch) {
+            b.resize(BATCH_ROWS * raw_width);
+        }
+        batch_first_row = first_row;
+        started = true;
+    }
+
+    // Rows after the subframe are ignored.
+    while(length > 0 && raw_y < end_row)
+    {
+        uint32_t n = std::min(length, raw_width - raw_x);
+
+        if (raw_y >= first_row) {
+            memcpy(batch[filling].data() + batch_rows * raw_width + raw_x, data, n);
+        }
+
+        data += n;
+        length -= n;
+        raw_x += n;
+
+        if (raw_x >= raw_width) {
+            raw_x = 0;
+            raw_y++;
+
+            if (raw_y > first_row) {
+                batch_rows++;
+                if (batch_rows == BATCH_ROWS || raw_y == end_row) {
+                    submit_batch();
+                }
+            }
+
+            // Last row of the subframe received, join before the frame is handed on.
+            if (raw_y == end_row) {
+                wait_batches();
+            }
+        }
+    }
+
+    busy_time += std::chrono::steady_clock::now() - start;
+}
+
+/**
+ * Hand the batch being filled to the workers and continue filling the other one.
+ */
+void ParallelDecodePipeline::submit_batch()
+{
+    // The other batch is refilled next, the workers must be done with it.
+    wait_batches();
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        job_data = batch[filling].data();
+        job_first_row = batch_first_row;
+        job_rows = batch_rows;
+        job_pending = threads;
+        job_id++;
+    }
+    work_cv.notify_all();
+
+    filling ^= 1;
+    batch_first_row += batch_rows;
+    batch_rows = 0;
+}
+
+void ParallelDecodePipeline::wait_batches()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this] { return job_pending == 0; });
+}
+
+void ParallelDecodePipeline::worker(unsigned int index, uint64_t done_id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true)
+    {
+        work_cv.wait(lock, [this, done_id] { return stop || job_id != done_id; });
+        if (stop) {
+            return;
+        }
+
+        done_id = job_id;
+        const uint8_t *data = job_data;
+        uint32_t first = job_first_row;
+        uint32_t rows = job_rows;
+        uint32_t count = threads;
+        lock.unlock();
+
+        // Each worker takes its own slice of rows, so the slices never overlap in the frame buffer.
+        uint32_t from = rows * index / count;
+        uint32_t to = rows * (index + 1) / count;
+        if (to > from) {
+            decoder->unpack_rows(data + from * raw_width, raw_width, first + from, to - from);
+        }
+
+        lock.lock();
+        if (--job_pending == 0) {
+            done_cv.notify_all();
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ Raspberry Pi High Quality Camera CCD Driver for Indi.
+ Copyright (C) 2020 Lars Berntzon (lars.berntzon@cecilia-data.se).
+ All rights reserved.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PARALLELDECODEPIPELINE_H
+#define PARALLELDECODEPIPELINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pipeline.h"
+
+struct BroadcomPipeline;
+class RawToBayer16Pipeline;
+
+/**
+ * @brief The ParallelDecodePipeline class
+ * Placed between the Broadcom header parser and a RAW decoder. Collects complete raw rows of the subframe
+ * into batches and lets a pool of worker threads unpack the rows of a batch in slices, while the next
+ * batch is collected from the following buffers. When the last row of the subframe has arrived all
+ * batches are joined, so the frame buffer is complete when the last buffer callback returns.
+ *
+ * With one thread the bytes are forwarded to the decoder unchanged, which is the serial path.
+ * The decoder must be daisy chained after this pipeline so it is reset and deleted with it.
+ */
+class ParallelDecodePipeline : public Pipeline
+{
+public:
+    ParallelDecodePipeline(const BroadcomPipeline *bcm_pipe, RawToBayer16Pipeline *decoder, unsigned int threads = 1);
+    virtual ~ParallelDecodePipeline();
+
+    virtual void data_received(uint8_t *data,  uint32_t length) override;
+    virtual void reset() override;
+
+    /**
+     * Set the number of decode threads, 1 decodes on the buffer callback thread.
+     * Must not be called during a capture.
+     */
+    void set_threads(unsigned int threads);
+    unsigned int get_threads() const { return threads; }
+
+    /**
+     * Time the buffer callback thread spent in this pipeline since the last reset().
+     */
+    std::chrono::duration<double> get_busy_time() const { return busy_time; }
+
+    static const uint32_t BATCH_ROWS {64};
+
+private:
+    void start_workers();
+    void stop_workers();
+    void worker(unsigned int index, uint64_t done_id);
+    void submit_batch();
+    void wait_batches();
+
+    const BroadcomPipeline *bcm_pipe;
+    RawToBayer16Pipeline *decoder;
+    unsigned int threads {1};
+
+    // Position in the raw data, set up on the first buffer as the decoder is reset after this pipeline.
+    bool started {false};
+    uint32_t raw_width {0};
+    uint32_t raw_x {0};
+    uint32_t raw_y {0};
+    uint32_t first_row {0};
+    uint32_t end_row {0};
+
+    // Rows are collected into one batch while the workers unpack the other.
+    std::vector<uint8_t> batch[2];
+    int filling {0};
+    uint32_t batch_first_row {0};
+    uint32_t batch_rows {0};
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    const uint8_t *job_data {nullptr};
+    uint32_t job_first_row {0};
+    uint32_t job_rows {0};
+    uint64_t job_id {0};
+    unsigned int job_pending {0};
+    bool stop {false};
+
+    std::chrono::duration<double> busy_time {};
+};
+
+#endif // PARALLELDECODEPIPELINE_H
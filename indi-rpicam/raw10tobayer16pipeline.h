@@ -22,10 +22,7 @@
 #define RAW10TOBAYER16PIPELINE_H
 
 #include <cstddef>
-#include "pipeline.h"
-
-struct BroadcomPipeline;
-class ChipWrapper;
+#include "rawtobayer16pipeline.h"
 
 /**
  * @brief The Raw10ToBayer16Pipeline class
@@ -33,30 +30,15 @@ class ChipWrapper;
  * Format of first line is: | B | G | B | G |  {lower 2 bits for the earlier 4 bytes} |
  * Second line is G R ...
  */
-class Raw10ToBayer16Pipeline : public Pipeline
+class Raw10ToBayer16Pipeline : public RawToBayer16Pipeline
 {
 public:
-    Raw10ToBayer16Pipeline(const BroadcomPipeline *bcm_pipe, ChipWrapper *ccd) : Pipeline(), bcm_pipe(bcm_pipe), ccd(ccd) {}
+    Raw10ToBayer16Pipeline(const BroadcomPipeline *bcm_pipe, ChipWrapper *ccd) : RawToBayer16Pipeline(bcm_pipe, ccd, 5, 4) {}
 
     virtual void data_received(uint8_t *data,  uint32_t length) override;
-    virtual void reset() override;
-
-private:
-    void next_line(uint32_t maxX);
-    const BroadcomPipeline *bcm_pipe;
-    ChipWrapper *ccd;
-    uint32_t x {0};
-    uint32_t y {0};
-    uint32_t raw_x {0};  // Position in the raw-data comming in.
-    uint32_t raw_y {0};  //! Position in the raw-data comming in.
-    uint32_t startRawX {0};
-    uint32_t startRawY {0};
-    uint8_t state = 0;
-    uint16_t* frame_buffer;
-    uint32_t raw_width{0};
-    uint32_t xRes, yRes = 0;
-    uint16_t* cur_row {0};
-    uint32_t bytes_consumed = 0;
+
+protected:
+    virtual void unpack_groups(const uint8_t *src, uint16_t *dst, uint32_t count) override;
 };
 
 #endif // RAW10TOBAYER16PIPELINE_H
@@ -18,15 +18,16 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
-#include <iostream>
 #include <cassert>
 
+#if defined(__ARM_NEON) || defined(__NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "raw12tobayer16pipeline.h"
 #include "broadcompipeline.h"
 #include "chipwrapper.h"
 
-#include <fstream>
-
 /**
  * Decoding the RAW12 format (not the official one, the Broadcom one) which is rows of:
  * [ Bh ] [ Gh ] [ Bl | Gl ] ...
@@ -45,68 +46,40 @@
  * startRawX = (getSubX() / 2) * 3
  */
 
-void Raw12ToBayer16Pipeline::reset()
-{
-    x = 0;
-    y = 0;
-    state = 0;
-    startRawX = (ccd->getSubX() / 2) * 3;
-    raw_x = 0;
-    raw_y = 0;
-}
-
 void Raw12ToBayer16Pipeline::data_received(uint8_t *data,  uint32_t length)
 {
-    uint8_t byte;
-
-    assert(bcm_pipe->header.omx_data.raw_width == 6112); 
+    assert(bcm_pipe->header.omx_data.raw_width == 6112);
     assert(ccd->getXRes() == 4056);
     assert(ccd->getYRes() == 3040);
 
-    int maxX = ccd->getSubW();
-    int maxY = ccd->getSubH();
+    RawToBayer16Pipeline::data_received(data, length);
+}
 
-    for(;length; data++, length--)
+void Raw12ToBayer16Pipeline::unpack_groups(const uint8_t *src, uint16_t *dst, uint32_t count)
+{
+#if defined(__ARM_NEON) || defined(__NEON__)
+    // 16 groups at a time, vld3 splits the high bytes of both pixels and the shared low nibbles.
+    const uint8x16_t mask = vdupq_n_u8(0x0F);
+    for (; count >= 16; count -= 16, src += 48, dst += 32)
     {
-        byte = *data;
-
-        if (raw_x >= bcm_pipe->header.omx_data.raw_width) {
-            x = 0;
-            raw_x = 0;
-            state = 0;
-
-            raw_y++;
-            if (raw_y > ccd->getSubY()) {
-                y += 1;
-            }
-        }
-
-        if (raw_x >= startRawX && raw_y >= ccd->getSubY() && x < maxX && y < maxY) {
-            uint16_t *cur_row = reinterpret_cast<uint16_t *>(ccd->getFrameBuffer()) + y * ccd->getSubW();
-
-            // RAW according to experiment.
-            switch(state)
-            {
-            case 0:
-                // FIXME: Optimize, if at least 3 bytes remaining here, all data can be calculated faster in one step.
-                cur_row[x] = byte << 8;
-                state = 1;
-                break;
-
-            case 1:
-                cur_row[x+1] = byte << 8;
-                state = 2;
-                break;
-
-            case 2:
-                cur_row[x+0] |= static_cast<uint16_t>((byte & 0x0F) << 4);
-                cur_row[x+1] |= static_cast<uint16_t>((byte & 0xF0) << 0);
-                x += 2;
-                state = 0;
-                break;
-            }
-        }
+        uint8x16x3_t in = vld3q_u8(src);
+        uint8x16_t low0 = vshlq_n_u8(vandq_u8(in.val[2], mask), 4);
+        uint8x16_t low1 = vbicq_u8(in.val[2], mask);
+        uint16x8x2_t out;
+
+        out.val[0] = vorrq_u16(vshll_n_u8(vget_low_u8(in.val[0]), 8), vmovl_u8(vget_low_u8(low0)));
+        out.val[1] = vorrq_u16(vshll_n_u8(vget_low_u8(in.val[1]), 8), vmovl_u8(vget_low_u8(low1)));
+        vst2q_u16(dst, out);
+
+        out.val[0] = vorrq_u16(vshll_n_u8(vget_high_u8(in.val[0]), 8), vmovl_u8(vget_high_u8(low0)));
+        out.val[1] = vorrq_u16(vshll_n_u8(vget_high_u8(in.val[1]), 8), vmovl_u8(vget_high_u8(low1)));
+        vst2q_u16(dst + 16, out);
+    }
+#endif
 
-        raw_x++;
+    for (; count; count--, src += 3, dst += 2)
+    {
+        dst[0] = static_cast<uint16_t>((src[0] << 8) | ((src[2] & 0x0F) << 4));
+        dst[1] = static_cast<uint16_t>((src[1] << 8) | ((src[2] & 0xF0) << 0));
     }
 }
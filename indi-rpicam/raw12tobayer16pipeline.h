@@ -22,10 +22,7 @@
 #define RAW12TOBAYER16PIPELINE_H
 
 #include <cstddef>
-#include "pipeline.h"
-
-struct BroadcomPipeline;
-class ChipWrapper;
+#include "rawtobayer16pipeline.h"
 
 /**
  * @brief The Raw12ToBayer16Pipeline class
@@ -34,23 +31,15 @@ class ChipWrapper;
  *                                   b1                                      b2                               b3
  * Odd lines are swapped R->G, G-B
  */
-class Raw12ToBayer16Pipeline : public Pipeline
+class Raw12ToBayer16Pipeline : public RawToBayer16Pipeline
 {
 public:
-    Raw12ToBayer16Pipeline(const BroadcomPipeline *bcm_pipe, ChipWrapper *ccd) : Pipeline(), bcm_pipe(bcm_pipe), ccd(ccd) {}
+    Raw12ToBayer16Pipeline(const BroadcomPipeline *bcm_pipe, ChipWrapper *ccd) : RawToBayer16Pipeline(bcm_pipe, ccd, 3, 2) {}
 
     virtual void data_received(uint8_t *data,  uint32_t length) override;
-    virtual void reset() override;
-
-private:
-    const BroadcomPipeline *bcm_pipe;
-    ChipWrapper *ccd;
-    int x {0};
-    int y {0};
-    int raw_x {0}; //! Position in the raw-data comming in.
-    int raw_y {0}; //! Position in the raw-data comming in.
-    int startRawX {0};
-    uint8_t state = 0; //! Which byte in the RAW12 format (see above).
+
+protected:
+    virtual void unpack_groups(const uint8_t *src, uint16_t *dst, uint32_t count) override;
 };
 
 #endif // RAW12TOBAYER16PIPELINE_H
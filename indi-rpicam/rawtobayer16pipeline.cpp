@@ -0,0 +1,151 @@
+/*
+ Raspberry Pi High Quality Camera CCD Driver for Indi.
+ Copyright (C) 2020 Lars Berntzon (lars.berntzon@cecilia-data.se).
+ All rights reserved.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+#include "rawtobayer16pipeline.h"
+#include "broadcompipeline.h"
+#include "chipwrapper.h"
+
+void RawToBayer16Pipeline::reset()
+{
+    assert(group_bytes <= MAX_GROUP_BYTES);
+
+    maxX = ccd->getSubW();
+    maxY = ccd->getSubH();
+    startRawX = (ccd->getSubX() / group_pixels) * group_bytes;
+    startRawY = ccd->getSubY();
+    endRawX = startRawX + ((maxX + group_pixels - 1) / group_pixels) * group_bytes;
+    raw_x = 0;
+    raw_y = 0;
+}
+
+void RawToBayer16Pipeline::data_received(uint8_t *data,  uint32_t length)
+{
+    const uint32_t raw_width = bcm_pipe->header.omx_data.raw_width;
+    uint16_t *frame_buffer = reinterpret_cast<uint16_t *>(ccd->getFrameBuffer());
+
+    while(length > 0)
+    {
+        // Everything after the subframe is ignored.
+        if (raw_y >= startRawY + maxY) {
+            return;
+        }
+
+        uint32_t n = std::min(length, raw_width - raw_x);
+
+        if (raw_y >= startRawY) {
+            uint32_t from = std::max(raw_x, startRawX);
+            uint32_t to = std::min(raw_x + n, endRawX);
+            if (from < to) {
+                unpack_segment(data + (from - raw_x), from - startRawX, to - from, frame_buffer + (raw_y - startRawY) * maxX);
+            }
+        }
+
+        data += n;
+        length -= n;
+        raw_x += n;
+
+        if (raw_x >= raw_width) {
+            raw_x = 0;
+            raw_y++;
+        }
+    }
+}
+
+/**
+ * Unpack length bytes starting offset bytes into the subframe part of a raw row.
+ */
+void RawToBayer16Pipeline::unpack_segment(const uint8_t *src, uint32_t offset, uint32_t length, uint16_t *row)
+{
+    uint32_t group = offset / group_bytes;
+    uint32_t phase = offset % group_bytes;
+
+    // Complete the group started at the end of the previous buffer.
+    if (phase != 0) {
+        uint32_t n = std::min(length, group_bytes - phase);
+        memcpy(pending + phase, src, n);
+        src += n;
+        length -= n;
+        if (phase + n < group_bytes) {
+            return;
+        }
+        unpack_clipped(pending, row, group);
+        group++;
+    }
+
+    // Bulk of the row, groups whose pixels are all inside the subframe.
+    uint32_t full_groups = maxX / group_pixels;
+    if (group < full_groups) {
+        uint32_t count = std::min(length / group_bytes, full_groups - group);
+        unpack_groups(src, row + group * group_pixels, count);
+        src += count * group_bytes;
+        length -= count * group_bytes;
+        group += count;
+    }
+
+    // Last group of the row when the subframe width is not a multiple of the group.
+    if (length >= group_bytes) {
+        unpack_clipped(src, row, group);
+        src += group_bytes;
+        length -= group_bytes;
+    }
+
+    // Start of a group continued in the next buffer.
+    assert(length < group_bytes);
+    memcpy(pending, src, length);
+}
+
+void RawToBayer16Pipeline::unpack_rows(const uint8_t *rows, uint32_t raw_width, uint32_t first_raw_row, uint32_t count)
+{
+    uint16_t *frame_buffer = reinterpret_cast<uint16_t *>(ccd->getFrameBuffer());
+    uint32_t end = std::min(endRawX, raw_width);
+    if (end <= startRawX) {
+        return;
+    }
+
+    uint32_t groups = (end - startRawX) / group_bytes;
+    uint32_t full_groups = std::min(groups, maxX / group_pixels);
+
+    for(uint32_t i = 0; i < count; i++) {
+        const uint8_t *src = rows + i * raw_width + startRawX;
+        uint16_t *row = frame_buffer + (first_raw_row + i - startRawY) * maxX;
+
+        unpack_groups(src, row, full_groups);
+        if (groups > full_groups) {
+            unpack_clipped(src + full_groups * group_bytes, row, full_groups);
+        }
+    }
+}
+
+/**
+ * Unpack a single group, only storing the pixels inside the subframe.
+ */
+void RawToBayer16Pipeline::unpack_clipped(const uint8_t *src, uint16_t *row, uint32_t group)
+{
+    uint16_t pixels[MAX_GROUP_BYTES];
+    unpack_groups(src, pixels, 1);
+
+    uint32_t x = group * group_pixels;
+    uint32_t n = std::min(group_pixels, maxX - x);
+    memcpy(row + x, pixels, n * sizeof(uint16_t));
+}
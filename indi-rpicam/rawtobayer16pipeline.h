@@ -0,0 +1,89 @@
+/*
+ Raspberry Pi High Quality Camera CCD Driver for Indi.
+ Copyright (C) 2020 Lars Berntzon (lars.berntzon@cecilia-data.se).
+ All rights reserved.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef RAWTOBAYER16PIPELINE_H
+#define RAWTOBAYER16PIPELINE_H
+
+#include <cstddef>
+#include "pipeline.h"
+
+struct BroadcomPipeline;
+class ChipWrapper;
+
+/**
+ * @brief The RawToBayer16Pipeline class
+ * Common row handling for the packed Broadcom RAW formats. The raw data is a sequence of rows of
+ * raw_width bytes (from the Broadcom header), each row is a sequence of groups where group_bytes
+ * bytes hold group_pixels pixels.
+ *
+ * Incoming buffers are split on row boundaries, complete groups inside the subframe are unpacked in
+ * bulk by unpack_groups() and a group split between two buffers is kept until the rest arrives.
+ * Subframes start on a group boundary, startRawX = (getSubX() / group_pixels) * group_bytes.
+ */
+class RawToBayer16Pipeline : public Pipeline
+{
+public:
+    RawToBayer16Pipeline(const BroadcomPipeline *bcm_pipe, ChipWrapper *ccd, uint32_t group_bytes, uint32_t group_pixels)
+        : Pipeline(), bcm_pipe(bcm_pipe), ccd(ccd), group_bytes(group_bytes), group_pixels(group_pixels) {}
+
+    virtual void data_received(uint8_t *data,  uint32_t length) override;
+    virtual void reset() override;
+
+    /**
+     * First raw row and number of rows of the subframe, valid after reset().
+     */
+    uint32_t first_row() const { return startRawY; }
+    uint32_t row_count() const { return maxY; }
+
+    /**
+     * Unpack count complete raw rows of raw_width bytes each, the first one being raw row first_raw_row.
+     * Does not use the streaming state of data_received(), several threads may unpack different rows at once.
+     */
+    void unpack_rows(const uint8_t *rows, uint32_t raw_width, uint32_t first_raw_row, uint32_t count);
+
+protected:
+    /**
+     * Unpack count complete groups from src into 16 bit pixels, upshifted so the most significant bit is bit 15.
+     * Writes exactly count * group_pixels pixels to dst.
+     */
+    virtual void unpack_groups(const uint8_t *src, uint16_t *dst, uint32_t count) = 0;
+
+    const BroadcomPipeline *bcm_pipe;
+    ChipWrapper *ccd;
+
+private:
+    void unpack_segment(const uint8_t *src, uint32_t offset, uint32_t length, uint16_t *row);
+    void unpack_clipped(const uint8_t *src, uint16_t *row, uint32_t group);
+
+    static const uint32_t MAX_GROUP_BYTES {8};
+
+    const uint32_t group_bytes;
+    const uint32_t group_pixels;
+    uint32_t raw_x {0};         //! Position in the raw-data comming in.
+    uint32_t raw_y {0};         //! Position in the raw-data comming in.
+    uint32_t startRawX {0};
+    uint32_t startRawY {0};
+    uint32_t endRawX {0};       //! First byte after the last group of the subframe in a raw row.
+    uint32_t maxX {0};
+    uint32_t maxY {0};
+    uint8_t pending[MAX_GROUP_BYTES] {}; //! Start of a group split between two buffers.
+};
+
+#endif // RAWTOBAYER16PIPELINE_H
@@ -0,0 +1,300 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <broadcompipeline.h>
+#include <raw10tobayer16pipeline.h>
+#include <raw12tobayer16pipeline.h>
+#include <paralleldecodepipeline.h>
+#include <chipwrapper.h>
+
+// Offline tests and throughput benchmark of the RAW unpackers, no camera needed.
+
+// {{{ MockCCD: Class for mocking the CCDChip which is used by the rawxxpipes to store the image.
+class MockCCD : public ChipWrapper
+{
+public:
+    MockCCD(int width, int height, int x, int y, int w, int h) :
+        subx(x), suby(y), subw(w), subh(h), width(width), height(height), frameBuffer(w * h * 2)
+    {
+    }
+
+    virtual int getFrameBufferSize() override {
+        return static_cast<int>(frameBuffer.size());
+    }
+
+    virtual uint8_t* getFrameBuffer() override {
+        return frameBuffer.data();
+    }
+
+    virtual int getSubX() override { return subx; }
+    virtual int getSubY() override { return suby; }
+    virtual int getSubW() override { return subw; }
+    virtual int getSubH() override { return subh; }
+    virtual int getXRes() override { return width; }
+    virtual int getYRes() override { return height; }
+
+    const uint16_t *pixels() const {
+        return reinterpret_cast<const uint16_t *>(frameBuffer.data());
+    }
+
+private:
+    int subx, suby, subw, subh;
+    int width;
+    int height;
+    std::vector<uint8_t> frameBuffer;
+};
+// }}}
+
+// {{{ Sensor: raw frame with random content and the reference decoding of it.
+struct Sensor
+{
+    int width;
+    int height;
+    int raw_width;
+    int group_bytes;
+    int group_pixels;
+
+    std::vector<uint8_t> raw;
+
+    Sensor(int width, int height, int raw_width, int group_bytes, int group_pixels) :
+        width(width), height(height), raw_width(raw_width), group_bytes(group_bytes), group_pixels(group_pixels),
+        raw(raw_width * (height + 16)) // Some padding rows after the image, like the real sensors.
+    {
+        srand(4711);
+        for(auto &byte : raw) {
+            byte = static_cast<uint8_t>(rand());
+        }
+    }
+
+    // One pixel at a time straight from the format description.
+    uint16_t reference(int raw_y, int startRawX, int x) const
+    {
+        const uint8_t *group = &raw[raw_y * raw_width + startRawX + (x / group_pixels) * group_bytes];
+        int i = x % group_pixels;
+
+        if (group_bytes == 3) {
+            return i == 0 ? static_cast<uint16_t>((group[0] << 8) | ((group[2] & 0x0F) << 4))
+                          : static_cast<uint16_t>((group[1] << 8) | (group[2] & 0xF0));
+        }
+
+        static const int high[4] = { 1, 0, 3, 2 };
+        return static_cast<uint16_t>((group[high[i]] << 8) | (((group[4] >> (2 * i)) & 0x03) << 6));
+    }
+};
+
+static Sensor imx477(4056, 3040, 6112, 3, 2);
+static Sensor imx219(3280, 2464, 4128, 5, 4);
+// }}}
+
+// {{{ Helpers
+static RawToBayer16Pipeline *create_pipe(const Sensor &sensor, BroadcomPipeline *bcm, ChipWrapper *ccd)
+{
+    bcm->header.omx_data.raw_width = static_cast<uint16_t>(sensor.raw_width);
+    if (sensor.group_bytes == 3) {
+        return new Raw12ToBayer16Pipeline(bcm, ccd);
+    }
+    return new Raw10ToBayer16Pipeline(bcm, ccd);
+}
+
+// Feed the raw frame in buffers of the given sizes (repeated), empty means all in one buffer.
+// With threads the decoder is put behind a ParallelDecodePipeline, as in the driver.
+static void decode(const Sensor &sensor, MockCCD &ccd, const std::vector<uint32_t> &sizes = {}, unsigned int threads = 0)
+{
+    BroadcomPipeline bcm;
+    RawToBayer16Pipeline *raw_pipe = create_pipe(sensor, &bcm, &ccd);
+    Pipeline *pipe = raw_pipe;
+    if (threads) {
+        pipe = new ParallelDecodePipeline(&bcm, raw_pipe, threads);
+        pipe->daisyChain(raw_pipe);
+    }
+    pipe->reset_pipe();
+
+    std::vector<uint8_t> raw = sensor.raw; // data_received() takes a non-const buffer.
+    uint8_t *data = raw.data();
+    uint32_t left = static_cast<uint32_t>(raw.size());
+
+    for(size_t i = 0; left; i++) {
+        uint32_t n = sizes.empty() ? left : std::min(left, sizes[i % sizes.size()]);
+        pipe->data_received(data, n);
+        data += n;
+        left -= n;
+    }
+
+    delete pipe;
+}
+
+static void expect_reference(const Sensor &sensor, MockCCD &ccd)
+{
+    int startRawX = (ccd.getSubX() / sensor.group_pixels) * sensor.group_bytes;
+    int mismatches = 0;
+
+    for(int y = 0; y < ccd.getSubH(); y++) {
+        for(int x = 0; x < ccd.getSubW(); x++) {
+            uint16_t expected = sensor.reference(ccd.getSubY() + y, startRawX, x);
+            uint16_t actual = ccd.pixels()[y * ccd.getSubW() + x];
+            if (expected != actual && mismatches++ < 10) {
+                ADD_FAILURE() << "pixel x=" << x << " y=" << y << " expected " << expected << " got " << actual;
+            }
+        }
+    }
+
+    EXPECT_EQ(mismatches, 0);
+}
+
+// Buffer sizes splitting groups and rows in every possible way, plus the usual MMAL buffer size.
+static const std::vector<uint32_t> odd_sizes = { 1, 2, 3, 4, 5, 7, 13, 64, 1021, 6112 + 1, 81920 };
+// }}}
+
+TEST(TestRawUnpack, raw12_full_frame)
+{
+    MockCCD ccd(imx477.width, imx477.height, 0, 0, imx477.width, imx477.height);
+    decode(imx477, ccd);
+    expect_reference(imx477, ccd);
+}
+
+TEST(TestRawUnpack, raw12_split_buffers)
+{
+    MockCCD ccd(imx477.width, imx477.height, 0, 0, imx477.width, imx477.height);
+    decode(imx477, ccd, odd_sizes);
+    expect_reference(imx477, ccd);
+}
+
+TEST(TestRawUnpack, raw12_subframe)
+{
+    // Odd start and width, so the last group of each row is only partly used.
+    MockCCD ccd(imx477.width, imx477.height, 101, 37, 641, 480);
+    decode(imx477, ccd, odd_sizes);
+    expect_reference(imx477, ccd);
+}
+
+TEST(TestRawUnpack, raw10_full_frame)
+{
+    MockCCD ccd(imx219.width, imx219.height, 0, 0, imx219.width, imx219.height);
+    decode(imx219, ccd);
+    expect_reference(imx219, ccd);
+}
+
+TEST(TestRawUnpack, raw10_split_buffers)
+{
+    MockCCD ccd(imx219.width, imx219.height, 0, 0, imx219.width, imx219.height);
+    decode(imx219, ccd, odd_sizes);
+    expect_reference(imx219, ccd);
+}
+
+TEST(TestRawUnpack, raw10_subframe)
+{
+    MockCCD ccd(imx219.width, imx219.height, 99, 41, 643, 480);
+    decode(imx219, ccd, odd_sizes);
+    expect_reference(imx219, ccd);
+}
+
+TEST(TestRawUnpack, raw12_parallel)
+{
+    for(unsigned int threads : { 1, 2, 4 }) {
+        MockCCD ccd(imx477.width, imx477.height, 0, 0, imx477.width, imx477.height);
+        decode(imx477, ccd, { 81920 }, threads);
+        expect_reference(imx477, ccd);
+    }
+}
+
+TEST(TestRawUnpack, raw12_parallel_split_buffers)
+{
+    MockCCD ccd(imx477.width, imx477.height, 0, 0, imx477.width, imx477.height);
+    decode(imx477, ccd, odd_sizes, 4);
+    expect_reference(imx477, ccd);
+}
+
+TEST(TestRawUnpack, raw12_parallel_subframe)
+{
+    // Fewer rows than a batch, and a batch count that does not divide the rows.
+    MockCCD small(imx477.width, imx477.height, 101, 37, 641, 5);
+    decode(imx477, small, odd_sizes, 4);
+    expect_reference(imx477, small);
+
+    MockCCD ccd(imx477.width, imx477.height, 101, 37, 641, 480 + 13);
+    decode(imx477, ccd, odd_sizes, 3);
+    expect_reference(imx477, ccd);
+}
+
+TEST(TestRawUnpack, raw10_parallel)
+{
+    MockCCD ccd(imx219.width, imx219.height, 0, 0, imx219.width, imx219.height);
+    decode(imx219, ccd, { 81920 }, 4);
+    expect_reference(imx219, ccd);
+}
+
+TEST(TestRawUnpack, raw10_parallel_subframe)
+{
+    MockCCD ccd(imx219.width, imx219.height, 99, 41, 643, 480 + 13);
+    decode(imx219, ccd, odd_sizes, 4);
+    expect_reference(imx219, ccd);
+}
+
+TEST(TestRawUnpack, parallel_reuse)
+{
+    // Same pipeline for several frames and thread counts, like repeated exposures in the driver.
+    MockCCD ccd(imx477.width, imx477.height, 0, 0, imx477.width, imx477.height);
+    BroadcomPipeline bcm;
+    RawToBayer16Pipeline *raw_pipe = create_pipe(imx477, &bcm, &ccd);
+    ParallelDecodePipeline *pipe = new ParallelDecodePipeline(&bcm, raw_pipe, 4);
+    pipe->daisyChain(raw_pipe);
+
+    for(unsigned int threads : { 4, 1, 2, 4 }) {
+        pipe->set_threads(threads);
+        memset(ccd.getFrameBuffer(), 0, ccd.getFrameBufferSize());
+        std::vector<uint8_t> raw = imx477.raw;
+        pipe->reset_pipe();
+        for(size_t i = 0; i < raw.size(); i += 81920) {
+            pipe->data_received(raw.data() + i, static_cast<uint32_t>(std::min<size_t>(81920, raw.size() - i)));
+        }
+        expect_reference(imx477, ccd);
+    }
+
+    delete pipe;
+}
+
+// Throughput of a full frame delivered in MMAL sized buffers.
+static void benchmark(const char *name, const Sensor &sensor, unsigned int threads = 0)
+{
+    const int iterations = 10;
+    MockCCD ccd(sensor.width, sensor.height, 0, 0, sensor.width, sensor.height);
+
+    decode(sensor, ccd, { 81920 }, threads);
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; i++) {
+        decode(sensor, ccd, { 81920 }, threads);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double seconds = elapsed.count() / iterations;
+    printf("%s %dx%d threads %u: %.1f ms/frame, %.1f MB/s raw input\n", name, sensor.width, sensor.height,
+           threads ? threads : 1, seconds * 1000, sensor.raw.size() / seconds / 1e6);
+}
+
+TEST(TestRawUnpack, benchmark)
+{
+    benchmark("RAW12 IMX477", imx477);
+    benchmark("RAW10 IMX219", imx219);
+}
+
+TEST(TestRawUnpack, benchmark_parallel)
+{
+    for(unsigned int threads : { 1, 2, 4 }) {
+        benchmark("RAW12 IMX477", imx477, threads);
+    }
+    for(unsigned int threads : { 1, 2, 4 }) {
+        benchmark("RAW10 IMX219", imx219, threads);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
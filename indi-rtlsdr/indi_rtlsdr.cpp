@@ -26,6 +26,8 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <termios.h>
+#include <poll.h>
+#include <errno.h>
 #include <indilogger.h>
 #include <memory>
 #include <indicom.h>
@@ -41,15 +43,16 @@
 #define MIN_FRAME_SIZE (512)
 #define MAX_FRAME_SIZE (SUBFRAME_SIZE * 16)
 #define SPECTRUM_SIZE  (256)
+// About 4 seconds at the highest sample rate, 8 bit I and Q
+#define RING_SIZE      (16 * 1024 * 1024)
+#define RING_WAIT      (std::chrono::milliseconds(100))
+#define RTL_TCP_HEADER (12)
 
 static int iNumofConnectedSpectrographs;
 static RTLSDR **receivers;
 
 static bool isInit = false;
 
-static pthread_cond_t cv         = PTHREAD_COND_INITIALIZER;
-static pthread_mutex_t condMutex = PTHREAD_MUTEX_INITIALIZER;
-
 static void cleanup()
 {
     for (int i = 0; i < fabs(iNumofConnectedSpectrographs); i++)
@@ -60,32 +63,176 @@ static void cleanup()
 
 void RTLSDR::Callback()
 {
+    const uint8_t *data;
+
     b_read  = 0;
     to_read = getSampleRate() * IntegrationRequest * getBPS() / 8;
     setBufferSize(to_read);
+    continuum = getBuffer();
+    setIntegrationTime(IntegrationRequest);
+
+    // The integration is the slice of samples received from now on
+    ring.flush();
+    integrationOverruns = ring.overruns();
+    while (InIntegration)
+    {
+        if (!ring.wait(1, RING_WAIT))
+        {
+            if (!acquiring)
+            {
+                LOG_ERROR("Receiver stopped, integration aborted.");
+                InIntegration = false;
+            }
+            continue;
+        }
+        grabData(data, static_cast<int>(ring.readable(&data)));
+    }
+}
+
+/**************************************************************************************
+** Acquisition, runs from connection to disconnection and fills the ring
+***************************************************************************************/
+bool RTLSDR::startAcquisition()
+{
+    ring.resize(RING_SIZE);
+    reportedOverruns = 0;
+    terminateThread  = false;
 
-    int len            = min(MAX_FRAME_SIZE, to_read);
-    int olen           = 0;
-    unsigned char *buf = (unsigned char *)malloc(len);
     if((getSensorConnection() & CONNECTION_TCP) == 0)
-        rtlsdr_reset_buffer(rtl_dev);
+    {
+        if (rtlsdr_reset_buffer(rtl_dev) < 0)
+        {
+            LOG_ERROR("Failed to reset the receiver buffer.");
+            return false;
+        }
+        acquiring   = true;
+        acquisition = std::thread(&RTLSDR::usbAcquisition, this);
+    }
     else
-        tcflush(PortFD, TCOFLUSH);
-    setIntegrationTime(IntegrationRequest);
-    while (InIntegration)
+    {
+        acquiring   = true;
+        acquisition = std::thread(&RTLSDR::tcpAcquisition, this);
+    }
+    return true;
+}
+
+void RTLSDR::stopAcquisition()
+{
+    if (!acquisition.joinable())
+        return;
+
+    terminateThread = true;
+    // Cancelling before rtlsdr_read_async() started has no effect, so repeat until the thread is out
+    while (acquiring)
     {
         if((getSensorConnection() & CONNECTION_TCP) == 0)
-            rtlsdr_read_sync(rtl_dev, buf, len, &olen);
+            rtlsdr_cancel_async(rtl_dev);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    acquisition.join();
+}
+
+void RTLSDR::asyncCallback(unsigned char *buf, uint32_t len, void *ctx)
+{
+    RTLSDR *receiver = static_cast<RTLSDR *>(ctx);
+    if (!receiver->terminateThread)
+        receiver->ring.write(buf, len);
+}
+
+void RTLSDR::usbAcquisition()
+{
+    // librtlsdr keeps its transfers queued, the callback only copies each one into the ring
+    int r = rtlsdr_read_async(rtl_dev, asyncCallback, this, 0, MAX_FRAME_SIZE);
+    if (!terminateThread)
+        LOGF_ERROR("Receiver stopped streaming (%d).", r);
+    acquiring = false;
+}
+
+void RTLSDR::tcpAcquisition()
+{
+    uint8_t header[RTL_TCP_HEADER];
+    std::vector<uint8_t> discard(MAX_FRAME_SIZE);
+    int headerLen = 0;
+    bool oddDrop  = false;
+    struct pollfd pfd;
+
+    pfd.fd     = PortFD;
+    pfd.events = POLLIN;
+    while (!terminateThread)
+    {
+        int r = poll(&pfd, 1, 100);
+        if (r == 0 || (r < 0 && errno == EINTR))
+            continue;
+        if (r < 0)
+        {
+            LOGF_ERROR("rtl_tcp connection failed: %s", strerror(errno));
+            break;
+        }
+
+        uint8_t *ptr;
+        size_t space = ring.writable(&ptr);
+        ssize_t n;
+        if (headerLen < RTL_TCP_HEADER)
+        {
+            // rtl_tcp starts with "RTL0", the tuner type and the gain count
+            n = read(PortFD, header + headerLen, RTL_TCP_HEADER - headerLen);
+            if (n > 0 && (headerLen += n) == RTL_TCP_HEADER && memcmp(header, "RTL0", 4))
+                ring.write(header, RTL_TCP_HEADER);
+        }
+        else if (space == 0 || oddDrop)
+        {
+            // Ring full, keep the socket drained and count what is lost. Drop whole I/Q pairs.
+            n = read(PortFD, discard.data(), oddDrop ? 1 : discard.size());
+            if (n > 0)
+            {
+                ring.overrun(n);
+                oddDrop = oddDrop != (n & 1);
+            }
+        }
         else
-            olen = read(PortFD, buf, len);
-        if(olen < 0 )
-            AbortIntegration();
-        else {
-            buffer = buf;
-            n_read = olen;
-            grabData();
+        {
+            // Received straight into the ring
+            n = read(PortFD, ptr, min(space, static_cast<size_t>(MAX_FRAME_SIZE)));
+            if (n > 0)
+                ring.commit(n);
+        }
+
+        if (n == 0)
+        {
+            LOG_ERROR("rtl_tcp server closed the connection.");
+            break;
+        }
+        if (n < 0 && errno != EINTR && errno != EAGAIN)
+        {
+            LOGF_ERROR("rtl_tcp read failed: %s", strerror(errno));
+            break;
         }
     }
+    acquiring = false;
+}
+
+void RTLSDR::stopCollector()
+{
+    InIntegration   = false;
+    streamPredicate = 0;
+    if (!collector.joinable())
+        return;
+    if (collector.get_id() == std::this_thread::get_id())
+        collector.detach();
+    else
+        collector.join();
+}
+
+void RTLSDR::updateOverruns()
+{
+    uint64_t overruns = ring.overruns();
+    if (overruns == reportedOverruns)
+        return;
+    reportedOverruns  = overruns;
+    OverrunN[0].value = static_cast<double>(overruns);
+    OverrunN[1].value = static_cast<double>(ring.dropped());
+    OverrunNP.s       = IPS_ALERT;
+    IDSetNumber(&OverrunNP, nullptr);
 }
 
 void ISInit()
@@ -212,7 +359,9 @@ void ISSnoopDevice(XMLEle *root)
 
 RTLSDR::RTLSDR(int32_t index)
 {
-    InIntegration = false;
+    InIntegration   = false;
+    streamPredicate = 0;
+    terminateThread = false;
     if(index<0) {
         setSensorConnection(CONNECTION_TCP);
     }
@@ -245,18 +394,14 @@ bool RTLSDR::Connect()
 ***************************************************************************************/
 bool RTLSDR::Disconnect()
 {
-    InIntegration = false;
+    stopCollector();
+    stopAcquisition();
     if((getSensorConnection() & CONNECTION_TCP) == 0) {
         rtlsdr_close(rtl_dev);
     }
     PortFD = -1;
 
     setBufferSize(1);
-    pthread_mutex_lock(&condMutex);
-    streamPredicate = 1;
-    terminateThread = true;
-    pthread_cond_signal(&cv);
-    pthread_mutex_unlock(&condMutex);
     LOG_INFO("RTL-SDR Spectrograph disconnected successfully!");
     return true;
 }
@@ -285,6 +430,11 @@ bool RTLSDR::initProperties()
     setMinMaxStep("SPECTROGRAPH_SETTINGS", "SPECTROGRAPH_BITSPERSAMPLE", 16, 16, 0, false);
     setIntegrationFileExtension("fits");
 
+    IUFillNumber(&OverrunN[0], "OVERRUN_EVENTS", "Overruns", "%.f", 0, 1e15, 0, 0);
+    IUFillNumber(&OverrunN[1], "OVERRUN_BYTES", "Lost bytes", "%.f", 0, 1e15, 0, 0);
+    IUFillNumberVector(&OverrunNP, OverrunN, 2, getDeviceName(), "RECEIVER_OVERRUNS", "Receiver", MAIN_CONTROL_TAB, IP_RO,
+                       60, IPS_IDLE);
+
     // Add Debug, Simulator, and Configuration controls
     addAuxControls();
 
@@ -306,9 +456,20 @@ bool RTLSDR::updateProperties()
         // Inital values
         setupParams(1000000, 1420000000, 10);
 
+        OverrunN[0].value = 0;
+        OverrunN[1].value = 0;
+        OverrunNP.s       = IPS_OK;
+        defineNumber(&OverrunNP);
+        if (!startAcquisition())
+            OverrunNP.s = IPS_ALERT;
+
         // Start the timer
         SetTimer(POLLMS);
     }
+    else
+    {
+        deleteProperty(OverrunNP.name);
+    }
 
     return true;
 }
@@ -406,17 +567,13 @@ bool RTLSDR::ISNewNumber(const char *dev, const char *name, double values[], cha
 bool RTLSDR::StartIntegration(double duration)
 {
     IntegrationRequest = static_cast<float>(duration);
-    AbortIntegration();
+    stopCollector();
 
     LOG_INFO("Integration started...");
-    // Run threads
-    std::thread(&RTLSDR::Callback, this).detach();
     gettimeofday(&IntStart, nullptr);
     InIntegration = true;
+    collector     = std::thread(&RTLSDR::Callback, this);
     return true;
-
-    // We're done
-    return false;
 }
 
 /**************************************************************************************
@@ -424,10 +581,7 @@ bool RTLSDR::StartIntegration(double duration)
 ***************************************************************************************/
 bool RTLSDR::AbortIntegration()
 {
-    if (InIntegration)
-    {
-        InIntegration = false;
-    }
+    stopCollector();
     return true;
 }
 
@@ -480,54 +634,89 @@ void RTLSDR::TimerHit()
 /**************************************************************************************
 ** Create the spectrum
 ***************************************************************************************/
-void RTLSDR::grabData()
+void RTLSDR::grabData(const uint8_t *data, int len)
 {
     if (InIntegration)
     {
-        n_read    = min(to_read, n_read);
-        continuum = getBuffer();
-        if (n_read > 0)
+        len = min(to_read, len);
+        if (len > 0)
         {
-            memcpy(continuum + b_read, buffer, n_read);
-            b_read += n_read;
-            to_read -= n_read;
+            memcpy(continuum + b_read, data, len);
+            b_read += len;
+            to_read -= len;
+            ring.consume(len);
         }
 
         if (to_read <= 0)
         {
             InIntegration = false;
-            if(!streamPredicate) {
-                LOG_INFO("Download complete.");
-                IntegrationComplete();
-            } else {
-                StartIntegration(1.0 / Streamer->getTargetFPS());
-                int32_t size = getBufferSize();
-                Streamer->newFrame(getBuffer(), size);
+            if (ring.overruns() != integrationOverruns)
+                LOGF_WARN("Receiver overrun during the integration, %llu chunks lost.",
+                          static_cast<unsigned long long>(ring.overruns() - integrationOverruns));
+            updateOverruns();
+            LOG_INFO("Download complete.");
+            IntegrationComplete();
+        }
+    }
+}
+
+/**************************************************************************************
+** Stream frames are consecutive slices of the ring, nothing is lost between frames
+***************************************************************************************/
+void RTLSDR::streamCapture()
+{
+    const uint8_t *data;
+    size_t size = static_cast<size_t>(getSampleRate() / Streamer->getTargetFPS()) * getBPS() / 8;
+    size        = min(size, ring.capacity() / 2);
+    if (size < MIN_FRAME_SIZE)
+        size = MIN_FRAME_SIZE;
+    uint64_t overruns = ring.overruns();
+
+    frame.resize(size);
+    ring.flush();
+    while (streamPredicate)
+    {
+        if (!ring.wait(size, RING_WAIT))
+        {
+            if (!acquiring)
+            {
+                LOG_ERROR("Receiver stopped, streaming aborted.");
+                break;
             }
+            continue;
+        }
+
+        // Handed to the streamer in place, unless the frame wraps around the end of the ring
+        size_t len = ring.readable(&data);
+        if (len < size)
+        {
+            memcpy(frame.data(), data, len);
+            memcpy(frame.data() + len, ring.begin(), size - len);
+            data = frame.data();
         }
+        Streamer->newFrame(data, size);
+        ring.consume(size);
+        updateOverruns();
     }
+
+    if (ring.overruns() != overruns)
+        LOGF_WARN("Receiver overrun while streaming, %llu chunks lost.",
+                  static_cast<unsigned long long>(ring.overruns() - overruns));
 }
 
 //Streamer API functions
 
 bool RTLSDR::StartStreaming()
 {
-    pthread_mutex_lock(&condMutex);
+    stopCollector();
     streamPredicate = 1;
-    StartIntegration(1.0 / Streamer->getTargetFPS());
-    pthread_mutex_unlock(&condMutex);
-    pthread_cond_signal(&cv);
-
+    collector       = std::thread(&RTLSDR::streamCapture, this);
     return true;
 }
 
 bool RTLSDR::StopStreaming()
 {
-    pthread_mutex_lock(&condMutex);
-    streamPredicate = 0;
-    pthread_mutex_unlock(&condMutex);
-    pthread_cond_signal(&cv);
-
+    stopCollector();
     return true;
 }
 
@@ -26,6 +26,10 @@
 #include <rtl-sdr.h>
 #include "indispectrograph.h"
 #include "stream/streammanager.h"
+#include "ringbuffer.h"
+
+#include <atomic>
+#include <thread>
 
 enum Settings
 {
@@ -39,13 +43,12 @@ class RTLSDR : public INDI::Spectrograph
   public:
     RTLSDR(int32_t index);
 
-    void grabData();
+    void grabData(const uint8_t *data, int len);
     rtlsdr_dev_t *rtl_dev = { nullptr };
     int to_read;
     // Are we integrating?
-    bool InIntegration;
-    uint8_t *buffer;
-    int b_read, n_read;
+    std::atomic<bool> InIntegration;
+    int b_read;
     bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n) override;
 
   protected:
@@ -64,13 +67,22 @@ class RTLSDR : public INDI::Spectrograph
 
     bool StartStreaming() override;
     bool StopStreaming() override;
-    void * streamCapture();
+    void streamCapture();
 
     bool Handshake() override;
 
   private:
     void Callback();
 
+    // Acquisition: samples are received continuously into the ring while connected
+    bool startAcquisition();
+    void stopAcquisition();
+    void usbAcquisition();
+    void tcpAcquisition();
+    static void asyncCallback(unsigned char *buf, uint32_t len, void *ctx);
+    void stopCollector();
+    void updateOverruns();
+
     // Utility functions
     float CalcTimeLeft();
 
@@ -81,9 +93,21 @@ class RTLSDR : public INDI::Spectrograph
 
     int32_t spectrographIndex = { 0 };
 
-    int streamPredicate;
-    pthread_t primary_thread;
-    bool terminateThread;
+    std::atomic<int> streamPredicate;
+    std::atomic<bool> terminateThread;
+
+    RingBuffer ring;
+    std::thread acquisition;
+    std::atomic<bool> acquiring { false };
+    // Integration or stream thread, the only consumer of the ring
+    std::thread collector;
+    // Frames wrapping around the end of the ring are copied here
+    std::vector<uint8_t> frame;
+
+    INumber OverrunN[2];
+    INumberVectorProperty OverrunNP;
+    uint64_t reportedOverruns { 0 };
+    uint64_t integrationOverruns { 0 };
 
     bool sendTcpCommand(int cmd, int value);
     enum TcpCommands {
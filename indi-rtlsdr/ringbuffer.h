@@ -0,0 +1,158 @@
+/*
+    indi_rtlsdr - a software defined radio driver for INDI
+    Copyright (C) 2017  Ilia Platone - Jasem Mutlaq
+    Collaborators:
+        - Ilia Platone <info@iliaplatone.com>
+        - Jasem Mutlaq - INDI library - <http://indilib.org>
+        - Monroe Pattillo - Fox Observatory - South Florida Amateur Astronomers Association <http://www.sfaaa.com/>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Single producer, single consumer byte ring for the received samples.
+ * The producer (USB async callback or rtl_tcp reader) and the consumer (integration or stream
+ * thread) only share two monotonic counters, nothing is locked on the sample path. A chunk which
+ * does not fit is dropped whole and counted as an overrun, so the samples the consumer sees are
+ * only discontinuous at counted overruns.
+ * The consumer reads slices of the ring in place: readable() returns the contiguous part at the
+ * tail, the rest of a slice wrapping around the end follows from the start of the buffer.
+ */
+class RingBuffer
+{
+    public:
+        /** Allocate size bytes rounded up to a power of two. Neither side may be running. */
+        void resize(size_t size)
+        {
+            size_t capacity = 1;
+            while (capacity < size)
+                capacity <<= 1;
+            data.assign(capacity, 0);
+            mask = capacity - 1;
+            head = 0;
+            tail = 0;
+            overrunCount = 0;
+            droppedBytes = 0;
+        }
+
+        size_t capacity() const { return data.size(); }
+
+        // Producer side
+
+        /** Contiguous free space at the head, to receive into directly. */
+        size_t writable(uint8_t **ptr)
+        {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            size_t space = data.size() - static_cast<size_t>(h - tail.load(std::memory_order_acquire));
+            size_t offset = static_cast<size_t>(h & mask);
+            *ptr = data.data() + offset;
+            return space < data.size() - offset ? space : data.size() - offset;
+        }
+
+        /** Publish len bytes written at the head. */
+        void commit(size_t len)
+        {
+            head.store(head.load(std::memory_order_relaxed) + len, std::memory_order_release);
+            ready.notify_one();
+        }
+
+        /** Copy a chunk in, or drop it whole if it does not fit. */
+        bool write(const uint8_t *chunk, size_t len)
+        {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            if (len > data.size() - static_cast<size_t>(h - tail.load(std::memory_order_acquire)))
+            {
+                overrun(len);
+                return false;
+            }
+            size_t offset = static_cast<size_t>(h & mask);
+            size_t first  = len < data.size() - offset ? len : data.size() - offset;
+            memcpy(data.data() + offset, chunk, first);
+            memcpy(data.data(), chunk + first, len - first);
+            commit(len);
+            return true;
+        }
+
+        /** Count len bytes lost by the producer. */
+        void overrun(size_t len)
+        {
+            overrunCount.fetch_add(1, std::memory_order_relaxed);
+            droppedBytes.fetch_add(len, std::memory_order_relaxed);
+        }
+
+        // Consumer side
+
+        size_t available() const
+        {
+            return static_cast<size_t>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed));
+        }
+
+        /** Contiguous received bytes at the tail. */
+        size_t readable(const uint8_t **ptr) const
+        {
+            size_t offset = static_cast<size_t>(tail.load(std::memory_order_relaxed) & mask);
+            size_t len    = available();
+            *ptr = data.data() + offset;
+            return len < data.size() - offset ? len : data.size() - offset;
+        }
+
+        /** Start of the buffer, where a slice wrapping around the end continues. */
+        const uint8_t *begin() const { return data.data(); }
+
+        void consume(size_t len)
+        {
+            tail.store(tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+        }
+
+        /** Drop everything received so far. */
+        void flush()
+        {
+            tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+        /** Wait until len bytes are available, false on timeout. */
+        bool wait(size_t len, std::chrono::milliseconds timeout)
+        {
+            if (available() >= len)
+                return true;
+            // The producer notifies without the lock, a missed wakeup only costs the timeout
+            std::unique_lock<std::mutex> lock(mutex);
+            return ready.wait_for(lock, timeout, [&] { return available() >= len; });
+        }
+
+        uint64_t overruns() const { return overrunCount.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return droppedBytes.load(std::memory_order_relaxed); }
+
+    private:
+        std::vector<uint8_t> data;
+        size_t mask { 0 };
+        std::atomic<uint64_t> head { 0 };
+        std::atomic<uint64_t> tail { 0 };
+        std::atomic<uint64_t> overrunCount { 0 };
+        std::atomic<uint64_t> droppedBytes { 0 };
+
+        std::mutex mutex;
+        std::condition_variable ready;
+};
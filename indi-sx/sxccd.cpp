@@ -33,9 +33,18 @@
 
 #include "sxconfig.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include <unistd.h>
+#include <errno.h>
+#include <sys/time.h>
 
 #define SX_GUIDE_EAST  0x08 /* RA+ */
 #define SX_GUIDE_NORTH 0x04 /* DEC+ */
@@ -178,6 +187,115 @@ void NSGuiderTimerCallback(void *p)
     ((SXCCD *)p)->NSGuiderTimerHit();
 }
 
+void ReadoutCompleteCallback(int fd, void *p)
+{
+    char c;
+    if (read(fd, &c, 1) == 1)
+        ((SXCCD *)p)->ReadoutComplete();
+}
+
+// Copies the rows of a field to every other frame buffer row as the bulk reads land
+struct FieldMerge
+{
+    const char *field;
+    uint8_t *buf;
+    int rowBytes;
+    int first;
+    int rows;
+    int merged;
+};
+
+static void MergeFieldRows(FieldMerge *merge, int rows)
+{
+    for (; merge->merged < rows; merge->merged++)
+        memcpy(merge->buf + (2 * merge->merged + merge->first) * merge->rowBytes,
+               merge->field + merge->merged * merge->rowBytes, merge->rowBytes);
+}
+
+static void MergeFieldProgress(unsigned long read, void *p)
+{
+    FieldMerge *merge = (FieldMerge *)p;
+    MergeFieldRows(merge, std::min<int>(read / merge->rowBytes, merge->rows));
+}
+
+// ICX453 sensors send each pair of rows as one row of twice the width, pixels alternating between the two.
+// SXVF-M25C sends every second pixel pair swapped.
+static void ReshuffleICX453Rows(const uint16_t *in, uint16_t *row0, uint16_t *row1, int subW, bool swap)
+{
+    int offset_1 = swap ? 3 : 2, offset_2 = swap ? 2 : 3;
+    int j = 0;
+#if defined(__SSE2__)
+    const __m128i odd = _mm_set1_epi32((int)0xFFFF0000);
+    for (; j + 8 <= subW; j += 8)
+    {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(in + 2 * j));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(in + 2 * j + 8));
+        __m128i t0 = _mm_unpacklo_epi16(x0, x1);
+        __m128i t1 = _mm_unpackhi_epi16(x0, x1);
+        __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+        __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+        __m128i p0 = _mm_unpacklo_epi16(u0, u1);
+        __m128i p1 = _mm_unpackhi_epi16(u0, u1);
+        if (swap)
+        {
+            __m128i s0 = _mm_or_si128(_mm_andnot_si128(odd, p0), _mm_and_si128(odd, p1));
+            p1 = _mm_or_si128(_mm_andnot_si128(odd, p1), _mm_and_si128(odd, p0));
+            p0 = s0;
+        }
+        _mm_storeu_si128((__m128i *)(row0 + j), p0);
+        _mm_storeu_si128((__m128i *)(row1 + j), p1);
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint16x8_t odd = vreinterpretq_u16_u32(vdupq_n_u32(0xFFFF0000));
+    for (; j + 8 <= subW; j += 8)
+    {
+        uint16x8x2_t x = vld2q_u16(in + 2 * j);
+        uint16x8_t p0 = x.val[0], p1 = x.val[1];
+        if (swap)
+        {
+            p0 = vbslq_u16(odd, x.val[1], x.val[0]);
+            p1 = vbslq_u16(odd, x.val[0], x.val[1]);
+        }
+        vst1q_u16(row0 + j, p0);
+        vst1q_u16(row1 + j, p1);
+    }
+#endif
+    for (; j < subW; j += 2)
+    {
+        int j2 = j * 2;
+        row0[j]     = in[j2];
+        row0[j + 1] = in[j2 + offset_1];
+        row1[j]     = in[j2 + 1];
+        row1[j + 1] = in[j2 + offset_2];
+    }
+}
+
+struct ICX453Merge
+{
+    const uint16_t *in;
+    uint16_t *buf;
+    int subW;
+    bool swap;
+    int pairs;
+    int merged;
+};
+
+static void MergeICX453Pairs(ICX453Merge *merge, int pairs)
+{
+    for (; merge->merged < pairs; merge->merged++)
+    {
+        int isubW = 2 * merge->merged * merge->subW;
+        ReshuffleICX453Rows(merge->in + isubW, merge->buf + isubW, merge->buf + isubW + merge->subW, merge->subW,
+                            merge->swap);
+    }
+}
+
+static void MergeICX453Progress(unsigned long read, void *p)
+{
+    ICX453Merge *merge = (ICX453Merge *)p;
+    MergeICX453Pairs(merge, std::min<int>(read / (4 * merge->subW), merge->pairs));
+}
+
 SXCCD::SXCCD(DEVICE device, const char *name)
 {
     this->device          = device;
@@ -203,6 +321,15 @@ SXCCD::SXCCD(DEVICE device, const char *name)
     DidGuideLatch         = false;
     NSGuiderTimerID       = 0;
     WEGuiderTimerID       = 0;
+    wipeDelay             = 0;
+    readoutExit           = false;
+    readoutPipe[0]        = -1;
+    readoutPipe[1]        = -1;
+    readoutCallbackID     = 0;
+    ExposureSequence      = 0;
+    GuideExposureSequence = 0;
+    ReadingPrimary        = false;
+    ExposureDeferred      = false;
     snprintf(this->name, 32, "SX CCD %s", name);
     setDeviceName(this->name);
     setVersion(VERSION_MAJOR, VERSION_MINOR);
@@ -210,6 +337,7 @@ SXCCD::SXCCD(DEVICE device, const char *name)
 
 SXCCD::~SXCCD()
 {
+    StopReadout();
     if (handle)
         sxClose(&handle);
 }
@@ -243,6 +371,10 @@ bool SXCCD::initProperties()
     IUFillSwitch(&ShutterS[1], "SHUTTER_OFF", "Manual close", ISS_ON);
     IUFillSwitchVector(&ShutterSP, ShutterS, 2, getDeviceName(), "CCD_SHUTTER", "Shutter", OPTIONS_TAB, IP_RW,
                        ISR_1OFMANY, 60, IPS_IDLE);
+    IUFillNumber(&ReadoutN[0], "READOUT_WIPE_DELAY", "Wipe delay (ms)", "%.1f", 0, 100000, 0, 0);
+    IUFillNumber(&ReadoutN[1], "READOUT_TIME", "Readout time (s)", "%.3f", 0, 1000, 0, 0);
+    IUFillNumberVector(&ReadoutNP, ReadoutN, 2, getDeviceName(), "CCD_READOUT", "Readout", IMAGE_INFO_TAB, IP_RO, 60,
+                       IPS_IDLE);
 
     //Adding switch to let user indicate whether the CCD has a Bayer filter, since I do not know which models beyond UltraStar C actually do
     //    IUFillSwitch(&BayerS[0], "BAYER_TRUE", "True", ISS_OFF);
@@ -264,6 +396,7 @@ bool SXCCD::updateProperties()
     if (isConnected())
     {
         SetupParms();
+        defineNumber(&ReadoutNP);
         if (HasCooler)
             defineSwitch(&CoolerSP);
         if (HasShutter)
@@ -274,6 +407,7 @@ bool SXCCD::updateProperties()
     }
     else
     {
+        deleteProperty(ReadoutNP.name);
         if (HasCooler)
             deleteProperty(CoolerSP.name);
         if (HasShutter)
@@ -374,6 +508,13 @@ bool SXCCD::Connect()
 
             SetCCDCapability(cap);
 
+            if (!StartReadout())
+            {
+                LOG_ERROR("Failed to start the readout thread");
+                sxClose(&handle);
+                return false;
+            }
+
             return true;
         }
     }
@@ -382,6 +523,7 @@ bool SXCCD::Connect()
 
 bool SXCCD::Disconnect()
 {
+    StopReadout();
     if (handle != nullptr)
     {
         sxClose(&handle);
@@ -389,6 +531,146 @@ bool SXCCD::Disconnect()
     return true;
 }
 
+bool SXCCD::StartReadout()
+{
+    if (pipe(readoutPipe) < 0)
+        return false;
+    readoutExit = false;
+    try
+    {
+        readoutThread = std::thread(&SXCCD::ReadoutThread, this);
+    }
+    catch (const std::system_error &)
+    {
+        close(readoutPipe[0]);
+        close(readoutPipe[1]);
+        readoutPipe[0] = readoutPipe[1] = -1;
+        return false;
+    }
+    readoutCallbackID = IEAddCallback(readoutPipe[0], ReadoutCompleteCallback, this);
+    return true;
+}
+
+void SXCCD::StopReadout()
+{
+    if (readoutThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(readoutMutex);
+            readoutExit = true;
+        }
+        readoutCondition.notify_one();
+        // A read in progress runs to completion or BULK_DATA_TIMEOUT
+        readoutThread.join();
+    }
+    if (readoutCallbackID)
+    {
+        IERmCallback(readoutCallbackID);
+        readoutCallbackID = 0;
+    }
+    if (readoutPipe[0] >= 0)
+    {
+        close(readoutPipe[0]);
+        close(readoutPipe[1]);
+        readoutPipe[0] = readoutPipe[1] = -1;
+    }
+    readoutRequests.clear();
+    readoutResults.clear();
+    DidLatch         = false;
+    DidGuideLatch    = false;
+    ReadingPrimary   = false;
+    ExposureDeferred = false;
+}
+
+void SXCCD::QueueReadout(Readout readout)
+{
+    {
+        std::lock_guard<std::mutex> lock(readoutMutex);
+        // The guide head is read ahead of a queued primary frame, it has to wait for one being read
+        // as both share the bulk in pipe
+        if (readout.guide)
+            readoutRequests.push_front(readout);
+        else
+            readoutRequests.push_back(readout);
+    }
+    readoutCondition.notify_one();
+}
+
+void SXCCD::ReadoutThread()
+{
+    std::unique_lock<std::mutex> lock(readoutMutex);
+    while (true)
+    {
+        readoutCondition.wait(lock, [this]
+        {
+            return readoutExit || !readoutRequests.empty();
+        });
+        if (readoutExit)
+            break;
+        Readout readout = readoutRequests.front();
+        readoutRequests.pop_front();
+        lock.unlock();
+
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        long startTime = tv.tv_sec * 1000000 + tv.tv_usec;
+        readout.rc = readout.guide ? ReadGuide(readout) : ReadPrimary(readout);
+        gettimeofday(&tv, nullptr);
+        readout.seconds = (tv.tv_sec * 1000000 + tv.tv_usec - startTime) / 1e6;
+
+        lock.lock();
+        readoutResults.push_back(readout);
+        char c = 0;
+        if (write(readoutPipe[1], &c, 1) != 1)
+            LOGF_ERROR("Failed to signal readout completion: %s", strerror(errno));
+    }
+}
+
+void SXCCD::ReadoutComplete()
+{
+    std::deque<Readout> results;
+    {
+        std::lock_guard<std::mutex> lock(readoutMutex);
+        results.swap(readoutResults);
+    }
+    for (const Readout &readout : results)
+    {
+        // Frames of aborted exposures are dropped
+        if (readout.guide)
+        {
+            if (readout.sequence != GuideExposureSequence || !InGuideExposure)
+                continue;
+            DidGuideLatch   = false;
+            InGuideExposure = false;
+            GuideCCD.setExposureLeft(GuideExposureTimeLeft = 0);
+            if (readout.rc)
+                ExposureComplete(&GuideCCD);
+        }
+        else
+        {
+            ReadingPrimary = false;
+            if (readout.sequence != ExposureSequence || !InExposure)
+                continue;
+            DidLatch   = false;
+            InExposure = false;
+            PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
+            if (readout.rc)
+            {
+                ReadoutN[0].value = sxIsInterlaced(model) ? wipeDelay / 1000.0 : 0;
+                ReadoutN[1].value = readout.seconds;
+                ReadoutNP.s       = IPS_OK;
+                IDSetNumber(&ReadoutNP, nullptr);
+                ExposureComplete(&PrimaryCCD);
+            }
+        }
+    }
+    if (ExposureDeferred && !ReadingPrimary)
+    {
+        ExposureDeferred = false;
+        BeginExposure();
+    }
+}
+
 void SXCCD::SetupParms()
 {
     struct t_sxccd_params params;
@@ -446,7 +728,9 @@ void SXCCD::TimerHit()
 {
     if (isConnected() && HasCooler)
     {
-        if (!DidLatch && !DidGuideLatch)
+        // Skip the cooler while a frame is being read, the next tick catches up
+        std::unique_lock<std::mutex> usb(usbMutex, std::try_to_lock);
+        if (usb.owns_lock())
         {
             unsigned char status;
             unsigned short temperature;
@@ -464,7 +748,7 @@ void SXCCD::TimerHit()
             }
         }
     }
-    if (InExposure && ExposureTimeLeft >= 0)
+    if (InExposure && !ExposureDeferred && ExposureTimeLeft >= 0)
         PrimaryCCD.setExposureLeft(ExposureTimeLeft--);
     if (InGuideExposure && GuideExposureTimeLeft >= 0)
         GuideCCD.setExposureLeft(GuideExposureTimeLeft--);
@@ -478,13 +762,16 @@ int SXCCD::SetTemperature(double temperature)
     TemperatureRequest = temperature;
     unsigned char status;
     unsigned short sx_temperature;
-    sxSetCooler(handle, (unsigned char)(CoolerS[0].s == ISS_ON), (unsigned short)(TemperatureRequest * 10 + 2730),
-                &status, &sx_temperature);
-    TemperatureReported = TemperatureN[0].value = (sx_temperature - 2730) / 10.0;
-    if (std::fabs(TemperatureRequest - TemperatureReported) < 1)
-        result = 1;
-    else
-        result = 0;
+    // While a frame is being read TimerHit() sends the request later
+    std::unique_lock<std::mutex> usb(usbMutex, std::try_to_lock);
+    if (usb.owns_lock())
+    {
+        sxSetCooler(handle, (unsigned char)(CoolerS[0].s == ISS_ON), (unsigned short)(TemperatureRequest * 10 + 2730),
+                    &status, &sx_temperature);
+        TemperatureReported = TemperatureN[0].value = (sx_temperature - 2730) / 10.0;
+        if (std::fabs(TemperatureRequest - TemperatureReported) < 1)
+            result = 1;
+    }
 
     CoolerSP.s   = IPS_OK;
     CoolerS[0].s = ISS_ON;
@@ -498,16 +785,38 @@ bool SXCCD::StartExposure(float n)
 {
     InExposure = true;
     PrimaryCCD.setExposureDuration(n);
-    if (sxIsInterlaced(model) && PrimaryCCD.getBinY() == 1)
+    PrimaryCCD.setExposureLeft(ExposureTimeLeft = n);
+    DidLatch = false;
+    ExposureSequence++;
+    // A frame latched before an abort is still being read, clearing now would block the event loop
+    // on usbMutex for the rest of that download. ReadoutComplete() starts the exposure instead.
+    if (ReadingPrimary)
     {
-        sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
-        usleep(wipeDelay);
-        sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
+        ExposureDeferred = true;
+        LOG_DEBUG("Exposure starts once the aborted frame is read.");
+        return true;
+    }
+    BeginExposure();
+    return true;
+}
+
+void SXCCD::BeginExposure()
+{
+    float n = PrimaryCCD.getExposureDuration();
+    {
+        // Only a guide head readout can hold the lock here, and not for long
+        std::lock_guard<std::mutex> usb(usbMutex);
+        if (sxIsInterlaced(model) && PrimaryCCD.getBinY() == 1)
+        {
+            sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
+            usleep(wipeDelay);
+            sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
+        }
+        else
+            sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0);
+        if (HasShutter && PrimaryCCD.getFrameType() != INDI::CCDChip::DARK_FRAME)
+            sxSetShutter(handle, 0);
     }
-    else
-        sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0);
-    if (HasShutter && PrimaryCCD.getFrameType() != INDI::CCDChip::DARK_FRAME)
-        sxSetShutter(handle, 0);
     int time = (int)(1000 * n);
     if (time < 1)
         time = 1;
@@ -518,10 +827,8 @@ bool SXCCD::StartExposure(float n)
     }
     else
         DidFlush = true;
-    DidLatch         = false;
     ExposureTimeLeft = n;
     ExposureTimerID  = IEAddTimer(time, ExposureTimerCallback, this);
-    return true;
 }
 
 bool SXCCD::AbortExposure()
@@ -530,12 +837,19 @@ bool SXCCD::AbortExposure()
     {
         if (ExposureTimerID)
             IERmTimer(ExposureTimerID);
-        if (HasShutter)
+        // A frame already latched is read anyway, ReadoutComplete() drops it
+        if (HasShutter && !DidLatch && !ExposureDeferred)
+        {
+            std::lock_guard<std::mutex> usb(usbMutex);
             sxSetShutter(handle, 1);
+        }
         ExposureTimerID = 0;
         PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
-        DidLatch = false;
-        DidFlush = false;
+        ExposureSequence++;
+        InExposure       = false;
+        DidLatch         = false;
+        DidFlush         = false;
+        ExposureDeferred = false;
         return true;
     }
     return false;
@@ -548,136 +862,132 @@ void SXCCD::ExposureTimerHit()
         if (!DidFlush)
         {
             ExposureTimerID = IEAddTimer(3000, ExposureTimerCallback, this);
+            std::lock_guard<std::mutex> usb(usbMutex);
             sxClearPixels(handle, CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
             DidFlush = true;
         }
         else
         {
-            int rc;
-            ExposureTimerID   = 0;
-            bool isInterlaced = sxIsInterlaced(model);
-            int subX          = PrimaryCCD.getSubX();
-            int subY          = PrimaryCCD.getSubY();
-            int subW          = PrimaryCCD.getSubW();
-            int subH          = PrimaryCCD.getSubH();
-            int binX          = PrimaryCCD.getBinX();
-            int binY          = PrimaryCCD.getBinY();
-            int subWW         = subW * 2;
-            bool isICX453     = sxIsICX453(model);
-            uint8_t *buf      = PrimaryCCD.getFrameBuffer();
-            int size;
-            if (isInterlaced && binY > 1)
-                size = subW * subH / 2 / binX / (binY / 2);
-            else
-                size = subW * subH / binX / binY;
-            if (HasShutter)
-                sxSetShutter(handle, 1);
-            DidLatch = true;
-            if (isInterlaced)
+            Readout readout;
+            ExposureTimerID  = 0;
+            readout.guide    = false;
+            readout.sequence = ExposureSequence;
+            readout.subX     = PrimaryCCD.getSubX();
+            readout.subY     = PrimaryCCD.getSubY();
+            readout.subW     = PrimaryCCD.getSubW();
+            readout.subH     = PrimaryCCD.getSubH();
+            readout.binX     = PrimaryCCD.getBinX();
+            readout.binY     = PrimaryCCD.getBinY();
+            readout.buf      = PrimaryCCD.getFrameBuffer();
+            readout.rc       = 0;
+            readout.seconds  = 0;
+            DidLatch         = true;
+            ReadingPrimary   = true;
+            QueueReadout(readout);
+        }
+    }
+}
+
+int SXCCD::ReadPrimary(const Readout &readout)
+{
+    int rc;
+    bool isInterlaced = sxIsInterlaced(model);
+    int subX          = readout.subX;
+    int subY          = readout.subY;
+    int subW          = readout.subW;
+    int subH          = readout.subH;
+    int binX          = readout.binX;
+    int binY          = readout.binY;
+    int subWW         = subW * 2;
+    bool isICX453     = sxIsICX453(model);
+    uint8_t *buf      = readout.buf;
+    int size;
+    if (isInterlaced && binY > 1)
+        size = subW * subH / 2 / binX / (binY / 2);
+    else
+        size = subW * subH / binX / binY;
+    std::lock_guard<std::mutex> usb(usbMutex);
+    if (HasShutter)
+        sxSetShutter(handle, 1);
+    if (isInterlaced)
+    {
+        if (binY > 1)
+        {
+            rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY / binY, subW, subH / 2, binX,
+                               binY / 2);
+            if (rc)
+                rc = sxReadPixels(handle, buf, size * 2);
+        }
+        else
+        {
+            rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2, subW,
+                               subH / 2, binX, 1);
+            // Odd field rows go to even frame buffer rows and the other way round, merged as they land
+            FieldMerge even = { evenBuf, buf, subWW, 1, (subH + 1) / 2, 0 };
+            FieldMerge odd  = { oddBuf, buf, subWW, 0, (subH + 1) / 2, 0 };
+            struct timeval tv;
+            gettimeofday(&tv, nullptr);
+            long startTime = tv.tv_sec * 1000000 + tv.tv_usec;
+            if (rc)
+                rc = sxReadPixels(handle, evenBuf, size, MergeFieldProgress, &even);
+            gettimeofday(&tv, nullptr);
+            wipeDelay = tv.tv_sec * 1000000 + tv.tv_usec - startTime;
+            if (rc)
+                rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2,
+                                   subW, subH / 2, binX, 1);
+            if (rc)
+                rc = sxReadPixels(handle, oddBuf, size, MergeFieldProgress, &odd);
+            if (rc)
             {
-                if (binY > 1)
-                {
-                    rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY / binY, subW, subH / 2, binX,
-                                       binY / 2);
-                    if (rc)
-                        rc = sxReadPixels(handle, buf, size * 2);
-                }
-                else
-                {
-                    rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2, subW,
-                                       subH / 2, binX, 1);
-                    struct timeval tv;
-                    gettimeofday(&tv, nullptr);
-                    long startTime = tv.tv_sec * 1000000 + tv.tv_usec;
-                    if (rc)
-                        rc = sxReadPixels(handle, evenBuf, size);
-                    gettimeofday(&tv, nullptr);
-                    wipeDelay = tv.tv_sec * 1000000 + tv.tv_usec - startTime;
-                    if (rc)
-                        rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2,
-                                           subW, subH / 2, binX, 1);
-                    if (rc)
-                        rc = sxReadPixels(handle, oddBuf, size);
-                    if (rc)
-                    {
-                        for (int i = 0, j = 0; i < subH; i += 2, j++)
-                        {
-                            memcpy(buf + i * subWW, oddBuf + (j * subWW), subWW);
-                            memcpy(buf + ((i + 1) * subWW), evenBuf + (j * subWW), subWW);
-                        }
-                        //            deinterlace((unsigned short *)buf, subW, subH);
-                    }
-                }
+                MergeFieldRows(&even, even.rows);
+                MergeFieldRows(&odd, odd.rows);
+                //            deinterlace((unsigned short *)buf, subW, subH);
             }
-            else if (isICX453)
+        }
+    }
+    else if (isICX453)
+    {
+        rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX * 2, subY / 2, subW * 2, subH / 2, binX, binY);
+        if (rc)
+        {
+            if (binX == 1 && binY == 1)
             {
-                rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX * 2, subY / 2, subW * 2, subH / 2, binX, binY);
+                // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
+                // on SXVF-M25C.
+                ICX453Merge merge = { reinterpret_cast<uint16_t *>(evenBuf), reinterpret_cast<uint16_t *>(buf), subW,
+                                      strstr(getDeviceName(), "SXVF-M25C") != nullptr, (subH + 1) / 2, 0
+                                    };
+                rc = sxReadPixels(handle, evenBuf, size * 2, MergeICX453Progress, &merge);
                 if (rc)
-                {
-                    if (binX == 1 && binY == 1)
-                    {
-                        rc = sxReadPixels(handle, evenBuf, size * 2);
-                        if (rc)
-                        {
-                            uint16_t *buf16 = reinterpret_cast<uint16_t *>(buf);
-                            uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
-
-                            int offset_1 = 2, offset_2 = 3;
-                            if (strstr(getDeviceName(), "SXVF-M25C"))
-                            {
-                                // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
-                                // on SXVF-M25C.
-                                offset_1 = 3;
-                                offset_2 = 2;
-                            }
-
-                            for (int i = 0; i < subH; i += 2)
-                            {
-                                for (int j = 0; j < subW; j += 2)
-                                {
-                                    int isubW = i * subW;
-                                    int i1subW = (i + 1) * subW;
-                                    int j2 = j * 2;
-
-                                    buf16[isubW + j]  = evenBuf16[isubW + j2];
-                                    buf16[isubW + j + 1]  = evenBuf16[isubW + j2 + offset_1];
-                                    buf16[i1subW + j]  = evenBuf16[isubW + j2 + 1];
-                                    buf16[i1subW + j + 1]  = evenBuf16[isubW + j2 + offset_2];
-
-                                }
-                            }
-                        }
-                    }
-                    else
-                    {
-                        rc = sxReadPixels(handle, buf, size * 2);
-                    }
-                }
+                    MergeICX453Pairs(&merge, merge.pairs);
             }
             else
             {
-                rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY, subW, subH, binX, binY);
-                if (rc)
-                    rc = sxReadPixels(handle, buf, size * 2);
+                rc = sxReadPixels(handle, buf, size * 2);
             }
-            DidLatch   = false;
-            InExposure = false;
-            PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
-            if (rc)
-                ExposureComplete(&PrimaryCCD);
         }
     }
+    else
+    {
+        rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY, subW, subH, binX, binY);
+        if (rc)
+            rc = sxReadPixels(handle, buf, size * 2);
+    }
+    return rc;
 }
 
 bool SXCCD::StartGuideExposure(float n)
 {
     InGuideExposure = true;
     GuideCCD.setExposureDuration(n);
+    // No reply to wait for, so this does not wait for a primary frame being read
     sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 1);
     int time = (int)(1000 * n);
     if (time < 1)
         time = 1;
     ExposureTimeLeft     = n;
+    DidGuideLatch        = false;
+    GuideExposureSequence++;
     GuideExposureTimerID = IEAddTimer(time, GuideExposureTimerCallback, this);
     return true;
 }
@@ -690,6 +1000,8 @@ bool SXCCD::AbortGuideExposure()
             IERmTimer(GuideExposureTimerID);
         GuideCCD.setExposureLeft(GuideExposureTimeLeft = 0);
         GuideExposureTimerID = 0;
+        GuideExposureSequence++;
+        InGuideExposure      = false;
         DidGuideLatch        = false;
         return true;
     }
@@ -700,28 +1012,35 @@ void SXCCD::GuideExposureTimerHit()
 {
     if (InGuideExposure)
     {
-        int rc;
+        Readout readout;
         GuideExposureTimerID = 0;
-        int subX             = GuideCCD.getSubX();
-        int subY             = GuideCCD.getSubY();
-        int subW             = GuideCCD.getSubW();
-        int subH             = GuideCCD.getSubH();
-        int binX             = GuideCCD.getBinX();
-        int binY             = GuideCCD.getBinY();
-        int size             = subW * subH / binX / binY;
-        uint8_t *buf         = GuideCCD.getFrameBuffer();
+        readout.guide        = true;
+        readout.sequence     = GuideExposureSequence;
+        readout.subX         = GuideCCD.getSubX();
+        readout.subY         = GuideCCD.getSubY();
+        readout.subW         = GuideCCD.getSubW();
+        readout.subH         = GuideCCD.getSubH();
+        readout.binX         = GuideCCD.getBinX();
+        readout.binY         = GuideCCD.getBinY();
+        readout.buf          = GuideCCD.getFrameBuffer();
+        readout.rc           = 0;
+        readout.seconds      = 0;
         DidGuideLatch        = true;
-        rc                   = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 1, subX, subY, subW, subH, binX, binY);
-        if (rc)
-            rc = sxReadPixels(handle, buf, size);
-        DidGuideLatch   = false;
-        InGuideExposure = false;
-        GuideCCD.setExposureLeft(GuideExposureTimeLeft = 0);
-        if (rc)
-            ExposureComplete(&GuideCCD);
+        QueueReadout(readout);
     }
 }
 
+int SXCCD::ReadGuide(const Readout &readout)
+{
+    int size = readout.subW * readout.subH / readout.binX / readout.binY;
+    std::lock_guard<std::mutex> usb(usbMutex);
+    int rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 1, readout.subX, readout.subY, readout.subW, readout.subH,
+                           readout.binX, readout.binY);
+    if (rc)
+        rc = sxReadPixels(handle, readout.buf, size);
+    return rc;
+}
+
 IPState SXCCD::GuideWest(uint32_t ms)
 {
     if (!HasST4Port || ms < 1)
@@ -735,6 +1054,7 @@ IPState SXCCD::GuideWest(uint32_t ms)
     }
     GuideStatus &= SX_CLEAR_WE;
     GuideStatus |= SX_GUIDE_WEST;
+    // No reply to wait for, so pulses do not wait for a frame being read
     sxSetSTAR2000(handle, GuideStatus);
     if (ms < 100)
     {
@@ -853,6 +1173,7 @@ bool SXCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
         IUUpdateSwitch(&ShutterSP, states, names, n);
         ShutterSP.s = IPS_OK;
         IDSetSwitch(&ShutterSP, nullptr);
+        std::lock_guard<std::mutex> usb(usbMutex);
         sxSetShutter(handle, ShutterS[0].s != ISS_ON);
         result = true;
     }
@@ -863,6 +1184,7 @@ bool SXCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
         IDSetSwitch(&CoolerSP, nullptr);
         unsigned char status;
         unsigned short temperature;
+        std::lock_guard<std::mutex> usb(usbMutex);
         sxSetCooler(handle, (unsigned char)(CoolerS[0].s == ISS_ON), (unsigned short)(TemperatureRequest * 10 + 2730),
                     &status, &temperature);
         TemperatureReported = TemperatureN[0].value = (temperature - 2730) / 10.0;
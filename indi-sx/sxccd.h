@@ -35,10 +35,17 @@
 
 #include <indiccd.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 void ExposureTimerCallback(void *p);
 void GuideExposureTimerCallback(void *p);
 void WEGuiderTimerCallback(void *p);
 void NSGuiderTimerCallback(void *p);
+void ReadoutCompleteCallback(int fd, void *p);
 
 class SXCCD : public INDI::CCD
 {
@@ -48,11 +55,13 @@ class SXCCD : public INDI::CCD
         unsigned short model;
         char name[32];
         char *evenBuf, *oddBuf;
-        long wipeDelay;
+        std::atomic<long> wipeDelay;
         ISwitch CoolerS[2];
         ISwitchVectorProperty CoolerSP;
         ISwitch ShutterS[2];
         ISwitchVectorProperty ShutterSP;
+        INumber ReadoutN[2];
+        INumberVectorProperty ReadoutNP;
         //    ISwitch BayerS[2];
         //    ISwitchVectorProperty BayerSP;
         float TemperatureRequest;
@@ -69,6 +78,42 @@ class SXCCD : public INDI::CCD
         bool InGuideExposure;
         char GuideStatus;
 
+        // Latched frames are read on the readout thread and handed back to the event loop through
+        // readoutPipe, so a download does not hold up guide exposures and pulses.
+        struct Readout
+        {
+            bool guide;
+            unsigned sequence;
+            int subX, subY, subW, subH, binX, binY;
+            uint8_t *buf;
+            int rc;
+            double seconds;
+        };
+        std::thread readoutThread;
+        std::mutex readoutMutex;
+        std::condition_variable readoutCondition;
+        std::deque<Readout> readoutRequests;
+        std::deque<Readout> readoutResults;
+        bool readoutExit;
+        int readoutPipe[2];
+        int readoutCallbackID;
+        unsigned ExposureSequence;
+        unsigned GuideExposureSequence;
+        // A primary frame is queued or being read, possibly one dropped by AbortExposure()
+        bool ReadingPrimary;
+        // StartExposure() waits for that frame before clearing the chip
+        bool ExposureDeferred;
+        // Held across USB exchanges that expect a reply, including latch and read
+        std::mutex usbMutex;
+
+        bool StartReadout();
+        void StopReadout();
+        void QueueReadout(Readout readout);
+        void BeginExposure();
+        void ReadoutThread();
+        int ReadPrimary(const Readout &readout);
+        int ReadGuide(const Readout &readout);
+
     protected:
         const char *getDefaultName();
         bool initProperties();
@@ -88,6 +133,7 @@ class SXCCD : public INDI::CCD
         void GuideExposureTimerHit();
         void WEGuiderTimerHit();
         void NSGuiderTimerHit();
+        void ReadoutComplete();
         //bool saveConfigItems(FILE *fp);
         IPState GuideWest(uint32_t ms);
         IPState GuideEast(uint32_t ms);
@@ -111,6 +157,7 @@ class SXCCD : public INDI::CCD
         friend void ::GuideExposureTimerCallback(void *p);
         friend void ::WEGuiderTimerCallback(void *p);
         friend void ::NSGuiderTimerCallback(void *p);
+        friend void ::ReadoutCompleteCallback(int fd, void *p);
         friend void ::ISGetProperties(const char *dev);
         friend void ::ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int num);
         friend void ::ISNewText(const char *dev, const char *name, char *texts[], char *names[], int num);
@@ -125,6 +125,9 @@
 //#warning "Intel mode, 16MB CHUNK_SIZE"
 #endif
 
+// Bulk reads kept in flight by sxReadPixels, CHUNK_SIZE in total to stay within the usbfs memory limit
+#define READ_QUEUE_DEPTH 8
+
 #if 1
 #define TRACE(c) (c)
 #define DEBUG(c) (c)
@@ -734,25 +737,96 @@ int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short ca
     return rc >= 0;
 }
 
-int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count)
+static void LIBUSB_CALL sxReadPixelsDone(struct libusb_transfer *transfer)
 {
-    int transferred;
-    unsigned long read = 0;
-    int rc             = 0;
-    while (read < count && rc >= 0)
+    *(int *)transfer->user_data = 1;
+}
+
+static void sxReadPixelsWait(struct libusb_transfer *transfer, int *done)
+{
+    while (!*done)
     {
-        int size = count - read;
-        if (size > CHUNK_SIZE)
-            size = CHUNK_SIZE;
-        rc = libusb_bulk_transfer(sxHandle, BULK_IN, (unsigned char *)pixels + read, size, &transferred,
-                                  BULK_DATA_TIMEOUT);
-        DEBUG(log(true, "sxReadPixels: libusb_control_transfer -> %s\n", rc < 0 ? libusb_error_name(rc) : "OK"));
-        if (transferred >= 0)
+        int rc = libusb_handle_events_completed(ctx, done);
+        if (rc < 0 && rc != LIBUSB_ERROR_INTERRUPTED)
         {
-            read += transferred;
+            DEBUG(log(true, "sxReadPixels: libusb_handle_events_completed -> %s\n", libusb_error_name(rc)));
+            if (libusb_cancel_transfer(transfer) < 0)
+                break;
         }
     }
-    return rc >= 0;
+}
+
+int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count, sxReadProgress progress, void *userData)
+{
+    struct libusb_transfer *transfers[READ_QUEUE_DEPTH];
+    int done[READ_QUEUE_DEPTH];
+    unsigned long size      = CHUNK_SIZE / READ_QUEUE_DEPTH;
+    unsigned long submitted = 0, read = 0;
+    int first = 0, inFlight = 0, rc = 0;
+    for (int i = 0; i < READ_QUEUE_DEPTH; i++)
+    {
+        transfers[i] = libusb_alloc_transfer(0);
+        if (transfers[i] == nullptr)
+            rc = LIBUSB_ERROR_NO_MEM;
+    }
+    while (rc >= 0 && read < count)
+    {
+        // Keep the queue full, transfers on the same endpoint complete in order
+        while (rc >= 0 && inFlight < READ_QUEUE_DEPTH && submitted < count)
+        {
+            int slot = (first + inFlight) % READ_QUEUE_DEPTH;
+            int length = count - submitted < size ? count - submitted : size;
+            done[slot] = 0;
+            libusb_fill_bulk_transfer(transfers[slot], sxHandle, BULK_IN, (unsigned char *)pixels + submitted, length,
+                                      sxReadPixelsDone, &done[slot], BULK_DATA_TIMEOUT);
+            rc = libusb_submit_transfer(transfers[slot]);
+            DEBUG(log(true, "sxReadPixels: libusb_submit_transfer -> %s\n", rc < 0 ? libusb_error_name(rc) : "OK"));
+            if (rc >= 0)
+            {
+                submitted += length;
+                inFlight++;
+            }
+        }
+        if (inFlight == 0)
+            break;
+
+        struct libusb_transfer *transfer = transfers[first];
+        sxReadPixelsWait(transfer, &done[first]);
+        first = (first + 1) % READ_QUEUE_DEPTH;
+        inFlight--;
+        if (transfer->status != LIBUSB_TRANSFER_COMPLETED)
+        {
+            DEBUG(log(true, "sxReadPixels: transfer status %d\n", transfer->status));
+            rc = transfer->status == LIBUSB_TRANSFER_TIMED_OUT ? LIBUSB_ERROR_TIMEOUT : LIBUSB_ERROR_IO;
+            break;
+        }
+        read += transfer->actual_length;
+        if (transfer->actual_length < transfer->length && read < count)
+        {
+            // A short read moves the rest of the data ahead of where the queued transfers put it, take
+            // them back and carry on from here unless they already got some
+            for (int i = 0; i < inFlight; i++)
+                libusb_cancel_transfer(transfers[(first + i) % READ_QUEUE_DEPTH]);
+            for (; inFlight > 0; inFlight--, first = (first + 1) % READ_QUEUE_DEPTH)
+            {
+                sxReadPixelsWait(transfers[first], &done[first]);
+                if (transfers[first]->actual_length > 0)
+                    rc = LIBUSB_ERROR_IO;
+            }
+            submitted = read;
+        }
+        if (progress != nullptr && rc >= 0)
+            progress(read, userData);
+    }
+
+    // Take back what is still queued after a failure
+    for (int i = 0; i < inFlight; i++)
+        libusb_cancel_transfer(transfers[(first + i) % READ_QUEUE_DEPTH]);
+    for (; inFlight > 0; inFlight--, first = (first + 1) % READ_QUEUE_DEPTH)
+        sxReadPixelsWait(transfers[first], &done[first]);
+    for (int i = 0; i < READ_QUEUE_DEPTH; i++)
+        libusb_free_transfer(transfers[i]);
+    return rc >= 0 && read >= count;
 }
 
 int sxSetSTAR2000(HANDLE sxHandle, char star2k)
@@ -159,7 +159,13 @@ int sxExposePixels(HANDLE sxHandle, unsigned short flags, unsigned short camInde
 int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short camIndex, unsigned short xoffset,
                         unsigned short yoffset, unsigned short width, unsigned short height, unsigned short xbin,
                         unsigned short ybin, unsigned long msec);
-int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count);
+/*
+ * Reads count bytes with several bulk transfers in flight. progress is called from the reading thread
+ * with the number of bytes received so far each time a transfer lands.
+ */
+typedef void (*sxReadProgress)(unsigned long read, void *userData);
+int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count, sxReadProgress progress = nullptr,
+                 void *userData = nullptr);
 int sxSetShutter(HANDLE sxHandle, unsigned short state);
 int sxSetTimer(HANDLE sxHandle, unsigned long msec);
 unsigned long sxGetTimer(HANDLE sxHandle);
@@ -22,9 +22,11 @@
 #include "indi_toupbase.h"
 
 #include "config.h"
+#include "pixelconvert.h"
 
 #include <stream/streammanager.h>
 
+#include <algorithm>
 #include <math.h>
 #include <unistd.h>
 
@@ -33,6 +35,9 @@
 #define TEMP_TIMER_MS           1000 /* Temperature polling time (ms) */
 #define TEMP_THRESHOLD          .25  /* Differential temperature threshold (C)*/
 #define MAX_DEVICES             4    /* Max device cameraCount */
+#define FRAME_POOL_SIZE         3    /* Frames queued between the SDK and the frame thread */
+#define FRAME_POOL_WAIT_MS      50   /* Max time an exposure waits for a free frame slot (ms) */
+#define FRAME_POOL_STATS_MS     1000 /* Frame pool statistics update interval (ms) */
 
 #define CONTROL_TAB "Controls"
 #define LEVEL_TAB "Levels"
@@ -395,6 +400,17 @@ bool ToupBase::initProperties()
     IUFillText(&FirmwareT[TC_FIRMWARE_REV], "Revision", "Revision", nullptr);
     IUFillTextVector(&FirmwareTP, FirmwareT, 5, getDeviceName(), "Firmware", "Firmware", "Firmware", IP_RO, 0, IPS_IDLE);
 
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Frame Pool Statistics
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillNumber(&FramePoolStatsN[TC_POOL_CALLBACK_MS], "CALLBACK_MS", "Callback (ms)", "%.3f", 0, 1e6, 0, 0);
+    IUFillNumber(&FramePoolStatsN[TC_POOL_CALLBACK_MAX_MS], "CALLBACK_MAX_MS", "Callback Max (ms)", "%.3f", 0, 1e6, 0, 0);
+    IUFillNumber(&FramePoolStatsN[TC_POOL_QUEUE_DEPTH], "QUEUE_DEPTH", "Queued", "%.f", 0, FRAME_POOL_SIZE, 0, 0);
+    IUFillNumber(&FramePoolStatsN[TC_POOL_DROPPED], "DROPPED", "Dropped", "%.f", 0, 1e9, 0, 0);
+    IUFillNumber(&FramePoolStatsN[TC_POOL_STALLS], "STALLS", "Stalls", "%.f", 0, 1e9, 0, 0);
+    IUFillNumberVector(&FramePoolStatsNP, FramePoolStatsN, 5, getDeviceName(), "TC_FRAME_POOL", "Frame Pool", IMAGE_INFO_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
     IUFillText(&SDKVersionT[0], "VERSION", "Version", nullptr);
     IUFillTextVector(&SDKVersionTP, SDKVersionT, 1, getDeviceName(), "SDK", "SDK", "Firmware", IP_RO, 0, IPS_IDLE);
 
@@ -442,6 +458,7 @@ bool ToupBase::updateProperties()
         defineSwitch(&VideoFormatSP);
         defineSwitch(&ResolutionSP);
         defineNumber(&ADCNP);
+        defineNumber(&FramePoolStatsNP);
 
         if (m_Instance->model->flag & (CP(FLAG_CG) | CP(FLAG_CGHDR)))
         {
@@ -488,6 +505,7 @@ bool ToupBase::updateProperties()
         deleteProperty(VideoFormatSP.name);
         deleteProperty(ResolutionSP.name);
         deleteProperty(ADCNP.name);
+        deleteProperty(FramePoolStatsNP.name);
 
         if (m_Instance->model->flag & (CP(FLAG_CG) | CP(FLAG_CGHDR)))
         {
@@ -602,6 +620,8 @@ bool ToupBase::Connect()
         PrimaryCCD.setBin(bin, bin);
     }
 
+    startFrameThread();
+
     // Success!
     LOGF_INFO("%s is online. Retrieving basic data.", getDeviceName());
 
@@ -615,6 +635,9 @@ bool ToupBase::Disconnect()
 
     FP(Close(m_CameraHandle));
 
+    // No more callbacks after the camera is closed, the frame thread drains what is left
+    stopFrameThread();
+
     return true;
 }
 
@@ -2230,6 +2253,175 @@ const char *ToupBase::getBayerString()
     }
 }
 
+void ToupBase::copyRGBToPlanar(const uint8_t *rgb)
+{
+    uint8_t *image  = PrimaryCCD.getFrameBuffer();
+    uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * (PrimaryCCD.getBPP() / 8);
+    uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY() * (PrimaryCCD.getBPP() / 8);
+    uint32_t pixels = width * height;
+
+    // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS
+    PixelConvert::deinterleave8(rgb, image, image + pixels, image + pixels * 2, pixels);
+}
+
+void ToupBase::startFrameThread()
+{
+    // Slots grow to the frame size on first use and are kept until the camera is disconnected
+    m_FramePool.allocate(FRAME_POOL_SIZE, 0);
+
+    m_CallbackTimeUS = 0;
+    m_CallbackCount  = 0;
+    m_CallbackMaxUS  = 0;
+    m_DroppedFrames  = 0;
+    m_PoolStalls     = 0;
+    m_FramePoolStatsUpdate = FramePool::Clock::now();
+
+    {
+        std::lock_guard<std::mutex> guard(m_FrameMutex);
+        m_FrameStop = false;
+    }
+    m_FrameThread = std::thread(&ToupBase::frameThreadEntry, this);
+}
+
+void ToupBase::stopFrameThread()
+{
+    if (m_FrameThread.joinable() == false)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_FrameMutex);
+        m_FrameStop = true;
+    }
+    m_FrameCV.notify_one();
+    m_FrameThread.join();
+}
+
+ToupBase::FramePool::Slot *ToupBase::claimFrameSlot(bool exposure)
+{
+    // The last free slot is kept for exposures, so stream frames never make one wait
+    if (exposure == false)
+    {
+        FramePool::Slot *slot = nullptr;
+        if (m_FramePool.depth() + 1 < m_FramePool.capacity())
+            slot = m_FramePool.acquire();
+        if (slot == nullptr)
+            m_DroppedFrames++;
+        return slot;
+    }
+
+    FramePool::Slot *slot = m_FramePool.acquire();
+    if (slot != nullptr)
+        return slot;
+
+    // Only a previous exposure still being uploaded holds the reserved slot, wait briefly for it
+    m_PoolStalls++;
+    std::unique_lock<std::mutex> guard(m_FrameMutex);
+    m_FrameSlotCV.wait_for(guard, std::chrono::milliseconds(FRAME_POOL_WAIT_MS), [this, &slot]
+    {
+        slot = m_FramePool.acquire();
+        return slot != nullptr;
+    });
+
+    return slot;
+}
+
+void ToupBase::queueFrameSlot()
+{
+    m_FramePool.commit();
+
+    std::lock_guard<std::mutex> guard(m_FrameMutex);
+    m_FrameCV.notify_one();
+}
+
+void ToupBase::recordCallbackTime(FramePool::Clock::time_point start)
+{
+    uint32_t us = std::chrono::duration_cast<std::chrono::microseconds>(FramePool::Clock::now() - start).count();
+
+    m_CallbackTimeUS += us;
+    m_CallbackCount++;
+
+    // Only the SDK thread writes the maximum, the frame thread resets it
+    if (us > m_CallbackMaxUS)
+        m_CallbackMaxUS = us;
+}
+
+void ToupBase::frameThreadEntry()
+{
+    while (true)
+    {
+        FramePool::Slot *slot = nullptr;
+        {
+            std::unique_lock<std::mutex> guard(m_FrameMutex);
+            m_FrameCV.wait_for(guard, std::chrono::milliseconds(FRAME_POOL_STATS_MS), [this, &slot]
+            {
+                slot = m_FramePool.front();
+                return slot != nullptr || m_FrameStop;
+            });
+
+            if (slot == nullptr && m_FrameStop)
+                break;
+        }
+
+        if (slot != nullptr)
+        {
+            processFrame(slot);
+            m_FramePool.release();
+
+            std::lock_guard<std::mutex> guard(m_FrameMutex);
+            m_FrameSlotCV.notify_one();
+        }
+
+        updateFramePoolStats();
+    }
+
+    updateFramePoolStats(true);
+}
+
+void ToupBase::processFrame(FramePool::Slot *slot)
+{
+    if (slot->info.exposure == false)
+    {
+        Streamer->newFrame(slot->data.data(), slot->size);
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    if (slot->info.rgb)
+        copyRGBToPlanar(slot->data.data());
+    else
+        memcpy(PrimaryCCD.getFrameBuffer(), slot->data.data(), std::min<uint32_t>(slot->size, PrimaryCCD.getFrameBufferSize()));
+    guard.unlock();
+
+    LOGF_DEBUG("Image received. Width: %u Height: %u queued: %.3f ms", slot->info.width, slot->info.height,
+               std::chrono::duration<double, std::milli>(FramePool::Clock::now() - slot->captured).count());
+
+    ExposureComplete(&PrimaryCCD);
+}
+
+void ToupBase::updateFramePoolStats(bool force)
+{
+    auto now = FramePool::Clock::now();
+    if (!force && now - m_FramePoolStatsUpdate < std::chrono::milliseconds(FRAME_POOL_STATS_MS))
+        return;
+    m_FramePoolStatsUpdate = now;
+
+    uint64_t callbackUS = m_CallbackTimeUS.exchange(0);
+    uint32_t callbacks  = m_CallbackCount.exchange(0);
+
+    FramePoolStatsN[TC_POOL_CALLBACK_MS].value     = callbacks > 0 ? callbackUS / 1000.0 / callbacks : 0;
+    FramePoolStatsN[TC_POOL_CALLBACK_MAX_MS].value = m_CallbackMaxUS.exchange(0) / 1000.0;
+    FramePoolStatsN[TC_POOL_QUEUE_DEPTH].value     = m_FramePool.depth();
+    FramePoolStatsN[TC_POOL_DROPPED].value         = m_DroppedFrames;
+    FramePoolStatsN[TC_POOL_STALLS].value          = m_PoolStalls;
+
+    // Stats are only published while there is something to report
+    if (callbacks > 0 || force)
+    {
+        FramePoolStatsNP.s = (m_DroppedFrames > 0 || m_PoolStalls > 0) ? IPS_BUSY : IPS_OK;
+        IDSetNumber(&FramePoolStatsNP, nullptr);
+    }
+}
+
 void ToupBase::refreshControls()
 {
     IDSetNumber(&ControlNP, nullptr);
@@ -2322,77 +2514,52 @@ void ToupBase::pushCB(const void* pData, const XP(FrameInfoV2)* pInfo, int bSnap
 
 void ToupBase::pushCallback(const void* pData, const XP(FrameInfoV2)* pInfo, int bSnap)
 {
-    //int captureBits = m_BitsPerPixel == 8 ? 8 : m_MaxBitDepth;
-
     INDI_UNUSED(bSnap);
 
-    if (Streamer->isStreaming() || Streamer->isRecording())
-    {
-        //std::unique_lock<std::mutex> guard(ccdBufferLock);
-        //HRESULT rc = FP(PullImageV2(m_CameraHandle, PrimaryCCD.getFrameBuffer(), captureBits * m_Channels, &info));
-        //guard.unlock();
-        //if (rc >= 0)
-        Streamer->newFrame(reinterpret_cast<const uint8_t*>(pData), PrimaryCCD.getFrameBufferSize());
-    }
-    else if (InExposure)
-    {
-        InExposure  = false;
-        PrimaryCCD.setExposureLeft(0);
-        uint8_t *buffer = PrimaryCCD.getFrameBuffer();
-        uint32_t size = PrimaryCCD.getFrameBufferSize();
+    auto start = FramePool::Clock::now();
+    bool streaming = Streamer->isStreaming() || Streamer->isRecording();
 
-        if (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB)
+    if (streaming || InExposure)
+    {
+        // The pushed buffer belongs to the SDK and is only valid during the callback,
+        // so it is copied into a pool slot and everything else happens on the frame thread.
+        bool exposure = !streaming;
+        if (exposure)
         {
-            size = PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * 3;
-            buffer = static_cast<uint8_t*>(malloc(size));
+            InExposure = false;
+            PrimaryCCD.setExposureLeft(0);
         }
 
-        //        std::unique_lock<std::mutex> guard(ccdBufferLock);
-        //        HRESULT rc = FP(PullImageV2(m_CameraHandle, buffer, captureBits * m_Channels, &info));
-        //        guard.unlock();
         if (pData == nullptr)
         {
-            LOG_ERROR("Failed to push image.");
-            PrimaryCCD.setExposureFailed();
-            if (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB)
-                free(buffer);
-        }
-        else
-        {
-            memcpy(buffer, pData, size);
-
-            if (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB)
+            if (exposure)
             {
-                std::unique_lock<std::mutex> guard(ccdBufferLock);
-                uint8_t *image  = PrimaryCCD.getFrameBuffer();
-                uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * (PrimaryCCD.getBPP() / 8);
-                uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY() * (PrimaryCCD.getBPP() / 8);
-
-                uint8_t *subR = image;
-                uint8_t *subG = image + width * height;
-                uint8_t *subB = image + width * height * 2;
-                int size      = width * height * 3 - 3;
-
-                // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS
-                for (int i = 0; i <= size; i += 3)
-                {
-                    *subR++ = buffer[i];
-                    *subG++ = buffer[i + 1];
-                    *subB++ = buffer[i + 2];
-                }
-
-                guard.unlock();
-                free(buffer);
+                LOG_ERROR("Failed to push image.");
+                PrimaryCCD.setExposureFailed();
             }
-
-            LOGF_DEBUG("Image received. Width: %d Height: %d flag: %d timestamp: %ld"
-                       , pInfo->width,
-                       pInfo->height,
-                       pInfo->flag,
-                       pInfo->timestamp);
-            ExposureComplete(&PrimaryCCD);
+        }
+        else if (FramePool::Slot *slot = claimFrameSlot(exposure))
+        {
+            uint32_t size = PrimaryCCD.getFrameBufferSize();
+            if (slot->data.size() < size)
+                slot->data.resize(size);
+            memcpy(slot->data.data(), pData, size);
+            slot->size             = size;
+            slot->captured         = start;
+            slot->info.width       = pInfo->width;
+            slot->info.height      = pInfo->height;
+            slot->info.exposure    = exposure;
+            slot->info.rgb         = (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB);
+            queueFrameSlot();
+        }
+        else if (exposure)
+        {
+            LOG_ERROR("Failed to queue image, frame pool is full.");
+            PrimaryCCD.setExposureFailed();
         }
     }
+
+    recordCallbackTime(start);
 }
 
 void ToupBase::eventCB(unsigned event, void* pCtx)
@@ -2414,68 +2581,54 @@ void ToupBase::eventPullCallBack(unsigned event)
                 break;
         case CP(EVENT_IMAGE: )
             {
+                auto start = FramePool::Clock::now();
                 m_TimeoutRetries = 0;
-                XP(FrameInfoV2) info;
-                memset(&info, 0, sizeof(XP(FrameInfoV2)));
 
-                int captureBits = m_BitsPerPixel == 8 ? 8 : m_MaxBitDepth;
-
-                if (Streamer->isStreaming() || Streamer->isRecording())
+                bool streaming = Streamer->isStreaming() || Streamer->isRecording();
+                if (streaming || InExposure)
                 {
-                    std::unique_lock<std::mutex> guard(ccdBufferLock);
-                    HRESULT rc = FP(PullImageV2(m_CameraHandle, PrimaryCCD.getFrameBuffer(), captureBits * m_Channels, &info));
-                    guard.unlock();
-                    if (SUCCEEDED(rc))
-                        Streamer->newFrame(PrimaryCCD.getFrameBuffer(), PrimaryCCD.getFrameBufferSize());
-                }
-                else if (InExposure)
-                {
-                    InExposure = false;
-                    PrimaryCCD.setExposureLeft(0);
-                    uint8_t *buffer = PrimaryCCD.getFrameBuffer();
+                    // Pull straight into a pool slot, conversion, FITS creation and upload run on the frame thread
+                    bool exposure = !streaming;
+                    if (exposure)
+                    {
+                        InExposure = false;
+                        PrimaryCCD.setExposureLeft(0);
+                    }
 
-                    if (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB)
-                        buffer = static_cast<uint8_t*>(malloc(PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * 3));
+                    int captureBits = m_BitsPerPixel == 8 ? 8 : m_MaxBitDepth;
+                    HRESULT rc = E_OUTOFMEMORY;
 
-                    std::unique_lock<std::mutex> guard(ccdBufferLock);
-                    HRESULT rc = FP(PullImageV2(m_CameraHandle, buffer, captureBits * m_Channels, &info));
-                    guard.unlock();
-                    if (FAILED(rc))
+                    if (FramePool::Slot *slot = claimFrameSlot(exposure))
                     {
-                        LOGF_ERROR("Failed to pull image. %s", errorCodes[rc].c_str());
-                        PrimaryCCD.setExposureFailed();
-                        if (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB)
-                            free(buffer);
+                        XP(FrameInfoV2) info;
+                        memset(&info, 0, sizeof(XP(FrameInfoV2)));
+
+                        uint32_t size = PrimaryCCD.getFrameBufferSize();
+                        if (slot->data.size() < size)
+                            slot->data.resize(size);
+
+                        rc = FP(PullImageV2(m_CameraHandle, slot->data.data(), captureBits * m_Channels, &info));
+                        if (SUCCEEDED(rc))
+                        {
+                            slot->size             = size;
+                            slot->captured         = start;
+                            slot->info.width       = info.width;
+                            slot->info.height      = info.height;
+                            slot->info.exposure    = exposure;
+                            slot->info.rgb         = (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB);
+                            queueFrameSlot();
+                        }
                     }
                     else
                     {
-                        if (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB)
-                        {
-                            std::unique_lock<std::mutex> guard(ccdBufferLock);
-                            uint8_t *image  = PrimaryCCD.getFrameBuffer();
-                            uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * (PrimaryCCD.getBPP() / 8);
-                            uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY() * (PrimaryCCD.getBPP() / 8);
-
-                            uint8_t *subR = image;
-                            uint8_t *subG = image + width * height;
-                            uint8_t *subB = image + width * height * 2;
-                            int size      = width * height * 3 - 3;
-
-                            // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS
-                            for (int i = 0; i <= size; i += 3)
-                            {
-                                *subR++ = buffer[i];
-                                *subG++ = buffer[i + 1];
-                                *subB++ = buffer[i + 2];
-                            }
-
-                            guard.unlock();
-                            free(buffer);
-                        }
+                        // No room for the frame, drop it from the SDK queue as well
+                        FP(Flush(m_CameraHandle));
+                    }
 
-                        LOGF_DEBUG("Image received. Width: %d Height: %d flag: %d timestamp: %ld", info.width, info.height, info.flag,
-                                   info.timestamp);
-                        ExposureComplete(&PrimaryCCD);
+                    if (FAILED(rc) && exposure)
+                    {
+                        LOGF_ERROR("Failed to pull image. %s", errorCodes[rc].c_str());
+                        PrimaryCCD.setExposureFailed();
                     }
                 }
                 else
@@ -2489,6 +2642,8 @@ void ToupBase::eventPullCallBack(unsigned event)
                         LOGF_ERROR("Failed to flush image. %s", errorCodes[rc].c_str());
                     }
                 }
+
+                recordCallbackTime(start);
             }
             break;
         case CP(EVENT_STILLIMAGE: )
@@ -21,9 +21,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <indiccd.h>
 
+#include "framering.h"
+
 #ifdef BUILD_TOUPCAM
 #include <toupcam.h>
 #define FP(x) Toupcam_##x
@@ -408,16 +415,46 @@ class ToupBase : public INDI::CCD
         //#############################################################################
         // Get the current Bayer string used
         const char *getBayerString();
+        // Split interleaved RGB24 into the planar R, G and B frames of the FITS buffer.
+        // Caller must hold ccdBufferLock.
+        void copyRGBToPlanar(const uint8_t *rgb);
 
         //#############################################################################
         // Callbacks
         //#############################################################################
+        // The SDK callbacks only move frames into m_FramePool, processing and upload run on the frame thread.
         static void pushCB(const void* pData, const XP(FrameInfoV2)* pInfo, int bSnap, void* pCallbackCtx);
         void pushCallback(const void* pData, const XP(FrameInfoV2)* pInfo, int bSnap);
 
         static void eventCB(unsigned event, void* pCtx);
         void eventPullCallBack(unsigned event);
 
+        //#############################################################################
+        // Frame Pool
+        //#############################################################################
+        struct FrameInfo
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            // Frame completes an exposure (true) or belongs to the video stream (false)
+            bool exposure = false;
+            // Interleaved RGB24 that has to be split into planes for FITS
+            bool rgb = false;
+        };
+        typedef FrameRing<FrameInfo> FramePool;
+
+        void startFrameThread();
+        void stopFrameThread();
+        void frameThreadEntry();
+        // Get a free slot for a new frame. Stream frames are dropped when only the slot kept for
+        // exposures is left, exposures wait briefly for the frame thread to release a slot.
+        FramePool::Slot *claimFrameSlot(bool exposure);
+        // Hand the claimed slot over to the frame thread.
+        void queueFrameSlot();
+        void processFrame(FramePool::Slot *slot);
+        void recordCallbackTime(FramePool::Clock::time_point start);
+        void updateFramePoolStats(bool force = false);
+
         static void TempTintCB(const int nTemp, const int nTint, void* pCtx);
         void TempTintChanged(const int nTemp, const int nTint);
 
@@ -567,6 +604,18 @@ class ToupBase : public INDI::CCD
             TC_VIDEO_MONO_16,
         };
 
+        // Frame pool statistics
+        INumberVectorProperty FramePoolStatsNP;
+        INumber FramePoolStatsN[5];
+        enum
+        {
+            TC_POOL_CALLBACK_MS,
+            TC_POOL_CALLBACK_MAX_MS,
+            TC_POOL_QUEUE_DEPTH,
+            TC_POOL_DROPPED,
+            TC_POOL_STALLS,
+        };
+
         // Firmware Info
         ITextVectorProperty FirmwareTP;
         IText FirmwareT[5] = {};
@@ -621,6 +670,22 @@ class ToupBase : public INDI::CCD
         uint8_t m_Channels { 1 };
         uint8_t m_TimeoutRetries { 0 };
 
+        // Frames travel from the SDK callback thread to the frame thread through the pool slots
+        FramePool m_FramePool;
+        std::thread m_FrameThread;
+        std::mutex m_FrameMutex;
+        std::condition_variable m_FrameCV;
+        // Signalled by the frame thread when it releases a slot
+        std::condition_variable m_FrameSlotCV;
+        bool m_FrameStop { false };
+        // Callback duration, stream frames dropped and exposures delayed because the pool was full
+        std::atomic<uint64_t> m_CallbackTimeUS { 0 };
+        std::atomic<uint32_t> m_CallbackCount { 0 };
+        std::atomic<uint32_t> m_CallbackMaxUS { 0 };
+        std::atomic<uint32_t> m_DroppedFrames { 0 };
+        std::atomic<uint32_t> m_PoolStalls { 0 };
+        FramePool::Clock::time_point m_FramePoolStatsUpdate;
+
         uint32_t m_MaxGainNative { 0 };
         uint32_t m_MaxGainHCG { 0 };
         uint32_t m_NativeGain { 0 };
@@ -195,9 +195,7 @@ indi_webcam::indi_webcam()
   pCodec = nullptr;
   optionsDict=nullptr;
   pFrame = nullptr;
-  pFrameOUT = nullptr;
   sws_ctx = nullptr;
-  buffer = nullptr;
   
   // These calls are depreciated, but are required for some older FFMPEG distributions on Linux
   av_register_all();
@@ -344,12 +342,31 @@ bool indi_webcam::ConnectToSource(std::string device, std::string source, int fr
       return false;      
     }
 
+    //Decoding threads, 0 lets FFMpeg pick one per core.
+    //Frame threading decodes several frames at once but delays each frame by one per thread,
+    //slice threading splits single frames and adds no delay, but not every codec supports it.
+    pCodecCtx->thread_count = static_cast<int>(DecodeN[DECODE_THREADS].value);
+    if(DecodeThreadingS[0].s == ISS_ON)
+        pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    else
+        pCodecCtx->thread_type = FF_THREAD_SLICE;
+
+    //A packet left over from the previous connection is not for this decoder
+    if(hasPendingPacket)
+    {
+        av_packet_unref(&pendingPacket);
+        hasPendingPacket = false;
+    }
+
     //Attempt to open the codec.  If that fails, abort the connection.
     if(avcodec_open2(pCodecCtx, pCodec, &optionsDict)<0)
     {
       DEBUG(INDI::Logger::DBG_SESSION,"Failed to open codec.");
       return false;
     }
+    DEBUGF(INDI::Logger::DBG_SESSION, "Decoding %s with %d threads, %s threading.", pCodec->name, pCodecCtx->thread_count,
+           (pCodecCtx->active_thread_type & FF_THREAD_FRAME) ? "frame" :
+           (pCodecCtx->active_thread_type & FF_THREAD_SLICE) ? "slice" : "no");
 
     //Set the initial parameters for the CCD.
     SetCCDParams(pCodecCtx->width, pCodecCtx->height, 8, 5, 5); //Note 5 microns is a guess!
@@ -490,6 +507,11 @@ bool indi_webcam::Disconnect()
     if (isConnected()) {
       // Close the codecs
       avcodec_close(pCodecCtx);
+      if(hasPendingPacket)
+      {
+          av_packet_unref(&pendingPacket);
+          hasPendingPacket = false;
+      }
 
       // Close the video file
       avformat_close_input(&pFormatCtx);
@@ -535,8 +557,40 @@ bool indi_webcam::initProperties()
                        MAIN_CONTROL_TAB, IP_RW, ISR_ATMOST1, 60, IPS_IDLE);
     defineSwitch(&OutputFormatSelection);
 
+    StackRejection = new ISwitch[3];
+    IUFillSwitch(&StackRejection[0], "None", "None", ISS_ON);
+    IUFillSwitch(&StackRejection[1], "Sigma Clip", "Sigma Clip", ISS_OFF);
+    IUFillSwitch(&StackRejection[2], "Median", "Median", ISS_OFF);
+
+    IUFillSwitchVector(&StackRejectionSelection, StackRejection, 3, getDeviceName(), "STACK_REJECTION", "Stack Rejection",
+                       MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    defineSwitch(&StackRejectionSelection);
+
+    //Rejection works on groups of frames, each group adds its median or clipped mean to the stack
+    IUFillNumber(&StackRejectionN[0], "GROUP", "Group Frames", "%.f", 3, FrameStack::MAX_GROUP, 1, 5);
+    IUFillNumber(&StackRejectionN[1], "KAPPA", "Sigma Kappa", "%.1f", 0.5, 10, 0.5, 2.5);
+    IUFillNumberVector(&StackRejectionNP, StackRejectionN, 2, getDeviceName(), "STACK_REJECTION_SETTINGS", "Rejection",
+                       MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
+    defineNumber(&StackRejectionNP);
+
+    IUFillSwitch(&DecodeThreadingS[0], "FRAME", "Frame and Slice", ISS_ON);
+    IUFillSwitch(&DecodeThreadingS[1], "SLICE", "Slice only", ISS_OFF);
+    IUFillSwitchVector(&DecodeThreadingSP, DecodeThreadingS, 2, getDeviceName(), "DECODE_THREADING", "Decode Threading",
+                       OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    defineSwitch(&DecodeThreadingSP);
+
+    IUFillNumber(&DecodeN[DECODE_THREADS], "THREADS", "Threads (0 auto)", "%.f", 0, 16, 1, 0);
+    IUFillNumber(&DecodeN[DECODE_QUEUE], "QUEUE", "Stream Queue", "%.f", 1, 16, 1, 4);
+    IUFillNumberVector(&DecodeNP, DecodeN, 2, getDeviceName(), "DECODE_OPTIONS", "Decoding",
+                       OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
+    defineNumber(&DecodeNP);
+
     loadConfig(true, "RAPID_STACKING_OPTION");
     loadConfig(true, "OUTPUT_FORMAT_OPTION");
+    loadConfig(true, "STACK_REJECTION");
+    loadConfig(true, "STACK_REJECTION_SETTINGS");
+    loadConfig(true, "DECODE_THREADING");
+    loadConfig(true, "DECODE_OPTIONS");
 
 
     /* Add debug controls so we may debug driver if necessary */
@@ -766,6 +820,26 @@ bool indi_webcam::ISNewNumber (const char *dev, const char *name, double values[
     if (dev && strcmp (getDeviceName(), dev))
       return true;
     DEBUGF(INDI::Logger::DBG_SESSION, "Setting number %s", name);
+
+    if (!strcmp(name, StackRejectionNP.name))
+    {
+        IUUpdateNumber(&StackRejectionNP, values, names, n);
+        StackRejectionNP.s = IPS_OK;
+        IDSetNumber(&StackRejectionNP, nullptr);
+        return true;
+    }
+
+    if (!strcmp(name, DecodeNP.name))
+    {
+        int threads = DecodeN[DECODE_THREADS].value;
+        IUUpdateNumber(&DecodeNP, values, names, n);
+        DecodeNP.s = IPS_OK;
+        IDSetNumber(&DecodeNP, nullptr);
+        //The queue is sized when streaming starts, the decoder threads only when the codec is opened
+        if(threads != static_cast<int>(DecodeN[DECODE_THREADS].value) && isConnected() && !InExposure)
+            ChangeSource(videoDevice, videoSource, frameRate, videoSize);
+        return true;
+    }
     
     return INDI::CCD::ISNewNumber(dev,name,values,names,n);
 }
@@ -898,6 +972,36 @@ bool indi_webcam::ISNewSwitch (const char *dev, const char *name, ISState *state
         return false;
     }
 
+    if (!strcmp(svp->name, StackRejectionSelection.name))
+    {
+        IUUpdateSwitch(&StackRejectionSelection, states, names, n);
+        ISwitch *sp = IUFindOnSwitch(&StackRejectionSelection);
+        if (sp)
+        {
+           if(!strcmp(sp->name, "None"))
+               stackRejection = FrameStack::REJECT_NONE;
+           if(!strcmp(sp->name, "Sigma Clip"))
+               stackRejection = FrameStack::REJECT_SIGMA_CLIP;
+           if(!strcmp(sp->name, "Median"))
+               stackRejection = FrameStack::REJECT_MEDIAN;
+                StackRejectionSelection.s = IPS_OK;
+                IDSetSwitch(&StackRejectionSelection, nullptr);
+                return true;
+        }
+        return false;
+    }
+
+    if (!strcmp(svp->name, DecodeThreadingSP.name))
+    {
+        IUUpdateSwitch(&DecodeThreadingSP, states, names, n);
+        DecodeThreadingSP.s = IPS_OK;
+        IDSetSwitch(&DecodeThreadingSP, nullptr);
+        //The codec has to be opened again to change the threading
+        if(isConnected() && !InExposure)
+            ChangeSource(videoDevice, videoSource, frameRate, videoSize);
+        return true;
+    }
+
     if (!strcmp(svp->name, OutputFormatSelection.name))
     {
         IUUpdateSwitch(&OutputFormatSelection, states, names, n);
@@ -1010,23 +1114,17 @@ bool indi_webcam::StartExposure(float duration)
         return 0;
     }
 
-    //This resets the stack buffer
-    if(webcamStacking){
-        if(stackBuffer)
-            free(stackBuffer);
-        stackBuffer = nullptr;
-    }
-
     //This sets up the output format for the exposure
+    //Color is scaled straight into the planes FITS expects, see scaleFrame
     if(outputFormat == "16 bit RGB")
     {
-        out_pix_fmt=AV_PIX_FMT_RGB48LE;
+        out_pix_fmt=AV_PIX_FMT_GBRP16LE;
         PrimaryCCD.setBPP(16);
         PrimaryCCD.setNAxis(3);
     }
     else if(outputFormat == "8 bit RGB")
     {
-        out_pix_fmt=AV_PIX_FMT_RGB24;
+        out_pix_fmt=AV_PIX_FMT_GBRP;
         PrimaryCCD.setBPP(8);
         PrimaryCCD.setNAxis(3);
     }
@@ -1048,6 +1146,10 @@ bool indi_webcam::StartExposure(float duration)
     //Set up the stream, if there is an error, return
     if(!setupStreaming())
         return -1;
+    //This resets the stack, it is sized once the frame size is known
+    if(webcamStacking)
+        stack.start(numBytes / (PrimaryCCD.getBPP() / 8), PrimaryCCD.getBPP(), stackRejection,
+                    StackRejectionN[0].value, StackRejectionN[1].value);
      //This will ensure that we get the current frame, not some old frame still in the buffer
     if(flush_frame_buffer())
         return 0;
@@ -1057,8 +1159,7 @@ bool indi_webcam::StartExposure(float duration)
 
 bool indi_webcam::AbortExposure()
 {
-    if(stackBuffer)
-        free(stackBuffer);
+    stack.abort();
     InExposure = false;
     return true;
 }
@@ -1134,19 +1235,15 @@ void indi_webcam::TimerHit()
 }
 
 // Downloads the image from the Webcam.
-//If the image is an RGB, it converts it to Fits RGB
+//The image is scaled straight into the primary buffer, color as FITS RGB planes.
 //If rapid stacking is happening, it adds the image to the stack.
 
 bool indi_webcam::grabImage()
 {
     if(getStreamFrame())
     {
-        if(PrimaryCCD.getNAxis()==3)
-            convertINDI_RGBtoFITS_RGB(pFrameOUT->data[0], PrimaryCCD.getFrameBuffer());
-        else
-            memcpy(PrimaryCCD.getFrameBuffer(), pFrameOUT->data[0], numBytes);
         if(webcamStacking)
-            addToStack();
+            stack.add(PrimaryCCD.getFrameBuffer());
     }
     else
     {
@@ -1157,97 +1254,18 @@ bool indi_webcam::grabImage()
     return true;
 }
 
-//This adds each image to the running stack
-bool indi_webcam::addToStack()
-{
-    if(!stackBuffer)
-    {
-        stackBuffer = (float *)malloc(numBytes*sizeof(float_t));
-        numberOfFramesInStack = 0;
-    }
-
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
-
-    for (int i = 0; i < w * h; i++)
-       {
-           int x = i % w;
-           int y = i / w;
-           if(x >= 0 && y >= 0 && x < w && y < h)
-           {
-                   if(numberOfFramesInStack == 0)
-                       stackBuffer[i]=getImageDataFloatValue(x, y);
-                   else
-                       stackBuffer[i]+=getImageDataFloatValue(x, y);
-           }
-       }
-    numberOfFramesInStack++;
-    return true;
-}
-
-//This gets the pixel value at an x, y position in the image
-float indi_webcam::getImageDataFloatValue(int x, int y){
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
-    if(PrimaryCCD.getBPP()==8)
-        return (float) primaryBuffer[y * w + x];
-    else if(PrimaryCCD.getBPP()==16)
-    {
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        return (float) newBuffer[y * w + x];
-    }
-    else
-        return 0;
-}
-//This sets the pixel value at an x, y position in the image
-void indi_webcam::setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer)
-{
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
-    int w = pCodecCtx->width * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    if(!stackBuffer)
-        return;
-    if(PrimaryCCD.getBPP()==8)
-    {
-        int max = std::numeric_limits<uint8_t>::max();
-        if (value > max)
-            value = max;
-        if(roundAnswer)
-            primaryBuffer[y * w + x] = round(value);
-        else
-            primaryBuffer[y * w + x] = value;
-    }
-    else if(PrimaryCCD.getBPP()==16)
-    {
-        int max = std::numeric_limits<uint16_t>::max();
-        if (value > max)
-            value = max;
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        if(roundAnswer)
-            newBuffer[y * w + x] = round(value);
-        else
-            newBuffer[y * w + x] = value;
-    }
-}
-
 //This will take the final image stack and copy it back to the primary buffer for final download.
+//The stack is always 16 bit so that integrations and averages of 8 bit frames do not saturate at 255.
+//The frames were already planar, so the stack is too.
 void indi_webcam::copyFinalStackToPrimaryFrameBuffer()
 {
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
-    for (int i = 0; i < w*h; i++)
-        {
-            int x = i % w;
-            int y = i / w;
-            if(x >= 0 && y >= 0 && x < w && y < h)
-            {
-                if(averaging)
-                    setImageDataValueFromFloat(x, y, round(stackBuffer[i]/numberOfFramesInStack), true);
-                else //Integrating
-                    setImageDataValueFromFloat(x, y, round(stackBuffer[i]), true);
-            }
-        }
+    size_t samples = numBytes / (PrimaryCCD.getBPP() / 8);
+
+    PrimaryCCD.setBPP(16);
+    PrimaryCCD.setFrameBufferSize(samples * sizeof(uint16_t));
+    size_t frames = stack.finish(reinterpret_cast<uint16_t *>(PrimaryCCD.getFrameBuffer()), averaging);
 
-    LOGF_INFO("Final Image is a stack of %u exposures.", numberOfFramesInStack);
+    LOGF_INFO("Final Image is a stack of %u exposures.", static_cast<uint32_t>(frames));
 }
 
 //This will crop the image to a subframe if desired.
@@ -1259,6 +1277,7 @@ void indi_webcam::finishExposure()
     int h = pCodecCtx->height;
     int bpp = PrimaryCCD.getBPP();
     int naxis = PrimaryCCD.getNAxis();
+    int frameBufferSize = PrimaryCCD.getFrameBufferSize();
 
     if (PrimaryCCD.getSubW() < w || PrimaryCCD.getSubH() < h)
     {
@@ -1307,7 +1326,7 @@ void indi_webcam::finishExposure()
 
         // Restore old pointer and release memory
         PrimaryCCD.setFrameBuffer(memptr);
-        PrimaryCCD.setFrameBufferSize(numBytes, false);
+        PrimaryCCD.setFrameBufferSize(frameBufferSize, false);
         if(subframeBuf)
             free(subframeBuf);
     }
@@ -1375,7 +1394,7 @@ void indi_webcam::RunCaptureThread(indi_webcam *webcam)
 }
 
 //This is the loop that runs during streaming
-//Note that it ONLY supports RGB24 aka INDI_RGB format.
+//Note that RGB is only streamed as RGB24 aka INDI_RGB format, grayscale keeps 16 bits.
 void indi_webcam::run_capture()
 {
 
@@ -1397,11 +1416,10 @@ void indi_webcam::run_capture()
     }
     else if(outputFormat == "16 bit Grayscale")
     {
-        LOG_INFO("Note, 16 bit Grayscale not supported in video stream using 8 Bit Grayscale instead.");
-        out_pix_fmt=AV_PIX_FMT_GRAY8;
-        PrimaryCCD.setBPP(8);
+        out_pix_fmt=AV_PIX_FMT_GRAY16LE;
+        PrimaryCCD.setBPP(16);
         PrimaryCCD.setNAxis(2);
-        Streamer->setPixelFormat(INDI_MONO);
+        Streamer->setPixelFormat(INDI_MONO, 16);
     }
     else
         return;
@@ -1418,81 +1436,130 @@ void indi_webcam::run_capture()
   if(!flush_frame_buffer())
       return;
 
+  //This thread only reads and decodes, scaling and delivery run on their own threads.
+  size_t queue = static_cast<size_t>(DecodeN[DECODE_QUEUE].value);
+  decodedFrames.allocate(queue, 0);
+  convertedFrames.allocate(queue, numBytes);
+  droppedFrames = 0;
+  pipeline_stop = false;
+  convert_thread = std::thread(&indi_webcam::run_convert, this);
+  deliver_thread = std::thread(&indi_webcam::run_deliver, this);
+
   while (is_capturing && is_streaming) {
 
-    if(getStreamFrame())
-        Streamer->newFrame(pFrameOUT->data[0], numBytes);
-    else
+    //If the converter is behind, the frame still has to be decoded, but into pFrame and dropped
+    FrameRing<DecodedFrame>::Slot *slot = decodedFrames.acquire();
+    AVFrame *frame = slot ? slot->info.frame.get() : pFrame;
+
+    if(!readFrame(frame))
     {
         is_capturing = false;
         is_streaming = false;
     }
+    else if(slot == nullptr)
+        droppedFrames++;
+    else
+    {
+        slot->captured = FrameRing<DecodedFrame>::Clock::now();
+        decodedFrames.commit();
+        std::lock_guard<std::mutex> guard(pipeline_mutex);
+        decoded_cv.notify_one();
+    }
+  }
+
+  {
+      std::lock_guard<std::mutex> guard(pipeline_mutex);
+      pipeline_stop = true;
   }
+  decoded_cv.notify_one();
+  converted_cv.notify_one();
+  convert_thread.join();
+  deliver_thread.join();
+
+  //Frames left in the queue still reference decoder buffers
+  while (FrameRing<DecodedFrame>::Slot *slot = decodedFrames.front())
+  {
+      av_frame_unref(slot->info.frame.get());
+      decodedFrames.release();
+  }
+
+  if(droppedFrames > 0)
+      DEBUGF(INDI::Logger::DBG_SESSION, "%u frames were dropped because the stream queue was full.", droppedFrames.load());
 
   freeMemory();
 
   DEBUG(INDI::Logger::DBG_SESSION,"Capture thread releasing device.");
 }
 
-//This converts an image from INDI_RGB to FITS_RGB so the FITSViewer can read it.
-bool indi_webcam::convertINDI_RGBtoFITS_RGB(uint8_t *originalImage, uint8_t *convertedImage)
+//This scales the decoded frames into the converted frames ring during streaming.
+void indi_webcam::run_convert()
 {
-    if(PrimaryCCD.getBPP() == 8)
+    while (true)
     {
-        int size =  numBytes / 3;
-        uint8_t *r,*g,*b;
-        r = (convertedImage);
-        g = (convertedImage + size);
-        b = (convertedImage + size * 2);
-        for(int i=0; i < numBytes; i+=3)
+        FrameRing<DecodedFrame>::Slot *slot = nullptr;
+        {
+            std::unique_lock<std::mutex> guard(pipeline_mutex);
+            decoded_cv.wait(guard, [this, &slot]
+            {
+                slot = decodedFrames.front();
+                return slot != nullptr || pipeline_stop;
+            });
+            if (pipeline_stop)
+                break;
+        }
+
+        FrameRing<>::Slot *out = convertedFrames.acquire();
+        if(out == nullptr)
+            droppedFrames++;
+        else
         {
-            *r++ = *originalImage++;
-            *g++ = *originalImage++;
-            *b++ = *originalImage++;
+            scaleFrame(slot->info.frame.get(), out->data.data());
+            out->size = numBytes;
+            out->captured = slot->captured;
+            convertedFrames.commit();
+            std::lock_guard<std::mutex> guard(pipeline_mutex);
+            converted_cv.notify_one();
         }
+
+        //Hand the buffers back to the decoder right away
+        av_frame_unref(slot->info.frame.get());
+        decodedFrames.release();
     }
-    else if(PrimaryCCD.getBPP() == 16)
+}
+
+//This passes the converted frames to the streamer.
+void indi_webcam::run_deliver()
+{
+    while (true)
     {
-        uint16_t *bigOriginalImage = reinterpret_cast<uint16_t *>(originalImage);
-        uint16_t *bigConvertedImage = reinterpret_cast<uint16_t *>(convertedImage);
-        int size =  numBytes / 2 / 3;
-        uint16_t *r,*g,*b;
-        r = (bigConvertedImage);
-        g = (bigConvertedImage + size);
-        b = (bigConvertedImage + size * 2);
-        for(int i=0; i < numBytes / 2; i+=3)
+        FrameRing<>::Slot *slot = nullptr;
         {
-            *r++ = *bigOriginalImage++;
-            *g++ = *bigOriginalImage++;
-            *b++ = *bigOriginalImage++;
+            std::unique_lock<std::mutex> guard(pipeline_mutex);
+            converted_cv.wait(guard, [this, &slot]
+            {
+                slot = convertedFrames.front();
+                return slot != nullptr || pipeline_stop;
+            });
+            if (pipeline_stop)
+                break;
         }
+
+        Streamer->newFrame(slot->data.data(), slot->size);
+        convertedFrames.release();
     }
-    return true;
 }
 
 //This sets up the webcam to get images
 //It is used for both the streaming and exposing algorithms
 bool indi_webcam::setupStreaming()
 {
-    // Determine required buffer size and allocate buffer for pframeRGB
+    // Determine required buffer size
     numBytes = av_image_get_buffer_size(out_pix_fmt, pCodecCtx->width, pCodecCtx->height, 1);
 
     // Allocate video frame
     pFrame=av_frame_alloc();
     if(pFrame==nullptr)
       return false;
-    // Allocate an AVFrame structure
-    pFrameOUT=av_frame_alloc();
-    if(pFrameOUT==nullptr)
-      return false;
-
-    // Assign appropriate parts of buffer to image planes in pFrameRGB
-    buffer = (uint8_t *)av_malloc(numBytes*sizeof(uint8_t));
-    if(buffer==nullptr)
-      return false;
-
-    av_image_fill_arrays (pFrameOUT->data, pFrameOUT->linesize, buffer, out_pix_fmt,
-              pCodecCtx->width, pCodecCtx->height, 1);
 
     // initialize SWS context for software scaling
     sws_ctx = sws_getContext( pCodecCtx->width, pCodecCtx->height,
@@ -1501,6 +1568,9 @@ bool indi_webcam::setupStreaming()
                  );
     if(sws_ctx==nullptr)
       return false;
+    sourceWidth = pCodecCtx->width;
+    sourceHeight = pCodecCtx->height;
+    sourcePixFmt = pCodecCtx->pix_fmt;
 
     PrimaryCCD.setFrameBufferSize(numBytes);
     PrimaryCCD.setResolution(pCodecCtx->width, pCodecCtx->height);
@@ -1508,72 +1578,102 @@ bool indi_webcam::setupStreaming()
     return true;
 }
 
-//This gets one image from the camera.
-//It is used for both the streaming and exposing algorithms
+//This gets one image from the camera into the primary buffer.
+//It is used for the exposing algorithms, streaming uses readFrame and scaleFrame on separate threads.
 bool indi_webcam::getStreamFrame()
 {
-    AVPacket packet;
-    //If at first you don't succees to get a frame, try again.
-    int ret = -1;
-    while(ret < 0)
+    if(!readFrame(pFrame))
+        return false;
+    scaleFrame(pFrame, PrimaryCCD.getFrameBuffer());
+    return true;
+}
+
+//This reads packets until the decoder returns a frame.
+//With frame threading the decoder only returns frames once several packets are queued,
+//and then may hold several decoded frames, which are handed out before more packets are read.
+bool indi_webcam::readFrame(AVFrame *frame)
+{
+    while(true)
     {
-        ret = av_read_frame(pFormatCtx, &packet);
-        char errbuff[200];
-        av_make_error_string(errbuff, 200, ret);
-        if(ret < 0) // Negative return value means stream stopped
+        int ret = avcodec_receive_frame(pCodecCtx, frame);
+        if (ret == 0)
+            return true;
+        if (ret != AVERROR(EAGAIN)) {
+            DEBUG(INDI::Logger::DBG_SESSION, "Error during decoding");
+            return false;
+        }
+
+        AVPacket packet;
+        if(hasPendingPacket)
         {
-            DEBUGF(INDI::Logger::DBG_SESSION, "FFMPEG Error:%s, attempting to reconnect.", errbuff);
-            if(reconnectSource())
+            av_packet_move_ref(&packet, &pendingPacket);
+            hasPendingPacket = false;
+        }
+        else
+        {
+            ret = av_read_frame(pFormatCtx, &packet);
+            if(ret < 0) // Negative return value means stream stopped
             {
-                DEBUG(INDI::Logger::DBG_SESSION, "Device successfully reconnected.");
-                freeMemory();
-                //Try to set up streaming again, if there is an error, return
-                if(!setupStreaming())
+                char errbuff[200];
+                av_make_error_string(errbuff, 200, ret);
+                DEBUGF(INDI::Logger::DBG_SESSION, "FFMPEG Error:%s, attempting to reconnect.", errbuff);
+                if(!reconnectSource())
                 {
-                    DEBUG(INDI::Logger::DBG_SESSION, "Error on Stream Setup.");
+                    DEBUG(INDI::Logger::DBG_SESSION, "Device did not reconnect after 10 tries.");
+                    return false;
+                }
+                //The scaler may be in use on another thread, so it is kept, which needs the same format as before
+                if(pCodecCtx->width != sourceWidth || pCodecCtx->height != sourceHeight || pCodecCtx->pix_fmt != sourcePixFmt)
+                {
+                    DEBUG(INDI::Logger::DBG_SESSION, "Device reconnected with a different format.");
                     return false;
                 }
-                //Flush it one more time because of the disconnect.
-                flush_frame_buffer();
+                DEBUG(INDI::Logger::DBG_SESSION, "Device successfully reconnected.");
+                continue;
             }
-            else
+
+            if(packet.stream_index != videoStream)
             {
-                DEBUG(INDI::Logger::DBG_SESSION, "Device did not reconnect after 10 tries.");
                 av_packet_unref(&packet);
-                return false;
+                continue;
             }
         }
-    }
-    if(packet.stream_index==videoStream) {
-        int ret;
+
         ret = avcodec_send_packet(pCodecCtx, &packet);
-        char errbuff[200];
-        av_make_error_string(errbuff, 200, ret);
+        if (ret == AVERROR(EAGAIN)) {
+            //The decoder is full, drain it and send the same packet again
+            av_packet_move_ref(&pendingPacket, &packet);
+            hasPendingPacket = true;
+            continue;
+        }
+        av_packet_unref(&packet);
         if (ret < 0) {
+            char errbuff[200];
+            av_make_error_string(errbuff, 200, ret);
             DEBUGF(INDI::Logger::DBG_SESSION, "Error sending a packet for decoding:%s",errbuff);
-            av_packet_unref(&packet);
             return false;
         }
-        while (ret >= 0) {
-            ret = avcodec_receive_frame(pCodecCtx, pFrame);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-                continue;
-            else if (ret < 0) {
-                DEBUG(INDI::Logger::DBG_SESSION, "Error during decoding");
-                av_packet_unref(&packet);
-                return false;
-            }
-            // We have a frame at that point
-            // Convert the image from its native format to our output format
-           sws_scale(sws_ctx, (uint8_t const * const *)pFrame->data,
-                pFrame->linesize, 0, pCodecCtx->height,
-                pFrameOUT->data, pFrameOUT->linesize);
-           av_packet_unref(&packet);
-           return true;
-        }
+    }
+}
 
+//This converts a decoded frame from its native format to our output format, straight into destination.
+//Planar RGB from swscale is ordered G, B, R, so the planes are pointed at the FITS R, G, B order.
+void indi_webcam::scaleFrame(AVFrame *frame, uint8_t *destination)
+{
+    uint8_t *data[4];
+    int linesize[4];
+    av_image_fill_arrays(data, linesize, destination, out_pix_fmt, sourceWidth, sourceHeight, 1);
+
+    if(out_pix_fmt == AV_PIX_FMT_GBRP || out_pix_fmt == AV_PIX_FMT_GBRP16LE)
+    {
+        uint8_t *r = data[0];
+        data[0] = data[1];
+        data[1] = data[2];
+        data[2] = r;
     }
-    return false;
+
+    sws_scale(sws_ctx, (uint8_t const * const *)frame->data,
+              frame->linesize, 0, sourceHeight, data, linesize);
 }
 
 //This will clear out the frame buffer of any unread frames.
@@ -1629,6 +1729,8 @@ bool indi_webcam::flush_frame_buffer() {
         packetReceiveTime = now.tv_usec - then.tv_usec;
         av_packet_unref(&packet);
     }
+    //Frames still queued in the decoder threads are stale as well
+    avcodec_flush_buffers(pCodecCtx);
     DEBUGF(INDI::Logger::DBG_SESSION, "Buffer Cleared of %u stale frames.", num);
     return true;  //Buffer Cleared
 
@@ -1642,16 +1744,6 @@ void indi_webcam::freeMemory()
         sws_freeContext(sws_ctx);
     sws_ctx = nullptr;
 
-    // Free the Buffer
-    if(buffer)
-        av_free(buffer);
-    buffer = nullptr;
-
-    // Free the RGB image
-    if(pFrameOUT)
-        av_free(pFrameOUT);
-    pFrameOUT = nullptr;
-
     // Free the input frame
     if(pFrame)
         av_free(pFrame);
@@ -1664,6 +1756,10 @@ bool indi_webcam::saveConfigItems(FILE *fp)
     INDI::CCD::saveConfigItems(fp);
     IUSaveConfigSwitch(fp, &CaptureDeviceSelection);
     IUSaveConfigSwitch(fp, &RapidStackingSelection);
+    IUSaveConfigSwitch(fp, &StackRejectionSelection);
+    IUSaveConfigNumber(fp, &StackRejectionNP);
+    IUSaveConfigSwitch(fp, &DecodeThreadingSP);
+    IUSaveConfigNumber(fp, &DecodeNP);
     IUSaveConfigSwitch(fp, &OutputFormatSelection);
     IUSaveConfigText(fp, &HTTPInputOptionsP);
     IUSaveConfigText(fp, &InputOptionsTP);
@@ -28,6 +28,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <indiccd.h>
 #include <stream/streammanager.h>
 
+#include "framering.h"
+#include "framestack.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +44,10 @@ extern "C" {
 }
 #endif
 //#include <ctime>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 //These are required to check for AVFoundation Devices
@@ -94,7 +101,6 @@ private:
     //Related to exposures
     struct timeval ExpStart { 0, 0 };
     float ExposureRequest { 0 };
-    bool convertINDI_RGBtoFITS_RGB(uint8_t *originalImage, uint8_t *convertedImage);
 
     //These are related to how we change sources
     bool ConnectToSource(std::string device, std::string source, int framerate, std::string videosize, std::string htmlSource);
@@ -111,16 +117,12 @@ private:
     ISwitchVectorProperty RefreshSP;
 
     //webcam stacking.
+    //Frames are accumulated interleaved on the stack worker thread, the final stack is 16 bit.
     bool webcamStacking;
     bool averaging;
-    float *stackBuffer;
-    int numberOfFramesInStack;
-    bool addToStack();
+    FrameStack stack;
+    FrameStack::Rejection stackRejection = FrameStack::REJECT_NONE;
     void copyFinalStackToPrimaryFrameBuffer();
-    void setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer);
-    void setRGBImageDataValueFromFloat(int x, int y, int channel, float value, bool roundAnswer);
-    float getImageDataFloatValue(int x, int y);
-    float getRGBImageDataFloatValue(int x, int y, int channel);
 
     //These are our device capture settings
     bool use16Bit = true;
@@ -155,16 +157,31 @@ private:
     ISwitchVectorProperty VideoSizeSelection;
     ISwitch *RapidStacking = nullptr;
     ISwitchVectorProperty RapidStackingSelection;
+    ISwitch *StackRejection = nullptr;
+    ISwitchVectorProperty StackRejectionSelection;
+    INumber StackRejectionN[2];
+    INumberVectorProperty StackRejectionNP;
     ISwitch *OutputFormats = nullptr;
     ISwitchVectorProperty OutputFormatSelection;
     IText TimeoutOptionsT[2] {};
     ITextVectorProperty TimeoutOptionsTP;
+    ISwitch DecodeThreadingS[2];
+    ISwitchVectorProperty DecodeThreadingSP;
+    enum
+    {
+        DECODE_THREADS,
+        DECODE_QUEUE
+    };
+    INumber DecodeN[2];
+    INumberVectorProperty DecodeNP;
 
 
     //Webcam setup, release, and frame capture
     bool setupStreaming();
     void freeMemory();
     bool getStreamFrame();
+    bool readFrame(AVFrame *frame);
+    void scaleFrame(AVFrame *frame, uint8_t *destination);
     bool flush_frame_buffer();
 
     //Related to streaming
@@ -176,18 +193,46 @@ private:
     void start_capturing();
     void stop_capturing();
 
+    //Streaming pipeline: the capture thread reads and decodes packets into decodedFrames,
+    //the convert thread scales them into convertedFrames and the deliver thread passes those to the streamer.
+    //Both rings are bounded, if one is full the newest frame is dropped instead of stalling the capture.
+    struct AVFrameDeleter
+    {
+        void operator()(AVFrame *frame) { av_frame_free(&frame); }
+    };
+    struct DecodedFrame
+    {
+        std::unique_ptr<AVFrame, AVFrameDeleter> frame { av_frame_alloc() };
+    };
+    FrameRing<DecodedFrame> decodedFrames;
+    FrameRing<> convertedFrames;
+    std::thread convert_thread;
+    std::thread deliver_thread;
+    std::mutex pipeline_mutex;
+    std::condition_variable decoded_cv;
+    std::condition_variable converted_cv;
+    bool pipeline_stop = false;
+    std::atomic<uint32_t> droppedFrames { 0 };
+    void run_convert();
+    void run_deliver();
+
     //FFMpeg Variables to make captures work.
     struct SwsContext *sws_ctx;
-    uint8_t *buffer;
     int numBytes;
     AVPixelFormat out_pix_fmt;
+    //Source format sws_ctx was set up for, a reconnected source must match it
+    int sourceWidth = 0;
+    int sourceHeight = 0;
+    AVPixelFormat sourcePixFmt = AV_PIX_FMT_NONE;
     AVFormatContext *pFormatCtx;
     int              videoStream;
     AVCodecContext  *pCodecCtx;
     AVCodec         *pCodec;
     AVFrame         *pFrame;
-    AVFrame         *pFrameOUT;
     AVDictionary *optionsDict;
+    //Packet the decoder refused while it still had frames to hand out, sent again by readFrame once they are read
+    AVPacket pendingPacket {};
+    bool hasPendingPacket = false;
 
 };
 #endif // indi_webcam_H
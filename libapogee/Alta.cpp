@@ -478,6 +478,24 @@ Apg::Status Alta::GetImagingStatus()
 //////////////////////////// 
 // GET  IMAGE 
 void Alta::GetImage( std::vector<uint16_t> & out )
+{
+    uint16_t r=0, c= 0;
+    ExposureAndGetImgRC( r, c );
+    const int32_t numCols = GetRoiNumCols();
+    const int32_t size = r*GetImageZ()*numCols;
+
+    if( size != apgHelper::SizeT2Int32( out.size() ) )
+    {
+        out.clear();
+        out.resize( size );
+    }
+
+    GetImage( &out[0], numCols );
+}
+
+//////////////////////////// 
+// GET  IMAGE 
+void Alta::GetImage( uint16_t * out, int32_t stride )
 {
 #ifdef DEBUGGING_CAMERA
     apgHelper::DebugMsg( "Alta::GetImage -> BEGINNING" );
@@ -512,29 +530,39 @@ void Alta::GetImage( std::vector<uint16_t> & out )
         }
     }
 
-    // allocating the buffers for the image
+    // sizing the staging buffer for the image
     // doing this outside of the try / catch, so that
     // even if the GetImage function throws
     // we can try to copy whatever data we managed
     // to fetch from the camera into the user supplied
-    // vector
-    uint16_t r=0, c = 0;
+    // buffer
+    // zero filled, so pixels past a partial transfer are
+    // not left over from the previous image
+    uint16_t r=0, c= 0;
     ExposureAndGetImgRC( r, c );
     const uint16_t z = GetImageZ();
-    std::vector<uint16_t> datafromCam( r*c*z, 0 ); 
+    m_ImgStaging.assign( r*c*z, 0 );
 
     const int32_t dataLen = r*z;
-    const int32_t numCols = GetRoiNumCols();  
+    const int32_t numCols = GetRoiNumCols();
 
-    if( dataLen*numCols != apgHelper::SizeT2Int32( out.size() ) )
+    if( 0 == stride )
     {
-        out.clear();
-        out.resize( dataLen*numCols );
+        stride = numCols;
+    }
+
+    if( stride < numCols )
+    {
+        std::stringstream msg;
+        msg << "Invalid stride, " << stride;
+        msg << ", for an image with " << numCols << " columns.";
+        apgHelper::throwRuntimeException( m_fileName, msg.str(), 
+            __LINE__, Apg::ErrorType_InvalidUsage );
     }
 
     try
     {
-        m_CamIo->GetImageData( datafromCam );
+        m_CamIo->GetImageData( m_ImgStaging );
     }
     catch(std::exception & err )
     {
@@ -545,7 +573,7 @@ void Alta::GetImage( std::vector<uint16_t> & out )
         ApgLogger::Instance().Write(ApgLogger::LEVEL_RELEASE,"error",
         apgHelper::mkMsg( m_fileName, msg, __LINE__) );
 
-        FixImgFromCamera( datafromCam, out, dataLen, numCols );
+        FixImgFromCamera( m_ImgStaging, out, dataLen, numCols, stride );
         throw;
     }
     
@@ -580,7 +608,7 @@ void Alta::GetImage( std::vector<uint16_t> & out )
 #endif
 
     // removing the AD garbage pixels at the beginning of every row
-    FixImgFromCamera( datafromCam, out, dataLen, numCols );
+    FixImgFromCamera( m_ImgStaging, out, dataLen, numCols, stride );
   
     ApgLogger::Instance().Write(ApgLogger::LEVEL_DEBUG,"info","Get Image Completed.");
 
@@ -955,11 +983,11 @@ Apg::FanMode Alta::GetFanMode()
 //////////////////////////// 
 //      FIX      IMG        FROM          CAMERA
 void Alta::FixImgFromCamera( const std::vector<uint16_t> & data,
-                              std::vector<uint16_t> & out,  const int32_t rows, 
-                              const int32_t cols )
+                              uint16_t * out,  const int32_t rows, 
+                              const int32_t cols, const int32_t stride )
 {
     const int32_t offset = m_CcdAcqSettings->GetPixelShift();
-    ImgFix::SingleOuputCopy( data, out, rows, cols, offset );
+    ImgFix::SingleOuputCopy( &data[0], out, rows, cols, offset, stride );
 }
 
 //////////////////////////// 
@@ -42,7 +42,7 @@ class DLL_EXPORT AltaF : public CamGen2Base
 
     protected:
         void FixImgFromCamera( const std::vector<uint16_t> & data,
-            std::vector<uint16_t> & out,  int32_t rows, int32_t cols );
+            uint16_t * out,  int32_t rows, int32_t cols, int32_t stride );
 
         void ExposureAndGetImgRC(uint16_t & r, uint16_t & c);
 
@@ -1166,6 +1166,18 @@ class DLL_EXPORT ApogeeCam
          */
         virtual void GetImage( std::vector<uint16_t> & out ) = 0;
 
+        /*! 
+         * Downloads the image data from the camera into a caller owned buffer.
+         * The AD latency pixels are removed while the data is copied out of a 
+         * staging buffer kept by the camera, so no memory is allocated per image.
+         * \param [out] out Buffer that will recieve the image data. It must hold 
+         * GetRoiNumRows() rows for each image in the download.
+         * \param [in] stride Number of pixels from the start of one row in out 
+         * to the start of the next one, 0 for GetRoiNumCols().
+         * \exception std::runtime_error
+         */
+        virtual void GetImage( uint16_t * out, int32_t stride = 0 ) = 0;
+
         /*! 
          * This method halts an in progress exposure. If this method is called 
          * and there is no exposure in progress a std::runtime_error exception is thrown.
@@ -1284,7 +1296,7 @@ class DLL_EXPORT ApogeeCam
         virtual uint16_t GetImageZ() = 0;
         virtual uint16_t GetIlluminationMask() = 0;
         virtual void FixImgFromCamera( const std::vector<uint16_t> & data,
-            std::vector<uint16_t> & out,  int32_t rows, int32_t cols) = 0;
+            uint16_t * out,  int32_t rows, int32_t cols, int32_t stride ) = 0;
                 
 //this code removes vc++ compiler warning C4251
 //from http://www.unknownroad.com/rtfm/VisualStudio/warningC4251.html
@@ -1316,6 +1328,10 @@ class DLL_EXPORT ApogeeCam
         bool m_IsInitialized;
         bool m_IsConnected;
 		double m_LastExposureTime;
+
+        // raw data from the camera, kept between images so the
+        // buffer is only allocated again when the image size grows
+        std::vector<uint16_t> m_ImgStaging;
      
     private:
 
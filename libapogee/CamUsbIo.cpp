@@ -18,7 +18,9 @@
 #include <iostream>
 
 #include "apgHelper.h" 
+#include "ApgLogger.h"
 #include "IUsb.h"
+#include "UsbReadout.h"
 #include "helpers.h"
 #include "ApnUsbSys.h"
 
@@ -29,7 +31,12 @@
     #include "linux/GenOneLinuxUSB.h"
 #endif
 
-
+namespace
+{
+    // reads queued on the bus during an image download, enough
+    // to cover the time it takes to hand a chunk back to the host
+    const uint32_t NUM_READS_IN_FLIGHT = 4;
+}
 
 //////////////////////////// 
 // CTOR 
@@ -165,33 +172,19 @@ void CamUsbIo::GetImageData( std::vector<uint16_t> & data )
         data.resize( data.size() + PadSize );
     }
    
-    uint32_t NumBytesExpected = 
-        apgHelper::SizeT2Uint32( data.size() ) * sizeof(uint16_t);
-    std::vector<uint16_t>::iterator iter = data.begin();
-
-    while( NumBytesExpected > 0 )
-    {
-        uint32_t SizeToRead = std::min<uint32_t>(NumBytesExpected,
-            m_MaxBufSize );
+    const uint32_t TotalBytes = 
+         apgHelper::SizeT2Uint32( data.size() ) * sizeof(uint16_t);
 
-        uint32_t ReceivedSize = 0;
+    UsbReadout readout( *m_Usb, m_MaxBufSize, NUM_READS_IN_FLIGHT );
+    const uint32_t NumBytesExpected = TotalBytes - readout.Read( &data[0], TotalBytes );
 
-        m_Usb->ReadImage(&(*iter),SizeToRead,ReceivedSize);
-
-        NumBytesExpected -= ReceivedSize;
-        
-        if( ReceivedSize != SizeToRead )
-        {
-            break;
-        }
-        
-        iter += ReceivedSize / sizeof(uint16_t);
-    }
+    std::stringstream rate;
+    rate << "Downloaded " << ( TotalBytes - NumBytesExpected ) << " bytes at ";
+    rate << readout.GetMBPerSec() << " MB/s.";
+    ApgLogger::Instance().Write( ApgLogger::LEVEL_DEBUG, "info", rate.str() );
 
     if( NumBytesExpected )
     {
-        const uint32_t TotalBytes = 
-             apgHelper::SizeT2Uint32( data.size() ) * sizeof(uint16_t);
         const uint32_t  DownloadedBytes = TotalBytes - NumBytesExpected;
         std::stringstream msg;
         msg << "GetImageData error - Expected " << data.size()*sizeof(uint16_t) << " bytes.";
@@ -88,17 +88,19 @@ void HiC::Get4kby4kImage( std::vector<uint16_t> & out )
     // we can try to copy whatever data we managed
     // to fetch from the camera into the user supplied
     // vector
+    // zero filled, so pixels past a partial transfer are
+    // not left over from the previous image
     uint16_t r=0, c= 0;
     ExposureAndGetImgRC( r, c );
     const uint16_t z = GetImageZ();
-    std::vector<uint16_t>  datafromCam( r*c*z );
+    m_ImgStaging.assign( r*c*z, 0 );
 
     const int32_t dataLen = GetRoiNumRows()*z;
     const int32_t numCols = GetRoiNumCols();
     
     try
     {
-        m_CamIo->GetImageData( datafromCam );
+        m_CamIo->GetImageData( m_ImgStaging );
     }
     catch(std::exception & err )
     {
@@ -108,7 +110,13 @@ void HiC::Get4kby4kImage( std::vector<uint16_t> & out )
         ApgLogger::Instance().Write(ApgLogger::LEVEL_RELEASE,"error",
         apgHelper::mkMsg( m_fileName, msg, __LINE__) );
 
-        FixImgFromCamera( datafromCam, out, dataLen, numCols );
+        if( dataLen*numCols != apgHelper::SizeT2Int32( out.size() ) )
+        {
+            out.clear();
+            out.resize( dataLen*numCols );
+        }
+
+        FixImgFromCamera( m_ImgStaging, &out[0], dataLen, numCols, numCols );
         throw;
     }
         
@@ -142,12 +150,12 @@ void HiC::Get4kby4kImage( std::vector<uint16_t> & out )
     const int32_t LATENCY_PIXELS =  c - numCols;
 
     // if the data from the camera is bigger than the
-    if( datafromCam.size() > out.size() )
+    if( m_ImgStaging.size() > out.size() )
     {
         // TODO - copy some data into the output buffer
         // before throw
         std::stringstream msg;
-        msg << "Invalid buffer size from camera " << datafromCam.size();
+        msg << "Invalid buffer size from camera " << m_ImgStaging.size();
         apgHelper::throwRuntimeException(m_fileName, msg.str(), 
             __LINE__, Apg::ErrorType_InvalidUsage );
     }
@@ -167,14 +175,15 @@ void HiC::Get4kby4kImage( std::vector<uint16_t> & out )
     const int32_t OUTPUT_OFFSET =  
     ( (m_CamCfgData->m_MetaData.ImagingRows - r) / 2 ) * numCols;
 
-    ImgFix::QuadOuputCopy( datafromCam, out, dataLen, 
+    ImgFix::QuadOuputCopy( m_ImgStaging, out, dataLen, 
         numCols, LATENCY_PIXELS, OUTPUT_OFFSET );
 
     if( IsPixelReorderOn() )
     {
-        std::vector<uint16_t> temp = out;
+        // the raw data has been copied out, reuse the staging buffer
+        m_ImgStaging.assign( out.begin(), out.end() );
         //already removed latency pixels above
-        ImgFix::QuadOuputFix( temp, out, dataLen, numCols, 0 );
+        ImgFix::QuadOuputFix( m_ImgStaging, out, dataLen, numCols, 0 );
     }
    
    ApgLogger::Instance().Write(ApgLogger::LEVEL_DEBUG,"info","Get Image Completed.");
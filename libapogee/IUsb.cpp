@@ -10,6 +10,7 @@
 */ 
 
 #include "IUsb.h" 
+#include "apgHelper.h" 
 
 
 //////////////////////////// 
@@ -18,3 +19,36 @@ IUsb::~IUsb()
 { 
 
 }
+
+//////////////////////////// 
+// SUBMIT      IMAGE       READ
+void IUsb::SubmitImageRead( uint16_t * ImageData,
+                            const uint32_t InSizeInBytes, const uint32_t Tag )
+{
+    CompletedRead read = { Tag, 0 };
+    ReadImage( ImageData, InSizeInBytes, read.OutSizeInBytes );
+    m_CompletedReads.push_back( read );
+}
+
+//////////////////////////// 
+// REAP      IMAGE       READ
+void IUsb::ReapImageRead( uint32_t & Tag, uint32_t & OutSizeInBytes )
+{
+    if( m_CompletedReads.empty() )
+    {
+        apgHelper::throwRuntimeException( __BASE_FILE__, 
+            "ReapImageRead called without a submitted read", 
+            __LINE__, Apg::ErrorType_InvalidUsage );
+    }
+
+    Tag = m_CompletedReads.front().Tag;
+    OutSizeInBytes = m_CompletedReads.front().OutSizeInBytes;
+    m_CompletedReads.pop_front();
+}
+
+//////////////////////////// 
+// CANCEL      IMAGE       READS
+void IUsb::CancelImageReads()
+{
+    m_CompletedReads.clear();
+}
@@ -14,6 +14,7 @@
 #define IUSB_INCLUDE_H__ 
 
 #include <vector>
+#include <deque>
 #include <string>
 #include <stdint.h>
 
@@ -42,6 +43,32 @@ class IUsb
 					            const uint32_t InSizeInBytes,
 					            uint32_t &OutSizeInBytes) = 0;	
 
+        // queued image reads for UsbReadout.  the defaults read synchronously 
+        // with ReadImage, implementations that can keep several reads 
+        // on the bus at a time override all three.
+
+        /*!
+         * Starts reading InSizeInBytes of image data into ImageData.  The read is 
+         * identified by Tag when it completes.
+         * \exception std::runtime_error
+         */
+        virtual void SubmitImageRead( uint16_t * ImageData,
+                                      uint32_t InSizeInBytes, uint32_t Tag );
+
+        /*!
+         * Waits for the oldest submitted read to complete.  Throws the same
+         * errors as ReadImage, including for short reads unless they are
+         * tolerated by the implementation.
+         * \exception std::runtime_error
+         */
+        virtual void ReapImageRead( uint32_t & Tag, uint32_t & OutSizeInBytes );
+
+        /*!
+         * Cancels the submitted reads and waits until they are off the bus,
+         * so the buffers can be released.
+         */
+        virtual void CancelImageReads();
+
         virtual void GetStatus(uint8_t * status, uint32_t NumBytes) = 0;
 
         virtual void UsbRequestIn(uint8_t RequestCode,
@@ -68,6 +95,14 @@ class IUsb
 
         virtual void ReadSerialPort( uint16_t PortId, 
             uint8_t * ioBuf, uint16_t BufSzInBytes ) = 0;
+
+    private:
+        struct CompletedRead
+        {
+            uint32_t Tag;
+            uint32_t OutSizeInBytes;
+        };
+        std::deque<CompletedRead> m_CompletedReads;
 }; 
 
 #endif
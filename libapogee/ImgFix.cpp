@@ -11,147 +11,343 @@
 
 #include "ImgFix.h" 
 #include <algorithm>
+#include <system_error>
+#include <thread>
 
-//////////////////////////// 
-//      SINGLE       OUPUT       ERASE
-void ImgFix::SingleOuputErase( std::vector<uint16_t> & data, const int32_t rows,  
-        const int32_t numImgCols,  const int32_t numLatencyPixels )
+#if defined(__SSE2__)
+    #define IMGFIX_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define IMGFIX_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace
 {
-        for(int32_t r = 0, i=numLatencyPixels; r < rows; i += numImgCols, ++r)
+    // smaller images are fixed on the calling thread
+    const int64_t MT_MIN_PIXELS = 1024 * 1024;
+    // the fixes are limited by memory bandwidth, more
+    // threads than this do not help
+    const int32_t MT_MAX_THREADS = 4;
+
+    //////////////////////////// 
+    //      FOR       EACH       ROW       BAND
+    // calls fx( begin, end ) for bands of rows in [0, rows)
+    template<class Fx>
+    void ForEachRowBand( const int32_t rows, const int64_t pixels,
+        int32_t numThreads, const Fx & fx )
+    {
+        if( numThreads <= 0 )
+        {
+            numThreads = 1;
+            if( pixels >= MT_MIN_PIXELS )
+            {
+                const int32_t hw = static_cast<int32_t>( std::thread::hardware_concurrency() );
+                numThreads = std::min<int32_t>( std::max<int32_t>( hw, 1 ), MT_MAX_THREADS );
+            }
+        }
+
+        numThreads = std::max<int32_t>( std::min<int32_t>( numThreads, rows ), 1 );
+
+        std::vector<std::thread> threads;
+        for( int32_t i = 1; i < numThreads; ++i )
+        {
+            const int32_t begin = static_cast<int32_t>( int64_t(rows) * i / numThreads );
+            const int32_t end = static_cast<int32_t>( int64_t(rows) * (i+1) / numThreads );
+            try
+            {
+                threads.push_back( std::thread( fx, begin, end ) );
+            }
+            catch( std::system_error & )
+            {
+                // out of threads, do this band here
+                fx( begin, end );
+            }
+        }
+
+        fx( 0, rows / numThreads );
+
+        for( std::vector<std::thread>::iterator iter = threads.begin();
+            iter != threads.end(); ++iter )
         {
-            std::vector<uint16_t>::iterator start = data.begin()+i;
-            std::vector<uint16_t>::iterator end = start+numLatencyPixels;
-            data.erase( start, end );
+            (*iter).join();
         }
+    }
+
+#ifdef IMGFIX_SSE2
+    //////////////////////////// 
+    //      REVERSE
+    inline __m128i Reverse( __m128i v )
+    {
+        v = _mm_shuffle_epi32( v, _MM_SHUFFLE(0,1,2,3) );
+        v = _mm_shufflelo_epi16( v, _MM_SHUFFLE(2,3,0,1) );
+        return _mm_shufflehi_epi16( v, _MM_SHUFFLE(2,3,0,1) );
+    }
+
+    inline __m128i Load( const uint16_t * p )
+    {
+        return _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) );
+    }
+
+    inline void Store( uint16_t * p, const __m128i v )
+    {
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( p ), v );
+    }
+#endif
+
+#ifdef IMGFIX_NEON
+    //////////////////////////// 
+    //      REVERSE
+    inline uint16x8_t Reverse( const uint16x8_t v )
+    {
+        const uint16x8_t r = vrev64q_u16( v );
+        return vcombine_u16( vget_high_u16( r ), vget_low_u16( r ) );
+    }
+#endif
+
+    //////////////////////////// 
+    //      DUAL       ROWS
+    // the two outputs alternate, the left one reads left to right
+    // and the right one right to left
+    void DualRows( const uint16_t * data, uint16_t * out,
+        const int32_t begin, const int32_t end, const int32_t cols,
+        const int32_t numLatencyPixels, const int32_t outStride )
+    {
+        const int32_t HALF_COLS = cols / 2;
+
+        //account for the odd no op col
+        const int32_t oddAdjust = ( cols % 2 ) ? 1 : 0;
+
+        for( int32_t r = begin; r < end; ++r )
+        {
+            const uint16_t * src = data + numLatencyPixels +
+                int64_t(r) * ( HALF_COLS*2 + numLatencyPixels );
+            uint16_t * left = out + int64_t(r) * outStride;
+            // upper right pixel of col c is right[-c]
+            uint16_t * right = left + cols - 1 - oddAdjust;
+
+            int32_t c = 0;
+#ifdef IMGFIX_SSE2
+            for( ; c + 8 <= HALF_COLS; c += 8 )
+            {
+                const __m128i a = Load( src + 2*c );
+                const __m128i b = Load( src + 2*c + 8 );
+
+                // split the even ( ur ) and odd ( ul ) pixels
+                const __m128i u0 = _mm_unpacklo_epi16( a, b );
+                const __m128i u1 = _mm_unpackhi_epi16( a, b );
+                const __m128i v0 = _mm_unpacklo_epi16( u0, u1 );
+                const __m128i v1 = _mm_unpackhi_epi16( u0, u1 );
+                const __m128i ur = _mm_unpacklo_epi16( v0, v1 );
+                const __m128i ul = _mm_unpackhi_epi16( v0, v1 );
+
+                Store( left + c, ul );
+                Store( right - c - 7, Reverse( ur ) );
+            }
+#endif
+#ifdef IMGFIX_NEON
+            for( ; c + 8 <= HALF_COLS; c += 8 )
+            {
+                const uint16x8x2_t v = vld2q_u16( src + 2*c );
+                vst1q_u16( left + c, v.val[1] );
+                vst1q_u16( right - c - 7, Reverse( v.val[0] ) );
+            }
+#endif
+            for( ; c < HALF_COLS; ++c )
+            {
+                right[-c] = src[2*c];
+                left[c] = src[2*c + 1];
+            }
+        }
+    }
+
+    //////////////////////////// 
+    //      QUAD       ROWS
+    // the four outputs take turns, the top left and bottom left ones
+    // read left to right, the right ones right to left.  the top and
+    // bottom rows move towards the middle of the image.
+    void QuadRows( const uint16_t * data, uint16_t * out,
+        const int32_t begin, const int32_t end, const int32_t rows,
+        const int32_t cols, const int32_t numLatencyPixels,
+        const int32_t outStride )
+    {
+        const int32_t HALF_COLS = cols / 2;
+
+        for( int32_t r = begin; r < end; ++r )
+        {
+            const uint16_t * src = data + numLatencyPixels*2 +
+                int64_t(r) * ( HALF_COLS*4 + numLatencyPixels*2 );
+            uint16_t * top = out + int64_t(r) * outStride;
+            uint16_t * bottom = out + int64_t(rows-(r+1)) * outStride;
+            const int32_t last = cols - 1;
+
+            int32_t c = 0;
+#ifdef IMGFIX_SSE2
+            for( ; c + 8 <= HALF_COLS; c += 8 )
+            {
+                const __m128i a = Load( src + 4*c );
+                const __m128i b = Load( src + 4*c + 8 );
+                const __m128i d = Load( src + 4*c + 16 );
+                const __m128i e = Load( src + 4*c + 24 );
+
+                // transpose the groups of ul, ur, lr, ll pixels
+                const __m128i u0 = _mm_unpacklo_epi16( a, b );
+                const __m128i u1 = _mm_unpackhi_epi16( a, b );
+                const __m128i u2 = _mm_unpacklo_epi16( d, e );
+                const __m128i u3 = _mm_unpackhi_epi16( d, e );
+                const __m128i v0 = _mm_unpacklo_epi16( u0, u1 );
+                const __m128i v1 = _mm_unpackhi_epi16( u0, u1 );
+                const __m128i v2 = _mm_unpacklo_epi16( u2, u3 );
+                const __m128i v3 = _mm_unpackhi_epi16( u2, u3 );
+
+                Store( top + c, _mm_unpacklo_epi64( v0, v2 ) );
+                Store( top + last - c - 7, Reverse( _mm_unpackhi_epi64( v0, v2 ) ) );
+                Store( bottom + last - c - 7, Reverse( _mm_unpacklo_epi64( v1, v3 ) ) );
+                Store( bottom + c, _mm_unpackhi_epi64( v1, v3 ) );
+            }
+#endif
+#ifdef IMGFIX_NEON
+            for( ; c + 8 <= HALF_COLS; c += 8 )
+            {
+                const uint16x8x4_t v = vld4q_u16( src + 4*c );
+                vst1q_u16( top + c, v.val[0] );
+                vst1q_u16( top + last - c - 7, Reverse( v.val[1] ) );
+                vst1q_u16( bottom + last - c - 7, Reverse( v.val[2] ) );
+                vst1q_u16( bottom + c, v.val[3] );
+            }
+#endif
+            for( ; c < HALF_COLS; ++c )
+            {
+                top[c] = src[4*c];
+                top[last - c] = src[4*c + 1];
+                bottom[last - c] = src[4*c + 2];
+                bottom[c] = src[4*c + 3];
+            }
+        }
+    }
 }
 
-    
 //////////////////////////// 
 //      SINGLE       OUPUT       COPY
-void ImgFix::SingleOuputCopy( const std::vector<uint16_t> & data, 
-      std::vector<uint16_t> & out, const int32_t rows,  const int32_t numImgCols,  
+void ImgFix::SingleOuputCopy( const std::vector<uint16_t> & data,
+      std::vector<uint16_t> & out, const int32_t rows,  const int32_t numImgCols,
       const int32_t numLatencyPixels )
 {
+    SingleOuputCopy( &data[0], &out[0], rows, numImgCols,
+        numLatencyPixels, numImgCols );
+}
 
-    // in testing found that this function is much faster than the erase function
+//////////////////////////// 
+//      SINGLE       OUPUT       COPY
+void ImgFix::SingleOuputCopy( const uint16_t * data, uint16_t * out,
+      const int32_t rows, const int32_t numImgCols,
+      const int32_t numLatencyPixels, const int32_t outStride,
+      const int32_t numThreads )
+{
     const int32_t actNumCols = numImgCols + numLatencyPixels;
 
-    for(int32_t r = 0, actColsOffset=numLatencyPixels, outColsOffset=0; r < rows;
-		    actColsOffset += actNumCols, outColsOffset += numImgCols, ++r)
-    {
-        std::vector<uint16_t>::const_iterator start = data.begin()+actColsOffset;
-        std::vector<uint16_t>::const_iterator end = start + numImgCols;
-        std::vector<uint16_t>::iterator outStart = out.begin() + outColsOffset;
-        std::copy( start, end, outStart );
-    }
+    ForEachRowBand( rows, int64_t(rows) * numImgCols, numThreads,
+        [=]( const int32_t begin, const int32_t end )
+        {
+            for( int32_t r = begin; r < end; ++r )
+            {
+                const uint16_t * start = data + numLatencyPixels + int64_t(r) * actNumCols;
+                std::copy( start, start + numImgCols, out + int64_t(r) * outStride );
+            }
+        } );
 }
 
 
 //////////////////////////// 
 //      QUAD      OUPUT       COPY
-void ImgFix::QuadOuputCopy( const std::vector<uint16_t> & data, 
-      std::vector<uint16_t> & out, const int32_t rows,  const int32_t cols,  
+void ImgFix::QuadOuputCopy( const std::vector<uint16_t> & data,
+      std::vector<uint16_t> & out, const int32_t rows,  const int32_t cols,
       const int32_t numLatencyPixels, const int32_t outputBuffOffset )
 {
-    int32_t numGood =  ( cols / 2 ) * 4;
-    int32_t numBad = numLatencyPixels*2;
+    QuadOuputCopy( &data[0], &out[0] + outputBuffOffset, rows, cols,
+        numLatencyPixels, cols );
+}
 
-    int32_t down = rows*cols;
-    
-    int32_t goodStart = 0;
-    int32_t badStart = numLatencyPixels*2;
+//////////////////////////// 
+//      QUAD      OUPUT       COPY
+void ImgFix::QuadOuputCopy( const uint16_t * data, uint16_t * out,
+      const int32_t rows, const int32_t cols,
+      const int32_t numLatencyPixels, const int32_t outStride )
+{
+    // the camera sends runs of numGood pixels, each one followed by
+    // numBad latency pixels.  the runs do not line up with the
+    // rows of the output, so split them where a row ends
+    const int32_t numGood =  ( cols / 2 ) * 4;
+    const int32_t numBad = numLatencyPixels*2;
 
-    while( down > 0 )
+    int32_t good = 0;
+    for( int32_t r = 0; r < rows; ++r, out += outStride )
     {
-         int32_t len = std::min<int32_t>( down, numGood );
+        int32_t col = 0;
+        while( col < cols )
+        {
+            const int32_t inRun = good % numGood;
+            const int32_t len = std::min<int32_t>( cols - col, numGood - inRun );
 
-        std::vector<uint16_t>::const_iterator start = data.begin()+badStart;
-        std::vector<uint16_t>::const_iterator end = start + len;
-        std::vector<uint16_t>::iterator outStart = out.begin() + outputBuffOffset + goodStart;
-        std::copy( start, end, outStart );
+            const uint16_t * start = data + numBad +
+                ( good / numGood ) * ( numGood + numBad ) + inRun;
+            std::copy( start, start + len, out + col );
 
-         goodStart += len;
-         badStart += (len + numBad);
-         down -= len;
+            good += len;
+            col += len;
+        }
     }
 }
 
 //////////////////////////// 
 //      QUAD       OUPUT       FIX
-void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data, 
+void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data,
                                              std::vector<uint16_t> & out,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
 {
-    const int32_t HALF_COLS = cols / 2;
-    const int32_t HALF_ROWS = rows / 2;
-    
-    int32_t index = numLatencyPixels*2;
-  
-    for( int32_t r=0; r < HALF_ROWS; ++r )
-    {
-        int32_t topOffset = cols*r;
-        int32_t bottomOffset = (cols*(rows-(r+1)));
+    QuadOuputFix( &data[0], &out[0], rows, cols, numLatencyPixels, cols );
+}
 
-        for( int32_t c=0; c < HALF_COLS; ++c)
+//////////////////////////// 
+//      QUAD       OUPUT       FIX
+void ImgFix::QuadOuputFix( const uint16_t * data, uint16_t * out,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels,
+                                             const int32_t outStride,
+                                             const int32_t numThreads )
+{
+    // each band of top rows also fills the matching bottom rows
+    ForEachRowBand( rows / 2, int64_t(rows) * cols, numThreads,
+        [=]( const int32_t begin, const int32_t end )
         {
-            int32_t ul = topOffset + c;
-            out[ul] = data[index];
-
-            int32_t ur =  topOffset + (cols-(c+1) );
-            ++index;
-            out[ur] = data[index];
-            
-            int32_t lr = bottomOffset + (cols-(c+1) );
-            ++index;
-            out[lr] = data[index];
-
-            int32_t ll = bottomOffset+c;
-            ++index;
-            out[ll] = data[index];
-
-            ++index;
-        }
-
-        //skip the latency pixels
-        index += numLatencyPixels*2;
-    }
+            QuadRows( data, out, begin, end, rows, cols,
+                numLatencyPixels, outStride );
+        } );
 }
 
 //////////////////////////// 
 //      DUAL       OUPUT       FIX
-void ImgFix::DualOuputFix( const std::vector<uint16_t> & data, 
+void ImgFix::DualOuputFix( const std::vector<uint16_t> & data,
                                              std::vector<uint16_t> & out,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
 {
-   
-    const int32_t HALF_COLS = cols / 2;
-
-     //account for the odd no op col
-    const int32_t oddAdjust = ( cols % 2 ) ? 1 : 0;
-    const int32_t START_UR_COL = cols;
-
-    int32_t index = numLatencyPixels;
-  
-    for( int32_t r=0; r < rows; ++r )
-    {
-        int32_t topOffset = cols*r;
+    DualOuputFix( &data[0], &out[0], rows, cols, numLatencyPixels, cols );
+}
 
-        for( int32_t c=0; c < HALF_COLS; ++c)
+//////////////////////////// 
+//      DUAL       OUPUT       FIX
+void ImgFix::DualOuputFix( const uint16_t * data, uint16_t * out,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels,
+                                             const int32_t outStride,
+                                             const int32_t numThreads )
+{
+    ForEachRowBand( rows, int64_t(rows) * cols, numThreads,
+        [=]( const int32_t begin, const int32_t end )
         {
-            // skip odd col if need with oddAdjust
-            int32_t ur =  topOffset + (START_UR_COL-(c+1) ) - oddAdjust;
-            out[ur] = data[index];
-
-           int32_t ul = topOffset + c;
-            ++index;
-            out[ul] = data[index];
-            
-            ++index;
-        }
-
-        //skip the latency pixels
-        index += numLatencyPixels;
-    }
+            DualRows( data, out, begin, end, cols,
+                numLatencyPixels, outStride );
+        } );
 }
@@ -18,9 +18,6 @@
 
 namespace ImgFix 
 { 
-    void SingleOuputErase( std::vector<uint16_t> & data, int32_t rows,  
-        int32_t numImgCols,  int32_t numLatencyPixels );
-
     void SingleOuputCopy( const std::vector<uint16_t> & data,   
         std::vector<uint16_t> & out, int32_t rows, int32_t numImgCols,  
         int32_t numLatencyPixels );
@@ -38,6 +35,28 @@ namespace ImgFix
                                      std::vector<uint16_t> & out,
                                      const int32_t rows,  const int32_t cols,
                                      const int32_t numLatencyPixels );
+
+    // the pointer versions write rows of the fixed image outStride pixels
+    // apart, so the data can go straight into a caller owned buffer.
+    // the dual and quad reorders use SSE2 or NEON where available.
+    // large images are split into bands of rows fixed on numThreads 
+    // threads, 0 picks the number of threads from the image size and 
+    // the hardware.
+    void SingleOuputCopy( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t numImgCols, int32_t numLatencyPixels,
+        int32_t outStride, int32_t numThreads=0 );
+
+    void QuadOuputCopy( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels,
+        int32_t outStride );
+
+    void QuadOuputFix( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels,
+        int32_t outStride, int32_t numThreads=0 );
+
+    void DualOuputFix( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels,
+        int32_t outStride, int32_t numThreads=0 );
 }; 
 
 #endif
@@ -0,0 +1,142 @@
+/*! 
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \class UsbReadout 
+* \brief Reads an image over usb with several reads queued on the bus at a time,
+* so the bus does not sit idle while a chunk is handed back to the host.
+* 
+*/ 
+
+#include "UsbReadout.h" 
+#include "IUsb.h"
+#include "apgHelper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+//////////////////////////// 
+// CTOR 
+UsbReadout::UsbReadout( IUsb & usb, const uint32_t ChunkSizeInBytes,
+                        const uint32_t NumReadsInFlight ) :
+                            m_Usb( usb ),
+                            m_ChunkSize( ChunkSizeInBytes ),
+                            m_NumReadsInFlight( std::max<uint32_t>( NumReadsInFlight, 1 ) ),
+                            m_Submitted( 0 ),
+                            m_NumInFlight( 0 ),
+                            m_NextTag( 0 ),
+                            m_Received( 0 ),
+                            m_Seconds( 0 )
+{ 
+    if( 0 == m_ChunkSize || 0 != m_ChunkSize % sizeof(uint16_t) )
+    {
+        apgHelper::throwRuntimeException( __BASE_FILE__, 
+            "UsbReadout chunk size must be a non zero number of pixels", 
+            __LINE__, Apg::ErrorType_InvalidUsage );
+    }
+} 
+
+//////////////////////////// 
+// READ 
+uint32_t UsbReadout::Read( uint16_t * ImageData, const uint32_t InSizeInBytes )
+{
+    const std::chrono::steady_clock::time_point start = 
+        std::chrono::steady_clock::now();
+
+    m_Submitted = 0;
+    m_NumInFlight = 0;
+    m_NextTag = 0;
+    m_Received = 0;
+
+    try
+    {
+        while( m_Submitted < InSizeInBytes && m_NumInFlight < m_NumReadsInFlight )
+        {
+            Submit( ImageData, InSizeInBytes );
+        }
+
+        // reads complete in the order they were submitted, so everything
+        // up to m_Received is in place
+        while( m_NumInFlight > 0 )
+        {
+            const uint32_t expectedTag = m_NextTag - m_NumInFlight;
+            uint32_t tag = 0;
+            uint32_t received = 0;
+            m_Usb.ReapImageRead( tag, received );
+            --m_NumInFlight;
+
+            if( tag != expectedTag )
+            {
+                std::stringstream msg;
+                msg << "UsbReadout error - read " << tag;
+                msg << " completed, expected read " << expectedTag << ".";
+                apgHelper::throwRuntimeException( __BASE_FILE__, msg.str(), 
+                    __LINE__, Apg::ErrorType_Critical );
+            }
+
+            const uint32_t offset = tag * m_ChunkSize;
+            const uint32_t requested = std::min<uint32_t>( m_ChunkSize, 
+                InSizeInBytes - offset );
+            m_Received += received;
+
+            if( received != requested )
+            {
+                // the camera has no more data for us
+                break;
+            }
+
+            if( m_Submitted < InSizeInBytes )
+            {
+                Submit( ImageData, InSizeInBytes );
+            }
+        }
+
+        if( m_NumInFlight > 0 )
+        {
+            m_Usb.CancelImageReads();
+            m_NumInFlight = 0;
+        }
+    }
+    catch( std::exception & )
+    {
+        // the reads write into the caller's buffer, get them
+        // off the bus before it can go away
+        m_Usb.CancelImageReads();
+        m_NumInFlight = 0;
+        m_Seconds = std::chrono::duration<double>( 
+            std::chrono::steady_clock::now() - start ).count();
+        throw;
+    }
+
+    m_Seconds = std::chrono::duration<double>( 
+        std::chrono::steady_clock::now() - start ).count();
+
+    return m_Received;
+}
+
+//////////////////////////// 
+// SUBMIT 
+void UsbReadout::Submit( uint16_t * ImageData, const uint32_t InSizeInBytes )
+{
+    const uint32_t size = std::min<uint32_t>( m_ChunkSize, InSizeInBytes - m_Submitted );
+
+    m_Usb.SubmitImageRead( ImageData + m_Submitted / sizeof(uint16_t), size, m_NextTag );
+
+    m_Submitted += size;
+    ++m_NextTag;
+    ++m_NumInFlight;
+}
+
+//////////////////////////// 
+// GET     MB     PER      SEC 
+double UsbReadout::GetMBPerSec() const
+{
+    if( m_Seconds <= 0 )
+    {
+        return 0;
+    }
+
+    return m_Received / m_Seconds / 1e6;
+}
@@ -0,0 +1,65 @@
+/*! 
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \class UsbReadout 
+* \brief Reads an image over usb with several reads queued on the bus at a time,
+* so the bus does not sit idle while a chunk is handed back to the host.
+* 
+*/ 
+
+
+#ifndef USBREADOUT_INCLUDE_H__ 
+#define USBREADOUT_INCLUDE_H__ 
+
+#include <stdint.h>
+
+class IUsb;
+
+class UsbReadout
+{ 
+    public: 
+        UsbReadout( IUsb & usb, uint32_t ChunkSizeInBytes, 
+            uint32_t NumReadsInFlight );
+
+        /*!
+         * Reads the image in chunks of ChunkSizeInBytes, straight into ImageData.  
+         * The readout stops at the first short read, the data before it is kept.  
+         * Reads still on the bus are cancelled before returning or throwing.
+         * \return Number of bytes received
+         * \exception std::runtime_error
+         */
+        uint32_t Read( uint16_t * ImageData, uint32_t InSizeInBytes );
+
+        /*!
+         * Transfer rate of the last Read in megabytes ( 10^6 bytes ) per second.
+         */
+        double GetMBPerSec() const;
+
+        /*!
+         * Duration of the last Read in seconds.
+         */
+        double GetSeconds() const { return m_Seconds; }
+
+    private:
+        void Submit( uint16_t * ImageData, uint32_t InSizeInBytes );
+
+        IUsb & m_Usb;
+        const uint32_t m_ChunkSize;
+        const uint32_t m_NumReadsInFlight;
+
+        uint32_t m_Submitted;
+        uint32_t m_NumInFlight;
+        uint32_t m_NextTag;
+        uint32_t m_Received;
+        double m_Seconds;
+
+        //disabling the copy ctor and assignment operator
+        //generated by the compiler - don't want them
+        //Effective C++ Item 6
+        UsbReadout(const UsbReadout&);
+        UsbReadout& operator=(UsbReadout&);
+}; 
+
+#endif
@@ -0,0 +1,166 @@
+/*! 
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \brief Times the ImgFix dual and quad output reorders on synthetic 4k by 4k
+* frames against the scalar versions they replaced, single threaded and on 
+* bands of rows, and checks the results are identical.
+* 
+*/ 
+
+#include "ImgFix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    //////////////////////////// 
+    // the scalar reorders as they were before the SIMD versions
+    namespace Scalar
+    {
+        void QuadOuputFix( const std::vector<uint16_t> & data, 
+                           std::vector<uint16_t> & out,
+                           const int32_t rows,  const int32_t cols,
+                           const int32_t numLatencyPixels)
+        {
+            const int32_t HALF_COLS = cols / 2;
+            const int32_t HALF_ROWS = rows / 2;
+            
+            int32_t index = numLatencyPixels*2;
+          
+            for( int32_t r=0; r < HALF_ROWS; ++r )
+            {
+                int32_t topOffset = cols*r;
+                int32_t bottomOffset = (cols*(rows-(r+1)));
+
+                for( int32_t c=0; c < HALF_COLS; ++c)
+                {
+                    out[topOffset + c] = data[index++];
+                    out[topOffset + (cols-(c+1))] = data[index++];
+                    out[bottomOffset + (cols-(c+1))] = data[index++];
+                    out[bottomOffset + c] = data[index++];
+                }
+
+                //skip the latency pixels
+                index += numLatencyPixels*2;
+            }
+        }
+
+        void DualOuputFix( const std::vector<uint16_t> & data, 
+                           std::vector<uint16_t> & out,
+                           const int32_t rows,  const int32_t cols,
+                           const int32_t numLatencyPixels)
+        {
+            const int32_t HALF_COLS = cols / 2;
+            const int32_t oddAdjust = ( cols % 2 ) ? 1 : 0;
+
+            int32_t index = numLatencyPixels;
+          
+            for( int32_t r=0; r < rows; ++r )
+            {
+                int32_t topOffset = cols*r;
+
+                for( int32_t c=0; c < HALF_COLS; ++c)
+                {
+                    out[topOffset + (cols-(c+1)) - oddAdjust] = data[index++];
+                    out[topOffset + c] = data[index++];
+                }
+
+                //skip the latency pixels
+                index += numLatencyPixels;
+            }
+        }
+    }
+
+    const int32_t ROWS = 4096;
+    const int32_t COLS = 4096;
+    const int32_t LATENCY = 8;
+
+    typedef std::chrono::steady_clock Clock;
+
+    //////////////////////////// 
+    // best of a few runs, in milliseconds
+    template<class Fx>
+    double Time( const Fx & fx, const int32_t runs )
+    {
+        double best = 1e9;
+        for( int32_t i = 0; i < runs; ++i )
+        {
+            const Clock::time_point start = Clock::now();
+            fx();
+            const double ms = std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+            best = std::min( best, ms );
+        }
+        return best;
+    }
+
+    void Report( const char * name, const char * variant, const double ms, const double baseline,
+                 const bool same )
+    {
+        const double gb = ROWS * double(COLS) * sizeof(uint16_t) / 1e9;
+        printf( "  %-6s %-22s %8.2f ms %6.2f GB/s %5.2fx%s\n", name, variant, ms, 
+            gb / ( ms / 1000 ), baseline / ms, same ? "" : "  MISMATCH" );
+    }
+}
+
+int main( int argc, char * argv[] )
+{
+    const int32_t runs = ( argc > 1 ) ? std::max( atoi( argv[1] ), 1 ) : 10;
+
+    // enough raw data for the quad layout, which has the most latency pixels
+    std::vector<uint16_t> raw( ( ROWS / 2 ) * ( COLS * 2 + LATENCY * 2 ) + LATENCY * 2 );
+    for( size_t i = 0; i < raw.size(); ++i )
+    {
+        raw[i] = static_cast<uint16_t>( rand() );
+    }
+
+    std::vector<uint16_t> expected( ROWS * COLS ), out( ROWS * COLS );
+    bool ok = true;
+
+    printf( "%dx%d frame, %d latency pixels, best of %d runs\n", COLS, ROWS, LATENCY, runs );
+
+    const struct
+    {
+        const char * name;
+        int32_t threads;
+    } variants[] = { { "simd, 1 thread", 1 }, { "simd, row bands", 0 } };
+
+    // dual outputs
+    {
+        const double baseline = Time( [&]() { Scalar::DualOuputFix( raw, expected, ROWS, COLS, LATENCY ); }, runs );
+        Report( "dual", "scalar", baseline, baseline, true );
+
+        for( size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); ++v )
+        {
+            std::fill( out.begin(), out.end(), 0 );
+            const double ms = Time( [&]() { ImgFix::DualOuputFix( &raw[0], &out[0], ROWS, COLS, 
+                LATENCY, COLS, variants[v].threads ); }, runs );
+            const bool same = out == expected;
+            Report( "dual", variants[v].name, ms, baseline, same );
+            ok = ok && same;
+        }
+    }
+
+    // quad outputs
+    {
+        const double baseline = Time( [&]() { Scalar::QuadOuputFix( raw, expected, ROWS, COLS, LATENCY ); }, runs );
+        Report( "quad", "scalar", baseline, baseline, true );
+
+        for( size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); ++v )
+        {
+            std::fill( out.begin(), out.end(), 0 );
+            const double ms = Time( [&]() { ImgFix::QuadOuputFix( &raw[0], &out[0], ROWS, COLS, 
+                LATENCY, COLS, variants[v].threads ); }, runs );
+            const bool same = out == expected;
+            Report( "quad", variants[v].name, ms, baseline, same );
+            ok = ok && same;
+        }
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,226 @@
+/*! 
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \brief Runs UsbReadout against a mock usb device with a fixed per read latency
+* and bus rate.  Reports MB/s for several numbers of reads in flight and checks 
+* the data, short reads and failed reads.
+* 
+*/ 
+
+#include "IUsb.h"
+#include "UsbReadout.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    //////////////////////////// 
+    // a camera that sends pixel i as value i, one read at a time. a read takes
+    // LATENCY to start once it is queued and the bus is idle, then moves
+    // BYTES_PER_SEC.  reads queued behind it start as soon as the bus is free.
+    class MockUsb : public IUsb
+    {
+        public:
+            MockUsb( uint32_t ShortAt, uint32_t FailAt ) :
+                m_Offset( 0 ), m_ShortAt( ShortAt ), m_FailAt( FailAt ), m_Cancels( 0 ) {}
+
+            void SubmitImageRead( uint16_t * ImageData, uint32_t InSizeInBytes, uint32_t Tag )
+            {
+                const Clock::time_point now = Clock::now();
+                Clock::time_point start = now + LATENCY;
+                if( !m_Reads.empty() && m_Reads.back().Done > now )
+                {
+                    start = m_Reads.back().Done;
+                }
+
+                Read read;
+                read.Data = ImageData;
+                read.Offset = m_Offset;
+                read.Size = InSizeInBytes;
+                read.Tag = Tag;
+                read.Done = start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>( InSizeInBytes / BYTES_PER_SEC ) );
+                m_Reads.push_back( read );
+                m_Offset += InSizeInBytes;
+            }
+
+            void ReapImageRead( uint32_t & Tag, uint32_t & OutSizeInBytes )
+            {
+                if( m_Reads.empty() )
+                {
+                    throw std::runtime_error( "reap without a read" );
+                }
+
+                Read read = m_Reads.front();
+                m_Reads.pop_front();
+                std::this_thread::sleep_until( read.Done );
+
+                Tag = read.Tag;
+                OutSizeInBytes = read.Size;
+                if( read.Offset + read.Size > m_ShortAt )
+                {
+                    OutSizeInBytes = read.Offset < m_ShortAt ? m_ShortAt - read.Offset : 0;
+                }
+
+                for( uint32_t i = 0; i < OutSizeInBytes / 2; ++i )
+                {
+                    read.Data[i] = static_cast<uint16_t>( read.Offset / 2 + i );
+                }
+
+                if( read.Offset + read.Size > m_FailAt )
+                {
+                    throw std::runtime_error( "ReadImage failed with error -7." );
+                }
+            }
+
+            void CancelImageReads()
+            {
+                m_Reads.clear();
+                ++m_Cancels;
+            }
+
+            size_t Pending() const { return m_Reads.size(); }
+            int Cancels() const { return m_Cancels; }
+
+            void ReadImage( uint16_t *, const uint32_t, uint32_t & )
+            {
+                throw std::runtime_error( "ReadImage is not used by UsbReadout" );
+            }
+
+            uint16_t ReadReg( uint16_t ) { return 0; }
+            void WriteReg( uint16_t, const uint16_t ) {}
+            void GetVendorInfo( uint16_t &, uint16_t &, uint16_t & ) {}
+            void SetupSingleImgXfer( uint16_t, uint32_t ) {}
+            void SetupSequenceImgXfer( uint16_t, uint16_t, uint16_t ) {}
+            void CancelImgXfer() {}
+            void GetStatus( uint8_t *, uint32_t ) {}
+            void UsbRequestIn( uint8_t, uint16_t, uint16_t, uint8_t *, uint32_t ) {}
+            void UsbRequestOut( uint8_t, uint16_t, uint16_t, const uint8_t *, uint32_t ) {}
+            void GetSerialNumber( int8_t *, uint32_t ) {}
+            void GetUsbFirmwareVersion( int8_t *, uint32_t ) {}
+            std::string GetDriverVersion() { return "mock"; }
+            bool IsError() { return false; }
+            uint16_t GetDeviceNum() { return 0; }
+            void UsbReqOutWithExtendedTimeout( uint8_t, uint16_t, uint16_t, const uint8_t *, uint32_t ) {}
+            void ReadSerialPort( uint16_t, uint8_t *, uint16_t ) {}
+
+            static const std::chrono::microseconds LATENCY;
+            static const double BYTES_PER_SEC;
+
+        private:
+            struct Read
+            {
+                uint16_t * Data;
+                uint32_t Offset;
+                uint32_t Size;
+                uint32_t Tag;
+                Clock::time_point Done;
+            };
+
+            std::deque<Read> m_Reads;
+            uint32_t m_Offset;
+            const uint32_t m_ShortAt;
+            const uint32_t m_FailAt;
+            int m_Cancels;
+    };
+
+    const std::chrono::microseconds MockUsb::LATENCY( 1000 );
+    const double MockUsb::BYTES_PER_SEC = 40e6;
+
+    // the Alta usb chunk size and a 4 megapixel image
+    const uint32_t CHUNK = 0x1F000;
+    const uint32_t IMAGE_BYTES = 2048 * 2048 * 2;
+    const uint32_t NONE = 0xFFFFFFFF;
+
+    bool Check( bool ok, const char * what )
+    {
+        printf( "  %-52s %s\n", what, ok ? "ok" : "FAILED" );
+        return ok;
+    }
+
+    bool Intact( const std::vector<uint16_t> & data, uint32_t bytes )
+    {
+        for( uint32_t i = 0; i < bytes / 2; ++i )
+        {
+            if( data[i] != static_cast<uint16_t>( i ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    std::vector<uint16_t> image( IMAGE_BYTES / 2 );
+    bool ok = true;
+
+    printf( "%u byte image in %u byte reads, %.0f MB/s bus, %ld us latency per read\n",
+        IMAGE_BYTES, CHUNK, MockUsb::BYTES_PER_SEC / 1e6, 
+        static_cast<long>( MockUsb::LATENCY.count() ) );
+
+    for( uint32_t depth = 1; depth <= 8; depth *= 2 )
+    {
+        MockUsb usb( NONE, NONE );
+        UsbReadout readout( usb, CHUNK, depth );
+        std::fill( image.begin(), image.end(), 0 );
+        const uint32_t received = readout.Read( &image[0], IMAGE_BYTES );
+        printf( "  %u in flight: %7.2f MB/s\n", depth, readout.GetMBPerSec() );
+        ok = Check( received == IMAGE_BYTES && Intact( image, IMAGE_BYTES ) && 0 == usb.Pending(), 
+            "  image complete" ) && ok;
+    }
+
+    {
+        // a short read ends the readout, the data before it is kept
+        const uint32_t shortAt = 5 * CHUNK + 1000;
+        MockUsb usb( shortAt, NONE );
+        UsbReadout readout( usb, CHUNK, 4 );
+        std::fill( image.begin(), image.end(), 0 );
+        const uint32_t received = readout.Read( &image[0], IMAGE_BYTES );
+        ok = Check( received == shortAt && Intact( image, shortAt ), 
+            "short read keeps the data before it" ) && ok;
+        ok = Check( 0 == usb.Pending() && 1 == usb.Cancels(), 
+            "short read cancels the reads in flight" ) && ok;
+    }
+
+    {
+        // a failed read throws after the reads in flight are cancelled
+        MockUsb usb( NONE, 7 * CHUNK );
+        UsbReadout readout( usb, CHUNK, 4 );
+        bool thrown = false;
+        try
+        {
+            readout.Read( &image[0], IMAGE_BYTES );
+        }
+        catch( std::runtime_error & )
+        {
+            thrown = true;
+        }
+        ok = Check( thrown && 0 == usb.Pending() && 1 == usb.Cancels(), 
+            "failed read throws and cancels the reads in flight" ) && ok;
+    }
+
+    {
+        // an image that is not a multiple of the chunk size
+        const uint32_t bytes = 3 * CHUNK + 4096;
+        MockUsb usb( NONE, NONE );
+        UsbReadout readout( usb, CHUNK, 4 );
+        std::fill( image.begin(), image.end(), 0 );
+        const uint32_t received = readout.Read( &image[0], bytes );
+        ok = Check( received == bytes && Intact( image, bytes ) && 0 == usb.Cancels(), 
+            "partial last chunk" ) && ok;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -108,6 +108,15 @@ GenOneLinuxUSB::~GenOneLinuxUSB()
 
     }
 
+    // get any reads off the bus before the device goes away
+    CancelImageReads();
+
+    for( std::vector<libusb_transfer *>::iterator iter = m_FreeXfers.begin();
+         iter != m_FreeXfers.end(); ++iter )
+    {
+        libusb_free_transfer( *iter );
+    }
+
     result = libusb_release_interface( m_Device, INTERFACE_NUM );
 
     if( 0 != result )
@@ -377,6 +386,15 @@ void GenOneLinuxUSB::ReadImage(uint16_t * ImageData,
                                reinterpret_cast<int32_t*>(&OutSizeInBytes), // number of bytes transfered
                                BULK_XFER_TIMEOUT );		// time out
 
+    CheckImageRead( result, InSizeInBytes, OutSizeInBytes );
+}
+
+////////////////////////////
+// CHECK    IMAGE     READ
+void GenOneLinuxUSB::CheckImageRead(const int32_t result,
+                                    const uint32_t InSizeInBytes,
+                                    const uint32_t OutSizeInBytes)
+{
     if( result < 0 )
     {
         std::stringstream err;
@@ -441,6 +459,170 @@ void GenOneLinuxUSB::ReadImage(uint16_t * ImageData,
 }
 
 
+////////////////////////////
+// IMAGE     READ      DONE
+void LIBUSB_CALL GenOneLinuxUSB::ImageReadDone(libusb_transfer * xfer)
+{
+    static_cast<ImageRead *>( xfer->user_data )->Done = 1;
+}
+
+////////////////////////////
+// SUBMIT    IMAGE     READ
+void GenOneLinuxUSB::SubmitImageRead(uint16_t * ImageData,
+                                     const uint32_t InSizeInBytes,
+                                     const uint32_t Tag)
+{
+    libusb_transfer * xfer = NULL;
+    if( m_FreeXfers.empty() )
+    {
+        xfer = libusb_alloc_transfer( 0 );
+        if( !xfer )
+        {
+            apgHelper::throwRuntimeException( m_fileName, 
+                "libusb_alloc_transfer failed", 
+                __LINE__, Apg::ErrorType_Critical );
+        }
+    }
+    else
+    {
+        xfer = m_FreeXfers.back();
+        m_FreeXfers.pop_back();
+    }
+
+    ImageRead read = { xfer, Tag, 0 };
+    m_ImageReads.push_back( read );
+
+    libusb_fill_bulk_transfer( xfer,
+                               m_Device,
+                               UsbFrmwr::END_POINT,
+                               reinterpret_cast<uint8_t*>(ImageData),
+                               InSizeInBytes,
+                               ImageReadDone,
+                               &m_ImageReads.back(),
+                               BULK_XFER_TIMEOUT );
+
+    const int32_t result = libusb_submit_transfer( xfer );
+
+    if( result < 0 )
+    {
+        m_ImageReads.pop_back();
+        m_FreeXfers.push_back( xfer );
+
+        std::stringstream err;
+        err << "libusb_submit_transfer failed with error " << result << ".";
+        m_ReadImgError = true;
+        apgHelper::throwRuntimeException( m_fileName, err.str(),
+                                          __LINE__, Apg::ErrorType_Critical );
+    }
+}
+
+////////////////////////////
+// REAP    IMAGE     READ
+void GenOneLinuxUSB::ReapImageRead(uint32_t & Tag, uint32_t & OutSizeInBytes)
+{
+    if( m_ImageReads.empty() )
+    {
+        apgHelper::throwRuntimeException( m_fileName, 
+            "ReapImageRead called without a submitted read", 
+            __LINE__, Apg::ErrorType_InvalidUsage );
+    }
+
+    ImageRead & read = m_ImageReads.front();
+
+    while( !read.Done )
+    {
+        const int32_t result = libusb_handle_events_completed( m_Context, &read.Done );
+
+        if( result < 0 && LIBUSB_ERROR_INTERRUPTED != result )
+        {
+            std::stringstream err;
+            err << "libusb_handle_events_completed failed with error " << result << ".";
+            m_ReadImgError = true;
+            apgHelper::throwRuntimeException( m_fileName, err.str(),
+                                              __LINE__, Apg::ErrorType_Critical );
+        }
+    }
+
+    libusb_transfer * xfer = read.Xfer;
+    Tag = read.Tag;
+    OutSizeInBytes = xfer->actual_length;
+
+    m_ImageReads.pop_front();
+    m_FreeXfers.push_back( xfer );
+
+    // report a failed transfer with the error libusb_bulk_transfer
+    // would have returned for it
+    int32_t result = 0;
+    switch( xfer->status )
+    {
+        case LIBUSB_TRANSFER_COMPLETED:
+            result = 0;
+        break;
+
+        case LIBUSB_TRANSFER_TIMED_OUT:
+            result = LIBUSB_ERROR_TIMEOUT;
+        break;
+
+        case LIBUSB_TRANSFER_STALL:
+            result = LIBUSB_ERROR_PIPE;
+        break;
+
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            result = LIBUSB_ERROR_NO_DEVICE;
+        break;
+
+        case LIBUSB_TRANSFER_OVERFLOW:
+            result = LIBUSB_ERROR_OVERFLOW;
+        break;
+
+        default:
+            result = LIBUSB_ERROR_IO;
+        break;
+    }
+
+    CheckImageRead( result, xfer->length, OutSizeInBytes );
+}
+
+////////////////////////////
+// CANCEL    IMAGE     READS
+void GenOneLinuxUSB::CancelImageReads()
+{
+    for( std::deque<ImageRead>::iterator iter = m_ImageReads.begin();
+         iter != m_ImageReads.end(); ++iter )
+    {
+        if( !(*iter).Done )
+        {
+            libusb_cancel_transfer( (*iter).Xfer );
+        }
+    }
+
+    while( !m_ImageReads.empty() )
+    {
+        ImageRead & read = m_ImageReads.front();
+
+        while( !read.Done )
+        {
+            const int32_t result = libusb_handle_events_completed( m_Context, &read.Done );
+
+            if( result < 0 && LIBUSB_ERROR_INTERRUPTED != result )
+            {
+                // the transfers may still complete, leave them queued
+                // rather than hand them out again
+                std::stringstream err;
+                err << "libusb_handle_events_completed failed with error " << result;
+                err << " while cancelling image reads.";
+                apgHelper::LogErrorMsg( m_fileName, err.str(), __LINE__ );
+                m_ReadImgError = true;
+                return;
+            }
+        }
+
+        m_FreeXfers.push_back( read.Xfer );
+        m_ImageReads.pop_front();
+    }
+}
+
+
 ////////////////////////////
 // GET  STATUS
 void GenOneLinuxUSB::GetStatus(uint8_t * status, uint32_t NumBytes)
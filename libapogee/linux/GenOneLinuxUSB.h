@@ -15,6 +15,7 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 
 #ifdef OSX_EMBEDED_MODE
 	#include <libusb.h>
@@ -50,6 +51,13 @@ class GenOneLinuxUSB : public IUsb
 					   const uint32_t InSizeInBytes,
 					   uint32_t &OutSizeInBytes);
 
+		void SubmitImageRead(uint16_t * ImageData,
+					   const uint32_t InSizeInBytes, const uint32_t Tag);
+
+		void ReapImageRead(uint32_t & Tag, uint32_t & OutSizeInBytes);
+
+		void CancelImageReads();
+
 		void GetStatus(uint8_t * status, uint32_t NumBytes);
 
 		void UsbRequestIn(uint8_t RequestCode,
@@ -79,6 +87,21 @@ class GenOneLinuxUSB : public IUsb
 
     private:
 		 bool OpenDeviceHandle(const uint16_t DeviceNum, std::string & err);
+		 void CheckImageRead(int32_t result, uint32_t InSizeInBytes,
+			 uint32_t OutSizeInBytes);
+		 static void LIBUSB_CALL ImageReadDone(libusb_transfer * xfer);
+
+		 struct ImageRead
+		 {
+			 libusb_transfer * Xfer;
+			 uint32_t Tag;
+			 int Done;
+		 };
+		 // submitted reads, oldest first.  deque keeps the
+		 // address of a read, which the transfer points to.
+		 std::deque<ImageRead> m_ImageReads;
+		 std::vector<libusb_transfer *> m_FreeXfers;
+
 		 libusb_context * m_Context;
 		 libusb_device_handle  * m_Device;
 		 libusb_device_descriptor m_DeviceDescriptor;
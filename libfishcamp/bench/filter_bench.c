@@ -0,0 +1,330 @@
+/*
+
+  Copyright (c) 2001-2013 Fishcamp Engineering (support@fishcamp.com)
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+// Times the 3x3, 5x5 and hot pixel filters on synthetic frames against the per pixel versions they
+// replaced, on one thread and on bands of rows, and checks the results are identical.
+
+#include "fcfilter.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef void (*filterFunc)(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer);
+
+// the per pixel filters as they were before fcfilter.c
+static void ref_do_3x3_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+	int				row, col;
+	UInt16			*inputPtr;
+	UInt16			*outputPtr;
+	UInt32			accumPixel;
+	UInt16			*tempBuffer;
+	size_t			size;
+	int				x, y;
+
+	size = imageWidth * imageHeight * 2;		// 2 bytes/pixel
+	tempBuffer = (UInt16 *) malloc(size);
+
+	if (tempBuffer != NULL)
+		{
+		memcpy( tempBuffer, frameBuffer, size );
+
+		for (row = 1; row < (imageHeight - 1); row++)
+			{
+			for (col = 1; col < (imageWidth - 1); col++)
+				{
+				inputPtr = tempBuffer + ((row - 1) * imageWidth) + col - 1;
+				outputPtr = frameBuffer + (row * imageWidth) + col;
+
+				accumPixel = 0;
+				for (y = 0; y < 3; y++)
+					for (x = 0; x < 3; x++)
+						accumPixel = accumPixel + (UInt32)inputPtr[y * imageWidth + x];
+
+				*outputPtr = (UInt16)(accumPixel / 9);
+				}
+			}
+
+		free (tempBuffer);
+		}
+}
+
+static void ref_do_5x5_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+	int				row, col;
+	UInt16			*inputPtr;
+	UInt16			*outputPtr;
+	UInt32			accumPixel;
+	UInt16			*tempBuffer;
+	size_t			size;
+	int				x, y;
+
+	size = imageWidth * imageHeight * 2;		// 2 bytes/pixel
+	tempBuffer = (UInt16 *) malloc(size);
+
+	if (tempBuffer != NULL)
+		{
+		memcpy( tempBuffer, frameBuffer, size );
+
+		for (row = 2; row < (imageHeight - 2); row++)
+			{
+			for (col = 2; col < (imageWidth - 2); col++)
+				{
+				inputPtr = tempBuffer + ((row - 2) * imageWidth) + col - 2;
+				outputPtr = frameBuffer + (row * imageWidth) + col;
+
+				accumPixel = 0;
+				for (y = 0; y < 5; y++)
+					for (x = 0; x < 5; x++)
+						accumPixel = accumPixel + (UInt32)inputPtr[y * imageWidth + x];
+
+				*outputPtr = (UInt16)(accumPixel / 25);
+				}
+			}
+
+		free (tempBuffer);
+		}
+}
+
+static void ref_do_hotPixel_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+	float			floatBrightPixel;
+	float			floatCenterPixel;
+	int				row, col;
+	UInt16			*inputPtr;
+	UInt16			*outputPtr;
+	UInt16			aPixel;
+	UInt32			accumPixel;
+	UInt16			*tempBuffer;
+	size_t			size;
+	UInt16			brightestNeighbor;
+	UInt16			thisPixel;
+	int				x, y;
+
+	size = imageWidth * imageHeight * 2;		// 2 bytes/pixel
+	tempBuffer = (UInt16 *) malloc(size);
+
+	if (tempBuffer != NULL)
+		{
+		memcpy( tempBuffer, frameBuffer, size );
+
+		for (row = 1; row < (imageHeight - 1); row++)
+			{
+			for (col = 1; col < (imageWidth - 1); col++)
+				{
+				inputPtr = tempBuffer + ((row - 1) * imageWidth) + col - 1;
+				outputPtr = frameBuffer + (row * imageWidth) + col;
+
+				accumPixel        = 0;
+				brightestNeighbor = 0;
+				thisPixel         = inputPtr[imageWidth + 1];
+				for (y = 0; y < 3; y++)
+					for (x = 0; x < 3; x++)
+						{
+						if (x == 1 && y == 1)
+							continue;
+						aPixel = inputPtr[y * imageWidth + x];
+						accumPixel = accumPixel + (UInt32)aPixel;
+						if (brightestNeighbor < aPixel)
+							brightestNeighbor = aPixel;
+						}
+
+				accumPixel = accumPixel / 8;
+
+				floatBrightPixel = (float)brightestNeighbor;
+				floatBrightPixel = floatBrightPixel * 1.2;
+
+				floatCenterPixel = (float)thisPixel;
+
+				if (floatCenterPixel > floatBrightPixel)
+					*outputPtr = (UInt16)accumPixel;
+				}
+			}
+
+		free (tempBuffer);
+		}
+}
+
+static double now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// sky background with noise, a few stars and hot pixels.  Full scale noise when fullScale is set.
+static void makeFrame(UInt16 *frame, int width, int height, bool fullScale)
+{
+	int		i, n = width * height;
+
+	for (i = 0; i < n; i++)
+		frame[i] = fullScale ? (UInt16)(rand() & 0xFFFF) : (UInt16)(1000 + rand() % 200);
+
+	if (fullScale)
+		return;
+
+	for (i = 0; i < n / 2000; i++)
+		frame[rand() % n] = (UInt16)(20000 + rand() % 45536);
+	for (i = 0; i < n / 500; i++)
+		frame[rand() % n] = 65535;
+}
+
+// median of the times of a few runs, in ms
+static double timeFilter(filterFunc filter, const UInt16 *frame, UInt16 *work, int width, int height, int runs,
+						 UInt16 *result)
+{
+	double	times[16];
+	double	t;
+	int		i, j;
+
+	for (i = 0; i < runs; i++)
+		{
+		memcpy(work, frame, (size_t)width * height * 2);
+		times[i] = now();
+		filter((UInt16)height, (UInt16)width, work);
+		times[i] = (now() - times[i]) * 1000;
+		}
+	memcpy(result, work, (size_t)width * height * 2);
+
+	for (i = 1; i < runs; i++)
+		for (j = i; j > 0 && times[j - 1] > times[j]; j--)
+			{
+			t = times[j];
+			times[j] = times[j - 1];
+			times[j - 1] = t;
+			}
+	return times[runs / 2];
+}
+
+// the integer hot pixel test against the float one for every brightest neighbor around the threshold
+static bool checkThreshold(void)
+{
+	int		bright, center;
+	float	floatBrightPixel;
+
+	for (bright = 0; bright < 65536; bright++)
+		for (center = 6 * bright / 5 - 2; center <= 6 * bright / 5 + 2; center++)
+			{
+			if (center < 0 || center > 65535)
+				continue;
+			floatBrightPixel = (float)bright;
+			floatBrightPixel = floatBrightPixel * 1.2;
+			if (((float)center > floatBrightPixel) != (5 * center > 6 * bright))
+				{
+				printf("hot pixel threshold differs for center %d brightest %d\n", center, bright);
+				return false;
+				}
+			}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct {
+		int			width, height;
+		bool		fullScale;
+		} sizes[] = {
+		{ 1280, 1024, false },		// Starfish
+		{ 2048, 2048, false },
+		{ 2048, 2048, true },
+		{ 1001, 77, true },
+		{ 13, 9, true },
+		{ 5, 5, true },
+		{ 3, 3, true },
+		{ 2, 40, true },
+		};
+	static const struct {
+		const char	*name;
+		filterFunc	reference;
+		filterFunc	filter;
+		} filters[] = {
+		{ "3x3", ref_do_3x3_kernel, fcImage_do_3x3_kernel },
+		{ "5x5", ref_do_5x5_kernel, fcImage_do_5x5_kernel },
+		{ "hot pixel", ref_do_hotPixel_kernel, fcImage_do_hotPixel_kernel },
+		};
+	int		runs = (argc > 1) ? atoi(argv[1]) : 5;
+	bool	ok   = checkThreshold();
+	size_t	s, f;
+
+	if (runs < 1)
+		runs = 1;
+	if (runs > 16)
+		runs = 16;
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+		{
+		int		width  = sizes[s].width;
+		int		height = sizes[s].height;
+		size_t	n      = (size_t)width * height;
+		UInt16	*frame     = malloc(n * 2);
+		UInt16	*work      = malloc(n * 2);
+		UInt16	*reference = malloc(n * 2);
+		UInt16	*result    = malloc(n * 2);
+
+		makeFrame(frame, width, height, sizes[s].fullScale);
+
+		for (f = 0; f < sizeof(filters) / sizeof(filters[0]); f++)
+			{
+			double	refMs, oneMs, bandMs;
+			bool	same;
+
+			refMs = timeFilter(filters[f].reference, frame, work, width, height, runs, reference);
+
+			fcImage_setFilterThreads(1);
+			oneMs = timeFilter(filters[f].filter, frame, work, width, height, runs, result);
+			same = memcmp(result, reference, n * 2) == 0;
+
+			fcImage_setFilterThreads(0);
+			bandMs = timeFilter(filters[f].filter, frame, work, width, height, runs, result);
+			same = same && memcmp(result, reference, n * 2) == 0;
+
+			printf("%5dx%-5d %-10s %-10s before %8.3f ms  1 thread %8.3f ms (%5.1fx)  bands %8.3f ms (%5.1fx)%s\n",
+				   width, height, sizes[s].fullScale ? "full scale" : "sky", filters[f].name, refMs, oneMs,
+				   refMs / oneMs, bandMs, refMs / bandMs, same ? "" : "  MISMATCH");
+			ok = ok && same;
+			}
+
+		free(frame);
+		free(work);
+		free(reference);
+		free(result);
+		}
+
+	fcImage_freeFilterScratch();
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,499 @@
+/*
+
+  Copyright (c) 2001-2013 Fishcamp Engineering (support@fishcamp.com)
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+#include "fcfilter.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#define kFilterMaxThreads		4
+#define kFilterMinThreadPixels	(1024 * 1024)		// smaller frames are filtered on the calling thread
+
+typedef enum {
+
+	kFilterBox3x3,
+	kFilterBox5x5,
+	kFilterHotPixel
+
+	} fcFilterType;
+
+// the rows [firstRow, lastRow) of the output filtered by one thread
+typedef struct {
+
+	fcFilterType	type;
+	const UInt16	*input;				// copy of the unfiltered frame
+	UInt16			*output;
+	int				width;
+	int				firstRow;
+	int				lastRow;
+	uint32_t		*colSum;			// vertical sums of the rows under the kernel, one per column
+
+	} fcFilterBand;
+
+// the filters run 'in place' and need a copy of the frame to read from.  It is kept between frames
+// with the column sums of each band behind it.
+static pthread_mutex_t	gFilterMutex = PTHREAD_MUTEX_INITIALIZER;
+static void				*gFilterScratch;
+static size_t			gFilterScratchSize;
+static int				gFilterThreads;
+
+
+static inline UInt16 fcFilter_divide(uint32_t sum, int radius)
+{
+	if (radius == 1)
+		return (UInt16)(sum / 9);
+	return (UInt16)(sum / 25);
+}
+
+// the SIMD versions divide by 9 and 25 with the multiply and shift the compiler uses for the scalar
+// division, exact for any 32 bit sum
+
+#if defined(__SSE2__)
+
+static inline __m128i fcFilter_divideSSE2(__m128i sum, __m128i magic, __m128i shift)
+{
+	__m128i even = _mm_srl_epi64(_mm_mul_epu32(sum, magic), shift);
+	__m128i odd  = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(sum, 32), magic), shift);
+
+	return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+// pack 32 bit lanes holding 16 bit values, SSE2 only has the signed saturating pack
+static inline __m128i fcFilter_packSSE2(__m128i lo, __m128i hi)
+{
+	const __m128i bias = _mm_set1_epi32(0x8000);
+
+	return _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias)),
+						 _mm_set1_epi16((short)0x8000));
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+static inline uint32x4_t fcFilter_divideNEON(uint32x4_t sum, uint32_t magic, int64x2_t shift)
+{
+	uint64x2_t lo = vshlq_u64(vmull_n_u32(vget_low_u32(sum), magic), shift);
+	uint64x2_t hi = vshlq_u64(vmull_n_u32(vget_high_u32(sum), magic), shift);
+
+	return vcombine_u32(vmovn_u64(lo), vmovn_u64(hi));
+}
+
+#endif
+
+// vertical sums of the rows [row - radius, row + radius] for every column
+static void fcFilter_sumRows(const UInt16 *input, int width, int row, int radius, uint32_t *colSum)
+{
+	int		col, r;
+
+	memset(colSum, 0, width * sizeof(uint32_t));
+
+	for (r = row - radius; r <= row + radius; r++)
+		{
+		const UInt16	*inputPtr = input + r * width;
+
+		for (col = 0; col < width; col++)
+			colSum[col] += inputPtr[col];
+		}
+}
+
+// move the vertical sums down one row
+static void fcFilter_slideRows(const UInt16 *leaving, const UInt16 *entering, int width, uint32_t *colSum)
+{
+	int		col = 0;
+
+#if defined(__SSE2__)
+	const __m128i	zero = _mm_setzero_si128();
+
+	for (; col + 8 <= width; col += 8)
+		{
+		__m128i	in  = _mm_loadu_si128((const __m128i *)(entering + col));
+		__m128i	out = _mm_loadu_si128((const __m128i *)(leaving + col));
+		__m128i	lo  = _mm_loadu_si128((const __m128i *)(colSum + col));
+		__m128i	hi  = _mm_loadu_si128((const __m128i *)(colSum + col + 4));
+
+		lo = _mm_sub_epi32(_mm_add_epi32(lo, _mm_unpacklo_epi16(in, zero)), _mm_unpacklo_epi16(out, zero));
+		hi = _mm_sub_epi32(_mm_add_epi32(hi, _mm_unpackhi_epi16(in, zero)), _mm_unpackhi_epi16(out, zero));
+		_mm_storeu_si128((__m128i *)(colSum + col), lo);
+		_mm_storeu_si128((__m128i *)(colSum + col + 4), hi);
+		}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; col + 8 <= width; col += 8)
+		{
+		uint16x8_t	in  = vld1q_u16(entering + col);
+		uint16x8_t	out = vld1q_u16(leaving + col);
+		uint32x4_t	lo  = vld1q_u32(colSum + col);
+		uint32x4_t	hi  = vld1q_u32(colSum + col + 4);
+
+		lo = vsubw_u16(vaddw_u16(lo, vget_low_u16(in)), vget_low_u16(out));
+		hi = vsubw_u16(vaddw_u16(hi, vget_high_u16(in)), vget_high_u16(out));
+		vst1q_u32(colSum + col, lo);
+		vst1q_u32(colSum + col + 4, hi);
+		}
+#endif
+
+	for (; col < width; col++)
+		colSum[col] = colSum[col] + entering[col] - leaving[col];
+}
+
+// horizontal pass of the box filter, the average of (2 * radius + 1)^2 pixels for the columns [radius, width - radius)
+static void fcFilter_boxRow(const uint32_t *colSum, UInt16 *outputPtr, int width, int radius)
+{
+	int			col = radius;
+	int			k;
+	uint32_t	accum;
+
+#if defined(__SSE2__)
+	const __m128i	magic = _mm_set1_epi32(radius == 1 ? 0x38E38E39 : 0x51EB851F);
+	const __m128i	shift = _mm_cvtsi32_si128(radius == 1 ? 33 : 35);
+
+	for (; col + 8 <= width - radius; col += 8)
+		{
+		__m128i	lo = _mm_setzero_si128();
+		__m128i	hi = _mm_setzero_si128();
+
+		for (k = -radius; k <= radius; k++)
+			{
+			lo = _mm_add_epi32(lo, _mm_loadu_si128((const __m128i *)(colSum + col + k)));
+			hi = _mm_add_epi32(hi, _mm_loadu_si128((const __m128i *)(colSum + col + k + 4)));
+			}
+		lo = fcFilter_divideSSE2(lo, magic, shift);
+		hi = fcFilter_divideSSE2(hi, magic, shift);
+		_mm_storeu_si128((__m128i *)(outputPtr + col), fcFilter_packSSE2(lo, hi));
+		}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	const uint32_t	magic = radius == 1 ? 0x38E38E39 : 0x51EB851F;
+	const int64x2_t	shift = vdupq_n_s64(radius == 1 ? -33 : -35);
+
+	for (; col + 8 <= width - radius; col += 8)
+		{
+		uint32x4_t	lo = vdupq_n_u32(0);
+		uint32x4_t	hi = vdupq_n_u32(0);
+
+		for (k = -radius; k <= radius; k++)
+			{
+			lo = vaddq_u32(lo, vld1q_u32(colSum + col + k));
+			hi = vaddq_u32(hi, vld1q_u32(colSum + col + k + 4));
+			}
+		lo = fcFilter_divideNEON(lo, magic, shift);
+		hi = fcFilter_divideNEON(hi, magic, shift);
+		vst1q_u16(outputPtr + col, vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+		}
+#endif
+
+	if (col >= width - radius)
+		return;
+
+	// running sum over the remaining columns
+	accum = 0;
+	for (k = -radius; k <= radius; k++)
+		accum += colSum[col + k];
+
+	for (;;)
+		{
+		outputPtr[col] = fcFilter_divide(accum, radius);
+		if (++col >= width - radius)
+			break;
+		accum = accum + colSum[col + radius] - colSum[col - radius - 1];
+		}
+}
+
+// hot pixel test and replacement for the columns [1, width - 1) of one row.
+//
+// (float)center > (float)brightest * 1.2 as the filter was first written is, for 16 bit pixels,
+// exactly 5 * center > 6 * brightest.
+//
+static void fcFilter_hotPixelRow(const UInt16 *above, const UInt16 *inputPtr, const UInt16 *below,
+								 const uint32_t *colSum, UInt16 *outputPtr, int width)
+{
+	int			col = 1;
+	UInt16		brightestNeighbor;
+	UInt16		thisPixel;
+	uint32_t	accumPixel;
+
+#if defined(__SSE2__)
+	// the signed max of biased pixels is the unsigned max
+	const __m128i	sign = _mm_set1_epi16((short)0x8000);
+	const __m128i	zero = _mm_setzero_si128();
+
+	for (; col + 8 <= width - 1; col += 8)
+		{
+		__m128i	center = _mm_loadu_si128((const __m128i *)(inputPtr + col));
+		__m128i	bright = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(above + col - 1)), sign);
+
+		bright = _mm_max_epi16(bright, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(above + col)), sign));
+		bright = _mm_max_epi16(bright, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(above + col + 1)), sign));
+		bright = _mm_max_epi16(bright, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(inputPtr + col - 1)), sign));
+		bright = _mm_max_epi16(bright, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(inputPtr + col + 1)), sign));
+		bright = _mm_max_epi16(bright, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(below + col - 1)), sign));
+		bright = _mm_max_epi16(bright, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(below + col)), sign));
+		bright = _mm_max_epi16(bright, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(below + col + 1)), sign));
+		bright = _mm_xor_si128(bright, sign);
+
+		__m128i	centerLo = _mm_unpacklo_epi16(center, zero);
+		__m128i	centerHi = _mm_unpackhi_epi16(center, zero);
+		__m128i	brightLo = _mm_unpacklo_epi16(bright, zero);
+		__m128i	brightHi = _mm_unpackhi_epi16(bright, zero);
+		__m128i	hotLo    = _mm_cmpgt_epi32(_mm_add_epi32(_mm_slli_epi32(centerLo, 2), centerLo),
+										   _mm_add_epi32(_mm_slli_epi32(brightLo, 2), _mm_slli_epi32(brightLo, 1)));
+		__m128i	hotHi    = _mm_cmpgt_epi32(_mm_add_epi32(_mm_slli_epi32(centerHi, 2), centerHi),
+										   _mm_add_epi32(_mm_slli_epi32(brightHi, 2), _mm_slli_epi32(brightHi, 1)));
+		__m128i	hot      = _mm_packs_epi32(hotLo, hotHi);
+
+		// average of the 8 neighbors
+		__m128i	sumLo = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(colSum + col - 1)),
+									  _mm_loadu_si128((const __m128i *)(colSum + col)));
+		__m128i	sumHi = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(colSum + col + 3)),
+									  _mm_loadu_si128((const __m128i *)(colSum + col + 4)));
+		sumLo = _mm_sub_epi32(_mm_add_epi32(sumLo, _mm_loadu_si128((const __m128i *)(colSum + col + 1))), centerLo);
+		sumHi = _mm_sub_epi32(_mm_add_epi32(sumHi, _mm_loadu_si128((const __m128i *)(colSum + col + 5))), centerHi);
+		__m128i	average = fcFilter_packSSE2(_mm_srli_epi32(sumLo, 3), _mm_srli_epi32(sumHi, 3));
+
+		_mm_storeu_si128((__m128i *)(outputPtr + col),
+						 _mm_or_si128(_mm_and_si128(hot, average), _mm_andnot_si128(hot, center)));
+		}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; col + 8 <= width - 1; col += 8)
+		{
+		uint16x8_t	center = vld1q_u16(inputPtr + col);
+		uint16x8_t	bright = vld1q_u16(above + col - 1);
+
+		bright = vmaxq_u16(bright, vld1q_u16(above + col));
+		bright = vmaxq_u16(bright, vld1q_u16(above + col + 1));
+		bright = vmaxq_u16(bright, vld1q_u16(inputPtr + col - 1));
+		bright = vmaxq_u16(bright, vld1q_u16(inputPtr + col + 1));
+		bright = vmaxq_u16(bright, vld1q_u16(below + col - 1));
+		bright = vmaxq_u16(bright, vld1q_u16(below + col));
+		bright = vmaxq_u16(bright, vld1q_u16(below + col + 1));
+
+		uint32x4_t	hotLo = vcgtq_u32(vmull_n_u16(vget_low_u16(center), 5), vmull_n_u16(vget_low_u16(bright), 6));
+		uint32x4_t	hotHi = vcgtq_u32(vmull_n_u16(vget_high_u16(center), 5), vmull_n_u16(vget_high_u16(bright), 6));
+		uint16x8_t	hot   = vcombine_u16(vmovn_u32(hotLo), vmovn_u32(hotHi));
+
+		// average of the 8 neighbors
+		uint32x4_t	sumLo = vaddq_u32(vaddq_u32(vld1q_u32(colSum + col - 1), vld1q_u32(colSum + col)),
+									  vld1q_u32(colSum + col + 1));
+		uint32x4_t	sumHi = vaddq_u32(vaddq_u32(vld1q_u32(colSum + col + 3), vld1q_u32(colSum + col + 4)),
+									  vld1q_u32(colSum + col + 5));
+		sumLo = vsubw_u16(sumLo, vget_low_u16(center));
+		sumHi = vsubw_u16(sumHi, vget_high_u16(center));
+		uint16x8_t	average = vcombine_u16(vshrn_n_u32(sumLo, 3), vshrn_n_u32(sumHi, 3));
+
+		vst1q_u16(outputPtr + col, vbslq_u16(hot, average, center));
+		}
+#endif
+
+	for (; col < width - 1; col++)
+		{
+		thisPixel         = inputPtr[col];
+		brightestNeighbor = above[col - 1];
+		if (brightestNeighbor < above[col])
+			brightestNeighbor = above[col];
+		if (brightestNeighbor < above[col + 1])
+			brightestNeighbor = above[col + 1];
+		if (brightestNeighbor < inputPtr[col - 1])
+			brightestNeighbor = inputPtr[col - 1];
+		if (brightestNeighbor < inputPtr[col + 1])
+			brightestNeighbor = inputPtr[col + 1];
+		if (brightestNeighbor < below[col - 1])
+			brightestNeighbor = below[col - 1];
+		if (brightestNeighbor < below[col])
+			brightestNeighbor = below[col];
+		if (brightestNeighbor < below[col + 1])
+			brightestNeighbor = below[col + 1];
+
+		if (5 * (uint32_t)thisPixel > 6 * (uint32_t)brightestNeighbor)
+			{
+			// substitute average
+			accumPixel = colSum[col - 1] + colSum[col] + colSum[col + 1] - thisPixel;
+			outputPtr[col] = (UInt16)(accumPixel / 8);
+			}
+		}
+}
+
+static void fcFilter_runBand(const fcFilterBand *band)
+{
+	int		radius = (band->type == kFilterBox5x5) ? 2 : 1;
+	int		width  = band->width;
+	int		row;
+
+	for (row = band->firstRow; row < band->lastRow; row++)
+		{
+		if (row == band->firstRow)
+			fcFilter_sumRows(band->input, width, row, radius, band->colSum);
+		else
+			fcFilter_slideRows(band->input + (row - radius - 1) * width, band->input + (row + radius) * width,
+							   width, band->colSum);
+
+		if (band->type == kFilterHotPixel)
+			fcFilter_hotPixelRow(band->input + (row - 1) * width, band->input + row * width,
+								 band->input + (row + 1) * width, band->colSum, band->output + row * width, width);
+		else
+			fcFilter_boxRow(band->colSum, band->output + row * width, width, radius);
+		}
+}
+
+static void *fcFilter_bandThread(void *arg)
+{
+	fcFilter_runBand((const fcFilterBand *)arg);
+	return NULL;
+}
+
+static bool fcFilter_reserveScratch(size_t size)
+{
+	void	*scratch;
+
+	if (size <= gFilterScratchSize)
+		return true;
+
+	scratch = malloc(size);
+	if (scratch == NULL)
+		return false;
+
+	free(gFilterScratch);
+	gFilterScratch     = scratch;
+	gFilterScratchSize = size;
+	return true;
+}
+
+static void fcFilter_run(fcFilterType type, UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+	fcFilterBand	bands[kFilterMaxThreads];
+	pthread_t		threads[kFilterMaxThreads];
+	bool			started[kFilterMaxThreads];
+	int				radius = (type == kFilterBox5x5) ? 2 : 1;
+	int				width  = imageWidth;
+	int				height = imageHeight;
+	int				rows   = height - 2 * radius;
+	int				numThreads;
+	size_t			frameSize, colSumSize;
+	UInt16			*input;
+	int				i;
+
+	if (rows <= 0 || width <= 2 * radius)
+		return;
+
+	pthread_mutex_lock(&gFilterMutex);
+
+	numThreads = gFilterThreads;
+	if (numThreads <= 0)
+		{
+		numThreads = 1;
+		if (width * height >= kFilterMinThreadPixels)
+			numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		}
+	if (numThreads > kFilterMaxThreads)
+		numThreads = kFilterMaxThreads;
+	if (numThreads > rows)
+		numThreads = rows;
+	if (numThreads < 1)
+		numThreads = 1;
+
+	frameSize  = (size_t)width * height * 2;						// 2 bytes/pixel
+	colSumSize = ((size_t)width * sizeof(uint32_t) + 63) & ~(size_t)63;
+
+	if (fcFilter_reserveScratch(frameSize + numThreads * colSumSize))
+		{
+		// the column sums go first so they stay aligned whatever the frame size
+		input = (UInt16 *)((char *)gFilterScratch + numThreads * colSumSize);
+
+		// copy the image buffer to my local storage
+		memcpy(input, frameBuffer, frameSize);
+
+		for (i = 0; i < numThreads; i++)
+			{
+			bands[i].type     = type;
+			bands[i].input    = input;
+			bands[i].output   = frameBuffer;
+			bands[i].width    = width;
+			bands[i].firstRow = radius + (int)((long)rows * i / numThreads);
+			bands[i].lastRow  = radius + (int)((long)rows * (i + 1) / numThreads);
+			bands[i].colSum   = (uint32_t *)((char *)gFilterScratch + i * colSumSize);
+			}
+
+		// the calling thread takes the first band, and any band a thread could not be started for
+		for (i = 1; i < numThreads; i++)
+			started[i] = pthread_create(&threads[i], NULL, fcFilter_bandThread, &bands[i]) == 0;
+
+		fcFilter_runBand(&bands[0]);
+
+		for (i = 1; i < numThreads; i++)
+			{
+			if (started[i])
+				pthread_join(threads[i], NULL);
+			else
+				fcFilter_runBand(&bands[i]);
+			}
+		}
+
+	pthread_mutex_unlock(&gFilterMutex);
+}
+
+void fcImage_do_3x3_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+	fcFilter_run(kFilterBox3x3, imageHeight, imageWidth, frameBuffer);
+}
+
+void fcImage_do_5x5_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+	fcFilter_run(kFilterBox5x5, imageHeight, imageWidth, frameBuffer);
+}
+
+void fcImage_do_hotPixel_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+	fcFilter_run(kFilterHotPixel, imageHeight, imageWidth, frameBuffer);
+}
+
+void fcImage_setFilterThreads(int numThreads)
+{
+	pthread_mutex_lock(&gFilterMutex);
+	gFilterThreads = numThreads;
+	pthread_mutex_unlock(&gFilterMutex);
+}
+
+void fcImage_freeFilterScratch(void)
+{
+	pthread_mutex_lock(&gFilterMutex);
+	free(gFilterScratch);
+	gFilterScratch     = NULL;
+	gFilterScratchSize = 0;
+	pthread_mutex_unlock(&gFilterMutex);
+}
@@ -0,0 +1,71 @@
+/*
+
+  Copyright (c) 2001-2013 Fishcamp Engineering (support@fishcamp.com)
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+// image post processing filters applied by fcUsb_cmd_getRawFrame.  Not part of the public interface.
+
+#ifndef FCFILTER_H
+#define FCFILTER_H
+
+#include "fishcamp_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the filters work 'in place' and leave the pixels closer to the edge than the kernel radius untouched.
+// large frames are split in bands of rows filtered on several threads.
+
+// routine to perform a 3x3 kernel filter on the image buffer
+void	fcImage_do_3x3_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer);
+
+// routine to perform a 5x5 kernel filter on the image buffer
+void	fcImage_do_5x5_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer);
+
+// routine to perform hot pixel removal filter on the image buffer
+//
+// a pixel more than 20% brighter than the brightest of its 8 neighbors
+// is replaced with the average of the neighboring pixels.
+//
+void	fcImage_do_hotPixel_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer);
+
+// number of threads used by the filters.  0, the default, picks one per core up to 4 for large frames
+void	fcImage_setFilterThreads(int numThreads);
+
+// release the scratch buffer the filters keep between frames
+void	fcImage_freeFilterScratch(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
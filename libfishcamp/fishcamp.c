@@ -34,6 +34,7 @@
 */
 
 #include "fishcamp.h"
+#include "fcfilter.h"
 
 #include <errno.h>
 #include <stdio.h>
@@ -1718,291 +1719,6 @@ void fcImage_PRO_calibrateProCamera(int camNum, UInt16 *frameBufferPtr, int imag
 	gProWantColNormalization = savedWantNorm;
 }
 
-// routine to perform a 3x3 kernel filter on the image buffer
-//
-void fcImage_do_3x3_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
-{
-	float			reference;
-	int				row, col;
-    UInt16			*inputPtr;
-    UInt16			*outputPtr;
-    UInt16			aPixel;
-    UInt32			accumPixel;
-    UInt16			*tempBuffer;
-	size_t			size;
-
-	// this routine will work 'in place'.  We will first allocate a temporary image buffer	
-	// we copy the image to it and then fill the original buffer with the filtered image
-	//
-	size = imageWidth * imageHeight * 2;		// 2 bytes/pixel
-    tempBuffer = (UInt16 *) malloc(size);
-
-	if (tempBuffer != NULL)
-		{
-
-		// copy the image buffer to my local storage
-		memcpy( tempBuffer, frameBuffer, size );
-
-		// Start at row '1'
-		for (row = 1; row < (imageHeight - 1); row++)
-			{		
-			for (col = 1; col < (imageWidth - 1); col++)
-				{
-				inputPtr = tempBuffer;
-				inputPtr = inputPtr + (row * imageWidth) + col;
-				outputPtr = frameBuffer;
-				outputPtr = outputPtr + (row * imageWidth) + col;
-
-				accumPixel = 0;
-				
-				inputPtr = inputPtr - imageWidth - 1;			// 1
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr++;										// 2
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr++;										// 3
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr = inputPtr + imageWidth - 2;			// 4
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr++;										// 5
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr++;										// 6
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr = inputPtr + imageWidth - 2;			// 7
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr++;										// 8
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				inputPtr++;										// 9
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-				// divide by the kernel size
-				accumPixel = accumPixel / 9;
-
-				// put filtered value back
-                *outputPtr = (UInt16)accumPixel;
-		
-				}
-			}
-
-		free (tempBuffer);
-		}
-
-}
-
-// routine to perform a 5x5 kernel filter on the image buffer
-//
-void fcImage_do_5x5_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
-{
-	float			reference;
-	int				row, col;
-    UInt16			*inputPtr;
-    UInt16			*outputPtr;
-    UInt16			aPixel;
-    UInt32			accumPixel;
-    UInt16			*tempBuffer;
-	size_t			size;
-	int				x, y;
-
-
-	// this routine will work 'in place'.  We will first allocate a temporary image buffer	
-	// we copy the image to it and then fill the original buffer with the filtered image
-	//
-	size = imageWidth * imageHeight * 2;		// 2 bytes/pixel
-    tempBuffer = (UInt16 *) malloc(size);
-
-	if (tempBuffer != NULL)
-		{
-
-		// copy the image buffer to my local storage
-		memcpy( tempBuffer, frameBuffer, size );
-
-		// Start at row '2'
-		for (row = 2; row < (imageHeight - 2); row++)
-			{		
-			for (col = 2; col < (imageWidth - 2); col++)
-				{
-				inputPtr = tempBuffer;
-				inputPtr = inputPtr + (row * imageWidth) + col;
-				outputPtr = frameBuffer;
-				outputPtr = outputPtr + (row * imageWidth) + col;
-
-				accumPixel = 0;
-				
-				inputPtr = inputPtr - (3 * imageWidth) + 2;		
-
-				for (y = 0; y < 5; y++)
-					{
-					inputPtr = inputPtr + imageWidth - 4;			
-					aPixel = *inputPtr;
-                    accumPixel = accumPixel + (UInt32)aPixel;
-
-					for (x = 0; x < 4; x++)
-						{
-						inputPtr++;									
-						aPixel = *inputPtr;
-                        accumPixel = accumPixel + (UInt32)aPixel;
-						}
-
-					}
-
-
-				// divide by the kernel size
-				accumPixel = accumPixel / 25;
-
-				// put filtered value back
-                *outputPtr = (UInt16)accumPixel;
-		
-				}
-			}
-
-		free (tempBuffer);
-		}
-
-}
-
-// routine to perform hot pixel removal filter on the image buffer
-//
-// algorithm looks for the center pixel ina 3x3 grid being more than 20%
-// brighter than the brightest of the neigboring pixels.  If it is
-// then it will replace it with the average of the neighboring pixels.
-//
-void fcImage_do_hotPixel_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
-{
-	float			floatBrightPixel;
-	float			floatCenterPixel;
-	int				row, col;
-    UInt16			*inputPtr;
-    UInt16			*outputPtr;
-    UInt16			aPixel;
-    UInt32			accumPixel;
-    UInt16			*tempBuffer;
-	size_t			size;
-    UInt16			brightestNeighbor;
-    UInt16			thisPixel;
-	int				numHotPixels;
-	char			buffer[200];
-
-
-	// this routine will work 'in place'.  We will first allocate a temporary image buffer	
-	// we copy the image to it and then fill the original buffer with the filtered image
-	//
-	size = imageWidth * imageHeight * 2;		// 2 bytes/pixel
-    tempBuffer = (UInt16 *) malloc(size);
-
-	if (tempBuffer != NULL)
-		{
-		numHotPixels = 0;
-
-		// copy the image buffer to my local storage
-		memcpy( tempBuffer, frameBuffer, size );
-
-		// Start at row '1'
-		for (row = 1; row < (imageHeight - 1); row++)
-			{		
-			for (col = 1; col < (imageWidth - 1); col++)
-				{
-				inputPtr = tempBuffer;
-				inputPtr = inputPtr + (row * imageWidth) + col;
-				outputPtr = frameBuffer;
-				outputPtr = outputPtr + (row * imageWidth) + col;
-
-				accumPixel        = 0;
-				brightestNeighbor = 0;
-				
-				inputPtr = inputPtr - imageWidth - 1;			// 1
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				inputPtr++;										// 2
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				inputPtr++;										// 3
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				inputPtr = inputPtr + imageWidth - 2;			// 4
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				inputPtr++;										// 5 - center pixel
-				aPixel = *inputPtr;
-				thisPixel = aPixel;
-
-				inputPtr++;										// 6
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				inputPtr = inputPtr + imageWidth - 2;			// 7
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				inputPtr++;										// 8
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				inputPtr++;										// 9
-				aPixel = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-				if (brightestNeighbor < aPixel)
-					brightestNeighbor = aPixel;
-
-				// divide by the number of surrounding pixels
-				accumPixel = accumPixel / 8;
-
-				floatBrightPixel = (float)brightestNeighbor;
-				floatBrightPixel = floatBrightPixel * 1.2;
-
-				floatCenterPixel = (float)thisPixel;
-
-				if (floatCenterPixel > floatBrightPixel)
-					{
-					numHotPixels++;
-					// substitute average
-                    *outputPtr = (UInt16)accumPixel;
-					}
-		
-				}
-			}
-
-		free (tempBuffer);
-		}
-
-//	sprintf(buffer, "fcImage_do_hotPixel_kernel numHotPixels = %d\n", numHotPixels);
-//	Starfish_Log( buffer );
-
-}
-
 // This is the framework initialization routine and needs to be called once upon application startup
 void fcUsb_init(void)
 {
@@ -2100,7 +1816,7 @@ void fcUsb_close(void)
 
 
 	free (gFrameBuffer);
-
+	fcImage_freeFilterScratch();
 
 	for (i = 0; i < kNumCamsSupported; i++)
 		{			